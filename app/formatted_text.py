@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Splits the static text resources shown by FormattedTextLayer into fragments ahead of time, so the watch can
+# load them as-is instead of parsing them every time a window opens. This must match prv_fragment in
+# src/c/util/formatted_text_layer.c.
+#
+# The output is little-endian:
+#   uint16 fragment_count
+#   uint16 reserved
+#   fragment_count * { uint16 text_offset, uint16 text_length, int16 vertical_offset (always 0), uint8 type, uint8 reserved }
+#   the text of each fragment, NUL-terminated, which text_offset is relative to
+
+import os
+import struct
+import sys
+
+FRAGMENT_TYPE_TITLE = 0
+FRAGMENT_TYPE_SUBTITLE = 1
+FRAGMENT_TYPE_BODY = 2
+
+# Relative to resources/text. about.txt isn't here because it's a format string, filled in at runtime.
+PRECOMPILED_TEXTS = [
+    'legal.txt',
+    'feedback_blurb.txt',
+    'report_blurb.txt',
+]
+
+
+def fragment(text):
+    fragments = []
+    body_start = 0
+    pos = text.find(b'#')
+    while pos != -1:
+        fragments.append((FRAGMENT_TYPE_BODY, text[body_start:pos]))
+        hash_count = 0
+        while pos < len(text) and text[pos:pos + 1] in (b'#', b' '):
+            if text[pos:pos + 1] == b'#':
+                hash_count += 1
+            pos += 1
+        end = pos
+        while end < len(text) and text[end:end + 1] != b'\n':
+            end += 1
+        fragments.append((FRAGMENT_TYPE_TITLE if hash_count == 1 else FRAGMENT_TYPE_SUBTITLE, text[pos:end]))
+        if end < len(text):
+            end += 1
+        body_start = end
+        pos = text.find(b'#', body_start)
+    fragments.append((FRAGMENT_TYPE_BODY, text[body_start:]))
+    return fragments
+
+
+def serialise(text):
+    fragments = fragment(text)
+    table = struct.pack('<HH', len(fragments), 0)
+    strings = b''
+    for fragment_type, fragment_text in fragments:
+        table += struct.pack('<HHhBB', len(strings), len(fragment_text), 0, fragment_type, 0)
+        strings += fragment_text + b'\0'
+    return table + strings
+
+
+def convert(file_path, out_path=None):
+    if out_path is None:
+        out_path = os.path.splitext(file_path)[0] + '.ftl'
+    with open(file_path, 'rb') as f:
+        data = serialise(f.read())
+    with open(out_path, 'wb') as o:
+        o.write(data)
+    return out_path
+
+
+def precompile(text_dir):
+    for name in PRECOMPILED_TEXTS:
+        source = os.path.join(text_dir, name)
+        target = os.path.splitext(source)[0] + '.ftl'
+        if os.path.exists(target) and os.path.getmtime(target) >= os.path.getmtime(source):
+            continue
+        convert(source, target)
+
+
+if __name__ == '__main__':
+    for path in sys.argv[1:]:
+        print(convert(path))
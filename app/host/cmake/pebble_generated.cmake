@@ -0,0 +1,101 @@
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Generates, from package.json, the files the Pebble SDK would generate for a real build: message_keys.auto.h,
+# resource_ids.auto.h and the app's PebbleProcessInfo. Resource IDs point at the files in app/resources, so the shim
+# can load them at run time.
+
+# bobby_generate_sdk_files(<platform> <output directory> <list of generated .c files, set in the caller's scope>)
+function(bobby_generate_sdk_files PLATFORM OUT_DIR OUT_SOURCES)
+    set(package_json_path ${APP_DIR}/package.json)
+    file(READ ${package_json_path} package_json)
+    # Regenerate whenever package.json changes.
+    set_property(DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR} APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${package_json_path})
+    file(MAKE_DIRECTORY ${OUT_DIR})
+
+    # Message keys. The SDK numbers them from 10000 in order, and a key like "NAME[9]" takes nine numbers.
+    set(keys_h "#pragma once\n\n#include <stdint.h>\n\n")
+    set(keys_c "#include <stdint.h>\n\n")
+    string(JSON key_count LENGTH ${package_json} pebble messageKeys)
+    set(next_key 10000)
+    # Host tools can also look keys up by name, the way PebbleKit JS refers to them.
+    set(key_names_c "")
+    set(key_values_c "")
+    math(EXPR last_index "${key_count} - 1")
+    foreach(i RANGE ${last_index})
+        string(JSON key GET ${package_json} pebble messageKeys ${i})
+        set(width 1)
+        if(key MATCHES "^([A-Za-z0-9_]+)\\[([0-9]+)\\]$")
+            set(key ${CMAKE_MATCH_1})
+            set(width ${CMAKE_MATCH_2})
+        endif()
+        string(APPEND keys_h "extern uint32_t MESSAGE_KEY_${key};\n")
+        string(APPEND keys_c "uint32_t MESSAGE_KEY_${key} = ${next_key};\n")
+        string(APPEND key_names_c "  \"${key}\",\n")
+        string(APPEND key_values_c "  &MESSAGE_KEY_${key},\n")
+        math(EXPR next_key "${next_key} + ${width}")
+    endforeach()
+    string(APPEND keys_c "\nconst char *const g_shim_message_key_names[] = {\n${key_names_c}};\n")
+    string(APPEND keys_c "const uint32_t *const g_shim_message_key_values[] = {\n${key_values_c}};\n")
+    string(APPEND keys_c "const uint32_t g_shim_message_key_count = ${key_count};\n")
+
+    # Resources, numbered from 1 in the order package.json lists the ones this platform gets. A file with a
+    # "~platform" variant next to it uses that instead, as the SDK does.
+    set(ids_h "#pragma once\n\n")
+    set(files_c "#include <stdint.h>\n\n// Indexed by resource ID; there is no resource 0.\nconst char *const g_shim_resource_files[] = {\n  0,\n")
+    string(JSON media_count LENGTH ${package_json} pebble resources media)
+    set(next_id 1)
+    math(EXPR last_index "${media_count} - 1")
+    foreach(i RANGE ${last_index})
+        string(JSON entry GET ${package_json} pebble resources media ${i})
+        string(JSON targets ERROR_VARIABLE no_targets GET ${entry} targetPlatforms)
+        if(NOT no_targets AND NOT targets MATCHES "\"${PLATFORM}\"")
+            continue()
+        endif()
+        string(JSON name GET ${entry} name)
+        string(JSON file GET ${entry} file)
+        set(path ${APP_DIR}/resources/${file})
+        get_filename_component(dir ${path} DIRECTORY)
+        get_filename_component(stem ${path} NAME_WLE)
+        get_filename_component(ext ${path} LAST_EXT)
+        if(EXISTS ${dir}/${stem}~${PLATFORM}${ext})
+            set(path ${dir}/${stem}~${PLATFORM}${ext})
+        endif()
+        string(APPEND ids_h "#define RESOURCE_ID_${name} ${next_id}\n")
+        string(APPEND files_c "  \"${path}\",\n")
+        math(EXPR next_id "${next_id} + 1")
+    endforeach()
+    string(APPEND files_c "};\nconst uint32_t g_shim_resource_count = ${next_id};\n")
+
+    # The version the app reports comes from package.json's "major.minor.patch".
+    string(JSON version GET ${package_json} version)
+    string(JSON display_name GET ${package_json} pebble displayName)
+    string(REPLACE "." ";" version_parts ${version})
+    list(GET version_parts 0 major)
+    list(GET version_parts 1 minor)
+    set(info_c "#include <pebble_process_info.h>\n\nconst PebbleProcessInfo __pbl_app_info = {\n")
+    string(APPEND info_c "  .process_version = { .major = ${major}, .minor = ${minor} },\n  .name = \"${display_name}\",\n};\n")
+
+    # Only touch files whose contents changed, so reconfiguring doesn't rebuild everything.
+    file(CONFIGURE OUTPUT ${OUT_DIR}/message_keys.auto.h CONTENT "${keys_h}" @ONLY)
+    file(CONFIGURE OUTPUT ${OUT_DIR}/message_keys.auto.c CONTENT "${keys_c}" @ONLY)
+    file(CONFIGURE OUTPUT ${OUT_DIR}/resource_ids.auto.h CONTENT "${ids_h}" @ONLY)
+    file(CONFIGURE OUTPUT ${OUT_DIR}/resource_files.auto.c CONTENT "${files_c}" @ONLY)
+    file(CONFIGURE OUTPUT ${OUT_DIR}/pebble_process_info.auto.c CONTENT "${info_c}" @ONLY)
+    set(${OUT_SOURCES}
+            ${OUT_DIR}/message_keys.auto.c
+            ${OUT_DIR}/resource_files.auto.c
+            ${OUT_DIR}/pebble_process_info.auto.c
+            PARENT_SCOPE)
+endfunction()
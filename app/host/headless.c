@@ -0,0 +1,120 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the whole app on the host with no screen and no phone attached: it starts, draws, sends whatever it sends,
+// and after a while of simulated time it's told to stop. What it did is summarised at the end.
+//
+//   bobby_headless [--seconds N] [--heap BYTES] [--launch user|quick|phone|wakeup] [--screenshot FILE.ppm]
+//
+// Exits non-zero if the app ran out of memory or never drew anything.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble_shim.h>
+
+// Roughly what an app gets on the Pebble Time series once the firmware has taken its share.
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define DEFAULT_SECONDS 30
+
+int bobby_app_main(void);
+
+static int s_messages_sent;
+static size_t s_bytes_sent;
+
+static AppMessageResult prv_outbox(const uint8_t *data, size_t size, void *context);
+static bool prv_parse_launch_reason(const char *name, AppLaunchReason *reason);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  uint32_t seconds = DEFAULT_SECONDS;
+  AppLaunchReason reason = APP_LAUNCH_USER;
+  const char *screenshot_path = NULL;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--seconds") == 0 && arg + 1 < argc) {
+      seconds = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--launch") == 0 && arg + 1 < argc) {
+      if (!prv_parse_launch_reason(argv[++arg], &reason)) {
+        prv_usage();
+        return 2;
+      }
+    } else if (strcmp(argv[arg], "--screenshot") == 0 && arg + 1 < argc) {
+      screenshot_path = argv[++arg];
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+
+  sim_heap_init(heap_size);
+  pebble_shim_init();
+  pebble_shim_set_launch_reason(reason);
+  pebble_shim_set_outbox_handler(prv_outbox, NULL);
+  pebble_shim_set_event_loop_duration(seconds * 1000);
+
+  bobby_app_main();
+
+  // The app has left its event loop but hasn't exited yet, so what's on screen is what it last drew.
+  if (screenshot_path && !pebble_shim_write_ppm(screenshot_path)) {
+    fprintf(stderr, "Couldn't write %s\n", screenshot_path);
+  }
+  const SimHeapStats stats = sim_heap_get_stats();
+  printf("Ran for %u simulated seconds.\n", seconds);
+  printf("Frames drawn:       %d\n", pebble_shim_render_count());
+  printf("Messages sent:      %d (%zu bytes)\n", s_messages_sent, s_bytes_sent);
+  printf("Heap:               %zu bytes\n", stats.size);
+  printf("Peak heap use:      %zu bytes\n", stats.peak_used);
+  printf("Still allocated:    %zu bytes\n", stats.used);
+  printf("Failed allocations: %d (%d from fragmentation)\n", stats.failures, stats.fragmented_failures);
+  const bool ok = stats.failures == 0 && pebble_shim_render_count() > 0;
+
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+static AppMessageResult prv_outbox(const uint8_t *data, size_t size, void *context) {
+  ++s_messages_sent;
+  s_bytes_sent += size;
+  return APP_MSG_OK;
+}
+
+static bool prv_parse_launch_reason(const char *name, AppLaunchReason *reason) {
+  static const struct {
+    const char *name;
+    AppLaunchReason reason;
+  } s_reasons[] = {
+    { "user", APP_LAUNCH_USER },
+    { "quick", APP_LAUNCH_QUICK_LAUNCH },
+    { "phone", APP_LAUNCH_PHONE },
+    { "wakeup", APP_LAUNCH_WAKEUP },
+  };
+  for (size_t i = 0; i < sizeof(s_reasons) / sizeof(s_reasons[0]); ++i) {
+    if (strcmp(name, s_reasons[i].name) == 0) {
+      *reason = s_reasons[i].reason;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "Usage: bobby_headless [--seconds N] [--heap BYTES] [--launch user|quick|phone|wakeup] "
+                  "[--screenshot FILE.ppm]\n");
+}
@@ -0,0 +1,425 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the app's allocator and conversation storage against a simulated watch heap, so changes to either can be
+// compared without a watch.
+//
+//   heap_sim [--heap BYTES] [--verbose] trace FILE
+//     Replays the "trace:" lines bmalloc logs at APP_LOG_LEVEL_DEBUG_VERBOSE. Set BOBBY_DEBUG_LEVEL to that in
+//     util/debug_state.h, and save the app's logs while doing whatever you want to reproduce.
+//   heap_sim [--heap BYTES] [--verbose] conversation [TURNS [SEED]]
+//     Holds a long, randomly generated conversation, deleting the oldest entries under memory pressure the way
+//     ConversationManager does.
+//   heap_sim [--heap BYTES] [--verbose] images [STEPS [SEEDS]]
+//     Runs a random mix of images and short-lived allocations twice for each seed from 1 to SEEDS: once evicting images
+//     the way the image manager does, picking by size with memory_pressure_plan_eviction, and once evicting the oldest
+//     first. Fails if picking by size comes out worse overall.
+//
+// The first two finish with a report on how the heap and the bmalloc pools fared.
+//
+// To build it: cmake -S app -B build/host && cmake --build build/host
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <stdarg.h>
+
+#include "converse/conversation.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+
+// The simulator's own bookkeeping doesn't come out of the watch heap.
+#undef malloc
+#undef free
+
+// Roughly what an app gets on the Pebble Time series once the firmware has taken its share.
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+// Recorded pointers, and what they were replayed as. Must be a power of two.
+#define POINTER_MAP_SIZE (1 << 16)
+// The images mode holds at most this many images, and this many short-lived allocations at once.
+#define MAX_IMAGES 32
+#define MAX_TRANSIENTS 48
+
+typedef enum {
+  EvictionPlanned,
+  EvictionOldestFirst,
+} EvictionPolicy;
+
+typedef struct {
+  EvictionPolicy policy;
+  // Oldest first, as the image manager keeps them.
+  void *images[MAX_IMAGES];
+  size_t image_sizes[MAX_IMAGES];
+  int image_count;
+  int images_evicted;
+} ImageSim;
+
+typedef struct {
+  int failures;
+  int images_evicted;
+} ImageSimResult;
+
+typedef struct {
+  uint64_t recorded;
+  void *replayed;
+} PointerMapping;
+
+static bool s_verbose;
+static PointerMapping *s_pointer_map;
+
+static int prv_replay_trace(const char *path);
+static int prv_run_conversation(int turns, unsigned int seed);
+static size_t prv_delete_oldest_entries(size_t bytes_needed, void *context);
+static int prv_compare_image_eviction(int steps, int seeds, size_t heap_size);
+static ImageSimResult prv_run_images(EvictionPolicy policy, int steps, unsigned int seed, size_t heap_size);
+static size_t prv_evict_images(size_t bytes_needed, void *context);
+static void prv_random_text(char *buffer, int min_length, int max_length);
+static PointerMapping *prv_find_mapping(uint64_t recorded, bool create);
+static void prv_print_report(void);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  int arg = 1;
+  for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg) {
+    if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--verbose") == 0) {
+      s_verbose = true;
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+  if (arg >= argc) {
+    prv_usage();
+    return 2;
+  }
+  if (strcmp(argv[arg], "images") == 0) {
+    int steps = arg + 1 < argc ? atoi(argv[arg + 1]) : 20000;
+    int seeds = arg + 2 < argc ? atoi(argv[arg + 2]) : 4;
+    return prv_compare_image_eviction(steps, seeds, heap_size);
+  }
+  sim_heap_init(heap_size);
+  memory_pressure_init();
+  bmalloc_init();
+  int result;
+  if (strcmp(argv[arg], "trace") == 0 && arg + 1 < argc) {
+    result = prv_replay_trace(argv[arg + 1]);
+  } else if (strcmp(argv[arg], "conversation") == 0) {
+    int turns = arg + 1 < argc ? atoi(argv[arg + 1]) : 100;
+    unsigned int seed = arg + 2 < argc ? strtoul(argv[arg + 2], NULL, 0) : 1;
+    result = prv_run_conversation(turns, seed);
+  } else {
+    prv_usage();
+    return 2;
+  }
+  if (result == 0) {
+    prv_print_report();
+  }
+  sim_heap_deinit();
+  return result;
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  if (!s_verbose) {
+    return;
+  }
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "%s:%d> ", src_filename, src_line_number);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+// Conversations only ask the image manager to drop their map images, and there are none here.
+void image_manager_destroy_image(int image_id) {}
+
+static int prv_replay_trace(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return 1;
+  }
+  s_pointer_map = calloc(POINTER_MAP_SIZE, sizeof(PointerMapping));
+  int recorded_failures = 0;
+  int replayed_failures = 0;
+  int reservations_failed = 0;
+  int unknown_frees = 0;
+  char line[512];
+  while (fgets(line, sizeof(line), file)) {
+    const char *trace = strstr(line, "trace: ");
+    if (!trace) {
+      continue;
+    }
+    trace += strlen("trace: ");
+    size_t size;
+    char recorded[32];
+    if (sscanf(trace, "alloc %zu %31s", &size, recorded) == 2) {
+      void *ptr = bmalloc(size);
+      if (!ptr) {
+        replayed_failures++;
+      }
+      uint64_t address = strtoull(recorded, NULL, 16);
+      if (address == 0) {
+        // The watch ran out, so nothing will free this later.
+        recorded_failures++;
+        bfree(ptr);
+        continue;
+      }
+      prv_find_mapping(address, true)->replayed = ptr;
+    } else if (sscanf(trace, "free %31s", recorded) == 1) {
+      PointerMapping *mapping = prv_find_mapping(strtoull(recorded, NULL, 16), false);
+      if (!mapping) {
+        // Allocated before the log started.
+        unknown_frees++;
+        continue;
+      }
+      bfree(mapping->replayed);
+      mapping->replayed = NULL;
+      mapping->recorded = 0;
+    } else if (sscanf(trace, "reserve %zu", &size) == 1) {
+      if (!bmalloc_reserve(size)) {
+        reservations_failed++;
+      }
+    }
+  }
+  fclose(file);
+  free(s_pointer_map);
+  printf("Trace: %d allocations failed on the watch, %d in replay; %d reservations failed; %d unknown frees.\n",
+         recorded_failures, replayed_failures, reservations_failed, unknown_frees);
+  return 0;
+}
+
+static int prv_run_conversation(int turns, unsigned int seed) {
+  srand(seed);
+  Conversation *conversation = conversation_create();
+  int added = 0;
+  MemoryPressureCallback *callback = memory_pressure_register_callback(prv_delete_oldest_entries, 1, conversation);
+  char text[256];
+  for (int turn = 0; turn < turns; ++turn) {
+    prv_random_text(text, 10, 120);
+    conversation_add_prompt(conversation, text);
+    added++;
+    if (rand() % 3 == 0) {
+      prv_random_text(text, 10, 60);
+      conversation_add_thought(conversation, text);
+      added++;
+    }
+    conversation_start_response(conversation);
+    added++;
+    const int fragments = 1 + rand() % 30;
+    for (int i = 0; i < fragments; ++i) {
+      prv_random_text(text, 5, 60);
+      conversation_add_response_fragment(conversation, text);
+    }
+    conversation_complete_response(conversation);
+    if (turn % 3 == 0) {
+      // Something else wants a big block now and then, like dictation does.
+      bmalloc_reserve(2048);
+    }
+  }
+  printf("Conversation: %d turns, %d entries left, %d deleted.\n", turns, conversation_length(conversation),
+         added - conversation_length(conversation));
+  memory_pressure_unregister_callback(callback);
+  conversation_destroy(conversation);
+  return 0;
+}
+
+// What ConversationManager's memory pressure handler does, without the rest of the manager.
+static size_t prv_delete_oldest_entries(size_t bytes_needed, void *context) {
+  Conversation *conversation = context;
+  if (conversation_length(conversation) <= 2) {
+    return 0;
+  }
+  const int free_before = bmalloc_bytes_free();
+  while (conversation_length(conversation) > 2 && bmalloc_bytes_free() - free_before < (int)bytes_needed) {
+    conversation_delete_first_entry(conversation);
+  }
+  return memory_pressure_bytes_freed_since(free_before);
+}
+
+static int prv_compare_image_eviction(int steps, int seeds, size_t heap_size) {
+  printf("Images: %d steps per seed.\n", steps);
+  printf("        seed  failed by size  failed oldest first  evicted by size  evicted oldest first\n");
+  ImageSimResult planned_total = {0};
+  ImageSimResult oldest_total = {0};
+  for (int seed = 1; seed <= seeds; ++seed) {
+    const ImageSimResult planned = prv_run_images(EvictionPlanned, steps, seed, heap_size);
+    const ImageSimResult oldest = prv_run_images(EvictionOldestFirst, steps, seed, heap_size);
+    printf("        %4d  %14d  %19d  %15d  %20d\n", seed, planned.failures, oldest.failures, planned.images_evicted,
+           oldest.images_evicted);
+    planned_total.failures += planned.failures;
+    planned_total.images_evicted += planned.images_evicted;
+    oldest_total.failures += oldest.failures;
+    oldest_total.images_evicted += oldest.images_evicted;
+  }
+  printf("         all  %14d  %19d  %15d  %20d\n", planned_total.failures, oldest_total.failures,
+         planned_total.images_evicted, oldest_total.images_evicted);
+  if (planned_total.failures > oldest_total.failures) {
+    printf("Picking images by size failed more often than evicting the oldest.\n");
+    return 1;
+  }
+  return 0;
+}
+
+// Images of a few kilobytes arrive now and then and are kept until memory pressure evicts them, while small
+// allocations come and go around them and a big block is reserved every so often, as dictation does. A failure is an
+// allocation or reservation that couldn't be met even after evicting everything that could be.
+static ImageSimResult prv_run_images(EvictionPolicy policy, int steps, unsigned int seed, size_t heap_size) {
+  sim_heap_init(heap_size);
+  memory_pressure_init();
+  bmalloc_init();
+  srand(seed);
+  ImageSim sim = { .policy = policy };
+  MemoryPressureCallback *callback = memory_pressure_register_callback(prv_evict_images, 0, &sim);
+  void *transients[MAX_TRANSIENTS] = {0};
+  int failures = 0;
+  for (int step = 0; step < steps; ++step) {
+    const int roll = rand() % 150;
+    if (roll == 0) {
+      if (!bmalloc_reserve(2048)) {
+        failures++;
+      }
+    } else if (roll < 5) {
+      if (sim.image_count == MAX_IMAGES) {
+        // Nothing keeps this many; let the oldest go as if its segment had been deleted.
+        bfree(sim.images[0]);
+        memmove(sim.images, sim.images + 1, sizeof(sim.images[0]) * (MAX_IMAGES - 1));
+        memmove(sim.image_sizes, sim.image_sizes + 1, sizeof(sim.image_sizes[0]) * (MAX_IMAGES - 1));
+        sim.image_count--;
+      }
+      const size_t size = 1024 + rand() % 5121;
+      void *image = bmalloc(size);
+      if (!image) {
+        failures++;
+        continue;
+      }
+      sim.images[sim.image_count] = image;
+      sim.image_sizes[sim.image_count] = size;
+      sim.image_count++;
+    } else {
+      const int slot = rand() % MAX_TRANSIENTS;
+      bfree(transients[slot]);
+      transients[slot] = bmalloc(16 + rand() % 301);
+      if (!transients[slot]) {
+        failures++;
+      }
+    }
+  }
+  for (int i = 0; i < MAX_TRANSIENTS; ++i) {
+    bfree(transients[i]);
+  }
+  for (int i = 0; i < sim.image_count; ++i) {
+    bfree(sim.images[i]);
+  }
+  memory_pressure_unregister_callback(callback);
+  sim_heap_deinit();
+  return (ImageSimResult) {
+    .failures = failures,
+    .images_evicted = sim.images_evicted,
+  };
+}
+
+// What ImageManager's memory pressure handler does, or evicting oldest first as it used to.
+static size_t prv_evict_images(size_t bytes_needed, void *context) {
+  ImageSim *sim = context;
+  int count = sim->image_count;
+  if (count > MEMORY_PRESSURE_MAX_CANDIDATES) {
+    count = MEMORY_PRESSURE_MAX_CANDIDATES;
+  }
+  bool evict[MEMORY_PRESSURE_MAX_CANDIDATES];
+  if (sim->policy == EvictionPlanned) {
+    memory_pressure_plan_eviction(sim->image_sizes, count, bytes_needed, evict);
+  } else {
+    size_t planned = 0;
+    for (int i = 0; i < count; ++i) {
+      evict[i] = planned < bytes_needed;
+      if (evict[i]) {
+        planned += sim->image_sizes[i];
+      }
+    }
+  }
+  const int free_before = bmalloc_bytes_free();
+  int kept = 0;
+  int evicted = 0;
+  for (int i = 0; i < sim->image_count; ++i) {
+    if (i < count && evict[i]) {
+      bfree(sim->images[i]);
+      evicted++;
+      continue;
+    }
+    sim->images[kept] = sim->images[i];
+    sim->image_sizes[kept] = sim->image_sizes[i];
+    kept++;
+  }
+  sim->image_count = kept;
+  sim->images_evicted += evicted;
+  if (evicted == 0) {
+    return 0;
+  }
+  return memory_pressure_bytes_freed_since(free_before);
+}
+
+static void prv_random_text(char *buffer, int min_length, int max_length) {
+  const int length = min_length + rand() % (max_length - min_length + 1);
+  for (int i = 0; i < length; ++i) {
+    buffer[i] = rand() % 6 == 0 ? ' ' : 'a' + rand() % 26;
+  }
+  buffer[length] = '\0';
+}
+
+static PointerMapping *prv_find_mapping(uint64_t recorded, bool create) {
+  // Addresses are at least four-byte aligned, so the low bits are no use for hashing.
+  size_t index = (recorded >> 2) & (POINTER_MAP_SIZE - 1);
+  for (size_t probes = 0; probes < POINTER_MAP_SIZE; ++probes) {
+    PointerMapping *mapping = &s_pointer_map[index];
+    if (mapping->recorded == recorded) {
+      return mapping;
+    }
+    if (mapping->recorded == 0) {
+      if (!create) {
+        return NULL;
+      }
+      mapping->recorded = recorded;
+      return mapping;
+    }
+    index = (index + 1) & (POINTER_MAP_SIZE - 1);
+  }
+  fprintf(stderr, "Too many live allocations in trace.\n");
+  exit(1);
+}
+
+static void prv_print_report(void) {
+  SimHeapStats heap = sim_heap_get_stats();
+  printf("Heap: %zu bytes, peak use %zu, %zu in use at the end.\n", heap.size, heap.peak_used, heap.used);
+  printf("      %d allocations; %d failed and had to wait for memory to be freed, %d of those only for lack of a big enough gap.\n",
+         heap.allocations, heap.failures, heap.fragmented_failures);
+  printf("      %d free blocks at the end, the largest %zu bytes.\n", heap.free_blocks, heap.largest_free_block);
+  printf("Pools: size  slabs  in use  peak  allocations  fallbacks\n");
+  for (int i = 0; i < bmalloc_pool_count(); ++i) {
+    const BmallocPoolStats *pool = bmalloc_get_pool_stats(i);
+    printf("       %4d  %5d  %6d  %4d  %11u  %9u\n", pool->size, pool->slabs, pool->in_use, pool->peak_in_use,
+           (unsigned)pool->allocations, (unsigned)pool->fallbacks);
+  }
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "usage: heap_sim [--heap BYTES] [--verbose] trace FILE\n"
+                  "       heap_sim [--heap BYTES] [--verbose] conversation [TURNS [SEED]]\n"
+                  "       heap_sim [--heap BYTES] [--verbose] images [STEPS [SEEDS]]\n");
+}
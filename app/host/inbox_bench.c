@@ -0,0 +1,328 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Counts how many tuples the conversation manager reads to handle each kind of message the phone sends, and what the
+// same messages cost the way the inbox used to be decoded:
+//
+// - dict_find per field: a chain of key comparisons over the message, with every widget field then looked up with
+//   its own dict_find, each walking the message from the start.
+// - one scan per widget: the same chain, with each widget's fields gathered in one more pass over the message.
+// - key table: what conversation_manager.c does now, measured by handing the message to the app. The router's own
+//   pass over the message, which the conversation manager shares with everything else, is counted separately.
+//
+//   bobby_inbox_bench [--heap BYTES]
+//
+// The messages are laid out as PebbleKit JS sends them (see pkjs/widgets and emulator/prerecorded.js). Exits
+// non-zero if the conversation manager reads any tuple more than once.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+#include <pebble_shim.h>
+
+#include "converse/conversation_manager.h"
+#include "util/app_message_router.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define MESSAGE_BUFFER_SIZE 512
+#define MAX_FIELDS 16
+
+typedef enum {
+  BenchChat,
+  BenchChatDone,
+  BenchFunction,
+  BenchWeatherOneDay,
+  BenchWeatherNow,
+  BenchWeatherThreeDays,
+  BenchTimer,
+  BenchHighlight,
+  BenchMessageCount,
+} BenchMessageId;
+
+typedef struct {
+  const uint32_t *key;
+  // For the elements of array keys.
+  uint8_t index;
+  // Sent as a string if set, otherwise as an int32.
+  const char *string;
+  int32_t number;
+} BenchField;
+
+typedef struct {
+  const char *name;
+  BenchField fields[MAX_FIELDS];
+} BenchMessage;
+
+typedef struct {
+  int tuples;
+  int original;
+  int one_scan;
+  int router;
+  int manager;
+} BenchVisits;
+
+static const BenchMessage s_messages[BenchMessageCount] = {
+  [BenchChat] = { "CHAT fragment", {
+    { &MESSAGE_KEY_CHAT, .string = "wind " },
+  } },
+  [BenchChatDone] = { "CHAT_DONE", {
+    { &MESSAGE_KEY_CHAT_DONE, .number = 1 },
+  } },
+  [BenchFunction] = { "FUNCTION", {
+    { &MESSAGE_KEY_FUNCTION, .string = "Checking the weather nearby..." },
+  } },
+  [BenchWeatherOneDay] = { "weather: one day", {
+    { &MESSAGE_KEY_WEATHER_WIDGET, .number = 1 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_HIGH, .number = 19 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_LOW, .number = 9 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_LOCATION, .string = "REDWOOD CITY" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY, .string = "Partly Cloudy" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_TEMP_UNIT, .string = "°C" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON, .number = 7 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_OF_WEEK, .string = "Saturday" },
+  } },
+  [BenchWeatherNow] = { "weather: now", {
+    { &MESSAGE_KEY_WEATHER_WIDGET, .number = 2 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_CURRENT_TEMP, .number = 12 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_FEELS_LIKE, .number = 12 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_LOCATION, .string = "REDWOOD CITY" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY, .string = "Fair" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_TEMP_UNIT, .string = "°C" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED, .number = 1 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED_UNIT, .string = "mph" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON, .number = 8 },
+  } },
+  [BenchWeatherThreeDays] = { "weather: three days", {
+    { &MESSAGE_KEY_WEATHER_WIDGET, .number = 3 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_LOCATION, .string = "REDWOOD CITY" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_DAY, 0, .string = "SAT" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_HIGH, 0, .number = 19 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_LOW, 0, .number = 9 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_ICON, 0, .number = 7 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_DAY, 1, .string = "SUN" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_HIGH, 1, .number = 21 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_LOW, 1, .number = 10 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_ICON, 1, .number = 8 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_DAY, 2, .string = "MON" },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_HIGH, 2, .number = 17 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_LOW, 2, .number = 11 },
+    { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_ICON, 2, .number = 3 },
+  } },
+  [BenchTimer] = { "timer", {
+    { &MESSAGE_KEY_TIMER_WIDGET, .number = 1 },
+    { &MESSAGE_KEY_TIMER_WIDGET_TARGET_TIME, .number = 1700000000 },
+    { &MESSAGE_KEY_TIMER_WIDGET_NAME, .string = "Pasta" },
+  } },
+  [BenchHighlight] = { "highlight", {
+    { &MESSAGE_KEY_HIGHLIGHT_WIDGET, .number = 1 },
+    { &MESSAGE_KEY_HIGHLIGHT_WIDGET_PRIMARY, .string = "42" },
+    { &MESSAGE_KEY_HIGHLIGHT_WIDGET_SECONDARY, .string = "km" },
+  } },
+};
+
+// "What's the weather like?" from emulator/prerecorded.js: a function call, the widget, then the answer a word at a
+// time.
+static const struct {
+  BenchMessageId message;
+  int repeat;
+} s_response[] = {
+  { BenchFunction, 1 },
+  { BenchWeatherNow, 1 },
+  { BenchChat, 11 },
+  { BenchChatDone, 1 },
+};
+
+static uint32_t prv_encode(const BenchMessage *message, uint8_t *buffer, size_t size);
+static BenchVisits prv_count_visits(const BenchMessage *message);
+static void prv_decode_with_dict_find(DictionaryIterator *iter);
+static void prv_decode_with_one_scan(DictionaryIterator *iter);
+static void prv_find_all(DictionaryIterator *iter, const uint32_t *keys, int count);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+
+  sim_heap_init(heap_size);
+  pebble_shim_init();
+  memory_pressure_init();
+  bmalloc_init();
+  app_message_router_init();
+  conversation_manager_init();
+  events_app_message_open();
+  ConversationManager *manager = conversation_manager_create();
+
+  printf("Tuples read per message:\n");
+  printf("  %-22s %7s %14s %14s %10s %8s\n", "", "tuples", "dict_find", "one scan", "key table", "router");
+  bool ok = true;
+  BenchVisits visits[BenchMessageCount];
+  for (int i = 0; i < BenchMessageCount; ++i) {
+    visits[i] = prv_count_visits(&s_messages[i]);
+    printf("  %-22s %7d %14d %14d %10d %8d\n", s_messages[i].name, visits[i].tuples, visits[i].original,
+           visits[i].one_scan, visits[i].manager, visits[i].router);
+    if (visits[i].manager > visits[i].tuples) {
+      printf("  The conversation manager read some of these tuples more than once.\n");
+      ok = false;
+    }
+  }
+
+  BenchVisits response = {0};
+  int response_messages = 0;
+  for (size_t i = 0; i < sizeof(s_response) / sizeof(s_response[0]); ++i) {
+    const BenchVisits *message = &visits[s_response[i].message];
+    response.tuples += message->tuples * s_response[i].repeat;
+    response.original += message->original * s_response[i].repeat;
+    response.one_scan += message->one_scan * s_response[i].repeat;
+    response.manager += message->manager * s_response[i].repeat;
+    response.router += message->router * s_response[i].repeat;
+    response_messages += s_response[i].repeat;
+  }
+  printf("  %-22s %7d %14d %14d %10d %8d\n", "a weather answer", response.tuples, response.original,
+         response.one_scan, response.manager, response.router);
+  printf("  (%d messages: FUNCTION, the current weather, 11 CHAT fragments and CHAT_DONE)\n", response_messages);
+
+  conversation_manager_destroy(manager);
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+static uint32_t prv_encode(const BenchMessage *message, uint8_t *buffer, size_t size) {
+  DictionaryIterator iter;
+  dict_write_begin(&iter, buffer, size);
+  for (int i = 0; i < MAX_FIELDS && message->fields[i].key; ++i) {
+    const BenchField *field = &message->fields[i];
+    const uint32_t key = *field->key + field->index;
+    if (field->string) {
+      dict_write_cstring(&iter, key, field->string);
+    } else {
+      dict_write_int32(&iter, key, field->number);
+    }
+  }
+  return dict_write_end(&iter);
+}
+
+static BenchVisits prv_count_visits(const BenchMessage *message) {
+  uint8_t buffer[MESSAGE_BUFFER_SIZE];
+  const uint32_t size = prv_encode(message, buffer, sizeof(buffer));
+  BenchVisits visits = {0};
+  while (visits.tuples < MAX_FIELDS && message->fields[visits.tuples].key) {
+    visits.tuples++;
+  }
+
+  DictionaryIterator iter;
+  dict_read_begin_from_buffer(&iter, buffer, size);
+  uint32_t before = pebble_shim_dict_tuple_visits();
+  prv_decode_with_dict_find(&iter);
+  visits.original = pebble_shim_dict_tuple_visits() - before;
+
+  dict_read_begin_from_buffer(&iter, buffer, size);
+  before = pebble_shim_dict_tuple_visits();
+  prv_decode_with_one_scan(&iter);
+  visits.one_scan = pebble_shim_dict_tuple_visits() - before;
+
+  before = pebble_shim_dict_tuple_visits();
+  pebble_shim_deliver_inbox(buffer, size);
+  const int delivered = pebble_shim_dict_tuple_visits() - before;
+  visits.router = app_message_router_get_stats()->last_tuples_visited;
+  visits.manager = delivered - visits.router;
+  return visits;
+}
+
+// The tuple handling of the inbox handler as it was before widgets were decoded in one pass. The key comparisons
+// don't read anything, so only the widgets' lookups are kept.
+static void prv_decode_with_dict_find(DictionaryIterator *iter) {
+  for (Tuple *tuple = dict_read_first(iter); tuple; tuple = dict_read_next(iter)) {
+    DictionaryIterator copy = *iter;
+    if (tuple->key == MESSAGE_KEY_WEATHER_WIDGET) {
+      switch (tuple->value->int32) {
+        case 1: {
+          const uint32_t keys[] = {
+            MESSAGE_KEY_WEATHER_WIDGET_DAY_HIGH, MESSAGE_KEY_WEATHER_WIDGET_DAY_LOW,
+            MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON, MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY,
+            MESSAGE_KEY_WEATHER_WIDGET_LOCATION, MESSAGE_KEY_WEATHER_WIDGET_TEMP_UNIT,
+            MESSAGE_KEY_WEATHER_WIDGET_DAY_OF_WEEK,
+          };
+          prv_find_all(&copy, keys, sizeof(keys) / sizeof(keys[0]));
+          break;
+        }
+        case 2: {
+          const uint32_t keys[] = {
+            MESSAGE_KEY_WEATHER_WIDGET_CURRENT_TEMP, MESSAGE_KEY_WEATHER_WIDGET_FEELS_LIKE,
+            MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON, MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED,
+            MESSAGE_KEY_WEATHER_WIDGET_LOCATION, MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY,
+            MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED_UNIT,
+          };
+          prv_find_all(&copy, keys, sizeof(keys) / sizeof(keys[0]));
+          break;
+        }
+        case 3: {
+          const uint32_t location = MESSAGE_KEY_WEATHER_WIDGET_LOCATION;
+          prv_find_all(&copy, &location, 1);
+          for (uint32_t i = 0; i < 3; ++i) {
+            const uint32_t keys[] = {
+              MESSAGE_KEY_WEATHER_WIDGET_MULTI_HIGH + i, MESSAGE_KEY_WEATHER_WIDGET_MULTI_LOW + i,
+              MESSAGE_KEY_WEATHER_WIDGET_MULTI_ICON + i, MESSAGE_KEY_WEATHER_WIDGET_MULTI_DAY + i,
+            };
+            prv_find_all(&copy, keys, sizeof(keys) / sizeof(keys[0]));
+          }
+          break;
+        }
+      }
+    } else if (tuple->key == MESSAGE_KEY_TIMER_WIDGET) {
+      const uint32_t keys[] = { MESSAGE_KEY_TIMER_WIDGET_TARGET_TIME, MESSAGE_KEY_TIMER_WIDGET_NAME };
+      prv_find_all(&copy, keys, sizeof(keys) / sizeof(keys[0]));
+    } else if (tuple->key == MESSAGE_KEY_HIGHLIGHT_WIDGET) {
+      const uint32_t keys[] = { MESSAGE_KEY_HIGHLIGHT_WIDGET_PRIMARY, MESSAGE_KEY_HIGHLIGHT_WIDGET_SECONDARY };
+      prv_find_all(&copy, keys, sizeof(keys) / sizeof(keys[0]));
+    }
+  }
+}
+
+// The same, once widget fields were gathered in a single extra pass over the message.
+static void prv_decode_with_one_scan(DictionaryIterator *iter) {
+  for (Tuple *tuple = dict_read_first(iter); tuple; tuple = dict_read_next(iter)) {
+    if (tuple->key == MESSAGE_KEY_WEATHER_WIDGET || tuple->key == MESSAGE_KEY_TIMER_WIDGET ||
+        tuple->key == MESSAGE_KEY_HIGHLIGHT_WIDGET) {
+      // Every field was checked against the widget's keys; which ones matched doesn't change what was read.
+      DictionaryIterator scan = *iter;
+      Tuple *field = dict_read_first(&scan);
+      while (field) {
+        field = dict_read_next(&scan);
+      }
+    }
+  }
+}
+
+static void prv_find_all(DictionaryIterator *iter, const uint32_t *keys, int count) {
+  for (int i = 0; i < count; ++i) {
+    dict_find(iter, keys[i]);
+  }
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "usage: bobby_inbox_bench [--heap BYTES]\n");
+}
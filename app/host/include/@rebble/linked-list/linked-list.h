@@ -0,0 +1,40 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The @rebble/linked-list package's interface, for host builds. The implementation is in
+// ../../../shim/linked_list.c; like the real one, it allocates its nodes from the app's heap.
+
+#pragma once
+
+#include <pebble.h>
+
+typedef struct LinkedRoot LinkedRoot;
+
+typedef bool (*LinkedListCompare)(void *object1, void *object2);
+typedef bool (*LinkedListForEach)(void *object, void *context);
+
+LinkedRoot *linked_list_create_root(void);
+uint16_t linked_list_count(LinkedRoot *root);
+void linked_list_append(LinkedRoot *root, void *object);
+void linked_list_prepend(LinkedRoot *root, void *object);
+void linked_list_insert(LinkedRoot *root, void *object, uint16_t after);
+void *linked_list_get(LinkedRoot *root, uint16_t index);
+void linked_list_remove(LinkedRoot *root, uint16_t index);
+void linked_list_clear(LinkedRoot *root);
+bool linked_list_contains(LinkedRoot *root, void *object);
+int16_t linked_list_find(LinkedRoot *root, void *object);
+int16_t linked_list_find_compare(LinkedRoot *root, void *object, LinkedListCompare compare);
+void linked_list_foreach(LinkedRoot *root, LinkedListForEach callback, void *context);
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The subset of the pebble-events package the app uses, for host builds. The implementation is in
+// ../../shim/events.c.
+
+#pragma once
+
+#include <pebble.h>
+
+typedef void *EventHandle;
+
+typedef void (*EventTickHandler)(struct tm *tick_time, TimeUnits units_changed, void *context);
+
+typedef struct EventAppMessageHandlers {
+  AppMessageOutboxSent sent;
+  AppMessageOutboxFailed failed;
+  AppMessageInboxReceived received;
+  AppMessageInboxDropped dropped;
+} EventAppMessageHandlers;
+
+EventHandle events_tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+EventHandle events_tick_timer_service_subscribe_context(TimeUnits tick_units, EventTickHandler handler,
+                                                        void *context);
+void events_tick_timer_service_unsubscribe(EventHandle handle);
+
+void events_app_message_request_inbox_size(uint32_t size);
+void events_app_message_request_outbox_size(uint32_t size);
+AppMessageResult events_app_message_open(void);
+EventHandle events_app_message_register_inbox_received(AppMessageInboxReceived received_callback, void *context);
+EventHandle events_app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback, void *context);
+EventHandle events_app_message_register_outbox_sent(AppMessageOutboxSent sent_callback, void *context);
+EventHandle events_app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback, void *context);
+EventHandle events_app_message_subscribe_handlers(EventAppMessageHandlers handlers, void *context);
+void events_app_message_unsubscribe(EventHandle handle);
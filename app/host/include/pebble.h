@@ -0,0 +1,1122 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A stand-in for the Pebble SDK's pebble.h, so app code can be built and run on a normal computer. It only covers
+// what the app actually uses; the implementations are in ../shim. Names, types and behaviour follow the SDK, but
+// nothing here promises to be pixel- or timing-exact.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Everything the app allocates, directly or through the firmware, comes out of a simulated watch heap. See
+// sim_heap.h.
+void *sim_heap_malloc(size_t size);
+void sim_heap_free(void *ptr);
+int heap_bytes_free(void);
+#define malloc(size) sim_heap_malloc(size)
+#define free(ptr) sim_heap_free(ptr)
+
+// The shim builds for one platform at a time; the default is basalt.
+#ifndef PBL_DISPLAY_WIDTH
+#define PBL_DISPLAY_WIDTH 144
+#endif
+#ifndef PBL_DISPLAY_HEIGHT
+#define PBL_DISPLAY_HEIGHT 168
+#endif
+#define PBL_COLOR
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_false)
+#define COLOR_FALLBACK(color, bw) (color)
+
+//
+// Logging
+//
+
+typedef enum {
+  APP_LOG_LEVEL_ERROR = 1,
+  APP_LOG_LEVEL_WARNING = 50,
+  APP_LOG_LEVEL_INFO = 100,
+  APP_LOG_LEVEL_DEBUG = 200,
+  APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+#define APP_LOG(level, fmt, args...) app_log(level, __FILE__, __LINE__, fmt, ## args)
+
+//
+// Status codes
+//
+
+typedef enum {
+  S_SUCCESS = 0,
+  E_ERROR = -1,
+  E_UNKNOWN = -2,
+  E_INTERNAL = -3,
+  E_INVALID_ARGUMENT = -4,
+  E_OUT_OF_MEMORY = -5,
+  E_OUT_OF_STORAGE = -6,
+  E_OUT_OF_RESOURCES = -7,
+  E_RANGE = -8,
+  E_DOES_NOT_EXIST = -9,
+  E_INVALID_OPERATION = -10,
+  E_BUSY = -11,
+  S_TRUE = 1,
+  S_FALSE = 0,
+  S_NO_MORE_ITEMS = 2,
+  S_NO_ACTION_REQUIRED = 3,
+} StatusCode;
+
+typedef int32_t status_t;
+
+//
+// Time
+//
+
+// time() is simulated: it starts at a fixed moment and only moves when the event loop does. See pebble_shim.h.
+time_t shim_time(time_t *tloc);
+#define time(tloc) shim_time(tloc)
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms);
+time_t time_start_of_today(void);
+bool clock_is_24h_style(void);
+
+typedef enum {
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+//
+// Geometry
+//
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+} GPoint;
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GPointZero GPoint(0, 0)
+
+typedef struct {
+  int16_t w;
+  int16_t h;
+} GSize;
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GSizeZero GSize(0, 0)
+
+typedef struct {
+  GPoint origin;
+  GSize size;
+} GRect;
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GRectZero GRect(0, 0, 0, 0)
+
+typedef struct {
+  int16_t top;
+  int16_t right;
+  int16_t bottom;
+  int16_t left;
+} GEdgeInsets;
+#define GEdgeInsets1(value) ((GEdgeInsets){(value), (value), (value), (value)})
+#define GEdgeInsets2(vertical, horizontal) ((GEdgeInsets){(vertical), (horizontal), (vertical), (horizontal)})
+#define GEdgeInsets3(top, horizontal, bottom) ((GEdgeInsets){(top), (horizontal), (bottom), (horizontal)})
+#define GEdgeInsets4(top, right, bottom, left) ((GEdgeInsets){(top), (right), (bottom), (left)})
+#define PRV_GEDGEINSETS(_1, _2, _3, _4, name, ...) name
+#define GEdgeInsets(...) \
+    PRV_GEDGEINSETS(__VA_ARGS__, GEdgeInsets4, GEdgeInsets3, GEdgeInsets2, GEdgeInsets1)(__VA_ARGS__)
+
+typedef enum {
+  GAlignCenter,
+  GAlignTopLeft,
+  GAlignTopRight,
+  GAlignTop,
+  GAlignLeft,
+  GAlignBottom,
+  GAlignRight,
+  GAlignBottomRight,
+  GAlignBottomLeft,
+} GAlign;
+
+typedef enum {
+  GCornerNone = 0,
+  GCornerTopLeft = 1 << 0,
+  GCornerTopRight = 1 << 1,
+  GCornerBottomLeft = 1 << 2,
+  GCornerBottomRight = 1 << 3,
+  GCornersAll = GCornerTopLeft | GCornerTopRight | GCornerBottomLeft | GCornerBottomRight,
+  GCornersTop = GCornerTopLeft | GCornerTopRight,
+  GCornersBottom = GCornerBottomLeft | GCornerBottomRight,
+  GCornersLeft = GCornerTopLeft | GCornerBottomLeft,
+  GCornersRight = GCornerTopRight | GCornerBottomRight,
+} GCornerMask;
+
+bool gpoint_equal(const GPoint *point_a, const GPoint *point_b);
+bool gsize_equal(const GSize *size_a, const GSize *size_b);
+bool grect_equal(const GRect *rect_a, const GRect *rect_b);
+bool grect_is_empty(const GRect *rect);
+bool grect_contains_point(const GRect *rect, const GPoint *point);
+GPoint grect_center_point(const GRect *rect);
+void grect_align(GRect *rect, const GRect *inside_rect, const GAlign alignment, const bool clip);
+void grect_clip(GRect *rect_to_clip, const GRect *rect_clipper);
+GRect grect_crop(GRect rect, const int32_t crop_size_px);
+GRect grect_inset(GRect rect, GEdgeInsets insets);
+
+//
+// Colours
+//
+
+typedef union GColor8 {
+  uint8_t argb;
+  struct {
+    uint8_t b:2;
+    uint8_t g:2;
+    uint8_t r:2;
+    uint8_t a:2;
+  };
+} GColor8;
+typedef GColor8 GColor;
+
+#define GColorFromRGBA(red, green, blue, alpha) \
+    ((GColor8){.a = (uint8_t)(alpha) >> 6, .r = (uint8_t)(red) >> 6, .g = (uint8_t)(green) >> 6, \
+               .b = (uint8_t)(blue) >> 6})
+#define GColorFromRGB(red, green, blue) GColorFromRGBA(red, green, blue, 255)
+#define GColorFromHEX(v) GColorFromRGB(((v) >> 16) & 0xff, ((v) >> 8) & 0xff, ((v) & 0xff))
+
+#define GColorClearARGB8 ((uint8_t)0b00000000)
+#define GColorBlackARGB8 ((uint8_t)0b11000000)
+#define GColorOxfordBlueARGB8 ((uint8_t)0b11000001)
+#define GColorDukeBlueARGB8 ((uint8_t)0b11000010)
+#define GColorBlueARGB8 ((uint8_t)0b11000011)
+#define GColorDarkGreenARGB8 ((uint8_t)0b11000100)
+#define GColorMidnightGreenARGB8 ((uint8_t)0b11000101)
+#define GColorCobaltBlueARGB8 ((uint8_t)0b11000110)
+#define GColorBlueMoonARGB8 ((uint8_t)0b11000111)
+#define GColorIslamicGreenARGB8 ((uint8_t)0b11001000)
+#define GColorJaegerGreenARGB8 ((uint8_t)0b11001001)
+#define GColorTiffanyBlueARGB8 ((uint8_t)0b11001010)
+#define GColorVividCeruleanARGB8 ((uint8_t)0b11001011)
+#define GColorGreenARGB8 ((uint8_t)0b11001100)
+#define GColorMalachiteARGB8 ((uint8_t)0b11001101)
+#define GColorMediumSpringGreenARGB8 ((uint8_t)0b11001110)
+#define GColorCyanARGB8 ((uint8_t)0b11001111)
+#define GColorBulgarianRoseARGB8 ((uint8_t)0b11010000)
+#define GColorImperialPurpleARGB8 ((uint8_t)0b11010001)
+#define GColorIndigoARGB8 ((uint8_t)0b11010010)
+#define GColorElectricUltramarineARGB8 ((uint8_t)0b11010011)
+#define GColorArmyGreenARGB8 ((uint8_t)0b11010100)
+#define GColorDarkGrayARGB8 ((uint8_t)0b11010101)
+#define GColorLibertyARGB8 ((uint8_t)0b11010110)
+#define GColorVeryLightBlueARGB8 ((uint8_t)0b11010111)
+#define GColorKellyGreenARGB8 ((uint8_t)0b11011000)
+#define GColorMayGreenARGB8 ((uint8_t)0b11011001)
+#define GColorCadetBlueARGB8 ((uint8_t)0b11011010)
+#define GColorPictonBlueARGB8 ((uint8_t)0b11011011)
+#define GColorBrightGreenARGB8 ((uint8_t)0b11011100)
+#define GColorScreaminGreenARGB8 ((uint8_t)0b11011101)
+#define GColorMediumAquamarineARGB8 ((uint8_t)0b11011110)
+#define GColorElectricBlueARGB8 ((uint8_t)0b11011111)
+#define GColorDarkCandyAppleRedARGB8 ((uint8_t)0b11100000)
+#define GColorJazzberryJamARGB8 ((uint8_t)0b11100001)
+#define GColorPurpleARGB8 ((uint8_t)0b11100010)
+#define GColorVividVioletARGB8 ((uint8_t)0b11100011)
+#define GColorWindsorTanARGB8 ((uint8_t)0b11100100)
+#define GColorRoseValeARGB8 ((uint8_t)0b11100101)
+#define GColorPurpureusARGB8 ((uint8_t)0b11100110)
+#define GColorLavenderIndigoARGB8 ((uint8_t)0b11100111)
+#define GColorLimerickARGB8 ((uint8_t)0b11101000)
+#define GColorBrassARGB8 ((uint8_t)0b11101001)
+#define GColorLightGrayARGB8 ((uint8_t)0b11101010)
+#define GColorBabyBlueEyesARGB8 ((uint8_t)0b11101011)
+#define GColorSpringBudARGB8 ((uint8_t)0b11101100)
+#define GColorInchwormARGB8 ((uint8_t)0b11101101)
+#define GColorMintGreenARGB8 ((uint8_t)0b11101110)
+#define GColorCelesteARGB8 ((uint8_t)0b11101111)
+#define GColorRedARGB8 ((uint8_t)0b11110000)
+#define GColorFollyARGB8 ((uint8_t)0b11110001)
+#define GColorFashionMagentaARGB8 ((uint8_t)0b11110010)
+#define GColorMagentaARGB8 ((uint8_t)0b11110011)
+#define GColorOrangeARGB8 ((uint8_t)0b11110100)
+#define GColorSunsetOrangeARGB8 ((uint8_t)0b11110101)
+#define GColorBrilliantRoseARGB8 ((uint8_t)0b11110110)
+#define GColorShockingPinkARGB8 ((uint8_t)0b11110111)
+#define GColorChromeYellowARGB8 ((uint8_t)0b11111000)
+#define GColorRajahARGB8 ((uint8_t)0b11111001)
+#define GColorMelonARGB8 ((uint8_t)0b11111010)
+#define GColorRichBrilliantLavenderARGB8 ((uint8_t)0b11111011)
+#define GColorYellowARGB8 ((uint8_t)0b11111100)
+#define GColorIcterineARGB8 ((uint8_t)0b11111101)
+#define GColorPastelYellowARGB8 ((uint8_t)0b11111110)
+#define GColorWhiteARGB8 ((uint8_t)0b11111111)
+
+#define GColorClear ((GColor8){.argb = GColorClearARGB8})
+#define GColorBlack ((GColor8){.argb = GColorBlackARGB8})
+#define GColorOxfordBlue ((GColor8){.argb = GColorOxfordBlueARGB8})
+#define GColorDukeBlue ((GColor8){.argb = GColorDukeBlueARGB8})
+#define GColorBlue ((GColor8){.argb = GColorBlueARGB8})
+#define GColorDarkGreen ((GColor8){.argb = GColorDarkGreenARGB8})
+#define GColorMidnightGreen ((GColor8){.argb = GColorMidnightGreenARGB8})
+#define GColorCobaltBlue ((GColor8){.argb = GColorCobaltBlueARGB8})
+#define GColorBlueMoon ((GColor8){.argb = GColorBlueMoonARGB8})
+#define GColorIslamicGreen ((GColor8){.argb = GColorIslamicGreenARGB8})
+#define GColorJaegerGreen ((GColor8){.argb = GColorJaegerGreenARGB8})
+#define GColorTiffanyBlue ((GColor8){.argb = GColorTiffanyBlueARGB8})
+#define GColorVividCerulean ((GColor8){.argb = GColorVividCeruleanARGB8})
+#define GColorGreen ((GColor8){.argb = GColorGreenARGB8})
+#define GColorMalachite ((GColor8){.argb = GColorMalachiteARGB8})
+#define GColorMediumSpringGreen ((GColor8){.argb = GColorMediumSpringGreenARGB8})
+#define GColorCyan ((GColor8){.argb = GColorCyanARGB8})
+#define GColorBulgarianRose ((GColor8){.argb = GColorBulgarianRoseARGB8})
+#define GColorImperialPurple ((GColor8){.argb = GColorImperialPurpleARGB8})
+#define GColorIndigo ((GColor8){.argb = GColorIndigoARGB8})
+#define GColorElectricUltramarine ((GColor8){.argb = GColorElectricUltramarineARGB8})
+#define GColorArmyGreen ((GColor8){.argb = GColorArmyGreenARGB8})
+#define GColorDarkGray ((GColor8){.argb = GColorDarkGrayARGB8})
+#define GColorLiberty ((GColor8){.argb = GColorLibertyARGB8})
+#define GColorVeryLightBlue ((GColor8){.argb = GColorVeryLightBlueARGB8})
+#define GColorKellyGreen ((GColor8){.argb = GColorKellyGreenARGB8})
+#define GColorMayGreen ((GColor8){.argb = GColorMayGreenARGB8})
+#define GColorCadetBlue ((GColor8){.argb = GColorCadetBlueARGB8})
+#define GColorPictonBlue ((GColor8){.argb = GColorPictonBlueARGB8})
+#define GColorBrightGreen ((GColor8){.argb = GColorBrightGreenARGB8})
+#define GColorScreaminGreen ((GColor8){.argb = GColorScreaminGreenARGB8})
+#define GColorMediumAquamarine ((GColor8){.argb = GColorMediumAquamarineARGB8})
+#define GColorElectricBlue ((GColor8){.argb = GColorElectricBlueARGB8})
+#define GColorDarkCandyAppleRed ((GColor8){.argb = GColorDarkCandyAppleRedARGB8})
+#define GColorJazzberryJam ((GColor8){.argb = GColorJazzberryJamARGB8})
+#define GColorPurple ((GColor8){.argb = GColorPurpleARGB8})
+#define GColorVividViolet ((GColor8){.argb = GColorVividVioletARGB8})
+#define GColorWindsorTan ((GColor8){.argb = GColorWindsorTanARGB8})
+#define GColorRoseVale ((GColor8){.argb = GColorRoseValeARGB8})
+#define GColorPurpureus ((GColor8){.argb = GColorPurpureusARGB8})
+#define GColorLavenderIndigo ((GColor8){.argb = GColorLavenderIndigoARGB8})
+#define GColorLimerick ((GColor8){.argb = GColorLimerickARGB8})
+#define GColorBrass ((GColor8){.argb = GColorBrassARGB8})
+#define GColorLightGray ((GColor8){.argb = GColorLightGrayARGB8})
+#define GColorBabyBlueEyes ((GColor8){.argb = GColorBabyBlueEyesARGB8})
+#define GColorSpringBud ((GColor8){.argb = GColorSpringBudARGB8})
+#define GColorInchworm ((GColor8){.argb = GColorInchwormARGB8})
+#define GColorMintGreen ((GColor8){.argb = GColorMintGreenARGB8})
+#define GColorCeleste ((GColor8){.argb = GColorCelesteARGB8})
+#define GColorRed ((GColor8){.argb = GColorRedARGB8})
+#define GColorFolly ((GColor8){.argb = GColorFollyARGB8})
+#define GColorFashionMagenta ((GColor8){.argb = GColorFashionMagentaARGB8})
+#define GColorMagenta ((GColor8){.argb = GColorMagentaARGB8})
+#define GColorOrange ((GColor8){.argb = GColorOrangeARGB8})
+#define GColorSunsetOrange ((GColor8){.argb = GColorSunsetOrangeARGB8})
+#define GColorBrilliantRose ((GColor8){.argb = GColorBrilliantRoseARGB8})
+#define GColorShockingPink ((GColor8){.argb = GColorShockingPinkARGB8})
+#define GColorChromeYellow ((GColor8){.argb = GColorChromeYellowARGB8})
+#define GColorRajah ((GColor8){.argb = GColorRajahARGB8})
+#define GColorMelon ((GColor8){.argb = GColorMelonARGB8})
+#define GColorRichBrilliantLavender ((GColor8){.argb = GColorRichBrilliantLavenderARGB8})
+#define GColorYellow ((GColor8){.argb = GColorYellowARGB8})
+#define GColorIcterine ((GColor8){.argb = GColorIcterineARGB8})
+#define GColorPastelYellow ((GColor8){.argb = GColorPastelYellowARGB8})
+#define GColorWhite ((GColor8){.argb = GColorWhiteARGB8})
+
+bool gcolor_equal(GColor8 x, GColor8 y);
+GColor8 gcolor_legible_over(GColor8 background_color);
+
+//
+// Bitmaps
+//
+
+typedef enum {
+  GBitmapFormat1Bit = 0,
+  GBitmapFormat8Bit,
+  GBitmapFormat1BitPalette,
+  GBitmapFormat2BitPalette,
+  GBitmapFormat4BitPalette,
+  GBitmapFormat8BitCircular,
+} GBitmapFormat;
+
+typedef enum {
+  GCompOpAssign,
+  GCompOpAssignInverted,
+  GCompOpOr,
+  GCompOpAnd,
+  GCompOpClear,
+  GCompOpSet,
+} GCompOp;
+
+typedef struct GBitmap GBitmap;
+
+GBitmap *gbitmap_create_with_resource(uint32_t resource_id);
+GBitmap *gbitmap_create_with_data(const uint8_t *data);
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format);
+void gbitmap_destroy(GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+GColor *gbitmap_get_palette(const GBitmap *bitmap);
+
+//
+// Resources
+//
+
+typedef const struct ResourceEntry *ResHandle;
+
+ResHandle resource_get_handle(uint32_t resource_id);
+size_t resource_size(ResHandle h);
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length);
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes);
+
+//
+// Fonts and text
+//
+
+typedef struct FontInfo *GFont;
+
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24 "RESOURCE_ID_GOTHIC_24"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_GOTHIC_28 "RESOURCE_ID_GOTHIC_28"
+#define FONT_KEY_GOTHIC_28_BOLD "RESOURCE_ID_GOTHIC_28_BOLD"
+#define FONT_KEY_BITHAM_30_BLACK "RESOURCE_ID_BITHAM_30_BLACK"
+#define FONT_KEY_BITHAM_42_BOLD "RESOURCE_ID_BITHAM_42_BOLD"
+#define FONT_KEY_BITHAM_42_LIGHT "RESOURCE_ID_BITHAM_42_LIGHT"
+#define FONT_KEY_ROBOTO_CONDENSED_21 "RESOURCE_ID_ROBOTO_CONDENSED_21"
+#define FONT_KEY_LECO_20_BOLD_NUMBERS "RESOURCE_ID_LECO_20_BOLD_NUMBERS"
+#define FONT_KEY_LECO_26_BOLD_NUMBERS_AM_PM "RESOURCE_ID_LECO_26_BOLD_NUMBERS_AM_PM"
+#define FONT_KEY_LECO_32_BOLD_NUMBERS "RESOURCE_ID_LECO_32_BOLD_NUMBERS"
+#define FONT_KEY_LECO_36_BOLD_NUMBERS "RESOURCE_ID_LECO_36_BOLD_NUMBERS"
+#define FONT_KEY_LECO_38_BOLD_NUMBERS "RESOURCE_ID_LECO_38_BOLD_NUMBERS"
+#define FONT_KEY_LECO_42_NUMBERS "RESOURCE_ID_LECO_42_NUMBERS"
+
+typedef enum {
+  GTextOverflowModeWordWrap,
+  GTextOverflowModeTrailingEllipsis,
+  GTextOverflowModeFill,
+} GTextOverflowMode;
+
+typedef enum {
+  GTextAlignmentLeft,
+  GTextAlignmentCenter,
+  GTextAlignmentRight,
+} GTextAlignment;
+
+// The layout is private to the firmware; util/perimeter.h has a copy for code that needs to look inside.
+typedef struct GTextAttributes GTextAttributes;
+
+GFont fonts_get_system_font(const char *font_key);
+GFont fonts_load_custom_font(ResHandle handle);
+void fonts_unload_custom_font(GFont font);
+
+//
+// Drawing
+//
+
+typedef struct GContext GContext;
+
+typedef struct GPathInfo {
+  uint32_t num_points;
+  GPoint *points;
+} GPathInfo;
+
+typedef struct GPath {
+  uint32_t num_points;
+  GPoint *points;
+  int32_t rotation;
+  GPoint offset;
+} GPath;
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_text_color(GContext *ctx, GColor color);
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode);
+void graphics_context_set_antialiased(GContext *ctx, bool enable);
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width);
+
+void graphics_draw_pixel(GContext *ctx, GPoint point);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_draw_rect(GContext *ctx, GRect rect);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_draw_round_rect(GContext *ctx, GRect rect, uint16_t radius);
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+void gpath_draw_filled(GContext *ctx, GPath *path);
+void gpath_draw_outline(GContext *ctx, GPath *path);
+
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes *text_attributes);
+GSize graphics_text_layout_get_content_size(const char *text, GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment);
+GSize graphics_text_layout_get_content_size_with_attributes(const char *text, GFont font, const GRect box,
+                                                            const GTextOverflowMode overflow_mode,
+                                                            const GTextAlignment alignment,
+                                                            GTextAttributes *text_attributes);
+GTextAttributes *graphics_text_attributes_create(void);
+void graphics_text_attributes_destroy(GTextAttributes *text_attributes);
+
+//
+// Draw commands (PDC images and sequences)
+//
+
+typedef struct GDrawCommandImage GDrawCommandImage;
+typedef struct GDrawCommandSequence GDrawCommandSequence;
+typedef struct GDrawCommandFrame GDrawCommandFrame;
+
+#define PLAY_COUNT_INFINITE UINT16_MAX
+
+GDrawCommandImage *gdraw_command_image_create_with_resource(uint32_t resource_id);
+void gdraw_command_image_destroy(GDrawCommandImage *image);
+void gdraw_command_image_draw(GContext *ctx, GDrawCommandImage *image, GPoint offset);
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage *image);
+
+GDrawCommandSequence *gdraw_command_sequence_create_with_resource(uint32_t resource_id);
+void gdraw_command_sequence_destroy(GDrawCommandSequence *sequence);
+GDrawCommandFrame *gdraw_command_sequence_get_frame_by_index(GDrawCommandSequence *sequence, uint32_t index);
+GSize gdraw_command_sequence_get_bounds_size(GDrawCommandSequence *sequence);
+uint32_t gdraw_command_sequence_get_play_count(GDrawCommandSequence *sequence);
+uint32_t gdraw_command_sequence_get_num_frames(GDrawCommandSequence *sequence);
+void gdraw_command_frame_draw(GContext *ctx, GDrawCommandSequence *sequence, GDrawCommandFrame *frame, GPoint offset);
+uint32_t gdraw_command_frame_get_duration(GDrawCommandFrame *frame);
+
+//
+// Layers
+//
+
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(struct Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+Layer *layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void layer_mark_dirty(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_bounds(Layer *layer, GRect bounds);
+GRect layer_get_bounds(const Layer *layer);
+GPoint layer_convert_point_to_screen(const Layer *layer, GPoint point);
+struct Window *layer_get_window(const Layer *layer);
+void layer_remove_from_parent(Layer *child);
+void layer_remove_child_layers(Layer *parent);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_insert_below_sibling(Layer *layer_to_insert, Layer *below_sibling_layer);
+void layer_insert_above_sibling(Layer *layer_to_insert, Layer *above_sibling_layer);
+void layer_set_hidden(Layer *layer, bool hidden);
+bool layer_get_hidden(const Layer *layer);
+void layer_set_clips(Layer *layer, bool clips);
+bool layer_get_clips(const Layer *layer);
+void *layer_get_data(const Layer *layer);
+
+//
+// Buttons and windows
+//
+
+typedef enum {
+  BUTTON_ID_BACK = 0,
+  BUTTON_ID_UP,
+  BUTTON_ID_SELECT,
+  BUTTON_ID_DOWN,
+  NUM_BUTTONS,
+} ButtonId;
+
+typedef struct ClickRecognizer *ClickRecognizerRef;
+typedef void (*ClickHandler)(ClickRecognizerRef recognizer, void *context);
+typedef void (*ClickConfigProvider)(void *context);
+
+typedef struct Window Window;
+typedef void (*WindowHandler)(struct Window *window);
+
+typedef struct WindowHandlers {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_click_config_provider(Window *window, ClickConfigProvider click_config_provider);
+void window_set_click_config_provider_with_context(Window *window, ClickConfigProvider click_config_provider,
+                                                   void *context);
+ClickConfigProvider window_get_click_config_provider(const Window *window);
+void *window_get_click_config_context(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+struct Layer *window_get_root_layer(const Window *window);
+void window_set_background_color(Window *window, GColor background_color);
+bool window_is_loaded(Window *window);
+void window_set_user_data(Window *window, void *data);
+void *window_get_user_data(const Window *window);
+
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler);
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler);
+void window_multi_click_subscribe(ButtonId button_id, uint8_t min_clicks, uint8_t max_clicks, uint16_t timeout,
+                                  bool last_click_only, ClickHandler handler);
+void window_long_click_subscribe(ButtonId button_id, uint16_t delay_ms, ClickHandler down_handler,
+                                 ClickHandler up_handler);
+void window_set_click_context(ButtonId button_id, void *context);
+
+void window_stack_push(Window *window, bool animated);
+Window *window_stack_pop(bool animated);
+void window_stack_pop_all(const bool animated);
+bool window_stack_remove(Window *window, bool animated);
+Window *window_stack_get_top_window(void);
+bool window_stack_contains_window(Window *window);
+
+//
+// Standard layers
+//
+
+typedef struct TextLayer TextLayer;
+
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+const char *text_layer_get_text(TextLayer *text_layer);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+GSize text_layer_get_content_size(TextLayer *text_layer);
+void text_layer_set_size(TextLayer *text_layer, const GSize max_size);
+
+typedef struct BitmapLayer BitmapLayer;
+
+BitmapLayer *bitmap_layer_create(GRect frame);
+void bitmap_layer_destroy(BitmapLayer *bitmap_layer);
+Layer *bitmap_layer_get_layer(const BitmapLayer *bitmap_layer);
+const GBitmap *bitmap_layer_get_bitmap(BitmapLayer *bitmap_layer);
+void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, const GBitmap *bitmap);
+void bitmap_layer_set_alignment(BitmapLayer *bitmap_layer, GAlign alignment);
+void bitmap_layer_set_background_color(BitmapLayer *bitmap_layer, GColor color);
+void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode);
+
+typedef struct ContentIndicator ContentIndicator;
+
+typedef enum {
+  ContentIndicatorDirectionUp = 0,
+  ContentIndicatorDirectionDown,
+  NumContentIndicatorDirections,
+} ContentIndicatorDirection;
+
+typedef struct {
+  Layer *layer;
+  bool times_out;
+  GAlign alignment;
+  struct {
+    GColor foreground;
+    GColor background;
+  } colors;
+} ContentIndicatorConfig;
+
+bool content_indicator_configure_direction(ContentIndicator *content_indicator, ContentIndicatorDirection direction,
+                                           const ContentIndicatorConfig *config);
+bool content_indicator_get_content_available(ContentIndicator *content_indicator,
+                                             ContentIndicatorDirection direction);
+void content_indicator_set_content_available(ContentIndicator *content_indicator,
+                                             ContentIndicatorDirection direction, bool available);
+
+typedef struct ScrollLayer ScrollLayer;
+typedef void (*ScrollLayerCallback)(struct ScrollLayer *scroll_layer, void *context);
+
+typedef struct ScrollLayerCallbacks {
+  ClickConfigProvider click_config_provider;
+  ScrollLayerCallback content_offset_changed_handler;
+} ScrollLayerCallbacks;
+
+ScrollLayer *scroll_layer_create(GRect frame);
+void scroll_layer_destroy(ScrollLayer *scroll_layer);
+Layer *scroll_layer_get_layer(const ScrollLayer *scroll_layer);
+void scroll_layer_add_child(ScrollLayer *scroll_layer, Layer *child);
+void scroll_layer_set_click_config_onto_window(ScrollLayer *scroll_layer, struct Window *window);
+void scroll_layer_set_callbacks(ScrollLayer *scroll_layer, ScrollLayerCallbacks callbacks);
+void scroll_layer_set_context(ScrollLayer *scroll_layer, void *context);
+void scroll_layer_set_content_offset(ScrollLayer *scroll_layer, GPoint offset, bool animated);
+GPoint scroll_layer_get_content_offset(ScrollLayer *scroll_layer);
+void scroll_layer_set_content_size(ScrollLayer *scroll_layer, GSize size);
+GSize scroll_layer_get_content_size(const ScrollLayer *scroll_layer);
+void scroll_layer_scroll_up_click_handler(ClickRecognizerRef recognizer, void *context);
+void scroll_layer_scroll_down_click_handler(ClickRecognizerRef recognizer, void *context);
+void scroll_layer_set_shadow_hidden(ScrollLayer *scroll_layer, bool hidden);
+bool scroll_layer_get_shadow_hidden(const ScrollLayer *scroll_layer);
+ContentIndicator *scroll_layer_get_content_indicator(ScrollLayer *scroll_layer);
+
+typedef struct MenuIndex {
+  uint16_t section;
+  uint16_t row;
+} MenuIndex;
+#define MenuIndex(section, row) ((MenuIndex){(section), (row)})
+
+typedef enum {
+  MenuRowAlignNone,
+  MenuRowAlignCenter,
+  MenuRowAlignTop,
+  MenuRowAlignBottom,
+} MenuRowAlign;
+
+struct MenuLayer;
+typedef struct MenuLayer MenuLayer;
+
+typedef uint16_t (*MenuLayerGetNumberOfSectionsCallback)(struct MenuLayer *menu_layer, void *callback_context);
+typedef uint16_t (*MenuLayerGetNumberOfRowsInSectionsCallback)(struct MenuLayer *menu_layer, uint16_t section_index,
+                                                               void *callback_context);
+typedef int16_t (*MenuLayerGetCellHeightCallback)(struct MenuLayer *menu_layer, MenuIndex *cell_index,
+                                                  void *callback_context);
+typedef int16_t (*MenuLayerGetHeaderHeightCallback)(struct MenuLayer *menu_layer, uint16_t section_index,
+                                                    void *callback_context);
+typedef int16_t (*MenuLayerGetSeparatorHeightCallback)(struct MenuLayer *menu_layer, MenuIndex *cell_index,
+                                                       void *callback_context);
+typedef void (*MenuLayerDrawRowCallback)(GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index,
+                                         void *callback_context);
+typedef void (*MenuLayerDrawHeaderCallback)(GContext *ctx, const Layer *cell_layer, uint16_t section_index,
+                                            void *callback_context);
+typedef void (*MenuLayerDrawSeparatorCallback)(GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index,
+                                               void *callback_context);
+typedef void (*MenuLayerSelectCallback)(struct MenuLayer *menu_layer, MenuIndex *cell_index, void *callback_context);
+typedef void (*MenuLayerSelectionChangedCallback)(struct MenuLayer *menu_layer, MenuIndex new_index,
+                                                  MenuIndex old_index, void *callback_context);
+typedef void (*MenuLayerSelectionWillChangeCallback)(struct MenuLayer *menu_layer, MenuIndex *new_index,
+                                                     MenuIndex old_index, void *callback_context);
+typedef void (*MenuLayerDrawBackgroundCallback)(GContext *ctx, const Layer *bg_layer, bool highlight,
+                                                void *callback_context);
+
+typedef struct MenuLayerCallbacks {
+  MenuLayerGetNumberOfSectionsCallback get_num_sections;
+  MenuLayerGetNumberOfRowsInSectionsCallback get_num_rows;
+  MenuLayerGetCellHeightCallback get_cell_height;
+  MenuLayerGetHeaderHeightCallback get_header_height;
+  MenuLayerDrawRowCallback draw_row;
+  MenuLayerDrawHeaderCallback draw_header;
+  MenuLayerSelectCallback select_click;
+  MenuLayerSelectCallback select_long_click;
+  MenuLayerSelectionChangedCallback selection_changed;
+  MenuLayerGetSeparatorHeightCallback get_separator_height;
+  MenuLayerDrawSeparatorCallback draw_separator;
+  MenuLayerSelectionWillChangeCallback selection_will_change;
+  MenuLayerDrawBackgroundCallback draw_background;
+} MenuLayerCallbacks;
+
+MenuLayer *menu_layer_create(GRect frame);
+void menu_layer_destroy(MenuLayer *menu_layer);
+Layer *menu_layer_get_layer(const MenuLayer *menu_layer);
+void menu_layer_set_callbacks(MenuLayer *menu_layer, void *callback_context, MenuLayerCallbacks callbacks);
+void menu_layer_set_click_config_onto_window(MenuLayer *menu_layer, struct Window *window);
+void menu_layer_set_selected_next(MenuLayer *menu_layer, bool up, MenuRowAlign scroll_align, bool animated);
+void menu_layer_set_selected_index(MenuLayer *menu_layer, MenuIndex index, MenuRowAlign scroll_align,
+                                   bool animated);
+MenuIndex menu_layer_get_selected_index(const MenuLayer *menu_layer);
+void menu_layer_reload_data(MenuLayer *menu_layer);
+void menu_layer_set_normal_colors(MenuLayer *menu_layer, GColor background, GColor foreground);
+void menu_layer_set_highlight_colors(MenuLayer *menu_layer, GColor background, GColor foreground);
+bool menu_cell_layer_is_highlighted(const Layer *cell_layer);
+void menu_cell_basic_draw(GContext *ctx, const Layer *cell_layer, const char *title, const char *subtitle,
+                          GBitmap *icon);
+void menu_cell_title_draw(GContext *ctx, const Layer *cell_layer, const char *title);
+void menu_cell_basic_header_draw(GContext *ctx, const Layer *cell_layer, const char *title);
+
+typedef void (*SimpleMenuLayerSelectCallback)(int index, void *context);
+
+typedef struct {
+  const char *title;
+  const char *subtitle;
+  GBitmap *icon;
+  SimpleMenuLayerSelectCallback callback;
+} SimpleMenuItem;
+
+typedef struct {
+  const char *title;
+  const SimpleMenuItem *items;
+  uint32_t num_items;
+} SimpleMenuSection;
+
+typedef struct SimpleMenuLayer SimpleMenuLayer;
+
+SimpleMenuLayer *simple_menu_layer_create(GRect frame, Window *window, const SimpleMenuSection *sections,
+                                          int32_t num_sections, void *callback_context);
+void simple_menu_layer_destroy(SimpleMenuLayer *menu_layer);
+Layer *simple_menu_layer_get_layer(const SimpleMenuLayer *simple_menu);
+int simple_menu_layer_get_selected_index(const SimpleMenuLayer *simple_menu);
+void simple_menu_layer_set_selected_index(SimpleMenuLayer *simple_menu, int32_t index, bool animated);
+MenuLayer *simple_menu_layer_get_menu_layer(SimpleMenuLayer *simple_menu);
+
+#define STATUS_BAR_LAYER_HEIGHT 16
+
+typedef enum {
+  StatusBarLayerSeparatorModeNone = 0,
+  StatusBarLayerSeparatorModeDotted = 1,
+} StatusBarLayerSeparatorMode;
+
+typedef struct StatusBarLayer StatusBarLayer;
+
+StatusBarLayer *status_bar_layer_create(void);
+void status_bar_layer_destroy(StatusBarLayer *status_bar_layer);
+Layer *status_bar_layer_get_layer(StatusBarLayer *status_bar_layer);
+GColor status_bar_layer_get_background_color(const StatusBarLayer *status_bar_layer);
+GColor status_bar_layer_get_foreground_color(const StatusBarLayer *status_bar_layer);
+void status_bar_layer_set_colors(StatusBarLayer *status_bar_layer, GColor background, GColor foreground);
+void status_bar_layer_set_separator_mode(StatusBarLayer *status_bar_layer, StatusBarLayerSeparatorMode mode);
+
+#define ACTION_BAR_WIDTH 30
+#define NUM_ACTION_BAR_ITEMS 3
+
+typedef struct ActionBarLayer ActionBarLayer;
+
+ActionBarLayer *action_bar_layer_create(void);
+void action_bar_layer_destroy(ActionBarLayer *action_bar_layer);
+Layer *action_bar_layer_get_layer(ActionBarLayer *action_bar_layer);
+void action_bar_layer_set_context(ActionBarLayer *action_bar_layer, void *context);
+void action_bar_layer_set_click_config_provider(ActionBarLayer *action_bar, ClickConfigProvider click_config_provider);
+void action_bar_layer_set_icon(ActionBarLayer *action_bar, ButtonId button_id, const GBitmap *icon);
+void action_bar_layer_clear_icon(ActionBarLayer *action_bar, ButtonId button_id);
+void action_bar_layer_add_to_window(ActionBarLayer *action_bar, struct Window *window);
+void action_bar_layer_remove_from_window(ActionBarLayer *action_bar);
+void action_bar_layer_set_background_color(ActionBarLayer *action_bar, GColor background_color);
+
+typedef struct ActionMenuItem ActionMenuItem;
+typedef struct ActionMenuLevel ActionMenuLevel;
+typedef struct ActionMenu ActionMenu;
+
+typedef void (*ActionMenuPerformActionCb)(ActionMenu *action_menu, const ActionMenuItem *action, void *context);
+typedef void (*ActionMenuDidCloseCb)(ActionMenu *menu, const ActionMenuItem *performed_action, void *context);
+typedef void (*ActionMenuEachItemCb)(const ActionMenuItem *item, void *context);
+
+typedef enum {
+  ActionMenuLevelDisplayModeWide,
+  ActionMenuLevelDisplayModeThin,
+} ActionMenuLevelDisplayMode;
+
+typedef enum {
+  ActionMenuAlignTop = 0,
+  ActionMenuAlignCenter,
+} ActionMenuAlign;
+
+typedef struct {
+  const ActionMenuLevel *root_level;
+  void *context;
+  struct {
+    GColor background;
+    GColor foreground;
+  } colors;
+  ActionMenuDidCloseCb will_close;
+  ActionMenuDidCloseCb did_close;
+  ActionMenuAlign align;
+} ActionMenuConfig;
+
+char *action_menu_item_get_label(const ActionMenuItem *item);
+void *action_menu_item_get_action_data(const ActionMenuItem *item);
+ActionMenuLevel *action_menu_level_create(uint16_t max_items);
+void action_menu_level_set_display_mode(ActionMenuLevel *level, ActionMenuLevelDisplayMode display_mode);
+ActionMenuItem *action_menu_level_add_action(ActionMenuLevel *level, const char *label, ActionMenuPerformActionCb cb,
+                                             void *action_data);
+ActionMenuItem *action_menu_level_add_child(ActionMenuLevel *level, ActionMenuLevel *child, const char *label);
+void action_menu_hierarchy_destroy(const ActionMenuLevel *root, ActionMenuEachItemCb each_cb, void *context);
+void *action_menu_get_context(ActionMenu *action_menu);
+ActionMenuLevel *action_menu_get_root_level(ActionMenu *action_menu);
+ActionMenu *action_menu_open(ActionMenuConfig *config);
+void action_menu_freeze(ActionMenu *action_menu);
+void action_menu_unfreeze(ActionMenu *action_menu);
+void action_menu_set_result_window(ActionMenu *action_menu, Window *result_window);
+void action_menu_close(ActionMenu *action_menu, bool animated);
+
+//
+// Animation
+//
+
+typedef struct Animation Animation;
+typedef int32_t AnimationProgress;
+
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+#define ANIMATION_DURATION_INFINITE UINT32_MAX
+#define ANIMATION_PLAY_COUNT_INFINITE UINT32_MAX
+
+typedef enum {
+  AnimationCurveLinear = 0,
+  AnimationCurveEaseIn = 1,
+  AnimationCurveEaseOut = 2,
+  AnimationCurveEaseInOut = 3,
+  AnimationCurveDefault = AnimationCurveEaseInOut,
+} AnimationCurve;
+
+typedef void (*AnimationSetupImplementation)(Animation *animation);
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const AnimationProgress progress);
+typedef void (*AnimationTeardownImplementation)(Animation *animation);
+
+typedef struct AnimationImplementation {
+  AnimationSetupImplementation setup;
+  AnimationUpdateImplementation update;
+  AnimationTeardownImplementation teardown;
+} AnimationImplementation;
+
+typedef void (*AnimationStartedHandler)(Animation *animation, void *context);
+typedef void (*AnimationStoppedHandler)(Animation *animation, bool finished, void *context);
+
+typedef struct AnimationHandlers {
+  AnimationStartedHandler started;
+  AnimationStoppedHandler stopped;
+} AnimationHandlers;
+
+Animation *animation_create(void);
+bool animation_destroy(Animation *animation);
+bool animation_set_delay(Animation *animation, uint32_t delay_ms);
+bool animation_set_duration(Animation *animation, uint32_t duration_ms);
+bool animation_set_curve(Animation *animation, AnimationCurve curve);
+bool animation_set_play_count(Animation *animation, uint32_t play_count);
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context);
+void *animation_get_context(Animation *animation);
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+bool animation_schedule(Animation *animation);
+bool animation_unschedule(Animation *animation);
+bool animation_is_scheduled(Animation *animation);
+
+//
+// Timers
+//
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+//
+// Dictionaries and AppMessage
+//
+
+typedef enum {
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3,
+} TupleType;
+
+typedef struct __attribute__((__packed__)) {
+  uint32_t key;
+  TupleType type:8;
+  uint16_t length;
+  union {
+    uint8_t data[0];
+    char cstring[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+
+struct Dictionary;
+typedef struct Dictionary Dictionary;
+
+typedef struct {
+  Dictionary *dictionary;
+  const void *end;
+  Tuple *cursor;
+} DictionaryIterator;
+
+typedef enum {
+  DICT_OK = 0,
+  DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+  DICT_INVALID_ARGS = 1 << 2,
+  DICT_INTERNAL_INCONSISTENCY = 1 << 3,
+  DICT_MALLOC_FAILED = 1 << 4,
+} DictionaryResult;
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...);
+uint32_t dict_size(DictionaryIterator *iter);
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t *const buffer, const uint16_t size);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *const data,
+                                 const uint16_t size);
+DictionaryResult dict_write_cstring(DictionaryIterator *iter, const uint32_t key, const char *const cstring);
+DictionaryResult dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer,
+                                const uint8_t width_bytes, const bool is_signed);
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, const uint32_t key, const uint8_t value);
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value);
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value);
+DictionaryResult dict_write_int8(DictionaryIterator *iter, const uint32_t key, const int8_t value);
+DictionaryResult dict_write_int16(DictionaryIterator *iter, const uint32_t key, const int16_t value);
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value);
+uint32_t dict_write_end(DictionaryIterator *iter);
+Tuple *dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t *const buffer, const uint16_t size);
+Tuple *dict_read_next(DictionaryIterator *iter);
+Tuple *dict_read_first(DictionaryIterator *iter);
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+
+typedef enum {
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_APP_NOT_RUNNING = 1 << 4,
+  APP_MSG_INVALID_ARGS = 1 << 5,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+  APP_MSG_ALREADY_RELEASED = 1 << 9,
+  APP_MSG_CALLBACK_ALREADY_REGISTERED = 1 << 10,
+  APP_MSG_CALLBACK_NOT_REGISTERED = 1 << 11,
+  APP_MSG_OUT_OF_MEMORY = 1 << 12,
+  APP_MSG_CLOSED = 1 << 13,
+  APP_MSG_INTERNAL_ERROR = 1 << 14,
+  APP_MSG_INVALID_STATE = 1 << 15,
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+#define APP_MESSAGE_INBOX_SIZE_MINIMUM 124
+#define APP_MESSAGE_OUTBOX_SIZE_MINIMUM 636
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+void app_message_deregister_callbacks(void);
+void *app_message_get_context(void);
+void *app_message_set_context(void *context);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+uint32_t app_message_inbox_size_maximum(void);
+uint32_t app_message_outbox_size_maximum(void);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+
+//
+// Persistent storage
+//
+
+#define PERSIST_DATA_MAX_LENGTH 256
+#define PERSIST_STRING_MAX_LENGTH PERSIST_DATA_MAX_LENGTH
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+bool persist_read_bool(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size);
+status_t persist_write_bool(const uint32_t key, const bool value);
+status_t persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_write_string(const uint32_t key, const char *cstring);
+status_t persist_delete(const uint32_t key);
+
+//
+// Wakeup and launch
+//
+
+typedef int32_t WakeupId;
+typedef void (*WakeupHandler)(WakeupId wakeup_id, int32_t cookie);
+
+void wakeup_service_subscribe(WakeupHandler handler);
+WakeupId wakeup_schedule(time_t timestamp, int32_t cookie, bool notify_if_missed);
+void wakeup_cancel(WakeupId wakeup_id);
+void wakeup_cancel_all(void);
+bool wakeup_get_launch_event(WakeupId *wakeup_id, int32_t *cookie);
+bool wakeup_query(WakeupId wakeup_id, time_t *timestamp);
+
+typedef enum {
+  APP_LAUNCH_SYSTEM,
+  APP_LAUNCH_USER,
+  APP_LAUNCH_PHONE,
+  APP_LAUNCH_WAKEUP,
+  APP_LAUNCH_WORKER,
+  APP_LAUNCH_QUICK_LAUNCH,
+  APP_LAUNCH_TIMELINE_ACTION,
+  APP_LAUNCH_SMARTSTRAP,
+} AppLaunchReason;
+
+AppLaunchReason launch_reason(void);
+uint32_t launch_get_args(void);
+
+typedef enum {
+  PreferredContentSizeSmall,
+  PreferredContentSizeMedium,
+  PreferredContentSizeLarge,
+  PreferredContentSizeExtraLarge,
+  NumPreferredContentSizes,
+} PreferredContentSize;
+
+PreferredContentSize preferred_content_size(void);
+
+void app_event_loop(void);
+
+//
+// Dictation
+//
+
+typedef struct DictationSession DictationSession;
+
+typedef enum {
+  DictationSessionStatusSuccess,
+  DictationSessionStatusFailureTranscriptionRejected,
+  DictationSessionStatusFailureTranscriptionRejectedWithError,
+  DictationSessionStatusFailureSystemAborted,
+  DictationSessionStatusFailureNoSpeechDetected,
+  DictationSessionStatusFailureConnectivityError,
+  DictationSessionStatusFailureDisabled,
+  DictationSessionStatusFailureInternalError,
+  DictationSessionStatusFailureRecognizerError,
+} DictationSessionStatus;
+
+typedef void (*DictationSessionStatusCallback)(DictationSession *session, DictationSessionStatus status,
+                                               char *transcription, void *context);
+
+DictationSession *dictation_session_create(uint32_t buffer_size, DictationSessionStatusCallback callback,
+                                           void *callback_context);
+void dictation_session_destroy(DictationSession *session);
+void dictation_session_enable_confirmation(DictationSession *session, bool is_enabled);
+void dictation_session_enable_error_dialogs(DictationSession *session, bool is_enabled);
+DictationSessionStatus dictation_session_start(DictationSession *session);
+DictationSessionStatus dictation_session_stop(DictationSession *session);
+
+//
+// Vibes and light
+//
+
+typedef struct {
+  const uint32_t *durations;
+  uint32_t num_segments;
+} VibePattern;
+
+void vibes_cancel(void);
+void vibes_short_pulse(void);
+void vibes_long_pulse(void);
+void vibes_double_pulse(void);
+void vibes_enqueue_custom_pattern(VibePattern pattern);
+void light_enable_interaction(void);
+void light_enable(bool enable);
+
+// Generated from package.json by CMake, just as the SDK generates them for a real build.
+#include "message_keys.auto.h"
+#include "resource_ids.auto.h"
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The part of the SDK's app header that app code reads. For host builds, CMake fills __pbl_app_info in from
+// package.json.
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct __attribute__((__packed__)) {
+  uint8_t major;
+  uint8_t minor;
+} Version;
+
+typedef struct __attribute__((__packed__)) {
+  Version process_version;
+  char name[32];
+  uint8_t uuid[16];
+} PebbleProcessInfo;
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The other side of the shim: what a host program (a test, a benchmark, headless.c) uses to drive the app the way
+// the firmware and the phone would. None of this exists on a watch.
+
+#pragma once
+
+#include <pebble.h>
+
+// Resets the simulated watch: clock, timers, windows, AppMessage, persist, wakeups. Call it before any app code,
+// after sim_heap_init().
+void pebble_shim_init(void);
+// Frees what the shim itself is holding on to. Anything the app leaked stays leaked.
+void pebble_shim_deinit(void);
+
+//
+// Time and the event loop
+//
+
+// Simulated milliseconds since the epoch. time() and time_ms() report this.
+int64_t pebble_shim_now_ms(void);
+void pebble_shim_set_time(time_t now);
+// Runs timers, ticks, animations and rendering until the simulated clock reaches now + duration_ms, or the app's
+// last window is popped. Returns false if the app has exited.
+bool pebble_shim_run_for(uint32_t duration_ms);
+// How long app_event_loop() runs before returning, in simulated time. Zero (the default) means until nothing is
+// left to do.
+void pebble_shim_set_event_loop_duration(uint32_t duration_ms);
+// Makes app_event_loop() / pebble_shim_run_for() return after the current event.
+void pebble_shim_exit(void);
+
+//
+// Buttons
+//
+
+void pebble_shim_click(ButtonId button);
+void pebble_shim_long_click(ButtonId button);
+
+//
+// AppMessage
+//
+
+// Called with each dictionary the app sends, as serialised bytes. Without a handler, sends just succeed.
+typedef AppMessageResult (*PebbleShimOutboxHandler)(const uint8_t *data, size_t size, void *context);
+void pebble_shim_set_outbox_handler(PebbleShimOutboxHandler handler, void *context);
+// Hands a serialised dictionary (see dict_write_begin) to the app as if the phone had sent it.
+AppMessageResult pebble_shim_deliver_inbox(const uint8_t *data, size_t size);
+// Looks up a message key by the name package.json gives it, which is how PebbleKit JS refers to them. Returns false
+// if there's no such key.
+bool pebble_shim_message_key(const char *name, uint32_t *key);
+// How many tuples the app has read with dict_read_first(), dict_read_next() and dict_find() since pebble_shim_init(),
+// counting every tuple dict_find() steps over on the way to the one it returns.
+uint32_t pebble_shim_dict_tuple_visits(void);
+
+//
+// Everything else the user or the system would do
+//
+
+void pebble_shim_set_launch_reason(AppLaunchReason reason);
+void pebble_shim_set_wakeup_launch(WakeupId id, int32_t cookie);
+// What the next dictation session returns, and how long it takes. Defaults to success with a fixed sentence.
+void pebble_shim_set_dictation_result(DictationSessionStatus status, const char *transcription, uint32_t delay_ms);
+int pebble_shim_vibe_count(void);
+
+//
+// The screen
+//
+
+// The framebuffer: GBitmapFormat8Bit, PBL_DISPLAY_WIDTH x PBL_DISPLAY_HEIGHT.
+GBitmap *pebble_shim_framebuffer(void);
+// Draws the top window now if anything is dirty. The event loop calls this after every batch of events.
+void pebble_shim_render(void);
+int pebble_shim_render_count(void);
+// Called after each frame is drawn.
+typedef void (*PebbleShimRenderHandler)(void *context);
+void pebble_shim_set_render_handler(PebbleShimRenderHandler handler, void *context);
+// Writes the framebuffer as a binary PPM. Returns false if the file couldn't be written.
+bool pebble_shim_write_ppm(const char *path);
+// A graphics context that draws into the given 8-bit bitmap, for rendering layers off screen.
+GContext *pebble_shim_graphics_context_create(GBitmap *bitmap);
+void pebble_shim_graphics_context_destroy(GContext *ctx);
+// How many drawing calls (graphics_fill_rect, graphics_draw_text, gdraw_command_image_draw...) have been made with ctx.
+uint32_t pebble_shim_graphics_context_draw_calls(const GContext *ctx);
+// Draws a layer and its children into ctx, with the layer's frame origin at the bitmap's top left.
+void pebble_shim_render_layer(Layer *layer, GContext *ctx);
+// How many times text has been laid out to be measured (graphics_text_layout_get_content_size, its _with_attributes
+// twin, and text_layer_get_content_size) since pebble_shim_init(). Drawing text isn't counted.
+uint32_t pebble_shim_text_layout_calls(void);
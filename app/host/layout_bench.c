@@ -0,0 +1,185 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Streams responses into a MessageLayer a word at a time, as the phone sends them, and counts how many times text is
+// laid out by the firmware to wrap them: with the glyph cache disabled, which is how MessageLayer measured every line
+// before there was a cache; with the cache starting empty, as for the first response after the app starts; and with
+// it already filled by that response, as for every one after.
+//
+//   bobby_layout_bench [--heap BYTES]
+//
+// The layer is updated after every fragment, which is the most a session window will ever ask for. Exits non-zero if
+// the cache ever changes how a response is wrapped, or if a filled cache doesn't save any layouts.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble_shim.h>
+
+#include "converse/conversation.h"
+#include "converse/segments/message_layer.h"
+#include "util/fonts.h"
+#include "util/glyph_cache.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+
+// The response has to fit in the heap alongside everything else, with room for the layer's line table.
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define MAX_FRAGMENTS 256
+
+typedef enum {
+  MeasureWithFirmware,
+  MeasureWithEmptyCache,
+  MeasureWithFilledCache,
+  MeasureCount,
+} MeasureMode;
+
+typedef struct {
+  const char *name;
+  const char *text;
+} BenchResponse;
+
+typedef struct {
+  int fragments;
+  uint32_t layout_calls;
+  int64_t ns;
+  // The layer's height after each fragment, to check every way of measuring wraps the same way.
+  int16_t heights[MAX_FRAGMENTS];
+} BenchResult;
+
+static const BenchResponse s_responses[] = {
+  // From replays/long_answer.json.
+  { "a long answer",
+    "The Pebble smartwatch was developed by Pebble Technology Corporation and shipped from 2013 to 2016. In December "
+    "2016, Pebble was sold to Fitbit, who were themselves acquired by Google in 2021. In January 2025, Google "
+    "announced that the operating system Pebble smartwatches use, PebbleOS, would be open-sourced. In March 2025, it "
+    "was announced that new devices would be produced using PebbleOS under the Core Devices brand name.\n\n\nOkay, "
+    "here are the times across the time zones of the United States: Honolulu is Fri, 18 Apr 2025 19:42:08 HST; "
+    "Anchorage is Fri, 18 Apr 2025 21:42:09 AKDT; Los Angeles is Fri, 18 Apr 2025 22:42:09 PDT; Denver is Fri, 18 "
+    "Apr 2025 23:42:10 MDT; Chicago is Sat, 19 Apr 2025 00:42:10 CDT; and New York is Sat, 19 Apr 2025 01:42:11 "
+    "EDT.\n" },
+  // From emulator/prerecorded.js. The degree sign isn't ASCII, so its line is measured by the firmware either way.
+  { "a weather answer",
+    "It's partly cloudy and 12°C. The wind is 1 mph from the NW." },
+};
+#define RESPONSE_COUNT ((int)(sizeof(s_responses) / sizeof(s_responses[0])))
+
+static BenchResult prv_stream(const BenchResponse *response, MeasureMode mode);
+static int64_t prv_host_ns(void);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+
+  sim_heap_init(heap_size);
+  pebble_shim_init();
+  memory_pressure_init();
+  bmalloc_init();
+  fonts_load();
+
+  printf("Text layouts to wrap a response streamed a word at a time:\n");
+  printf("  %-18s %10s %14s %14s %14s %12s\n", "", "fragments", "without cache", "empty cache", "filled cache",
+         "us filled");
+  bool ok = true;
+  for (int i = 0; i < RESPONSE_COUNT; ++i) {
+    // In this order, so the filled cache is the one the empty one ended up with.
+    BenchResult results[MeasureCount];
+    for (MeasureMode mode = 0; mode < MeasureCount; ++mode) {
+      results[mode] = prv_stream(&s_responses[i], mode);
+    }
+    const BenchResult *without = &results[MeasureWithFirmware];
+    const BenchResult *filled = &results[MeasureWithFilledCache];
+    printf("  %-18s %10d %14u %14u %14u %12.1f\n", s_responses[i].name, without->fragments,
+           (unsigned)without->layout_calls, (unsigned)results[MeasureWithEmptyCache].layout_calls,
+           (unsigned)filled->layout_calls, filled->ns / 1000.0);
+    for (MeasureMode mode = MeasureWithEmptyCache; mode < MeasureCount; ++mode) {
+      for (int f = 0; f < without->fragments; ++f) {
+        if (results[mode].heights[f] != without->heights[f]) {
+          printf("  After fragment %d the layer is %d high with the cache and %d without.\n", f,
+                 results[mode].heights[f], without->heights[f]);
+          ok = false;
+          break;
+        }
+      }
+    }
+    if (filled->layout_calls >= without->layout_calls) {
+      printf("  The glyph cache didn't save any layouts.\n");
+      ok = false;
+    }
+  }
+
+  fonts_unload();
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+// Sends the response a word (and the spaces after it) at a time, updating the layer after each, as segment_layer.c
+// does when the conversation manager tells the session window a response has grown.
+static BenchResult prv_stream(const BenchResponse *response, MeasureMode mode) {
+  BenchResult result = {0};
+  if (mode != MeasureWithFilledCache) {
+    glyph_cache_clear();
+  }
+  glyph_cache_set_enabled(mode != MeasureWithFirmware);
+  Conversation *conversation = conversation_create();
+  conversation_start_response(conversation);
+  MessageLayer *layer = NULL;
+  char fragment[64];
+  const uint32_t layouts_before = pebble_shim_text_layout_calls();
+  const int64_t start = prv_host_ns();
+  for (const char *next = response->text; *next && result.fragments < MAX_FRAGMENTS;) {
+    size_t length = strcspn(next, " \n");
+    length += strspn(next + length, " \n");
+    if (length >= sizeof(fragment)) {
+      length = sizeof(fragment) - 1;
+    }
+    memcpy(fragment, next, length);
+    fragment[length] = '\0';
+    next += length;
+    conversation_add_response_fragment(conversation, fragment);
+    if (!layer) {
+      layer = message_layer_create(GRect(0, 0, PBL_DISPLAY_WIDTH, 1000), conversation_peek(conversation));
+    } else {
+      message_layer_update(layer);
+    }
+    result.heights[result.fragments++] = layer_get_frame(layer).size.h;
+  }
+  result.ns = prv_host_ns() - start;
+  result.layout_calls = pebble_shim_text_layout_calls() - layouts_before;
+  message_layer_destroy(layer);
+  conversation_destroy(conversation);
+  glyph_cache_set_enabled(true);
+  return result;
+}
+
+static int64_t prv_host_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "usage: bobby_layout_bench [--heap BYTES]\n");
+}
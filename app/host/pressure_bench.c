@@ -0,0 +1,395 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the memory pressure machinery in util/memory/pressure.c:
+//
+// - Sweeps: how long memory_pressure_try_free takes to go through the callbacks the app really registers, and a full
+//   table of them, when none has anything to give. It's compared with the linked list the table replaced, which looked
+//   every callback up by index once per priority.
+// - Need-aware handlers: a conversation's worth of small blocks, with larger allocations made on top, once with a
+//   handler that frees as much as it's asked for and once with one that frees a block at a time, as they all used to.
+// - Sessions: conversation managers created and destroyed many times over, which must each give back their callback,
+//   and more open at once than there's room for callbacks, which mustn't stop the app.
+//
+//   bobby_pressure_bench [--sweeps N] [--heap BYTES]
+//
+// Exits non-zero if callbacks are called out of order, if freeing as much as asked takes as many sweeps as freeing a
+// block at a time, or if the sessions leave callbacks behind. Times are the host's, so only good for comparing one
+// build with another on the same computer.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+#include <pebble_shim.h>
+#include <@rebble/linked-list/linked-list.h>
+
+#include "converse/conversation_manager.h"
+#include "util/app_message_router.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define DEFAULT_SWEEPS 200000
+// Enough to fill the callback table, which is eight; bmalloc's own is already in it.
+#define CROWDED_CALLBACKS 7
+#define MAX_ENTRIES 512
+#define LARGE_ALLOCATIONS 400
+// More sessions than there's room for callbacks, several times over.
+#define SESSIONS 40
+// Open at once, more than there's room for callbacks: the last few have to do without.
+#define STACKED_SESSIONS 10
+
+typedef struct {
+  MemoryPressureHandler handler;
+  int priority;
+  void *context;
+} LegacyCallback;
+
+typedef struct {
+  // Oldest first.
+  void *blocks[MAX_ENTRIES];
+  size_t sizes[MAX_ENTRIES];
+  int count;
+  bool one_at_a_time;
+  int calls;
+  int deleted;
+} EntryList;
+
+typedef struct {
+  int sweeps;
+  int handler_calls;
+  int deleted;
+  int failures;
+  int64_t ns;
+} NeedResult;
+
+static int s_call_order[CROWDED_CALLBACKS];
+static int s_call_count;
+static LinkedRoot *s_legacy_callbacks;
+static int s_legacy_max_priority;
+
+static bool prv_bench_sweeps(int sweeps);
+static int64_t prv_time_sweeps(int sweeps);
+static int64_t prv_time_legacy_sweeps(int sweeps);
+static size_t prv_nothing_to_free(size_t bytes_needed, void *context);
+static void prv_legacy_register(MemoryPressureHandler handler, int priority, void *context);
+static void prv_legacy_clear(void);
+static bool prv_legacy_try_free(size_t bytes_needed);
+static bool prv_bench_need_aware(void);
+static NeedResult prv_run_entries(bool one_at_a_time);
+static bool prv_add_entry(EntryList *list);
+static size_t prv_delete_entries(size_t bytes_needed, void *context);
+static bool prv_bench_sessions(void);
+static int64_t prv_host_ns(void);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  int sweeps = DEFAULT_SWEEPS;
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--sweeps") == 0 && arg + 1 < argc) {
+      sweeps = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+
+  sim_heap_init(heap_size);
+  pebble_shim_init();
+  memory_pressure_init();
+  bmalloc_init();
+  app_message_router_init();
+  conversation_manager_init();
+  events_app_message_open();
+
+  bool ok = prv_bench_sweeps(sweeps);
+  ok = prv_bench_need_aware() && ok;
+  ok = prv_bench_sessions() && ok;
+
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+//
+// Sweeps
+//
+
+static bool prv_bench_sweeps(int sweeps) {
+  printf("Sweeps with nothing to free, %d of each:\n", sweeps);
+  printf("  %-34s %12s %12s\n", "", "table ns", "list ns");
+  // What a conversation registers besides bmalloc: the image manager, the session window and the conversation.
+  static const int s_app_priorities[] = { 0, 0, 1 };
+  // And a table full of them, over a few priorities, registered out of order.
+  static const int s_crowded_priorities[CROWDED_CALLBACKS] = { 3, 1, 0, 2, 1, 3, 0 };
+  struct {
+    const char *name;
+    const int *priorities;
+    int count;
+  } sets[] = {
+    { "as in a conversation (4)", s_app_priorities, 3 },
+    { "full table (8)", s_crowded_priorities, CROWDED_CALLBACKS },
+  };
+  bool ok = true;
+  for (size_t set = 0; set < sizeof(sets) / sizeof(sets[0]); ++set) {
+    MemoryPressureCallback *callbacks[CROWDED_CALLBACKS];
+    s_legacy_callbacks = linked_list_create_root();
+    s_legacy_max_priority = 0;
+    // Standing in for bmalloc's own, which is already in the table.
+    prv_legacy_register(prv_nothing_to_free, 0, (void *)(intptr_t)-1);
+    for (int i = 0; i < sets[set].count; ++i) {
+      callbacks[i] = memory_pressure_register_callback(prv_nothing_to_free, sets[set].priorities[i], (void *)(intptr_t)i);
+      prv_legacy_register(prv_nothing_to_free, sets[set].priorities[i], (void *)(intptr_t)i);
+    }
+
+    // Lowest priority first, and in the order they were registered within a priority.
+    s_call_count = 0;
+    memory_pressure_try_free(64);
+    for (int i = 1; i < s_call_count; ++i) {
+      const int previous = sets[set].priorities[s_call_order[i - 1]];
+      const int current = sets[set].priorities[s_call_order[i]];
+      if (previous > current || (previous == current && s_call_order[i - 1] > s_call_order[i])) {
+        printf("  Callbacks were called out of order.\n");
+        ok = false;
+        break;
+      }
+    }
+    if (s_call_count != sets[set].count) {
+      printf("  %d of %d callbacks were called.\n", s_call_count, sets[set].count);
+      ok = false;
+    }
+
+    const int64_t table_ns = prv_time_sweeps(sweeps);
+    const int64_t list_ns = prv_time_legacy_sweeps(sweeps);
+    printf("  %-34s %12.1f %12.1f\n", sets[set].name, (double)table_ns / sweeps, (double)list_ns / sweeps);
+
+    for (int i = 0; i < sets[set].count; ++i) {
+      memory_pressure_unregister_callback(callbacks[i]);
+    }
+    prv_legacy_clear();
+  }
+  return ok;
+}
+
+static int64_t prv_time_sweeps(int sweeps) {
+  const int64_t start = prv_host_ns();
+  for (int i = 0; i < sweeps; ++i) {
+    memory_pressure_try_free(64);
+  }
+  return prv_host_ns() - start;
+}
+
+static int64_t prv_time_legacy_sweeps(int sweeps) {
+  const int64_t start = prv_host_ns();
+  for (int i = 0; i < sweeps; ++i) {
+    prv_legacy_try_free(64);
+  }
+  return prv_host_ns() - start;
+}
+
+static size_t prv_nothing_to_free(size_t bytes_needed, void *context) {
+  if (s_call_count < CROWDED_CALLBACKS) {
+    s_call_order[s_call_count] = (intptr_t)context;
+  }
+  s_call_count++;
+  return 0;
+}
+
+// The registry as it was before the table: a linked list, swept once per priority up to the highest registered.
+static void prv_legacy_register(MemoryPressureHandler handler, int priority, void *context) {
+  LegacyCallback *callback = malloc(sizeof(LegacyCallback));
+  *callback = (LegacyCallback) { .handler = handler, .priority = priority, .context = context };
+  linked_list_append(s_legacy_callbacks, callback);
+  if (priority > s_legacy_max_priority) {
+    s_legacy_max_priority = priority;
+  }
+}
+
+static void prv_legacy_clear(void) {
+  while (linked_list_count(s_legacy_callbacks) > 0) {
+    free(linked_list_get(s_legacy_callbacks, 0));
+    linked_list_remove(s_legacy_callbacks, 0);
+  }
+  free(s_legacy_callbacks);
+  s_legacy_callbacks = NULL;
+}
+
+static bool prv_legacy_try_free(size_t bytes_needed) {
+  const int count = linked_list_count(s_legacy_callbacks);
+  for (int p = 0; p <= s_legacy_max_priority; ++p) {
+    for (int i = 0; i < count; ++i) {
+      LegacyCallback *callback = linked_list_get(s_legacy_callbacks, i);
+      if (callback->priority != p) {
+        continue;
+      }
+      if (callback->handler(bytes_needed, callback->context)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//
+// Need-aware handlers
+//
+
+static bool prv_bench_need_aware(void) {
+  printf("Need-aware handlers, %d allocations of 1-3 KB over a full conversation:\n", LARGE_ALLOCATIONS);
+  printf("  %-34s %8s %14s %9s %9s %12s\n", "", "sweeps", "handler calls", "deleted", "failed", "us");
+  const NeedResult need_aware = prv_run_entries(false);
+  const NeedResult one_at_a_time = prv_run_entries(true);
+  const struct {
+    const char *name;
+    const NeedResult *result;
+  } rows[] = {
+    { "freeing as much as asked", &need_aware },
+    { "freeing a block at a time", &one_at_a_time },
+  };
+  for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); ++i) {
+    printf("  %-34s %8d %14d %9d %9d %12.1f\n", rows[i].name, rows[i].result->sweeps, rows[i].result->handler_calls,
+           rows[i].result->deleted, rows[i].result->failures, rows[i].result->ns / 1000.0);
+  }
+  if (need_aware.sweeps >= one_at_a_time.sweeps) {
+    printf("  Freeing as much as asked took as many sweeps as freeing a block at a time.\n");
+    return false;
+  }
+  return true;
+}
+
+// Fills the heap with small blocks, as a long conversation does, then keeps asking for larger ones while adding more
+// small ones, so every large allocation has to evict.
+static NeedResult prv_run_entries(bool one_at_a_time) {
+  srand(1);
+  EntryList list = { .one_at_a_time = one_at_a_time };
+  MemoryPressureCallback *callback = memory_pressure_register_callback(prv_delete_entries, 1, &list);
+  while (list.count < MAX_ENTRIES && bmalloc_bytes_free() > 2048) {
+    if (!prv_add_entry(&list)) {
+      break;
+    }
+  }
+  const MemoryPressureStats before = memory_pressure_get_stats();
+  void *large[2] = { NULL, NULL };
+  int failures = 0;
+  const int64_t start = prv_host_ns();
+  for (int i = 0; i < LARGE_ALLOCATIONS; ++i) {
+    bfree(large[i % 2]);
+    large[i % 2] = bmalloc(1024 + rand() % 2049);
+    if (!large[i % 2]) {
+      failures++;
+    }
+    for (int j = 0; j < 4 && list.count < MAX_ENTRIES; ++j) {
+      if (!prv_add_entry(&list)) {
+        failures++;
+        break;
+      }
+    }
+  }
+  const int64_t ns = prv_host_ns() - start;
+  const MemoryPressureStats after = memory_pressure_get_stats();
+  bfree(large[0]);
+  bfree(large[1]);
+  for (int i = 0; i < list.count; ++i) {
+    bfree(list.blocks[i]);
+  }
+  memory_pressure_unregister_callback(callback);
+  return (NeedResult) {
+    .sweeps = after.sweeps - before.sweeps,
+    .handler_calls = list.calls,
+    .deleted = list.deleted,
+    .failures = failures,
+    .ns = ns,
+  };
+}
+
+// The allocation can sweep, and the sweep can delete entries, so only find the slot once it has returned.
+static bool prv_add_entry(EntryList *list) {
+  const size_t size = 80 + rand() % 161;
+  void *block = bmalloc(size);
+  if (!block || list->count >= MAX_ENTRIES) {
+    bfree(block);
+    return false;
+  }
+  list->blocks[list->count] = block;
+  list->sizes[list->count] = size;
+  list->count++;
+  return true;
+}
+
+// Deletes the oldest blocks, like the conversation manager does its oldest entries: either until bytes_needed have
+// been freed, or just the one.
+static size_t prv_delete_entries(size_t bytes_needed, void *context) {
+  EntryList *list = context;
+  list->calls++;
+  size_t freed = 0;
+  int deleted = 0;
+  while (deleted < list->count && (freed < bytes_needed || deleted == 0)) {
+    bfree(list->blocks[deleted]);
+    freed += list->sizes[deleted];
+    deleted++;
+    if (list->one_at_a_time) {
+      break;
+    }
+  }
+  memmove(list->blocks, list->blocks + deleted, sizeof(list->blocks[0]) * (list->count - deleted));
+  memmove(list->sizes, list->sizes + deleted, sizeof(list->sizes[0]) * (list->count - deleted));
+  list->count -= deleted;
+  list->deleted += deleted;
+  return freed;
+}
+
+//
+// Sessions
+//
+
+static bool prv_bench_sessions(void) {
+  ConversationManager *stacked[STACKED_SESSIONS];
+  for (int i = 0; i < STACKED_SESSIONS; ++i) {
+    stacked[i] = conversation_manager_create();
+  }
+  memory_pressure_try_free(sim_heap_get_stats().size);
+  for (int i = STACKED_SESSIONS - 1; i >= 0; --i) {
+    conversation_manager_destroy(stacked[i]);
+  }
+  for (int i = 0; i < SESSIONS; ++i) {
+    ConversationManager *manager = conversation_manager_create();
+    conversation_manager_destroy(manager);
+  }
+  // Had any of them left its callback behind, the table would have filled up long before now, and this sweep would
+  // call back into a manager that's been freed.
+  // Ask for more than the heap holds so that nothing earlier in the order can end the sweep before it gets there.
+  s_call_count = 0;
+  MemoryPressureCallback *callback = memory_pressure_register_callback(prv_nothing_to_free, 0, NULL);
+  memory_pressure_try_free(sim_heap_get_stats().size);
+  memory_pressure_unregister_callback(callback);
+  printf("Sessions: %d open at once, then %d created and destroyed; a sweep afterwards called %d callback%s.\n",
+         STACKED_SESSIONS, SESSIONS, s_call_count, s_call_count == 1 ? "" : "s");
+  return s_call_count == 1;
+}
+
+static int64_t prv_host_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "usage: bobby_pressure_bench [--sweeps N] [--heap BYTES]\n");
+}
@@ -0,0 +1,490 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Draws every kind of conversation segment, and the talking horse, into an off-screen framebuffer the size of this
+// build's screen, and reports how many drawing calls each makes and how much CPU time a frame takes. There's one of
+// these for each screen size: bobby_render_bench_<platform>.
+//
+//   bobby_render_bench_<platform> [--frames N] [--golden FILE [--update]] [--dump DIR]
+//
+// With --golden, what each one drew is checked against the hashes in FILE, so a change meant to make drawing cheaper
+// can show it still draws the same thing. --update rewrites FILE instead, and --dump saves each one's frame as
+// DIR/<platform>_<name>.ppm for a look at what changed.
+//
+// CPU time is the host's, so it's only good for comparing one build with another on the same computer. Draw calls
+// are what the watch would be asked to do.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+#include <pebble_shim.h>
+
+#include "converse/conversation.h"
+#include "converse/segments/segment_layer.h"
+#include "image_manager/image_manager.h"
+#include "talking_horse_layer.h"
+#include "util/app_message_router.h"
+#include "util/fonts.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+
+// The golden file and the report are the benchmark's own, not the watch's.
+#undef malloc
+#undef free
+
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define DEFAULT_FRAMES 200
+#define MAP_IMAGE_ID 1
+#define MAP_IMAGE_HEIGHT 100
+// What the phone sends images in, as lib/image_transfer.js does.
+#define MAP_CHUNK_SIZE 200
+#define MAX_GOLDEN_ENTRIES 32
+
+typedef struct {
+  const char *name;
+  // Adds the entry whose segment is drawn. NULL draws the talking horse instead.
+  void (*add_entry)(Conversation *conversation);
+  bool assistant_label;
+} BenchCase;
+
+typedef struct {
+  char name[32];
+  uint64_t hash;
+} GoldenEntry;
+
+static void prv_add_prompt(Conversation *conversation);
+static void prv_add_response(Conversation *conversation);
+static void prv_add_thought(Conversation *conversation);
+static void prv_add_error(Conversation *conversation);
+static void prv_add_action(Conversation *conversation);
+static void prv_add_weather_single_day(Conversation *conversation);
+static void prv_add_weather_current(Conversation *conversation);
+static void prv_add_weather_multi_day(Conversation *conversation);
+static void prv_add_timer(Conversation *conversation);
+static void prv_add_number(Conversation *conversation);
+#if ENABLE_FEATURE_MAPS
+static void prv_add_map(Conversation *conversation);
+static void prv_send_map_image(void);
+#endif
+static void prv_init_app(void);
+static void prv_clear_framebuffer(void);
+static uint64_t prv_hash_framebuffer(void);
+static int64_t prv_cpu_ns(void);
+static int prv_read_golden(const char *path, GoldenEntry *entries);
+static bool prv_write_golden(const char *path, const GoldenEntry *entries, int count);
+static void prv_usage(const char *program);
+
+static const BenchCase s_cases[] = {
+  { "prompt", prv_add_prompt, false },
+  { "response", prv_add_response, true },
+  { "info_thought", prv_add_thought, false },
+  { "info_error", prv_add_error, false },
+  { "info_action", prv_add_action, false },
+  { "weather_single_day", prv_add_weather_single_day, true },
+  { "weather_current", prv_add_weather_current, true },
+  { "weather_multi_day", prv_add_weather_multi_day, true },
+  { "timer", prv_add_timer, true },
+  { "number", prv_add_number, true },
+#if ENABLE_FEATURE_MAPS
+  { "map", prv_add_map, true },
+#endif
+  { "talking_horse", NULL, false },
+};
+#define CASE_COUNT ((int)(sizeof(s_cases) / sizeof(s_cases[0])))
+
+static const char s_long_response[] =
+    "The Pebble smartwatch was developed by Pebble Technology Corporation and first shipped in 2013, after one of the "
+    "most successful Kickstarter campaigns ever. It has an e-paper display, buttons instead of a touchscreen, and a "
+    "battery that lasts about a week.";
+
+int main(int argc, char **argv) {
+  int frames = DEFAULT_FRAMES;
+  const char *golden_path = NULL;
+  const char *dump_dir = NULL;
+  bool update = false;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--frames") == 0 && arg + 1 < argc) {
+      frames = atoi(argv[++arg]);
+      if (frames < 1) {
+        frames = 1;
+      }
+    } else if (strcmp(argv[arg], "--golden") == 0 && arg + 1 < argc) {
+      golden_path = argv[++arg];
+    } else if (strcmp(argv[arg], "--update") == 0) {
+      update = true;
+    } else if (strcmp(argv[arg], "--dump") == 0 && arg + 1 < argc) {
+      dump_dir = argv[++arg];
+    } else {
+      prv_usage(argv[0]);
+      return 2;
+    }
+  }
+  if (update && !golden_path) {
+    prv_usage(argv[0]);
+    return 2;
+  }
+
+  GoldenEntry golden[MAX_GOLDEN_ENTRIES];
+  int golden_count = 0;
+  if (golden_path && !update) {
+    golden_count = prv_read_golden(golden_path, golden);
+    if (golden_count < 0) {
+      fprintf(stderr, "Can't read %s\n", golden_path);
+      return 2;
+    }
+  }
+
+  sim_heap_init(DEFAULT_HEAP_SIZE);
+  pebble_shim_init();
+  prv_init_app();
+#if ENABLE_FEATURE_MAPS
+  prv_send_map_image();
+#endif
+
+  printf("%s (%dx%d), %d frames each\n", PLATFORM_NAME, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT, frames);
+  printf("%-20s %-9s %10s %12s %12s  %s\n", "", "size", "draw calls", "us/frame", "fastest us", "golden");
+  GoldenEntry results[CASE_COUNT];
+  int mismatches = 0;
+  for (int i = 0; i < CASE_COUNT; ++i) {
+    const BenchCase *bench = &s_cases[i];
+    const GRect screen = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+    Conversation *conversation = NULL;
+    Layer *layer;
+    if (bench->add_entry) {
+      conversation = conversation_create();
+      bench->add_entry(conversation);
+      layer = segment_layer_create(screen, conversation_peek(conversation), bench->assistant_label);
+    } else {
+      layer = talking_horse_layer_create(screen);
+      talking_horse_layer_set_text(layer, "How can I help?");
+    }
+
+    uint32_t draw_calls = 0;
+    int64_t total_ns = 0;
+    int64_t fastest_ns = INT64_MAX;
+    for (int frame = 0; frame < frames; ++frame) {
+      prv_clear_framebuffer();
+      GContext *ctx = pebble_shim_graphics_context_create(pebble_shim_framebuffer());
+      const int64_t start = prv_cpu_ns();
+      pebble_shim_render_layer(layer, ctx);
+      const int64_t elapsed = prv_cpu_ns() - start;
+      total_ns += elapsed;
+      if (elapsed < fastest_ns) {
+        fastest_ns = elapsed;
+      }
+      draw_calls = pebble_shim_graphics_context_draw_calls(ctx);
+      pebble_shim_graphics_context_destroy(ctx);
+    }
+
+    snprintf(results[i].name, sizeof(results[i].name), "%s", bench->name);
+    results[i].hash = prv_hash_framebuffer();
+    const char *verdict = "";
+    if (golden_path && !update) {
+      verdict = "missing";
+      for (int j = 0; j < golden_count; ++j) {
+        if (strcmp(golden[j].name, bench->name) == 0) {
+          verdict = golden[j].hash == results[i].hash ? "ok" : "CHANGED";
+        }
+      }
+      if (strcmp(verdict, "ok") != 0) {
+        ++mismatches;
+      }
+    }
+    if (dump_dir) {
+      char path[512];
+      snprintf(path, sizeof(path), "%s/%s_%s.ppm", dump_dir, PLATFORM_NAME, bench->name);
+      if (!pebble_shim_write_ppm(path)) {
+        fprintf(stderr, "Couldn't write %s\n", path);
+      }
+    }
+    const GSize size = layer_get_frame(layer).size;
+    char size_text[16];
+    snprintf(size_text, sizeof(size_text), "%dx%d", size.w, size.h);
+    printf("%-20s %-9s %10u %12.2f %12.2f  %s\n", bench->name, size_text, (unsigned)draw_calls,
+           total_ns / 1000.0 / frames, fastest_ns / 1000.0, verdict);
+
+    if (bench->add_entry) {
+      segment_layer_destroy(layer);
+      conversation_destroy(conversation);
+    } else {
+      talking_horse_layer_destroy(layer);
+    }
+  }
+
+  int status = 0;
+  if (update) {
+    if (!prv_write_golden(golden_path, results, CASE_COUNT)) {
+      fprintf(stderr, "Can't write %s\n", golden_path);
+      status = 2;
+    } else {
+      printf("Wrote %s\n", golden_path);
+    }
+  } else if (mismatches) {
+    printf("%d of %d drew something different from %s.\n", mismatches, CASE_COUNT, golden_path);
+    status = 1;
+  }
+  const SimHeapStats heap = sim_heap_get_stats();
+  if (heap.failures) {
+    printf("Failed allocations: %d\n", heap.failures);
+    status = 1;
+  }
+
+  fonts_unload();
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return status;
+}
+
+//
+// The segments
+//
+
+static void prv_add_prompt(Conversation *conversation) {
+  conversation_add_prompt(conversation, "Will I need an umbrella in Redwood City this weekend?");
+}
+
+static void prv_add_response(Conversation *conversation) {
+  conversation_add_response(conversation, s_long_response);
+}
+
+static void prv_add_thought(Conversation *conversation) {
+  char thought[] = "Checking the weather nearby...";
+  conversation_add_thought(conversation, thought);
+}
+
+static void prv_add_error(Conversation *conversation) {
+  conversation_add_error(conversation, "Lost connection to server.");
+}
+
+static void prv_add_action(Conversation *conversation) {
+  ConversationAction action = {
+    .type = ConversationActionTypeSetAlarm,
+    .action.set_alarm = {
+      .time = time(NULL) + 300,
+      .is_timer = true,
+      .name = "Baking",
+    },
+  };
+  conversation_add_action(conversation, &action);
+}
+
+static void prv_add_weather_single_day(Conversation *conversation) {
+  ConversationWidget widget = {
+    .type = ConversationWidgetTypeWeatherSingleDay,
+    .widget.weather_single_day = {
+      .high = 19,
+      .low = 9,
+      .condition = 7,
+      .location = "REDWOOD CITY",
+      .summary = "Partly Cloudy",
+      .temp_unit = "°C",
+      .day = "Saturday",
+    },
+  };
+  conversation_add_widget(conversation, &widget);
+}
+
+static void prv_add_weather_current(Conversation *conversation) {
+  ConversationWidget widget = {
+    .type = ConversationWidgetTypeWeatherCurrent,
+    .widget.weather_current = {
+      .temperature = 12,
+      .feels_like = 11,
+      .condition = 8,
+      .wind_speed = 4,
+      .location = "REDWOOD CITY",
+      .summary = "Fair",
+      .wind_speed_unit = "mph",
+    },
+  };
+  conversation_add_widget(conversation, &widget);
+}
+
+static void prv_add_weather_multi_day(Conversation *conversation) {
+  ConversationWidget widget = {
+    .type = ConversationWidgetTypeWeatherMultiDay,
+    .widget.weather_multi_day = {
+      .location = "REDWOOD CITY",
+      .days = {
+        { "SAT", 19, 9, 7 },
+        { "SUN", 21, 10, 8 },
+        { "MON", 17, 11, 3 },
+      },
+    },
+  };
+  conversation_add_widget(conversation, &widget);
+}
+
+static void prv_add_timer(Conversation *conversation) {
+  ConversationWidget widget = {
+    .type = ConversationWidgetTypeTimer,
+    .widget.timer = {
+      .target_time = time(NULL) + 272,
+      .name = "Baking",
+    },
+  };
+  conversation_add_widget(conversation, &widget);
+}
+
+static void prv_add_number(Conversation *conversation) {
+  ConversationWidget widget = {
+    .type = ConversationWidgetTypeNumber,
+    .widget.number = {
+      .number = "2,209",
+      .unit = "squared",
+    },
+  };
+  conversation_add_widget(conversation, &widget);
+}
+
+#if ENABLE_FEATURE_MAPS
+static void prv_add_map(Conversation *conversation) {
+  ConversationWidget widget = {
+    .type = ConversationWidgetTypeMap,
+    .widget.map = {
+      .image_id = MAP_IMAGE_ID,
+      .user_location = GPoint(PBL_DISPLAY_WIDTH / 2, MAP_IMAGE_HEIGHT / 2),
+    },
+  };
+  conversation_add_widget(conversation, &widget);
+}
+
+// Sends the image manager a screen-wide map, the way the phone does: a 2-bit .pbi of a street grid, in chunks.
+static void prv_send_map_image(void) {
+  const int width = PBL_DISPLAY_WIDTH;
+  const int row_size = (width * 2 + 7) / 8;
+  const size_t size = 12 + row_size * MAP_IMAGE_HEIGHT + 4;
+  uint8_t *pbi = calloc(1, size);
+  // Header: row size, then the format (2-bit palette) in bits 1-3 of the flags, then the bounds.
+  const uint16_t header[] = { row_size, GBitmapFormat2BitPalette << 1, 0, 0, width, MAP_IMAGE_HEIGHT };
+  memcpy(pbi, header, sizeof(header));
+  for (int y = 0; y < MAP_IMAGE_HEIGHT; ++y) {
+    for (int x = 0; x < width; ++x) {
+      // 0 is land, 1 a park, 2 a road.
+      int index = (x % 24 < 2 || y % 20 < 2 || (x + y) % 53 == 0) ? 2 : ((x / 24 + y / 20) % 5 == 0 ? 1 : 0);
+      pbi[12 + y * row_size + x / 4] |= index << (6 - (x % 4) * 2);
+    }
+  }
+  const GColor palette[] = { GColorWhite, GColorMayGreen, GColorBlack, GColorClear };
+  memcpy(pbi + 12 + row_size * MAP_IMAGE_HEIGHT, palette, sizeof(palette));
+
+  uint32_t key_id, key_size, key_width, key_height, key_offset, key_data, key_complete;
+  pebble_shim_message_key("IMAGE_ID", &key_id);
+  pebble_shim_message_key("IMAGE_START_BYTE_SIZE", &key_size);
+  pebble_shim_message_key("IMAGE_WIDTH", &key_width);
+  pebble_shim_message_key("IMAGE_HEIGHT", &key_height);
+  pebble_shim_message_key("IMAGE_CHUNK_OFFSET", &key_offset);
+  pebble_shim_message_key("IMAGE_CHUNK_DATA", &key_data);
+  pebble_shim_message_key("IMAGE_COMPLETE", &key_complete);
+  uint8_t buffer[MAP_CHUNK_SIZE + 64];
+  DictionaryIterator iter;
+  dict_write_begin(&iter, buffer, sizeof(buffer));
+  dict_write_int32(&iter, key_id, MAP_IMAGE_ID);
+  dict_write_int32(&iter, key_size, size);
+  dict_write_int32(&iter, key_width, width);
+  dict_write_int32(&iter, key_height, MAP_IMAGE_HEIGHT);
+  pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+  for (size_t offset = 0; offset < size; offset += MAP_CHUNK_SIZE) {
+    dict_write_begin(&iter, buffer, sizeof(buffer));
+    dict_write_int32(&iter, key_id, MAP_IMAGE_ID);
+    dict_write_int32(&iter, key_offset, offset);
+    dict_write_data(&iter, key_data, pbi + offset, size - offset < MAP_CHUNK_SIZE ? size - offset : MAP_CHUNK_SIZE);
+    pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+  }
+  dict_write_begin(&iter, buffer, sizeof(buffer));
+  dict_write_int32(&iter, key_id, MAP_IMAGE_ID);
+  dict_write_int32(&iter, key_complete, 1);
+  pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+  free(pbi);
+}
+#endif
+
+//
+// Everything else
+//
+
+// The parts of assistant.c's start-up that segments depend on.
+static void prv_init_app(void) {
+  memory_pressure_init();
+  bmalloc_init();
+  app_message_router_init();
+#if ENABLE_FEATURE_IMAGE_MANAGER
+  image_manager_init();
+#endif
+  events_app_message_open();
+  fonts_load();
+}
+
+static void prv_clear_framebuffer(void) {
+  GBitmap *framebuffer = pebble_shim_framebuffer();
+  memset(gbitmap_get_data(framebuffer), GColorWhiteARGB8,
+         gbitmap_get_bytes_per_row(framebuffer) * gbitmap_get_bounds(framebuffer).size.h);
+}
+
+// FNV-1a, over every pixel.
+static uint64_t prv_hash_framebuffer(void) {
+  GBitmap *framebuffer = pebble_shim_framebuffer();
+  const uint8_t *data = gbitmap_get_data(framebuffer);
+  const size_t size = gbitmap_get_bytes_per_row(framebuffer) * gbitmap_get_bounds(framebuffer).size.h;
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static int64_t prv_cpu_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// One "name hash" pair per line; lines starting with # are comments. Returns how many were read, or -1.
+static int prv_read_golden(const char *path, GoldenEntry *entries) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    return -1;
+  }
+  int count = 0;
+  char line[128];
+  while (count < MAX_GOLDEN_ENTRIES && fgets(line, sizeof(line), file)) {
+    unsigned long long hash;
+    if (line[0] == '#' || sscanf(line, "%31s %llx", entries[count].name, &hash) != 2) {
+      continue;
+    }
+    entries[count++].hash = hash;
+  }
+  fclose(file);
+  return count;
+}
+
+static bool prv_write_golden(const char *path, const GoldenEntry *entries, int count) {
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    return false;
+  }
+  fprintf(file, "# What each segment draws on %s (%dx%d). Regenerate with bobby_render_bench_%s --golden <this file> "
+                "--update.\n", PLATFORM_NAME, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT, PLATFORM_NAME);
+  for (int i = 0; i < count; ++i) {
+    fprintf(file, "%s %016llx\n", entries[i].name, (unsigned long long)entries[i].hash);
+  }
+  return fclose(file) == 0;
+}
+
+static void prv_usage(const char *program) {
+  fprintf(stderr, "Usage: %s [--frames N] [--golden FILE [--update]] [--dump DIR]\n", program);
+}
@@ -0,0 +1,627 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Plays a recorded reply from the phone into a session window, with the timing it was recorded with, and reports how
+// the watch kept up: how long until the reply was on screen, how long each message took to handle, and what it did to
+// the heap.
+//
+//   bobby_replay [--heap BYTES] [--prompt TEXT] [--gap MS] [--settle MS] [--verbose] [--screenshot FILE.ppm] FILE
+//
+// FILE is a JSON array of the messages the phone sent, as session.js logs them with LOGGING_ENABLED: each entry is
+// {"at": MS, "message": {...}}, where MS is how long after the prompt the message was sent. Entries can also be bare
+// messages, as in emulator/prerecorded.js, in which case they're sent --gap milliseconds apart. Message keys are the
+// names from package.json; elements of array keys are numbers in logs, but can also be written "NAME[INDEX]".
+// Strings, numbers (sent as int32, as PebbleKit JS does) and arrays of bytes are understood.
+//
+// Handler latency is host time, so it's only good for comparing one build with another on the same computer;
+// everything else is in simulated watch time and is repeatable.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+#include <pebble_shim.h>
+
+#include "converse/conversation_manager.h"
+#include "converse/session_window.h"
+#include "alarms/manager.h"
+#include "image_manager/image_manager.h"
+#include "settings/settings.h"
+#include "version/version.h"
+#include "util/app_message_router.h"
+#include "util/fonts.h"
+#include "util/memory/heap_report.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+#include "features.h"
+
+// The recording and the results are the replayer's own, not the watch's.
+#undef malloc
+#undef free
+
+// Roughly what an app gets on the Pebble Time series once the firmware has taken its share.
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define DEFAULT_PROMPT "What's the weather like?"
+#define DEFAULT_GAP_MS 50
+// How long to keep running after the last message, so batched updates and animations finish.
+#define DEFAULT_SETTLE_MS 2000
+// The conversation manager asks for a 1 KB inbox; nothing from the phone should come close.
+#define MAX_MESSAGE_SIZE 1024
+
+typedef enum {
+  JsonNull,
+  JsonBool,
+  JsonNumber,
+  JsonString,
+  JsonArray,
+  JsonObject,
+} JsonType;
+
+typedef struct JsonValue JsonValue;
+
+struct JsonValue {
+  JsonType type;
+  double number;
+  // Strings, and the member names of objects.
+  char *string;
+  // Array elements, or object members in the order they appear.
+  JsonValue *items;
+  char **names;
+  int count;
+};
+
+typedef struct {
+  const char *text;
+  const char *cursor;
+  const char *error;
+} JsonParser;
+
+typedef struct {
+  int64_t at_ms;
+  uint8_t *data;
+  size_t size;
+  // The first key in the message, for --verbose.
+  char label[32];
+  // Host nanoseconds spent in the app's inbox handlers.
+  int64_t handler_ns;
+  AppMessageResult result;
+} ReplayMessage;
+
+static int64_t s_prompt_sent_ms = -1;
+static int64_t s_first_message_ms = -1;
+static int64_t s_first_render_ms = -1;
+// The same two moments in host time.
+static int64_t s_first_message_ns;
+static int64_t s_first_render_ns;
+
+static bool prv_load_recording(const char *path, uint32_t gap_ms, ReplayMessage **messages, int *count);
+static bool prv_encode_message(const JsonValue *message, ReplayMessage *out);
+static bool prv_parse_value(JsonParser *parser, JsonValue *value);
+static void prv_free_value(JsonValue *value);
+static const JsonValue *prv_object_get(const JsonValue *object, const char *name);
+static void prv_init_app(void);
+static AppMessageResult prv_outbox(const uint8_t *data, size_t size, void *context);
+static void prv_rendered(void *context);
+static int64_t prv_host_ns(void);
+static int prv_compare_int64(const void *a, const void *b);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  const char *prompt = DEFAULT_PROMPT;
+  uint32_t gap_ms = DEFAULT_GAP_MS;
+  uint32_t settle_ms = DEFAULT_SETTLE_MS;
+  bool verbose = false;
+  const char *screenshot_path = NULL;
+  const char *path = NULL;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--prompt") == 0 && arg + 1 < argc) {
+      prompt = argv[++arg];
+    } else if (strcmp(argv[arg], "--gap") == 0 && arg + 1 < argc) {
+      gap_ms = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--settle") == 0 && arg + 1 < argc) {
+      settle_ms = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--verbose") == 0) {
+      verbose = true;
+    } else if (strcmp(argv[arg], "--screenshot") == 0 && arg + 1 < argc) {
+      screenshot_path = argv[++arg];
+    } else if (argv[arg][0] != '-' && !path) {
+      path = argv[arg];
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+  if (!path) {
+    prv_usage();
+    return 2;
+  }
+
+  sim_heap_init(heap_size);
+  pebble_shim_init();
+  // Message keys come from the generated tables, so this has to wait until the shim is up.
+  ReplayMessage *messages;
+  int count;
+  if (!prv_load_recording(path, gap_ms, &messages, &count)) {
+    pebble_shim_deinit();
+    sim_heap_deinit();
+    return 2;
+  }
+  pebble_shim_set_outbox_handler(prv_outbox, NULL);
+  pebble_shim_set_render_handler(prv_rendered, NULL);
+
+  // Straight into a conversation, as a quick launch would, but with the prompt already given so there's no dictation.
+  prv_init_app();
+  session_window_push(0, (char *)prompt);
+  while (s_prompt_sent_ms < 0) {
+    if (!pebble_shim_run_for(10) || pebble_shim_now_ms() > 10000) {
+      fprintf(stderr, "The session window never sent the prompt.\n");
+      return 1;
+    }
+  }
+  const int renders_before = pebble_shim_render_count();
+  const SimHeapStats heap_before = sim_heap_get_stats();
+
+  int64_t loop_ns = 0;
+  for (int i = 0; i < count; ++i) {
+    const int64_t due = s_prompt_sent_ms + messages[i].at_ms;
+    if (due > pebble_shim_now_ms()) {
+      const int64_t start = prv_host_ns();
+      pebble_shim_run_for(due - pebble_shim_now_ms());
+      loop_ns += prv_host_ns() - start;
+    }
+    const int64_t start = prv_host_ns();
+    if (s_first_message_ms < 0) {
+      s_first_message_ms = pebble_shim_now_ms();
+      s_first_message_ns = start;
+    }
+    messages[i].result = pebble_shim_deliver_inbox(messages[i].data, messages[i].size);
+    messages[i].handler_ns = prv_host_ns() - start;
+  }
+  const int64_t last_message_ms = pebble_shim_now_ms();
+  const int64_t start = prv_host_ns();
+  pebble_shim_run_for(settle_ms);
+  loop_ns += prv_host_ns() - start;
+
+  if (screenshot_path && !pebble_shim_write_ppm(screenshot_path)) {
+    fprintf(stderr, "Couldn't write %s\n", screenshot_path);
+  }
+
+  int64_t *latencies = malloc(sizeof(int64_t) * (count ? count : 1));
+  int64_t total_ns = 0;
+  size_t total_bytes = 0;
+  int rejected = 0;
+  for (int i = 0; i < count; ++i) {
+    latencies[i] = messages[i].handler_ns;
+    total_ns += messages[i].handler_ns;
+    total_bytes += messages[i].size;
+    if (messages[i].result != APP_MSG_OK) {
+      ++rejected;
+    }
+    if (verbose) {
+      printf("%8lld ms  %4zu bytes  %8.1f us  %s%s\n", (long long)messages[i].at_ms, messages[i].size,
+             messages[i].handler_ns / 1000.0, messages[i].label, messages[i].result == APP_MSG_OK ? "" : " (rejected)");
+    }
+  }
+  qsort(latencies, count, sizeof(int64_t), prv_compare_int64);
+
+  const SimHeapStats heap = sim_heap_get_stats();
+  const MemoryPressureStats pressure = memory_pressure_get_stats();
+  ConversationManager *manager = conversation_manager_get_current();
+  printf("Replayed %d messages (%zu bytes) over %lld simulated ms.\n", count, total_bytes,
+         (long long)(last_message_ms - s_prompt_sent_ms));
+  if (s_first_render_ms >= 0) {
+    printf("First render:       %lld ms after the prompt; %lld ms (%.1f us host time) after the first message\n",
+           (long long)(s_first_render_ms - s_prompt_sent_ms), (long long)(s_first_render_ms - s_first_message_ms),
+           (s_first_render_ns - s_first_message_ns) / 1000.0);
+  } else {
+    printf("First render:       never\n");
+  }
+  printf("Frames drawn:       %d\n", pebble_shim_render_count() - renders_before);
+  if (count > 0) {
+    printf("Handler latency:    median %.1f us, p95 %.1f us, max %.1f us, total %.2f ms\n",
+           latencies[count / 2] / 1000.0, latencies[count * 95 / 100] / 1000.0, latencies[count - 1] / 1000.0,
+           total_ns / 1e6);
+  }
+  printf("Event loop time:    %.2f ms\n", loop_ns / 1e6);
+  printf("Updates coalesced:  %u\n", manager ? (unsigned)conversation_manager_get_coalesced_update_count(manager) : 0);
+  printf("Heap:               %zu bytes, %zu in use before the reply\n", heap.size, heap_before.used);
+  printf("Peak heap use:      %zu bytes\n", heap.peak_used);
+  printf("Largest free block: %zu bytes\n", heap.largest_free_block);
+  printf("Evictions:          %u (%u bytes, %u sweeps)\n", (unsigned)pressure.evictions,
+         (unsigned)pressure.bytes_freed, (unsigned)pressure.sweeps);
+  printf("Failed allocations: %d (%d from fragmentation)\n", heap.failures, heap.fragmented_failures);
+  if (rejected) {
+    printf("Rejected messages:  %d\n", rejected);
+  }
+  const bool ok = heap.failures == 0 && rejected == 0 && s_first_render_ms >= 0;
+
+  for (int i = 0; i < count; ++i) {
+    free(messages[i].data);
+  }
+  free(messages);
+  free(latencies);
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+// As assistant.c does before it decides what to show.
+static void prv_init_app(void) {
+  memory_pressure_init();
+  bmalloc_init();
+  app_message_router_init();
+  heap_report_init();
+  version_init();
+  settings_init();
+  conversation_manager_init();
+#if ENABLE_FEATURE_IMAGE_MANAGER
+  image_manager_init();
+#endif
+  events_app_message_open();
+  alarm_manager_init();
+  fonts_load();
+}
+
+static AppMessageResult prv_outbox(const uint8_t *data, size_t size, void *context) {
+  DictionaryIterator iter;
+  if (s_prompt_sent_ms < 0 && dict_read_begin_from_buffer(&iter, data, size) && dict_find(&iter, MESSAGE_KEY_PROMPT)) {
+    s_prompt_sent_ms = pebble_shim_now_ms();
+  }
+  return APP_MSG_OK;
+}
+
+static void prv_rendered(void *context) {
+  if (s_first_message_ms >= 0 && s_first_render_ms < 0) {
+    s_first_render_ms = pebble_shim_now_ms();
+    s_first_render_ns = prv_host_ns();
+  }
+}
+
+static int64_t prv_host_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static int prv_compare_int64(const void *a, const void *b) {
+  const int64_t x = *(const int64_t *)a;
+  const int64_t y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static bool prv_load_recording(const char *path, uint32_t gap_ms, ReplayMessage **messages, int *count) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "Can't open %s\n", path);
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  const long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *text = malloc(length + 1);
+  const size_t read = fread(text, 1, length, file);
+  fclose(file);
+  text[read] = '\0';
+
+  JsonParser parser = { .text = text, .cursor = text };
+  JsonValue root;
+  bool ok = prv_parse_value(&parser, &root);
+  if (!ok) {
+    fprintf(stderr, "%s:%d: %s\n", path, (int)(parser.cursor - text), parser.error);
+    free(text);
+    return false;
+  }
+  free(text);
+  if (root.type != JsonArray) {
+    fprintf(stderr, "%s: expected an array of messages\n", path);
+    prv_free_value(&root);
+    return false;
+  }
+
+  *messages = calloc(root.count ? root.count : 1, sizeof(ReplayMessage));
+  *count = root.count;
+  int64_t previous_at = 0;
+  for (int i = 0; ok && i < root.count; ++i) {
+    const JsonValue *entry = &root.items[i];
+    const JsonValue *message = entry;
+    // A message that was still queued when the log was written has a null time; it goes out after the one before.
+    const JsonValue *at = entry->type == JsonObject ? prv_object_get(entry, "at") : NULL;
+    if (at) {
+      message = prv_object_get(entry, "message");
+    }
+    (*messages)[i].at_ms = (at && at->type == JsonNumber) ? (int64_t)at->number : previous_at + gap_ms;
+    if (!message || message->type != JsonObject) {
+      fprintf(stderr, "%s: entry %d isn't a message\n", path, i);
+      ok = false;
+    } else if ((*messages)[i].at_ms < previous_at) {
+      fprintf(stderr, "%s: entry %d is earlier than the one before it\n", path, i);
+      ok = false;
+    } else if (!prv_encode_message(message, &(*messages)[i])) {
+      fprintf(stderr, "%s: can't send entry %d\n", path, i);
+      ok = false;
+    }
+    previous_at = (*messages)[i].at_ms;
+  }
+  prv_free_value(&root);
+  if (!ok) {
+    for (int i = 0; i < *count; ++i) {
+      free((*messages)[i].data);
+    }
+    free(*messages);
+  }
+  return ok;
+}
+
+// A key name, an element of an array key written as "NAME[INDEX]", or a number.
+static bool prv_parse_key(const char *name, uint32_t *key) {
+  char *end;
+  *key = strtoul(name, &end, 10);
+  if (*name != '\0' && *end == '\0') {
+    return true;
+  }
+  char base[64];
+  unsigned int index = 0;
+  const char *bracket = strchr(name, '[');
+  if (!bracket) {
+    return pebble_shim_message_key(name, key);
+  }
+  if ((size_t)(bracket - name) >= sizeof(base) || sscanf(bracket, "[%u]", &index) != 1) {
+    return false;
+  }
+  memcpy(base, name, bracket - name);
+  base[bracket - name] = '\0';
+  if (!pebble_shim_message_key(base, key)) {
+    return false;
+  }
+  *key += index;
+  return true;
+}
+
+// Serialises a message the way the phone would send it.
+static bool prv_encode_message(const JsonValue *message, ReplayMessage *out) {
+  uint8_t buffer[MAX_MESSAGE_SIZE];
+  DictionaryIterator iter;
+  dict_write_begin(&iter, buffer, sizeof(buffer));
+  for (int i = 0; i < message->count; ++i) {
+    const char *name = message->names[i];
+    const JsonValue *value = &message->items[i];
+    uint32_t key;
+    if (!prv_parse_key(name, &key)) {
+      fprintf(stderr, "Unknown message key %s\n", name);
+      return false;
+    }
+    if (i == 0) {
+      snprintf(out->label, sizeof(out->label), "%s", name);
+    }
+    DictionaryResult result = DICT_INVALID_ARGS;
+    if (value->type == JsonString) {
+      result = dict_write_cstring(&iter, key, value->string);
+    } else if (value->type == JsonNumber || value->type == JsonBool) {
+      result = dict_write_int32(&iter, key, (int32_t)value->number);
+    } else if (value->type == JsonArray) {
+      uint8_t bytes[MAX_MESSAGE_SIZE];
+      if (value->count > MAX_MESSAGE_SIZE) {
+        return false;
+      }
+      for (int j = 0; j < value->count; ++j) {
+        if (value->items[j].type != JsonNumber) {
+          return false;
+        }
+        bytes[j] = (uint8_t)value->items[j].number;
+      }
+      result = dict_write_data(&iter, key, bytes, value->count);
+    } else if (value->type == JsonNull) {
+      continue;
+    }
+    if (result != DICT_OK) {
+      fprintf(stderr, "Can't write %s: %d\n", name, result);
+      return false;
+    }
+  }
+  out->size = dict_write_end(&iter);
+  out->data = malloc(out->size);
+  memcpy(out->data, buffer, out->size);
+  return true;
+}
+
+//
+// Just enough JSON for recordings.
+//
+
+static void prv_skip_space(JsonParser *parser) {
+  while (*parser->cursor == ' ' || *parser->cursor == '\t' || *parser->cursor == '\n' || *parser->cursor == '\r') {
+    parser->cursor++;
+  }
+}
+
+static bool prv_fail(JsonParser *parser, const char *error) {
+  parser->error = error;
+  return false;
+}
+
+static void prv_append_utf8(char *out, size_t *length, uint32_t codepoint) {
+  if (codepoint < 0x80) {
+    out[(*length)++] = codepoint;
+  } else if (codepoint < 0x800) {
+    out[(*length)++] = 0xc0 | (codepoint >> 6);
+    out[(*length)++] = 0x80 | (codepoint & 0x3f);
+  } else {
+    out[(*length)++] = 0xe0 | (codepoint >> 12);
+    out[(*length)++] = 0x80 | ((codepoint >> 6) & 0x3f);
+    out[(*length)++] = 0x80 | (codepoint & 0x3f);
+  }
+}
+
+static bool prv_parse_string(JsonParser *parser, char **string) {
+  const char *start = ++parser->cursor;
+  const char *end = start;
+  while (*end && *end != '"') {
+    end += (*end == '\\' && end[1]) ? 2 : 1;
+  }
+  if (!*end) {
+    return prv_fail(parser, "unterminated string");
+  }
+  // Unescaping never makes a string longer.
+  char *out = malloc(end - start + 1);
+  size_t length = 0;
+  for (const char *c = start; c < end; ++c) {
+    if (*c != '\\') {
+      out[length++] = *c;
+      continue;
+    }
+    ++c;
+    switch (*c) {
+      case 'n': out[length++] = '\n'; break;
+      case 't': out[length++] = '\t'; break;
+      case 'r': out[length++] = '\r'; break;
+      case 'b': out[length++] = '\b'; break;
+      case 'f': out[length++] = '\f'; break;
+      case 'u': {
+        unsigned int codepoint = 0;
+        if (end - c < 5 || sscanf(c + 1, "%4x", &codepoint) != 1) {
+          free(out);
+          parser->cursor = c;
+          return prv_fail(parser, "bad \\u escape");
+        }
+        prv_append_utf8(out, &length, codepoint);
+        c += 4;
+        break;
+      }
+      default: out[length++] = *c; break;
+    }
+  }
+  out[length] = '\0';
+  *string = out;
+  parser->cursor = end + 1;
+  return true;
+}
+
+// Arrays and objects both: a list of values between brackets, and for objects a name before each.
+static bool prv_parse_list(JsonParser *parser, JsonValue *value, char close, bool named) {
+  int space = 0;
+  parser->cursor++;
+  prv_skip_space(parser);
+  if (*parser->cursor == close) {
+    parser->cursor++;
+    return true;
+  }
+  while (true) {
+    if (value->count == space) {
+      space = space ? space * 2 : 8;
+      value->items = realloc(value->items, sizeof(JsonValue) * space);
+      if (named) {
+        value->names = realloc(value->names, sizeof(char *) * space);
+      }
+    }
+    prv_skip_space(parser);
+    if (named) {
+      if (*parser->cursor != '"') {
+        return prv_fail(parser, "expected a member name");
+      }
+      if (!prv_parse_string(parser, &value->names[value->count])) {
+        return false;
+      }
+      prv_skip_space(parser);
+      if (*parser->cursor != ':') {
+        free(value->names[value->count]);
+        return prv_fail(parser, "expected ':'");
+      }
+      parser->cursor++;
+    }
+    if (!prv_parse_value(parser, &value->items[value->count])) {
+      if (named) {
+        free(value->names[value->count]);
+      }
+      return false;
+    }
+    value->count++;
+    prv_skip_space(parser);
+    if (*parser->cursor == ',') {
+      parser->cursor++;
+    } else if (*parser->cursor == close) {
+      parser->cursor++;
+      return true;
+    } else {
+      return prv_fail(parser, named ? "expected ',' or '}'" : "expected ',' or ']'");
+    }
+  }
+}
+
+static bool prv_parse_value(JsonParser *parser, JsonValue *value) {
+  memset(value, 0, sizeof(*value));
+  prv_skip_space(parser);
+  const char c = *parser->cursor;
+  bool ok;
+  if (c == '[') {
+    value->type = JsonArray;
+    ok = prv_parse_list(parser, value, ']', false);
+  } else if (c == '{') {
+    value->type = JsonObject;
+    ok = prv_parse_list(parser, value, '}', true);
+  } else if (c == '"') {
+    value->type = JsonString;
+    ok = prv_parse_string(parser, &value->string);
+  } else if (strncmp(parser->cursor, "true", 4) == 0 || strncmp(parser->cursor, "false", 5) == 0) {
+    value->type = JsonBool;
+    value->number = c == 't';
+    parser->cursor += c == 't' ? 4 : 5;
+    ok = true;
+  } else if (strncmp(parser->cursor, "null", 4) == 0) {
+    value->type = JsonNull;
+    parser->cursor += 4;
+    ok = true;
+  } else {
+    char *end;
+    value->type = JsonNumber;
+    value->number = strtod(parser->cursor, &end);
+    ok = end != parser->cursor || prv_fail(parser, "unexpected character");
+    parser->cursor = end;
+  }
+  if (!ok) {
+    prv_free_value(value);
+  }
+  return ok;
+}
+
+static void prv_free_value(JsonValue *value) {
+  for (int i = 0; i < value->count; ++i) {
+    prv_free_value(&value->items[i]);
+    if (value->names) {
+      free(value->names[i]);
+    }
+  }
+  free(value->items);
+  free(value->names);
+  free(value->string);
+  memset(value, 0, sizeof(*value));
+}
+
+static const JsonValue *prv_object_get(const JsonValue *object, const char *name) {
+  for (int i = 0; i < object->count; ++i) {
+    if (strcmp(object->names[i], name) == 0) {
+      return &object->items[i];
+    }
+  }
+  return NULL;
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "Usage: bobby_replay [--heap BYTES] [--prompt TEXT] [--gap MS] [--settle MS] [--verbose] "
+                  "[--screenshot FILE.ppm] FILE\n");
+}
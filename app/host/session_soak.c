@@ -0,0 +1,303 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Keeps one session window going for a very long conversation: prompts, replies and widgets, far more than fit in the
+// heap, so the oldest are deleted off the top the whole time. Checks that the session window's bookkeeping stays
+// bounded while it does. Before it starts, checks that an entry pinned while its layer is built survives eviction
+// even when a deleted thought is all that's in front of it, and makes the segment array fail to grow once, so one
+// entry never gets a segment.
+//
+//   bobby_session_soak [--segments N] [--heap BYTES] [--verbose]
+//
+// It fails if the pinned entry is deleted, if segments stop matching up with entries, if the segment array keeps growing, if the container isn't moved back to the origin once it's been pushed
+// far enough down, or if layers are kept for segments that are nowhere near the screen.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+#include <pebble_shim.h>
+
+#include "converse/conversation_manager.h"
+#include "converse/session_window.h"
+#include "alarms/manager.h"
+#include "image_manager/image_manager.h"
+#include "settings/settings.h"
+#include "version/version.h"
+#include "util/app_message_router.h"
+#include "util/fonts.h"
+#include "util/memory/heap_report.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+#include "features.h"
+
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define DEFAULT_SEGMENTS 100000
+// As in session_window.c.
+#define SEGMENT_REBASE_THRESHOLD 8192
+// Only a handful of segments fit in the heap at once, so the array should never need to be bigger than this.
+#define MAX_SEGMENT_SPACE 128
+// A prompt, then this many segments of reply.
+#define SEGMENTS_PER_TURN 4
+#define MESSAGE_BUFFER_SIZE 256
+// A segment is 24 bytes on the host, so under this the segment array can grow to 32 segments but not 64. Nothing else
+// the session window allocates for a short reply comes close.
+#define SEGMENT_ARRAY_LIMIT 1024
+#define MAX_TURNS_TO_FILL_ARRAY 64
+
+static bool s_verbose;
+
+static void prv_init_app(void);
+static bool prv_check_pinned_entry(ConversationManager *manager);
+static bool prv_force_segment_without_room(ConversationManager *manager, SessionWindow *sw);
+static AppMessageResult prv_outbox(const uint8_t *data, size_t size, void *context);
+static void prv_send_reply_segment(int segment);
+static void prv_send_string(const uint32_t key, const char *value);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  int segments = DEFAULT_SEGMENTS;
+  size_t heap_size = DEFAULT_HEAP_SIZE;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--segments") == 0 && arg + 1 < argc) {
+      segments = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "--heap") == 0 && arg + 1 < argc) {
+      heap_size = strtoul(argv[++arg], NULL, 0);
+    } else if (strcmp(argv[arg], "--verbose") == 0) {
+      s_verbose = true;
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+
+  sim_heap_init(heap_size);
+  pebble_shim_init();
+  pebble_shim_set_outbox_handler(prv_outbox, NULL);
+  prv_init_app();
+  session_window_push(0, "Tell me something.");
+  pebble_shim_run_for(100);
+  SessionWindow *sw = window_get_user_data(window_stack_get_top_window());
+  ConversationManager *manager = conversation_manager_get_current();
+  if (!sw || !manager) {
+    fprintf(stderr, "No session window came up.\n");
+    return 1;
+  }
+
+  const bool pinned_entry_kept = prv_check_pinned_entry(manager);
+  const bool segment_without_room = prv_force_segment_without_room(manager, sw);
+
+  SessionWindowStats peak = {0};
+  int16_t lowest_offset = 0;
+  int out_of_view_checks = 0;
+  int out_of_view_failures = 0;
+  char prompt[32];
+  for (int segment = 0; segment < segments; ++segment) {
+    if (segment % (SEGMENTS_PER_TURN + 1) == 0) {
+      snprintf(prompt, sizeof(prompt), "Question %d?", segment);
+      conversation_manager_add_input(manager, prompt);
+    } else {
+      prv_send_reply_segment(segment);
+    }
+    // Let batched updates, timers and a frame happen now and then, as they would between messages.
+    if (segment % 16 == 0) {
+      pebble_shim_run_for(40);
+    }
+    const SessionWindowStats stats = session_window_get_stats(sw);
+    if (stats.segment_space > peak.segment_space) {
+      peak.segment_space = stats.segment_space;
+    }
+    if (stats.segments > peak.segments) {
+      peak.segments = stats.segments;
+    }
+    if (stats.layers > peak.layers) {
+      peak.layers = stats.layers;
+    }
+    if (stats.container_offset > peak.container_offset) {
+      peak.container_offset = stats.container_offset;
+    }
+    if (stats.container_offset < lowest_offset) {
+      lowest_offset = stats.container_offset;
+    }
+    out_of_view_checks++;
+    if (stats.layers_out_of_view > 0) {
+      out_of_view_failures++;
+      if (s_verbose) {
+        printf("After segment %d: %d of %d layers are off screen.\n", segment, stats.layers_out_of_view, stats.layers);
+      }
+    }
+  }
+  pebble_shim_run_for(1000);
+
+  const SessionWindowStats stats = session_window_get_stats(sw);
+  const int entries = conversation_length(conversation_manager_get_conversation(manager));
+  const MemoryPressureStats pressure = memory_pressure_get_stats();
+  const SimHeapStats heap = sim_heap_get_stats();
+  printf("Sent %d segments; %d still alive at the end, %d at most.\n", segments, stats.segments, peak.segments);
+  printf("Segment array:      %d slots at the end, %d at most\n", stats.segment_space, peak.segment_space);
+  printf("Segment layers:     %d at most; off screen after %d of %d segments\n", peak.layers, out_of_view_failures,
+         out_of_view_checks);
+  printf("Container offset:   %d at most, rebased %u times\n", peak.container_offset, (unsigned)stats.rebases);
+  printf("Evictions:          %u (%u sweeps)\n", (unsigned)pressure.evictions, (unsigned)pressure.sweeps);
+  printf("Peak heap use:      %zu of %zu bytes\n", heap.peak_used, heap.size);
+
+  bool ok = pinned_entry_kept && segment_without_room;
+  if (stats.segments != entries) {
+    printf("The session window has %d segments for %d entries.\n", stats.segments, entries);
+    ok = false;
+  }
+  if (peak.segment_space > MAX_SEGMENT_SPACE) {
+    printf("The segment array grew to %d slots; it should stay under %d.\n", peak.segment_space, MAX_SEGMENT_SPACE);
+    ok = false;
+  }
+  if (lowest_offset < 0 || peak.container_offset > 2 * SEGMENT_REBASE_THRESHOLD) {
+    printf("The container offset went to %d; it should be rebased once it passes %d.\n",
+           lowest_offset < 0 ? lowest_offset : peak.container_offset, SEGMENT_REBASE_THRESHOLD);
+    ok = false;
+  }
+  if (segments >= DEFAULT_SEGMENTS / 10 && stats.rebases == 0) {
+    printf("The container was never rebased.\n");
+    ok = false;
+  }
+  if (out_of_view_failures > 0) {
+    printf("Layers were kept for segments nowhere near the screen.\n");
+    ok = false;
+  }
+
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+// As assistant.c does before it decides what to show.
+static void prv_init_app(void) {
+  memory_pressure_init();
+  bmalloc_init();
+  app_message_router_init();
+  heap_report_init();
+  version_init();
+  settings_init();
+  conversation_manager_init();
+#if ENABLE_FEATURE_IMAGE_MANAGER
+  image_manager_init();
+#endif
+  events_app_message_open();
+  alarm_manager_init();
+  fonts_load();
+}
+
+// Builds prompt, thought, response, prompt, response. The session window deletes the thought once the response
+// replaces it, leaving a hole in the conversation just in front of the first response. That response is pinned, as
+// session_window.c does while it recreates a segment's layer, and the heap is asked for everything it has: the
+// prompt before the hole can go, but the response can't.
+static bool prv_check_pinned_entry(ConversationManager *manager) {
+  Conversation *conversation = conversation_manager_get_conversation(manager);
+  prv_send_string(MESSAGE_KEY_FUNCTION, "Looking that up.");
+  pebble_shim_run_for(40);
+  prv_send_string(MESSAGE_KEY_CHAT, "Here's what I found.");
+  pebble_shim_run_for(40);
+  ConversationEntry *pinned = conversation_peek(conversation);
+  prv_send_string(MESSAGE_KEY_CHAT_DONE, NULL);
+  conversation_manager_add_input(manager, "And then?");
+  prv_send_string(MESSAGE_KEY_CHAT, "Nothing else.");
+  prv_send_string(MESSAGE_KEY_CHAT_DONE, NULL);
+  pebble_shim_run_for(40);
+
+  conversation_manager_pin_entry(manager, pinned);
+  memory_pressure_try_free(sim_heap_get_stats().size);
+  conversation_manager_pin_entry(manager, NULL);
+  if (conversation_entry_get_type(pinned) != EntryTypeResponse || conversation_first_entry(conversation) != pinned) {
+    printf("The pinned response was deleted from behind a deleted thought.\n");
+    return false;
+  }
+  printf("Pinned entry:       kept behind a deleted thought\n");
+  return true;
+}
+
+// With the oldest entry pinned, eviction can't make any room, so when the segment array next needs to grow and can't,
+// the session window has nowhere to put the new entry's segment. Every segment deleted after that, which is all of
+// them by the end of the soak, has to still be the one for the entry being deleted.
+static bool prv_force_segment_without_room(ConversationManager *manager, SessionWindow *sw) {
+  Conversation *conversation = conversation_manager_get_conversation(manager);
+  conversation_manager_pin_entry(manager, conversation_first_entry(conversation));
+  sim_heap_set_allocation_limit(SEGMENT_ARRAY_LIMIT);
+  bool forced = false;
+  for (int turn = 0; turn < MAX_TURNS_TO_FILL_ARRAY && !forced; ++turn) {
+    conversation_manager_add_input(manager, "Again?");
+    prv_send_string(MESSAGE_KEY_CHAT, "Sure.");
+    prv_send_string(MESSAGE_KEY_CHAT_DONE, NULL);
+    pebble_shim_run_for(40);
+    forced = session_window_get_stats(sw).segments < conversation_length(conversation);
+  }
+  sim_heap_set_allocation_limit(0);
+  conversation_manager_pin_entry(manager, NULL);
+  if (!forced) {
+    printf("The segment array never failed to grow.\n");
+    return false;
+  }
+  printf("Segment array:      failed to grow once, leaving an entry without a segment\n");
+  return true;
+}
+
+static AppMessageResult prv_outbox(const uint8_t *data, size_t size, void *context) {
+  return APP_MSG_OK;
+}
+
+// Alternates between a short reply, a longer one and a widget, as a chatty assistant might.
+static void prv_send_reply_segment(int segment) {
+  uint8_t buffer[MESSAGE_BUFFER_SIZE];
+  DictionaryIterator iter;
+  switch (segment % 3) {
+    case 0:
+      dict_write_begin(&iter, buffer, sizeof(buffer));
+      dict_write_int32(&iter, MESSAGE_KEY_HIGHLIGHT_WIDGET, 1);
+      dict_write_cstring(&iter, MESSAGE_KEY_HIGHLIGHT_WIDGET_PRIMARY, "42");
+      dict_write_cstring(&iter, MESSAGE_KEY_HIGHLIGHT_WIDGET_SECONDARY, "nd");
+      pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+      return;
+    case 1:
+      dict_write_begin(&iter, buffer, sizeof(buffer));
+      dict_write_cstring(&iter, MESSAGE_KEY_CHAT, "Sure.");
+      pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+      break;
+    default:
+      dict_write_begin(&iter, buffer, sizeof(buffer));
+      dict_write_cstring(&iter, MESSAGE_KEY_CHAT, "That depends on who you ask, but most people would say it's "
+                                                  "somewhere between the two, and closer to the first.");
+      pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+      break;
+  }
+  dict_write_begin(&iter, buffer, sizeof(buffer));
+  dict_write_int32(&iter, MESSAGE_KEY_CHAT_DONE, 1);
+  pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+}
+
+// Sends a message with one field: a string, or the integer 1 if there's no string.
+static void prv_send_string(const uint32_t key, const char *value) {
+  uint8_t buffer[MESSAGE_BUFFER_SIZE];
+  DictionaryIterator iter;
+  dict_write_begin(&iter, buffer, sizeof(buffer));
+  if (value) {
+    dict_write_cstring(&iter, key, value);
+  } else {
+    dict_write_int32(&iter, key, 1);
+  }
+  pebble_shim_deliver_inbox(buffer, dict_write_end(&iter));
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "usage: bobby_session_soak [--segments N] [--heap BYTES] [--verbose]\n");
+}
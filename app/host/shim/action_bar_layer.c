@@ -0,0 +1,125 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+struct ActionBarLayer {
+  Layer layer;
+  void *context;
+  ClickConfigProvider click_config_provider;
+  const GBitmap *icons[NUM_BUTTONS];
+  GColor background_color;
+  Window *window;
+};
+
+static void prv_update(Layer *layer, GContext *ctx);
+static void prv_click_config_provider(void *context);
+
+ActionBarLayer *action_bar_layer_create(void) {
+  ActionBarLayer *action_bar = app_zalloc(sizeof(ActionBarLayer));
+  if (!action_bar) {
+    return NULL;
+  }
+  layer_init(&action_bar->layer, GRect(PBL_DISPLAY_WIDTH - ACTION_BAR_WIDTH, 0, ACTION_BAR_WIDTH,
+                                       PBL_DISPLAY_HEIGHT));
+  action_bar->layer.update_proc = prv_update;
+  action_bar->background_color = GColorBlack;
+  return action_bar;
+}
+
+void action_bar_layer_destroy(ActionBarLayer *action_bar_layer) {
+  if (!action_bar_layer) {
+    return;
+  }
+  action_bar_layer_remove_from_window(action_bar_layer);
+  layer_deinit(&action_bar_layer->layer);
+  app_free(action_bar_layer);
+}
+
+Layer *action_bar_layer_get_layer(ActionBarLayer *action_bar_layer) {
+  return &action_bar_layer->layer;
+}
+
+void action_bar_layer_set_context(ActionBarLayer *action_bar_layer, void *context) {
+  action_bar_layer->context = context;
+}
+
+void action_bar_layer_set_click_config_provider(ActionBarLayer *action_bar, ClickConfigProvider click_config_provider) {
+  action_bar->click_config_provider = click_config_provider;
+  if (action_bar->window) {
+    window_set_click_config_provider_with_context(action_bar->window, prv_click_config_provider, action_bar);
+  }
+}
+
+void action_bar_layer_set_icon(ActionBarLayer *action_bar, ButtonId button_id, const GBitmap *icon) {
+  if (button_id < NUM_BUTTONS) {
+    action_bar->icons[button_id] = icon;
+    layer_mark_dirty(&action_bar->layer);
+  }
+}
+
+void action_bar_layer_clear_icon(ActionBarLayer *action_bar, ButtonId button_id) {
+  action_bar_layer_set_icon(action_bar, button_id, NULL);
+}
+
+void action_bar_layer_add_to_window(ActionBarLayer *action_bar, Window *window) {
+  const GRect window_bounds = layer_get_bounds(window_get_root_layer(window));
+  layer_set_frame(&action_bar->layer, GRect(window_bounds.size.w - ACTION_BAR_WIDTH, 0, ACTION_BAR_WIDTH,
+                                            window_bounds.size.h));
+  layer_add_child(window_get_root_layer(window), &action_bar->layer);
+  action_bar->window = window;
+  window_set_click_config_provider_with_context(window, prv_click_config_provider, action_bar);
+}
+
+void action_bar_layer_remove_from_window(ActionBarLayer *action_bar) {
+  if (!action_bar->window) {
+    return;
+  }
+  layer_remove_from_parent(&action_bar->layer);
+  window_set_click_config_provider_with_context(action_bar->window, NULL, NULL);
+  action_bar->window = NULL;
+}
+
+void action_bar_layer_set_background_color(ActionBarLayer *action_bar, GColor background_color) {
+  action_bar->background_color = background_color;
+  layer_mark_dirty(&action_bar->layer);
+}
+
+static void prv_update(Layer *layer, GContext *ctx) {
+  ActionBarLayer *action_bar = (ActionBarLayer *)layer;
+  const GRect bounds = layer->bounds;
+  shim_graphics_fill_rect_color(ctx, bounds, action_bar->background_color);
+  const int16_t slot_height = bounds.size.h / 3;
+  for (ButtonId button = BUTTON_ID_UP; button <= BUTTON_ID_DOWN; ++button) {
+    const GBitmap *icon = action_bar->icons[button];
+    if (!icon) {
+      continue;
+    }
+    GRect icon_rect = (GRect) { .size = gbitmap_get_bounds(icon).size };
+    const GRect slot = GRect(0, (button - BUTTON_ID_UP) * slot_height, bounds.size.w, slot_height);
+    grect_align(&icon_rect, &slot, GAlignCenter, false);
+    graphics_context_set_compositing_mode(ctx, GCompOpSet);
+    graphics_draw_bitmap_in_rect(ctx, icon, icon_rect);
+  }
+}
+
+static void prv_click_config_provider(void *context) {
+  ActionBarLayer *action_bar = context;
+  if (action_bar->click_config_provider) {
+    shim_window_set_click_context(action_bar->context);
+    action_bar->click_config_provider(action_bar->context);
+  }
+}
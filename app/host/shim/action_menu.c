@@ -0,0 +1,292 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// ActionMenu: a window with a list of actions, and nested levels of them. It looks nothing like the firmware's, but
+// opens, navigates, performs and closes the same way.
+
+#include "shim_internal.h"
+
+#define ACTION_MENU_ROW_HEIGHT 36
+#define ACTION_MENU_MARGIN 6
+
+struct ActionMenuItem {
+  const char *label;
+  ActionMenuPerformActionCb perform_action;
+  union {
+    void *action_data;
+    ActionMenuLevel *next_level;
+  };
+  bool is_level;
+};
+
+// util/action_menu_crimes.c writes separator_index by offset, so this has to keep the firmware's layout.
+struct ActionMenuLevel {
+  uint16_t max_items;
+  uint16_t num_items;
+  uint16_t default_selected_item;
+  uint8_t display_mode;
+  uint8_t reserved[5];
+  unsigned separator_index;
+  ActionMenuLevel *parent_level;
+  ActionMenuItem items[];
+};
+_Static_assert(offsetof(ActionMenuLevel, separator_index) == 12, "ActionMenuLevel layout must match the firmware");
+
+struct ActionMenu {
+  Window *window;
+  Layer *layer;
+  ActionMenuConfig config;
+  const ActionMenuLevel *level;
+  uint16_t selected;
+  bool frozen;
+  bool closed;
+  Window *result_window;
+  const ActionMenuItem *performed_action;
+};
+
+static void prv_update(Layer *layer, GContext *ctx);
+static void prv_click_config_provider(void *context);
+static void prv_up_click(ClickRecognizerRef recognizer, void *context);
+static void prv_down_click(ClickRecognizerRef recognizer, void *context);
+static void prv_select_click(ClickRecognizerRef recognizer, void *context);
+static void prv_back_click(ClickRecognizerRef recognizer, void *context);
+static void prv_set_level(ActionMenu *action_menu, const ActionMenuLevel *level);
+static void prv_free(void *data);
+
+char *action_menu_item_get_label(const ActionMenuItem *item) {
+  return (char *)item->label;
+}
+
+void *action_menu_item_get_action_data(const ActionMenuItem *item) {
+  return item->is_level ? NULL : item->action_data;
+}
+
+ActionMenuLevel *action_menu_level_create(uint16_t max_items) {
+  ActionMenuLevel *level = app_zalloc(sizeof(ActionMenuLevel) + max_items * sizeof(ActionMenuItem));
+  if (level) {
+    level->max_items = max_items;
+  }
+  return level;
+}
+
+void action_menu_level_set_display_mode(ActionMenuLevel *level, ActionMenuLevelDisplayMode display_mode) {
+  level->display_mode = display_mode;
+}
+
+ActionMenuItem *action_menu_level_add_action(ActionMenuLevel *level, const char *label, ActionMenuPerformActionCb cb,
+                                             void *action_data) {
+  if (level->num_items >= level->max_items) {
+    return NULL;
+  }
+  ActionMenuItem *item = &level->items[level->num_items++];
+  *item = (ActionMenuItem) {
+    .label = label,
+    .perform_action = cb,
+    .action_data = action_data,
+  };
+  return item;
+}
+
+ActionMenuItem *action_menu_level_add_child(ActionMenuLevel *level, ActionMenuLevel *child, const char *label) {
+  if (level->num_items >= level->max_items) {
+    return NULL;
+  }
+  ActionMenuItem *item = &level->items[level->num_items++];
+  *item = (ActionMenuItem) {
+    .label = label,
+    .next_level = child,
+    .is_level = true,
+  };
+  child->parent_level = level;
+  return item;
+}
+
+void action_menu_hierarchy_destroy(const ActionMenuLevel *root, ActionMenuEachItemCb each_cb, void *context) {
+  if (!root) {
+    return;
+  }
+  for (uint16_t i = 0; i < root->num_items; ++i) {
+    const ActionMenuItem *item = &root->items[i];
+    if (item->is_level) {
+      action_menu_hierarchy_destroy(item->next_level, each_cb, context);
+    } else if (each_cb) {
+      each_cb(item, context);
+    }
+  }
+  app_free((void *)root);
+}
+
+void *action_menu_get_context(ActionMenu *action_menu) {
+  return action_menu->config.context;
+}
+
+ActionMenuLevel *action_menu_get_root_level(ActionMenu *action_menu) {
+  return (ActionMenuLevel *)action_menu->config.root_level;
+}
+
+ActionMenu *action_menu_open(ActionMenuConfig *config) {
+  ActionMenu *action_menu = app_zalloc(sizeof(ActionMenu));
+  if (!action_menu) {
+    return NULL;
+  }
+  action_menu->config = *config;
+  action_menu->window = window_create();
+  if (!action_menu->window) {
+    app_free(action_menu);
+    return NULL;
+  }
+  Layer *root_layer = window_get_root_layer(action_menu->window);
+  action_menu->layer = layer_create_with_data(layer_get_bounds(root_layer), sizeof(ActionMenu *));
+  *(ActionMenu **)layer_get_data(action_menu->layer) = action_menu;
+  layer_set_update_proc(action_menu->layer, prv_update);
+  layer_add_child(root_layer, action_menu->layer);
+  window_set_background_color(action_menu->window, config->colors.background);
+  window_set_click_config_provider_with_context(action_menu->window, prv_click_config_provider, action_menu);
+  prv_set_level(action_menu, config->root_level);
+  window_stack_push(action_menu->window, true);
+  return action_menu;
+}
+
+void action_menu_freeze(ActionMenu *action_menu) {
+  action_menu->frozen = true;
+}
+
+void action_menu_unfreeze(ActionMenu *action_menu) {
+  action_menu->frozen = false;
+}
+
+void action_menu_set_result_window(ActionMenu *action_menu, Window *result_window) {
+  action_menu->result_window = result_window;
+}
+
+void action_menu_close(ActionMenu *action_menu, bool animated) {
+  if (action_menu->closed) {
+    return;
+  }
+  action_menu->closed = true;
+  if (action_menu->config.will_close) {
+    action_menu->config.will_close(action_menu, action_menu->performed_action, action_menu->config.context);
+  }
+  window_stack_remove(action_menu->window, animated);
+  if (action_menu->config.did_close) {
+    action_menu->config.did_close(action_menu, action_menu->performed_action, action_menu->config.context);
+  }
+  if (action_menu->result_window) {
+    window_stack_push(action_menu->result_window, animated);
+  }
+  // The menu may be closing from inside one of its own click handlers, so it goes once they've returned.
+  app_timer_register(0, prv_free, action_menu);
+}
+
+static void prv_update(Layer *layer, GContext *ctx) {
+  ActionMenu *action_menu = *(ActionMenu **)layer_get_data(layer);
+  const ActionMenuLevel *level = action_menu->level;
+  if (!level) {
+    return;
+  }
+  const GRect bounds = layer_get_bounds(layer);
+  const GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD);
+  const int16_t visible_rows = MAX(1, bounds.size.h / ACTION_MENU_ROW_HEIGHT);
+  const int16_t first_row = MAX(0, action_menu->selected - visible_rows + 1);
+  int16_t y = action_menu->config.align == ActionMenuAlignCenter
+                  ? MAX(0, (bounds.size.h - level->num_items * ACTION_MENU_ROW_HEIGHT) / 2)
+                  : 0;
+  for (uint16_t i = first_row; i < level->num_items && y < bounds.size.h; ++i) {
+    const GRect row = GRect(0, y, bounds.size.w, ACTION_MENU_ROW_HEIGHT);
+    const bool selected = i == action_menu->selected;
+    if (selected) {
+      shim_graphics_fill_rect_color(ctx, row, action_menu->config.colors.foreground);
+    }
+    graphics_context_set_text_color(ctx, selected ? action_menu->config.colors.background
+                                                  : action_menu->config.colors.foreground);
+    graphics_draw_text(ctx, level->items[i].label, font,
+                       GRect(ACTION_MENU_MARGIN, y + 2, bounds.size.w - 2 * ACTION_MENU_MARGIN,
+                             ACTION_MENU_ROW_HEIGHT - 2),
+                       GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft, NULL);
+    if (i + 1u == level->separator_index) {
+      shim_graphics_fill_rect_color(ctx, GRect(0, y + ACTION_MENU_ROW_HEIGHT - 1, bounds.size.w, 1),
+                                    action_menu->config.colors.foreground);
+    }
+    y += ACTION_MENU_ROW_HEIGHT;
+  }
+}
+
+static void prv_click_config_provider(void *context) {
+  window_single_repeating_click_subscribe(BUTTON_ID_UP, 100, prv_up_click);
+  window_single_repeating_click_subscribe(BUTTON_ID_DOWN, 100, prv_down_click);
+  window_single_click_subscribe(BUTTON_ID_SELECT, prv_select_click);
+  window_single_click_subscribe(BUTTON_ID_BACK, prv_back_click);
+}
+
+static void prv_up_click(ClickRecognizerRef recognizer, void *context) {
+  ActionMenu *action_menu = context;
+  if (action_menu->frozen || action_menu->selected == 0) {
+    return;
+  }
+  --action_menu->selected;
+  layer_mark_dirty(action_menu->layer);
+}
+
+static void prv_down_click(ClickRecognizerRef recognizer, void *context) {
+  ActionMenu *action_menu = context;
+  if (action_menu->frozen || !action_menu->level || action_menu->selected + 1 >= action_menu->level->num_items) {
+    return;
+  }
+  ++action_menu->selected;
+  layer_mark_dirty(action_menu->layer);
+}
+
+static void prv_select_click(ClickRecognizerRef recognizer, void *context) {
+  ActionMenu *action_menu = context;
+  if (action_menu->frozen || !action_menu->level || action_menu->level->num_items == 0) {
+    return;
+  }
+  const ActionMenuItem *item = &action_menu->level->items[action_menu->selected];
+  if (item->is_level) {
+    prv_set_level(action_menu, item->next_level);
+    return;
+  }
+  action_menu->performed_action = item;
+  if (item->perform_action) {
+    item->perform_action(action_menu, item, action_menu->config.context);
+  }
+  // A frozen menu stays open until the app closes it.
+  if (!action_menu->frozen) {
+    action_menu_close(action_menu, true);
+  }
+}
+
+static void prv_back_click(ClickRecognizerRef recognizer, void *context) {
+  ActionMenu *action_menu = context;
+  if (action_menu->level && action_menu->level->parent_level) {
+    prv_set_level(action_menu, action_menu->level->parent_level);
+  } else {
+    action_menu_close(action_menu, true);
+  }
+}
+
+static void prv_set_level(ActionMenu *action_menu, const ActionMenuLevel *level) {
+  action_menu->level = level;
+  action_menu->selected = level ? level->default_selected_item : 0;
+  layer_mark_dirty(action_menu->layer);
+}
+
+static void prv_free(void *data) {
+  ActionMenu *action_menu = data;
+  layer_destroy(action_menu->layer);
+  window_destroy(action_menu->window);
+  app_free(action_menu);
+}
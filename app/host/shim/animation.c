@@ -0,0 +1,255 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Animations, stepped by a timer at about the firmware's frame rate.
+//
+// The firmware hands out animation handles rather than pointers, so an app can safely destroy an animation that
+// has already finished and been cleaned up. The shim keeps a list of live animations to give the same guarantee.
+
+#include "shim_internal.h"
+
+#define ANIMATION_FRAME_INTERVAL_MS 33
+#define ANIMATION_DEFAULT_DURATION_MS 250
+
+struct Animation {
+  uint32_t delay_ms;
+  uint32_t duration_ms;
+  uint32_t play_count;
+  AnimationCurve curve;
+  AnimationHandlers handlers;
+  void *context;
+  const AnimationImplementation *implementation;
+  bool scheduled;
+  int64_t start_ms;
+  uint32_t plays_done;
+  AppTimer *timer;
+};
+
+typedef struct LiveAnimation {
+  Animation *animation;
+  struct LiveAnimation *next;
+} LiveAnimation;
+
+static LiveAnimation *s_live;
+
+static bool prv_is_live(Animation *animation);
+static void prv_stop(Animation *animation, bool finished);
+static void prv_step(void *data);
+static AnimationProgress prv_apply_curve(AnimationCurve curve, AnimationProgress progress);
+
+Animation *animation_create(void) {
+  Animation *animation = app_malloc(sizeof(Animation));
+  if (!animation) {
+    return NULL;
+  }
+  *animation = (Animation) {
+    .duration_ms = ANIMATION_DEFAULT_DURATION_MS,
+    .play_count = 1,
+    .curve = AnimationCurveDefault,
+  };
+  LiveAnimation *live = malloc(sizeof(LiveAnimation));
+  *live = (LiveAnimation) { .animation = animation, .next = s_live };
+  s_live = live;
+  return animation;
+}
+
+bool animation_destroy(Animation *animation) {
+  if (!prv_is_live(animation)) {
+    return false;
+  }
+  if (animation->scheduled) {
+    prv_stop(animation, false);
+    // Stopping an animation destroys it.
+    return true;
+  }
+  for (LiveAnimation **link = &s_live; *link; link = &(*link)->next) {
+    if ((*link)->animation == animation) {
+      LiveAnimation *live = *link;
+      *link = live->next;
+      free(live);
+      break;
+    }
+  }
+  app_free(animation);
+  return true;
+}
+
+bool animation_set_delay(Animation *animation, uint32_t delay_ms) {
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return false;
+  }
+  animation->delay_ms = delay_ms;
+  return true;
+}
+
+bool animation_set_duration(Animation *animation, uint32_t duration_ms) {
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return false;
+  }
+  animation->duration_ms = duration_ms;
+  return true;
+}
+
+bool animation_set_curve(Animation *animation, AnimationCurve curve) {
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return false;
+  }
+  animation->curve = curve;
+  return true;
+}
+
+bool animation_set_play_count(Animation *animation, uint32_t play_count) {
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return false;
+  }
+  animation->play_count = play_count;
+  return true;
+}
+
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context) {
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return false;
+  }
+  animation->handlers = callbacks;
+  animation->context = context;
+  return true;
+}
+
+void *animation_get_context(Animation *animation) {
+  return prv_is_live(animation) ? animation->context : NULL;
+}
+
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return false;
+  }
+  animation->implementation = implementation;
+  return true;
+}
+
+bool animation_schedule(Animation *animation) {
+  if (!prv_is_live(animation)) {
+    return false;
+  }
+  if (animation->scheduled) {
+    animation_unschedule(animation);
+    return false;
+  }
+  animation->scheduled = true;
+  animation->plays_done = 0;
+  animation->start_ms = pebble_shim_now_ms() + animation->delay_ms;
+  if (animation->implementation && animation->implementation->setup) {
+    animation->implementation->setup(animation);
+  }
+  if (animation->handlers.started) {
+    animation->handlers.started(animation, animation->context);
+  }
+  animation->timer = app_timer_register(animation->delay_ms, prv_step, animation);
+  return true;
+}
+
+bool animation_unschedule(Animation *animation) {
+  if (!prv_is_live(animation) || !animation->scheduled) {
+    return false;
+  }
+  prv_stop(animation, false);
+  return true;
+}
+
+bool animation_is_scheduled(Animation *animation) {
+  return prv_is_live(animation) && animation->scheduled;
+}
+
+static bool prv_is_live(Animation *animation) {
+  for (LiveAnimation *live = s_live; live; live = live->next) {
+    if (live->animation == animation) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void prv_stop(Animation *animation, bool finished) {
+  app_timer_cancel(animation->timer);
+  animation->timer = NULL;
+  animation->scheduled = false;
+  if (animation->handlers.stopped) {
+    animation->handlers.stopped(animation, finished, animation->context);
+  }
+  // The handler may have rescheduled it.
+  if (!prv_is_live(animation) || animation->scheduled) {
+    return;
+  }
+  if (animation->implementation && animation->implementation->teardown) {
+    animation->implementation->teardown(animation);
+  }
+  animation_destroy(animation);
+}
+
+static void prv_step(void *data) {
+  Animation *animation = data;
+  animation->timer = NULL;
+  const int64_t elapsed_ms = pebble_shim_now_ms() - animation->start_ms;
+  bool finished = false;
+  AnimationProgress progress = ANIMATION_NORMALIZED_MAX;
+  if (animation->duration_ms != ANIMATION_DURATION_INFINITE && animation->duration_ms > 0) {
+    const uint32_t plays = elapsed_ms / animation->duration_ms;
+    if (animation->play_count != ANIMATION_PLAY_COUNT_INFINITE && plays >= animation->play_count) {
+      finished = true;
+    } else {
+      progress = (elapsed_ms % animation->duration_ms) * ANIMATION_NORMALIZED_MAX / animation->duration_ms;
+    }
+  } else if (animation->duration_ms == ANIMATION_DURATION_INFINITE) {
+    progress = ANIMATION_NORMALIZED_MIN;
+  } else {
+    finished = true;
+  }
+  if (animation->implementation && animation->implementation->update) {
+    animation->implementation->update(animation, prv_apply_curve(animation->curve, progress));
+  }
+  // The update may have unscheduled or destroyed the animation.
+  if (!prv_is_live(animation) || !animation->scheduled) {
+    return;
+  }
+  if (finished) {
+    prv_stop(animation, true);
+  } else {
+    animation->timer = app_timer_register(ANIMATION_FRAME_INTERVAL_MS, prv_step, animation);
+  }
+}
+
+static AnimationProgress prv_apply_curve(AnimationCurve curve, AnimationProgress progress) {
+  const int64_t t = progress;
+  const int64_t max = ANIMATION_NORMALIZED_MAX;
+  switch (curve) {
+    case AnimationCurveEaseIn:
+      return t * t * t / (max * max);
+    case AnimationCurveEaseOut: {
+      const int64_t r = max - t;
+      return max - r * r * r / (max * max);
+    }
+    case AnimationCurveEaseInOut:
+      if (t < max / 2) {
+        return 4 * t * t * t / (max * max);
+      } else {
+        const int64_t r = max - t;
+        return max - 4 * r * r * r / (max * max);
+      }
+    case AnimationCurveLinear:
+    default:
+      return progress;
+  }
+}
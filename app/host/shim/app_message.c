@@ -0,0 +1,198 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// AppMessage with a phone that's always there. Sends go to the host's outbox handler and are acknowledged a little
+// later; pebble_shim_deliver_inbox() plays the phone's side.
+
+#include "shim_internal.h"
+
+// Roughly how long the phone takes to ack a message.
+#define OUTBOX_ACK_DELAY_MS 40
+#define INBOX_SIZE_MAXIMUM 8200
+#define OUTBOX_SIZE_MAXIMUM 8200
+
+static bool s_open;
+static uint8_t *s_inbox;
+static uint32_t s_inbox_size;
+static uint8_t *s_outbox;
+static uint32_t s_outbox_size;
+static DictionaryIterator s_outbox_iterator;
+static bool s_outbox_busy;
+static AppMessageResult s_outbox_result;
+static void *s_context;
+static AppMessageInboxReceived s_inbox_received;
+static AppMessageInboxDropped s_inbox_dropped;
+static AppMessageOutboxSent s_outbox_sent;
+static AppMessageOutboxFailed s_outbox_failed;
+static PebbleShimOutboxHandler s_outbox_handler;
+static void *s_outbox_handler_context;
+
+static void prv_outbox_acked(void *data);
+
+void shim_app_message_reset(void) {
+  s_open = false;
+  s_inbox = NULL;
+  s_outbox = NULL;
+  s_inbox_size = 0;
+  s_outbox_size = 0;
+  s_outbox_busy = false;
+  s_context = NULL;
+  app_message_deregister_callbacks();
+  s_outbox_handler = NULL;
+  s_outbox_handler_context = NULL;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  if (s_open) {
+    return APP_MSG_INVALID_STATE;
+  }
+  // The firmware takes both buffers from the app's heap.
+  s_inbox = app_malloc(size_inbound);
+  s_outbox = app_malloc(size_outbound);
+  if (!s_inbox || !s_outbox) {
+    app_free(s_inbox);
+    app_free(s_outbox);
+    s_inbox = NULL;
+    s_outbox = NULL;
+    return APP_MSG_OUT_OF_MEMORY;
+  }
+  s_inbox_size = size_inbound;
+  s_outbox_size = size_outbound;
+  s_open = true;
+  return APP_MSG_OK;
+}
+
+void app_message_deregister_callbacks(void) {
+  s_inbox_received = NULL;
+  s_inbox_dropped = NULL;
+  s_outbox_sent = NULL;
+  s_outbox_failed = NULL;
+}
+
+void *app_message_get_context(void) {
+  return s_context;
+}
+
+void *app_message_set_context(void *context) {
+  void *previous = s_context;
+  s_context = context;
+  return previous;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+  AppMessageInboxReceived previous = s_inbox_received;
+  s_inbox_received = received_callback;
+  return previous;
+}
+
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback) {
+  AppMessageInboxDropped previous = s_inbox_dropped;
+  s_inbox_dropped = dropped_callback;
+  return previous;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+  AppMessageOutboxSent previous = s_outbox_sent;
+  s_outbox_sent = sent_callback;
+  return previous;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+  AppMessageOutboxFailed previous = s_outbox_failed;
+  s_outbox_failed = failed_callback;
+  return previous;
+}
+
+uint32_t app_message_inbox_size_maximum(void) {
+  return INBOX_SIZE_MAXIMUM;
+}
+
+uint32_t app_message_outbox_size_maximum(void) {
+  return OUTBOX_SIZE_MAXIMUM;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  if (!s_open) {
+    return APP_MSG_INVALID_STATE;
+  }
+  if (s_outbox_busy) {
+    return APP_MSG_BUSY;
+  }
+  dict_write_begin(&s_outbox_iterator, s_outbox, s_outbox_size);
+  *iterator = &s_outbox_iterator;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  if (!s_open || s_outbox_busy) {
+    return s_open ? APP_MSG_BUSY : APP_MSG_INVALID_STATE;
+  }
+  const uint32_t size = dict_write_end(&s_outbox_iterator);
+  s_outbox_result = APP_MSG_OK;
+  if (s_outbox_handler) {
+    s_outbox_result = s_outbox_handler(s_outbox, size, s_outbox_handler_context);
+  }
+  s_outbox_busy = true;
+  app_timer_register(OUTBOX_ACK_DELAY_MS, prv_outbox_acked, NULL);
+  return APP_MSG_OK;
+}
+
+void pebble_shim_set_outbox_handler(PebbleShimOutboxHandler handler, void *context) {
+  s_outbox_handler = handler;
+  s_outbox_handler_context = context;
+}
+
+AppMessageResult pebble_shim_deliver_inbox(const uint8_t *data, size_t size) {
+  if (!s_open) {
+    return APP_MSG_CLOSED;
+  }
+  if (size > s_inbox_size) {
+    if (s_inbox_dropped) {
+      s_inbox_dropped(APP_MSG_BUFFER_OVERFLOW, s_context);
+    }
+    return APP_MSG_BUFFER_OVERFLOW;
+  }
+  memcpy(s_inbox, data, size);
+  DictionaryIterator iterator;
+  shim_dict_read_begin(&iterator, s_inbox, size);
+  if (s_inbox_received) {
+    s_inbox_received(&iterator, s_context);
+  }
+  return APP_MSG_OK;
+}
+
+bool pebble_shim_message_key(const char *name, uint32_t *key) {
+  for (uint32_t i = 0; i < g_shim_message_key_count; ++i) {
+    if (strcmp(g_shim_message_key_names[i], name) == 0) {
+      *key = *g_shim_message_key_values[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+static void prv_outbox_acked(void *data) {
+  s_outbox_busy = false;
+  DictionaryIterator iterator;
+  shim_dict_read_begin(&iterator, s_outbox, dict_size(&s_outbox_iterator));
+  if (s_outbox_result == APP_MSG_OK) {
+    if (s_outbox_sent) {
+      s_outbox_sent(&iterator, s_context);
+    }
+  } else if (s_outbox_failed) {
+    s_outbox_failed(&iterator, s_outbox_result, s_context);
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+struct BitmapLayer {
+  Layer layer;
+  const GBitmap *bitmap;
+  GAlign alignment;
+  GColor background_color;
+  GCompOp compositing_mode;
+};
+
+static void prv_update(Layer *layer, GContext *ctx);
+
+BitmapLayer *bitmap_layer_create(GRect frame) {
+  BitmapLayer *bitmap_layer = app_zalloc(sizeof(BitmapLayer));
+  if (!bitmap_layer) {
+    return NULL;
+  }
+  layer_init(&bitmap_layer->layer, frame);
+  bitmap_layer->layer.update_proc = prv_update;
+  bitmap_layer->alignment = GAlignCenter;
+  bitmap_layer->background_color = GColorClear;
+  bitmap_layer->compositing_mode = GCompOpAssign;
+  return bitmap_layer;
+}
+
+void bitmap_layer_destroy(BitmapLayer *bitmap_layer) {
+  if (!bitmap_layer) {
+    return;
+  }
+  layer_deinit(&bitmap_layer->layer);
+  app_free(bitmap_layer);
+}
+
+Layer *bitmap_layer_get_layer(const BitmapLayer *bitmap_layer) {
+  return (Layer *)&bitmap_layer->layer;
+}
+
+const GBitmap *bitmap_layer_get_bitmap(BitmapLayer *bitmap_layer) {
+  return bitmap_layer->bitmap;
+}
+
+void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, const GBitmap *bitmap) {
+  bitmap_layer->bitmap = bitmap;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+void bitmap_layer_set_alignment(BitmapLayer *bitmap_layer, GAlign alignment) {
+  bitmap_layer->alignment = alignment;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+void bitmap_layer_set_background_color(BitmapLayer *bitmap_layer, GColor color) {
+  bitmap_layer->background_color = color;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode) {
+  bitmap_layer->compositing_mode = mode;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+static void prv_update(Layer *layer, GContext *ctx) {
+  BitmapLayer *bitmap_layer = (BitmapLayer *)layer;
+  if (bitmap_layer->background_color.a) {
+    shim_graphics_fill_rect_color(ctx, layer->bounds, bitmap_layer->background_color);
+  }
+  if (!bitmap_layer->bitmap) {
+    return;
+  }
+  GRect rect = (GRect) { .size = gbitmap_get_bounds(bitmap_layer->bitmap).size };
+  grect_align(&rect, &layer->bounds, bitmap_layer->alignment, false);
+  graphics_context_set_compositing_mode(ctx, bitmap_layer->compositing_mode);
+  graphics_draw_bitmap_in_rect(ctx, bitmap_layer->bitmap, rect);
+}
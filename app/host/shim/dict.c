@@ -0,0 +1,186 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Dictionaries in the same wire format the watch uses: a count byte, then packed tuples.
+
+#include "shim_internal.h"
+
+#include <stdarg.h>
+
+struct __attribute__((__packed__)) Dictionary {
+  uint8_t count;
+  uint8_t head[];
+};
+
+// Tuples the app has read, for pebble_shim_dict_tuple_visits().
+static uint32_t s_tuple_visits;
+
+static DictionaryResult prv_write(DictionaryIterator *iter, uint32_t key, TupleType type, const void *data,
+                                  uint16_t length);
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+  uint32_t size = sizeof(Dictionary) + tuple_count * sizeof(Tuple);
+  va_list args;
+  va_start(args, tuple_count);
+  for (int i = 0; i < tuple_count; ++i) {
+    size += va_arg(args, uint32_t);
+  }
+  va_end(args);
+  return size;
+}
+
+uint32_t dict_size(DictionaryIterator *iter) {
+  return (const uint8_t *)iter->end - (const uint8_t *)iter->dictionary;
+}
+
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t *const buffer, const uint16_t size) {
+  if (!iter || !buffer || size < sizeof(Dictionary)) {
+    return DICT_INVALID_ARGS;
+  }
+  iter->dictionary = (Dictionary *)buffer;
+  iter->dictionary->count = 0;
+  iter->cursor = (Tuple *)iter->dictionary->head;
+  iter->end = buffer + size;
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *const data,
+                                 const uint16_t size) {
+  return prv_write(iter, key, TUPLE_BYTE_ARRAY, data, size);
+}
+
+DictionaryResult dict_write_cstring(DictionaryIterator *iter, const uint32_t key, const char *const cstring) {
+  const uint16_t length = cstring ? strlen(cstring) + 1 : 0;
+  return prv_write(iter, key, TUPLE_CSTRING, cstring, length);
+}
+
+DictionaryResult dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer,
+                                const uint8_t width_bytes, const bool is_signed) {
+  if (width_bytes != 1 && width_bytes != 2 && width_bytes != 4) {
+    return DICT_INVALID_ARGS;
+  }
+  return prv_write(iter, key, is_signed ? TUPLE_INT : TUPLE_UINT, integer, width_bytes);
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, const uint32_t key, const uint8_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), false);
+}
+
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), false);
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), false);
+}
+
+DictionaryResult dict_write_int8(DictionaryIterator *iter, const uint32_t key, const int8_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+DictionaryResult dict_write_int16(DictionaryIterator *iter, const uint32_t key, const int16_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+uint32_t dict_write_end(DictionaryIterator *iter) {
+  if (!iter || !iter->dictionary) {
+    return 0;
+  }
+  iter->end = iter->cursor;
+  iter->cursor = (Tuple *)iter->dictionary->head;
+  return dict_size(iter);
+}
+
+Tuple *dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t *const buffer, const uint16_t size) {
+  if (!iter || !buffer || size < sizeof(Dictionary)) {
+    return NULL;
+  }
+  iter->dictionary = (Dictionary *)buffer;
+  iter->end = buffer + size;
+  return dict_read_first(iter);
+}
+
+void shim_dict_read_begin(DictionaryIterator *iter, const uint8_t *buffer, uint16_t size) {
+  iter->dictionary = (Dictionary *)buffer;
+  iter->cursor = (Tuple *)iter->dictionary->head;
+  iter->end = buffer + size;
+}
+
+void shim_dict_reset(void) {
+  s_tuple_visits = 0;
+}
+
+uint32_t pebble_shim_dict_tuple_visits(void) {
+  return s_tuple_visits;
+}
+
+Tuple *dict_read_first(DictionaryIterator *iter) {
+  iter->cursor = (Tuple *)iter->dictionary->head;
+  if (iter->dictionary->count == 0 || (const uint8_t *)iter->cursor + sizeof(Tuple) > (const uint8_t *)iter->end) {
+    return NULL;
+  }
+  ++s_tuple_visits;
+  return iter->cursor;
+}
+
+Tuple *dict_read_next(DictionaryIterator *iter) {
+  if ((const uint8_t *)iter->cursor >= (const uint8_t *)iter->end) {
+    return NULL;
+  }
+  Tuple *next = (Tuple *)((uint8_t *)iter->cursor + sizeof(Tuple) + iter->cursor->length);
+  iter->cursor = next;
+  if ((const uint8_t *)next + sizeof(Tuple) > (const uint8_t *)iter->end ||
+      (const uint8_t *)next + sizeof(Tuple) + next->length > (const uint8_t *)iter->end) {
+    return NULL;
+  }
+  ++s_tuple_visits;
+  return next;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  DictionaryIterator copy = *iter;
+  for (Tuple *tuple = dict_read_first(&copy); tuple; tuple = dict_read_next(&copy)) {
+    if (tuple->key == key) {
+      return tuple;
+    }
+  }
+  return NULL;
+}
+
+static DictionaryResult prv_write(DictionaryIterator *iter, uint32_t key, TupleType type, const void *data,
+                                  uint16_t length) {
+  if (!iter || !iter->dictionary || (length && !data)) {
+    return DICT_INVALID_ARGS;
+  }
+  uint8_t *start = (uint8_t *)iter->cursor;
+  if (start + sizeof(Tuple) + length > (const uint8_t *)iter->end) {
+    return DICT_NOT_ENOUGH_STORAGE;
+  }
+  Tuple *tuple = iter->cursor;
+  tuple->key = key;
+  tuple->type = type;
+  tuple->length = length;
+  if (length) {
+    memcpy(tuple->value->data, data, length);
+  }
+  iter->cursor = (Tuple *)(start + sizeof(Tuple) + length);
+  iter->dictionary->count++;
+  return DICT_OK;
+}
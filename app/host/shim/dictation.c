@@ -0,0 +1,96 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Dictation without a microphone: every session hears whatever pebble_shim_set_dictation_result() last said.
+
+#include "shim_internal.h"
+
+#define DEFAULT_DICTATION_DELAY_MS 1500
+#define DEFAULT_TRANSCRIPTION "What's the weather like today?"
+#define MAX_TRANSCRIPTION_LENGTH 512
+
+struct DictationSession {
+  DictationSessionStatusCallback callback;
+  void *context;
+  AppTimer *timer;
+  char transcription[MAX_TRANSCRIPTION_LENGTH];
+};
+
+static DictationSessionStatus s_status;
+static char s_transcription[MAX_TRANSCRIPTION_LENGTH];
+static uint32_t s_delay_ms;
+
+static void prv_finish(void *data);
+
+void shim_dictation_reset(void) {
+  pebble_shim_set_dictation_result(DictationSessionStatusSuccess, DEFAULT_TRANSCRIPTION, DEFAULT_DICTATION_DELAY_MS);
+}
+
+void pebble_shim_set_dictation_result(DictationSessionStatus status, const char *transcription, uint32_t delay_ms) {
+  s_status = status;
+  snprintf(s_transcription, sizeof(s_transcription), "%s", transcription ? transcription : "");
+  s_delay_ms = delay_ms;
+}
+
+DictationSession *dictation_session_create(uint32_t buffer_size, DictationSessionStatusCallback callback,
+                                           void *callback_context) {
+  DictationSession *session = app_zalloc(sizeof(DictationSession));
+  if (session) {
+    session->callback = callback;
+    session->context = callback_context;
+  }
+  return session;
+}
+
+void dictation_session_destroy(DictationSession *session) {
+  if (!session) {
+    return;
+  }
+  app_timer_cancel(session->timer);
+  app_free(session);
+}
+
+void dictation_session_enable_confirmation(DictationSession *session, bool is_enabled) {
+}
+
+void dictation_session_enable_error_dialogs(DictationSession *session, bool is_enabled) {
+}
+
+DictationSessionStatus dictation_session_start(DictationSession *session) {
+  if (session->timer) {
+    return DictationSessionStatusFailureSystemAborted;
+  }
+  session->timer = app_timer_register(s_delay_ms, prv_finish, session);
+  return DictationSessionStatusSuccess;
+}
+
+DictationSessionStatus dictation_session_stop(DictationSession *session) {
+  if (!session->timer) {
+    return DictationSessionStatusFailureSystemAborted;
+  }
+  app_timer_cancel(session->timer);
+  session->timer = NULL;
+  return DictationSessionStatusSuccess;
+}
+
+static void prv_finish(void *data) {
+  DictationSession *session = data;
+  session->timer = NULL;
+  // The transcription belongs to the session, and is only valid until the callback returns.
+  snprintf(session->transcription, sizeof(session->transcription), "%s", s_transcription);
+  session->callback(session, s_status, s_status == DictationSessionStatusSuccess ? session->transcription : NULL,
+                    session->context);
+}
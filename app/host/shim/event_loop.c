@@ -0,0 +1,266 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Simulated time. Nothing here looks at the host's clock: events run in order of their due time, and the clock
+// jumps straight to the next one, so a minute of app time takes as long as the app's own code does.
+
+#include "shim_internal.h"
+
+// 2025-06-02 09:00:00 UTC, a Monday morning.
+#define SHIM_EPOCH_SECONDS 1748854800
+
+struct AppTimer {
+  int64_t due_ms;
+  // Timers due at the same moment fire in the order they were registered.
+  uint64_t sequence;
+  AppTimerCallback callback;
+  void *data;
+  AppTimer *next;
+};
+
+static int64_t s_now_ms;
+static uint64_t s_next_sequence;
+static AppTimer *s_timers;
+static bool s_exit_requested;
+static bool s_render_requested;
+static uint32_t s_event_loop_duration_ms;
+
+static TimeUnits s_tick_units;
+static TickHandler s_tick_handler;
+static AppTimer *s_tick_timer;
+static struct tm s_last_tick;
+
+static void prv_insert_timer(AppTimer *timer);
+static bool prv_unlink_timer(AppTimer *timer);
+static bool prv_run_until(int64_t deadline_ms, bool stop_when_idle);
+static void prv_schedule_tick(void);
+static void prv_tick(void *data);
+
+void shim_events_reset(void) {
+  while (s_timers) {
+    AppTimer *next = s_timers->next;
+    free(s_timers);
+    s_timers = next;
+  }
+  s_now_ms = (int64_t)SHIM_EPOCH_SECONDS * 1000;
+  s_next_sequence = 0;
+  s_exit_requested = false;
+  s_render_requested = false;
+  s_event_loop_duration_ms = 0;
+  s_tick_units = 0;
+  s_tick_handler = NULL;
+  s_tick_timer = NULL;
+}
+
+int64_t pebble_shim_now_ms(void) {
+  return s_now_ms;
+}
+
+void pebble_shim_set_time(time_t now) {
+  s_now_ms = (int64_t)now * 1000;
+}
+
+time_t shim_time(time_t *tloc) {
+  time_t now = s_now_ms / 1000;
+  if (tloc) {
+    *tloc = now;
+  }
+  return now;
+}
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms) {
+  uint16_t ms = s_now_ms % 1000;
+  if (t_utc) {
+    *t_utc = s_now_ms / 1000;
+  }
+  if (out_ms) {
+    *out_ms = ms;
+  }
+  return ms;
+}
+
+time_t time_start_of_today(void) {
+  time_t now = s_now_ms / 1000;
+  struct tm *local = localtime(&now);
+  local->tm_hour = 0;
+  local->tm_min = 0;
+  local->tm_sec = 0;
+  return mktime(local);
+}
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  AppTimer *timer = malloc(sizeof(AppTimer));
+  *timer = (AppTimer) {
+    .due_ms = s_now_ms + timeout_ms,
+    .sequence = s_next_sequence++,
+    .callback = callback,
+    .data = callback_data,
+  };
+  prv_insert_timer(timer);
+  return timer;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+  if (!timer_handle || !prv_unlink_timer(timer_handle)) {
+    return false;
+  }
+  timer_handle->due_ms = s_now_ms + new_timeout_ms;
+  timer_handle->sequence = s_next_sequence++;
+  prv_insert_timer(timer_handle);
+  return true;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+  if (timer_handle && prv_unlink_timer(timer_handle)) {
+    free(timer_handle);
+  }
+}
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  s_tick_units = tick_units;
+  s_tick_handler = handler;
+  time_t now = s_now_ms / 1000;
+  s_last_tick = *localtime(&now);
+  prv_schedule_tick();
+}
+
+void tick_timer_service_unsubscribe(void) {
+  app_timer_cancel(s_tick_timer);
+  s_tick_timer = NULL;
+  s_tick_handler = NULL;
+  s_tick_units = 0;
+}
+
+void shim_request_render(void) {
+  s_render_requested = true;
+}
+
+void app_event_loop(void) {
+  // The first frame goes out before anything else happens, as it does when an app starts.
+  s_render_requested = true;
+  if (s_event_loop_duration_ms == 0) {
+    prv_run_until(INT64_MAX, true);
+  } else {
+    prv_run_until(s_now_ms + s_event_loop_duration_ms, false);
+  }
+  s_exit_requested = false;
+}
+
+bool pebble_shim_run_for(uint32_t duration_ms) {
+  bool running = prv_run_until(s_now_ms + duration_ms, false);
+  s_exit_requested = false;
+  return running;
+}
+
+void pebble_shim_set_event_loop_duration(uint32_t duration_ms) {
+  s_event_loop_duration_ms = duration_ms;
+}
+
+void pebble_shim_exit(void) {
+  s_exit_requested = true;
+}
+
+static void prv_insert_timer(AppTimer *timer) {
+  AppTimer **link = &s_timers;
+  while (*link && ((*link)->due_ms < timer->due_ms ||
+                   ((*link)->due_ms == timer->due_ms && (*link)->sequence < timer->sequence))) {
+    link = &(*link)->next;
+  }
+  timer->next = *link;
+  *link = timer;
+}
+
+static bool prv_unlink_timer(AppTimer *timer) {
+  for (AppTimer **link = &s_timers; *link; link = &(*link)->next) {
+    if (*link == timer) {
+      *link = timer->next;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns false once the app has no windows left, which is when the firmware would close it.
+static bool prv_run_until(int64_t deadline_ms, bool stop_when_idle) {
+  while (!s_exit_requested) {
+    if (s_render_requested) {
+      pebble_shim_render();
+    }
+    if (shim_window_stack_is_empty()) {
+      return false;
+    }
+    // Ticks alone don't keep an app busy; they'd run forever.
+    AppTimer *timer = s_timers;
+    if (!timer || (stop_when_idle && timer == s_tick_timer && !timer->next)) {
+      break;
+    }
+    if (timer->due_ms > deadline_ms) {
+      break;
+    }
+    if (timer->due_ms > s_now_ms) {
+      s_now_ms = timer->due_ms;
+    }
+    s_timers = timer->next;
+    AppTimerCallback callback = timer->callback;
+    void *data = timer->data;
+    free(timer);
+    callback(data);
+  }
+  if (!stop_when_idle && deadline_ms > s_now_ms) {
+    s_now_ms = deadline_ms;
+  }
+  if (s_render_requested) {
+    pebble_shim_render();
+  }
+  return !shim_window_stack_is_empty();
+}
+
+static void prv_schedule_tick(void) {
+  // Ticks land on the boundary of the smallest unit asked for; anything coarser can only change then too.
+  int64_t period_ms = (s_tick_units & SECOND_UNIT) ? 1000 : 60000;
+  int64_t due_ms = (s_now_ms / period_ms + 1) * period_ms;
+  s_tick_timer = app_timer_register(due_ms - s_now_ms, prv_tick, NULL);
+}
+
+static void prv_tick(void *data) {
+  s_tick_timer = NULL;
+  time_t now = s_now_ms / 1000;
+  struct tm tick_time = *localtime(&now);
+  TimeUnits changed = 0;
+  if (tick_time.tm_sec != s_last_tick.tm_sec) {
+    changed |= SECOND_UNIT;
+  }
+  if (tick_time.tm_min != s_last_tick.tm_min) {
+    changed |= MINUTE_UNIT;
+  }
+  if (tick_time.tm_hour != s_last_tick.tm_hour) {
+    changed |= HOUR_UNIT;
+  }
+  if (tick_time.tm_mday != s_last_tick.tm_mday) {
+    changed |= DAY_UNIT;
+  }
+  if (tick_time.tm_mon != s_last_tick.tm_mon) {
+    changed |= MONTH_UNIT;
+  }
+  if (tick_time.tm_year != s_last_tick.tm_year) {
+    changed |= YEAR_UNIT;
+  }
+  s_last_tick = tick_time;
+  prv_schedule_tick();
+  if ((changed & s_tick_units) && s_tick_handler) {
+    s_tick_handler(&tick_time, changed);
+  }
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// pebble-events: lets several parts of the app share the single AppMessage and tick timer subscriptions.
+
+#include "shim_internal.h"
+#include <pebble-events/pebble-events.h>
+
+#define MAX_SUBSCRIBERS 16
+
+typedef struct {
+  bool used;
+  EventAppMessageHandlers handlers;
+  void *context;
+} AppMessageSubscriber;
+
+typedef struct {
+  bool used;
+  TimeUnits units;
+  EventTickHandler handler;
+  TickHandler plain_handler;
+  void *context;
+} TickSubscriber;
+
+static AppMessageSubscriber s_app_message_subscribers[MAX_SUBSCRIBERS];
+static TickSubscriber s_tick_subscribers[MAX_SUBSCRIBERS];
+static uint32_t s_inbox_size;
+static uint32_t s_outbox_size;
+
+static void prv_inbox_received(DictionaryIterator *iterator, void *context);
+static void prv_inbox_dropped(AppMessageResult reason, void *context);
+static void prv_outbox_sent(DictionaryIterator *iterator, void *context);
+static void prv_outbox_failed(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+static void prv_tick(struct tm *tick_time, TimeUnits units_changed);
+static void prv_update_tick_subscription(void);
+
+void shim_pebble_events_reset(void) {
+  memset(s_app_message_subscribers, 0, sizeof(s_app_message_subscribers));
+  memset(s_tick_subscribers, 0, sizeof(s_tick_subscribers));
+  s_inbox_size = APP_MESSAGE_INBOX_SIZE_MINIMUM;
+  s_outbox_size = APP_MESSAGE_OUTBOX_SIZE_MINIMUM;
+}
+
+EventHandle events_tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (!s_tick_subscribers[i].used) {
+      s_tick_subscribers[i] = (TickSubscriber) { .used = true, .units = tick_units, .plain_handler = handler };
+      prv_update_tick_subscription();
+      return &s_tick_subscribers[i];
+    }
+  }
+  return NULL;
+}
+
+EventHandle events_tick_timer_service_subscribe_context(TimeUnits tick_units, EventTickHandler handler,
+                                                        void *context) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (!s_tick_subscribers[i].used) {
+      s_tick_subscribers[i] = (TickSubscriber) {
+        .used = true,
+        .units = tick_units,
+        .handler = handler,
+        .context = context,
+      };
+      prv_update_tick_subscription();
+      return &s_tick_subscribers[i];
+    }
+  }
+  return NULL;
+}
+
+void events_tick_timer_service_unsubscribe(EventHandle handle) {
+  TickSubscriber *subscriber = handle;
+  if (subscriber) {
+    subscriber->used = false;
+    prv_update_tick_subscription();
+  }
+}
+
+void events_app_message_request_inbox_size(uint32_t size) {
+  s_inbox_size = MAX(s_inbox_size, size);
+}
+
+void events_app_message_request_outbox_size(uint32_t size) {
+  s_outbox_size = MAX(s_outbox_size, size);
+}
+
+AppMessageResult events_app_message_open(void) {
+  app_message_register_inbox_received(prv_inbox_received);
+  app_message_register_inbox_dropped(prv_inbox_dropped);
+  app_message_register_outbox_sent(prv_outbox_sent);
+  app_message_register_outbox_failed(prv_outbox_failed);
+  return app_message_open(s_inbox_size, s_outbox_size);
+}
+
+EventHandle events_app_message_register_inbox_received(AppMessageInboxReceived received_callback, void *context) {
+  return events_app_message_subscribe_handlers((EventAppMessageHandlers) { .received = received_callback }, context);
+}
+
+EventHandle events_app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback, void *context) {
+  return events_app_message_subscribe_handlers((EventAppMessageHandlers) { .dropped = dropped_callback }, context);
+}
+
+EventHandle events_app_message_register_outbox_sent(AppMessageOutboxSent sent_callback, void *context) {
+  return events_app_message_subscribe_handlers((EventAppMessageHandlers) { .sent = sent_callback }, context);
+}
+
+EventHandle events_app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback, void *context) {
+  return events_app_message_subscribe_handlers((EventAppMessageHandlers) { .failed = failed_callback }, context);
+}
+
+EventHandle events_app_message_subscribe_handlers(EventAppMessageHandlers handlers, void *context) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (!s_app_message_subscribers[i].used) {
+      s_app_message_subscribers[i] = (AppMessageSubscriber) {
+        .used = true,
+        .handlers = handlers,
+        .context = context,
+      };
+      return &s_app_message_subscribers[i];
+    }
+  }
+  return NULL;
+}
+
+void events_app_message_unsubscribe(EventHandle handle) {
+  AppMessageSubscriber *subscriber = handle;
+  if (subscriber) {
+    subscriber->used = false;
+  }
+}
+
+static void prv_inbox_received(DictionaryIterator *iterator, void *context) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    AppMessageSubscriber *subscriber = &s_app_message_subscribers[i];
+    if (subscriber->used && subscriber->handlers.received) {
+      subscriber->handlers.received(iterator, subscriber->context);
+    }
+  }
+}
+
+static void prv_inbox_dropped(AppMessageResult reason, void *context) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    AppMessageSubscriber *subscriber = &s_app_message_subscribers[i];
+    if (subscriber->used && subscriber->handlers.dropped) {
+      subscriber->handlers.dropped(reason, subscriber->context);
+    }
+  }
+}
+
+static void prv_outbox_sent(DictionaryIterator *iterator, void *context) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    AppMessageSubscriber *subscriber = &s_app_message_subscribers[i];
+    if (subscriber->used && subscriber->handlers.sent) {
+      subscriber->handlers.sent(iterator, subscriber->context);
+    }
+  }
+}
+
+static void prv_outbox_failed(DictionaryIterator *iterator, AppMessageResult reason, void *context) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    AppMessageSubscriber *subscriber = &s_app_message_subscribers[i];
+    if (subscriber->used && subscriber->handlers.failed) {
+      subscriber->handlers.failed(iterator, reason, subscriber->context);
+    }
+  }
+}
+
+static void prv_tick(struct tm *tick_time, TimeUnits units_changed) {
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    TickSubscriber *subscriber = &s_tick_subscribers[i];
+    if (!subscriber->used || !(subscriber->units & units_changed)) {
+      continue;
+    }
+    if (subscriber->handler) {
+      subscriber->handler(tick_time, units_changed, subscriber->context);
+    } else if (subscriber->plain_handler) {
+      subscriber->plain_handler(tick_time, units_changed);
+    }
+  }
+}
+
+static void prv_update_tick_subscription(void) {
+  TimeUnits units = 0;
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (s_tick_subscribers[i].used) {
+      units |= s_tick_subscribers[i].units;
+    }
+  }
+  tick_timer_service_unsubscribe();
+  if (units) {
+    tick_timer_service_subscribe(units, prv_tick);
+  }
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+// The header of a serialised GBitmap (a .pbi), which is what gbitmap_create_with_data() takes.
+typedef struct __attribute__((__packed__)) {
+  uint16_t row_size_bytes;
+  uint16_t info_flags;
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} PbiHeader;
+
+#define PBI_FORMAT(info_flags) (((info_flags) >> 1) & 0x7)
+
+static const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static int prv_bits_per_pixel(GBitmapFormat format);
+static int prv_palette_size(GBitmapFormat format);
+static uint32_t prv_read_be32(const uint8_t *bytes);
+static void prv_load_png_palette(GBitmap *bitmap, const uint8_t *png, size_t size);
+
+GBitmap *shim_gbitmap_create(GSize size, GBitmapFormat format, bool app_heap) {
+  const uint16_t row_size_bytes = (size.w * prv_bits_per_pixel(format) + 7) / 8;
+  const size_t pixel_bytes = row_size_bytes * size.h;
+  const size_t palette_bytes = prv_palette_size(format) * sizeof(GColor);
+  GBitmap *bitmap = app_heap ? app_malloc(sizeof(GBitmap)) : malloc(sizeof(GBitmap));
+  if (!bitmap) {
+    return NULL;
+  }
+  uint8_t *data = app_heap ? app_malloc(pixel_bytes + palette_bytes) : malloc(pixel_bytes + palette_bytes);
+  if (!data) {
+    app_heap ? app_free(bitmap) : free(bitmap);
+    return NULL;
+  }
+  memset(data, 0, pixel_bytes + palette_bytes);
+  *bitmap = (GBitmap) {
+    .addr = data,
+    .row_size_bytes = row_size_bytes,
+    .format = format,
+    .bounds = GRect(0, 0, size.w, size.h),
+    .palette = palette_bytes ? (GColor *)(data + pixel_bytes) : NULL,
+    .owned_data = data,
+  };
+  return bitmap;
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+  return shim_gbitmap_create(size, format, true);
+}
+
+// There's no PNG decoder here, so the bitmap gets the image's real size, format and palette (which is what
+// layout and heap use depend on) and every pixel is the first palette entry, or dark grey.
+GBitmap *gbitmap_create_with_resource(uint32_t resource_id) {
+  size_t size;
+  const uint8_t *png = shim_resource_data(resource_id, &size);
+  if (!png || size < 33 || memcmp(png, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0) {
+    return NULL;
+  }
+  const GSize image_size = GSize(prv_read_be32(png + 16), prv_read_be32(png + 20));
+  const uint8_t bit_depth = png[24];
+  const uint8_t color_type = png[25];
+  GBitmapFormat format = GBitmapFormat8Bit;
+  if (color_type == 3) {
+    format = bit_depth == 1 ? GBitmapFormat1BitPalette
+           : bit_depth == 2 ? GBitmapFormat2BitPalette
+           : bit_depth == 4 ? GBitmapFormat4BitPalette
+           : GBitmapFormat8Bit;
+  }
+  GBitmap *bitmap = shim_gbitmap_create(image_size, format, true);
+  if (!bitmap) {
+    return NULL;
+  }
+  if (bitmap->palette) {
+    prv_load_png_palette(bitmap, png, size);
+  } else {
+    memset(bitmap->addr, GColorDarkGrayARGB8, bitmap->row_size_bytes * image_size.h);
+  }
+  return bitmap;
+}
+
+GBitmap *gbitmap_create_with_data(const uint8_t *data) {
+  const PbiHeader *header = (const PbiHeader *)data;
+  const GBitmapFormat format = PBI_FORMAT(header->info_flags);
+  if (format > GBitmapFormat8BitCircular) {
+    return NULL;
+  }
+  GBitmap *bitmap = app_malloc(sizeof(GBitmap));
+  if (!bitmap) {
+    return NULL;
+  }
+  // Like the firmware, the bitmap points into the caller's data rather than copying it.
+  const uint8_t *pixels = data + sizeof(PbiHeader);
+  *bitmap = (GBitmap) {
+    .addr = (uint8_t *)pixels,
+    .row_size_bytes = header->row_size_bytes,
+    .format = format,
+    .bounds = GRect(header->x, header->y, header->w, header->h),
+    .palette = prv_palette_size(format)
+        ? (GColor *)(pixels + header->row_size_bytes * (header->y + header->h))
+        : NULL,
+  };
+  return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+  if (!bitmap) {
+    return;
+  }
+  app_free(bitmap->owned_data);
+  app_free(bitmap);
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+  return bitmap->bounds;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+  return bitmap->row_size_bytes;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+  return bitmap->format;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+  return bitmap->addr;
+}
+
+GColor *gbitmap_get_palette(const GBitmap *bitmap) {
+  return bitmap->palette;
+}
+
+static int prv_bits_per_pixel(GBitmapFormat format) {
+  switch (format) {
+    case GBitmapFormat1Bit:
+    case GBitmapFormat1BitPalette:
+      return 1;
+    case GBitmapFormat2BitPalette:
+      return 2;
+    case GBitmapFormat4BitPalette:
+      return 4;
+    case GBitmapFormat8Bit:
+    case GBitmapFormat8BitCircular:
+      return 8;
+  }
+  return 8;
+}
+
+static int prv_palette_size(GBitmapFormat format) {
+  switch (format) {
+    case GBitmapFormat1BitPalette:
+      return 2;
+    case GBitmapFormat2BitPalette:
+      return 4;
+    case GBitmapFormat4BitPalette:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+static uint32_t prv_read_be32(const uint8_t *bytes) {
+  return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static void prv_load_png_palette(GBitmap *bitmap, const uint8_t *png, size_t size) {
+  const int entries = prv_palette_size(bitmap->format);
+  for (int i = 0; i < entries; ++i) {
+    bitmap->palette[i] = GColorDarkGray;
+  }
+  // Walk the chunks for PLTE (colours) and tRNS (their alpha).
+  size_t offset = sizeof(PNG_SIGNATURE);
+  while (offset + 8 <= size) {
+    const uint32_t length = prv_read_be32(png + offset);
+    const uint8_t *type = png + offset + 4;
+    const uint8_t *body = png + offset + 8;
+    if (offset + 12 + length > size) {
+      break;
+    }
+    if (memcmp(type, "PLTE", 4) == 0) {
+      for (uint32_t i = 0; i < length / 3 && i < (uint32_t)entries; ++i) {
+        bitmap->palette[i] = GColorFromRGB(body[i * 3], body[i * 3 + 1], body[i * 3 + 2]);
+      }
+    } else if (memcmp(type, "tRNS", 4) == 0) {
+      for (uint32_t i = 0; i < length && i < (uint32_t)entries; ++i) {
+        bitmap->palette[i].a = body[i] >> 6;
+      }
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      break;
+    }
+    offset += 12 + length;
+  }
+}
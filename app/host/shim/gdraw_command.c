@@ -0,0 +1,209 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Pebble Draw Commands, read straight from the .pdc / .pdcs resources. As on the watch, the whole resource is copied
+// onto the app's heap and drawn from there.
+
+#include "shim_internal.h"
+
+typedef enum {
+  GDrawCommandTypeInvalid = 0,
+  GDrawCommandTypePath,
+  GDrawCommandTypeCircle,
+  GDrawCommandTypePrecisePath,
+} GDrawCommandType;
+
+typedef struct __attribute__((__packed__)) {
+  uint8_t type;
+  uint8_t hidden;
+  GColor stroke_color;
+  uint8_t stroke_width;
+  GColor fill_color;
+  union {
+    uint16_t path_open;
+    uint16_t radius;
+  };
+  uint16_t num_points;
+  GPoint points[];
+} GDrawCommand;
+
+typedef struct __attribute__((__packed__)) {
+  uint16_t num_commands;
+  uint8_t commands[];
+} GDrawCommandList;
+
+struct __attribute__((__packed__)) GDrawCommandImage {
+  uint8_t version;
+  uint8_t reserved;
+  GSize size;
+  GDrawCommandList command_list;
+};
+
+struct __attribute__((__packed__)) GDrawCommandFrame {
+  uint16_t duration;
+  GDrawCommandList command_list;
+};
+
+struct __attribute__((__packed__)) GDrawCommandSequence {
+  uint8_t version;
+  uint8_t reserved;
+  GSize size;
+  uint16_t play_count;
+  uint16_t num_frames;
+  uint8_t frames[];
+};
+
+static void *prv_load(uint32_t resource_id, const char *magic);
+static size_t prv_command_size(const GDrawCommand *command);
+static size_t prv_list_size(const GDrawCommandList *list);
+static void prv_draw_list(GContext *ctx, const GDrawCommandList *list, GPoint offset);
+
+GDrawCommandImage *gdraw_command_image_create_with_resource(uint32_t resource_id) {
+  return prv_load(resource_id, "PDCI");
+}
+
+void gdraw_command_image_destroy(GDrawCommandImage *image) {
+  app_free(image);
+}
+
+void gdraw_command_image_draw(GContext *ctx, GDrawCommandImage *image, GPoint offset) {
+  ctx->draw_calls++;
+  if (image) {
+    prv_draw_list(ctx, &image->command_list, offset);
+  }
+}
+
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage *image) {
+  return image ? image->size : GSizeZero;
+}
+
+GDrawCommandSequence *gdraw_command_sequence_create_with_resource(uint32_t resource_id) {
+  return prv_load(resource_id, "PDCS");
+}
+
+void gdraw_command_sequence_destroy(GDrawCommandSequence *sequence) {
+  app_free(sequence);
+}
+
+GDrawCommandFrame *gdraw_command_sequence_get_frame_by_index(GDrawCommandSequence *sequence, uint32_t index) {
+  if (!sequence || index >= sequence->num_frames) {
+    return NULL;
+  }
+  uint8_t *frame = sequence->frames;
+  for (uint32_t i = 0; i < index; ++i) {
+    frame += offsetof(GDrawCommandFrame, command_list) + prv_list_size(&((GDrawCommandFrame *)frame)->command_list);
+  }
+  return (GDrawCommandFrame *)frame;
+}
+
+GSize gdraw_command_sequence_get_bounds_size(GDrawCommandSequence *sequence) {
+  return sequence ? sequence->size : GSizeZero;
+}
+
+uint32_t gdraw_command_sequence_get_play_count(GDrawCommandSequence *sequence) {
+  return sequence ? sequence->play_count : 0;
+}
+
+uint32_t gdraw_command_sequence_get_num_frames(GDrawCommandSequence *sequence) {
+  return sequence ? sequence->num_frames : 0;
+}
+
+void gdraw_command_frame_draw(GContext *ctx, GDrawCommandSequence *sequence, GDrawCommandFrame *frame,
+                              GPoint offset) {
+  ctx->draw_calls++;
+  if (frame) {
+    prv_draw_list(ctx, &frame->command_list, offset);
+  }
+}
+
+uint32_t gdraw_command_frame_get_duration(GDrawCommandFrame *frame) {
+  return frame ? frame->duration : 0;
+}
+
+static void *prv_load(uint32_t resource_id, const char *magic) {
+  size_t size;
+  const uint8_t *data = shim_resource_data(resource_id, &size);
+  // Four bytes of magic and four of length come before the image itself.
+  if (!data || size < 8 || memcmp(data, magic, 4) != 0) {
+    return NULL;
+  }
+  void *copy = app_malloc(size - 8);
+  if (!copy) {
+    return NULL;
+  }
+  memcpy(copy, data + 8, size - 8);
+  return copy;
+}
+
+static size_t prv_command_size(const GDrawCommand *command) {
+  return sizeof(GDrawCommand) + command->num_points * sizeof(GPoint);
+}
+
+static size_t prv_list_size(const GDrawCommandList *list) {
+  size_t size = sizeof(GDrawCommandList);
+  const uint8_t *command = list->commands;
+  for (uint16_t i = 0; i < list->num_commands; ++i) {
+    const size_t command_size = prv_command_size((const GDrawCommand *)command);
+    size += command_size;
+    command += command_size;
+  }
+  return size;
+}
+
+static void prv_draw_list(GContext *ctx, const GDrawCommandList *list, GPoint offset) {
+  const GContext saved = *ctx;
+  ctx->offset = GPoint(ctx->offset.x + offset.x, ctx->offset.y + offset.y);
+  const uint8_t *cursor = list->commands;
+  for (uint16_t i = 0; i < list->num_commands; ++i) {
+    const GDrawCommand *command = (const GDrawCommand *)cursor;
+    cursor += prv_command_size(command);
+    if (command->hidden || command->num_points == 0) {
+      continue;
+    }
+    ctx->fill_color = command->fill_color;
+    ctx->stroke_color = command->stroke_color;
+    ctx->stroke_width = MAX(1, command->stroke_width);
+    GPoint points[command->num_points];
+    memcpy(points, command->points, sizeof(points));
+    switch (command->type) {
+      case GDrawCommandTypeCircle:
+        if (command->fill_color.a) {
+          graphics_fill_circle(ctx, points[0], command->radius);
+        }
+        if (command->stroke_width && command->stroke_color.a) {
+          graphics_draw_circle(ctx, points[0], command->radius);
+        }
+        break;
+      case GDrawCommandTypePath:
+      case GDrawCommandTypePrecisePath:
+        if (command->type == GDrawCommandTypePath) {
+          for (uint16_t p = 0; p < command->num_points; ++p) {
+            points[p] = GPoint(points[p].x * 8, points[p].y * 8);
+          }
+        }
+        if (command->fill_color.a && !command->path_open && command->num_points > 2) {
+          shim_graphics_fill_precise_polygon(ctx, points, command->num_points);
+        }
+        if (command->stroke_width && command->stroke_color.a) {
+          shim_graphics_draw_precise_polyline(ctx, points, command->num_points, !command->path_open);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  *ctx = saved;
+}
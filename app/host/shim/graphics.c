@@ -0,0 +1,487 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A plain software rasteriser over an 8-bit framebuffer. It draws the same shapes in the same places as the
+// firmware, but makes no attempt at its exact pixels: no antialiasing, and square line caps.
+
+#include "shim_internal.h"
+
+#include <math.h>
+
+// PDC precise points, and the polygon filler, work in eighths of a pixel.
+#define PRECISE_SHIFT 3
+#define PRECISE_ONE (1 << PRECISE_SHIFT)
+#define TRIG_MAX_ANGLE 0x10000
+
+static void prv_plot(GContext *ctx, int x, int y, GColor color);
+static void prv_hspan(GContext *ctx, int x0, int x1, int y, GColor color);
+static void prv_stroke_point(GContext *ctx, int x, int y);
+static void prv_line(GContext *ctx, int x0, int y0, int x1, int y1);
+static GColor prv_bitmap_pixel(const GBitmap *bitmap, int x, int y);
+
+//
+// Geometry
+//
+
+bool gpoint_equal(const GPoint *point_a, const GPoint *point_b) {
+  return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+bool gsize_equal(const GSize *size_a, const GSize *size_b) {
+  return size_a->w == size_b->w && size_a->h == size_b->h;
+}
+
+bool grect_equal(const GRect *rect_a, const GRect *rect_b) {
+  return gpoint_equal(&rect_a->origin, &rect_b->origin) && gsize_equal(&rect_a->size, &rect_b->size);
+}
+
+bool grect_is_empty(const GRect *rect) {
+  return rect->size.w <= 0 || rect->size.h <= 0;
+}
+
+bool grect_contains_point(const GRect *rect, const GPoint *point) {
+  return point->x >= rect->origin.x && point->x < rect->origin.x + rect->size.w &&
+         point->y >= rect->origin.y && point->y < rect->origin.y + rect->size.h;
+}
+
+GPoint grect_center_point(const GRect *rect) {
+  return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2);
+}
+
+void grect_align(GRect *rect, const GRect *inside_rect, const GAlign alignment, const bool clip) {
+  const int16_t left = inside_rect->origin.x;
+  const int16_t top = inside_rect->origin.y;
+  const int16_t center_x = left + (inside_rect->size.w - rect->size.w) / 2;
+  const int16_t center_y = top + (inside_rect->size.h - rect->size.h) / 2;
+  const int16_t right = left + inside_rect->size.w - rect->size.w;
+  const int16_t bottom = top + inside_rect->size.h - rect->size.h;
+  switch (alignment) {
+    case GAlignCenter: rect->origin = GPoint(center_x, center_y); break;
+    case GAlignTopLeft: rect->origin = GPoint(left, top); break;
+    case GAlignTopRight: rect->origin = GPoint(right, top); break;
+    case GAlignTop: rect->origin = GPoint(center_x, top); break;
+    case GAlignLeft: rect->origin = GPoint(left, center_y); break;
+    case GAlignBottom: rect->origin = GPoint(center_x, bottom); break;
+    case GAlignRight: rect->origin = GPoint(right, center_y); break;
+    case GAlignBottomRight: rect->origin = GPoint(right, bottom); break;
+    case GAlignBottomLeft: rect->origin = GPoint(left, bottom); break;
+  }
+  if (clip) {
+    grect_clip(rect, inside_rect);
+  }
+}
+
+void grect_clip(GRect *rect_to_clip, const GRect *rect_clipper) {
+  int x0 = MAX(rect_to_clip->origin.x, rect_clipper->origin.x);
+  int y0 = MAX(rect_to_clip->origin.y, rect_clipper->origin.y);
+  int x1 = MIN(rect_to_clip->origin.x + rect_to_clip->size.w, rect_clipper->origin.x + rect_clipper->size.w);
+  int y1 = MIN(rect_to_clip->origin.y + rect_to_clip->size.h, rect_clipper->origin.y + rect_clipper->size.h);
+  *rect_to_clip = GRect(x0, y0, MAX(0, x1 - x0), MAX(0, y1 - y0));
+}
+
+GRect grect_crop(GRect rect, const int32_t crop_size_px) {
+  return grect_inset(rect, GEdgeInsets(crop_size_px));
+}
+
+GRect grect_inset(GRect rect, GEdgeInsets insets) {
+  GRect result = GRect(rect.origin.x + insets.left, rect.origin.y + insets.top,
+                       rect.size.w - insets.left - insets.right, rect.size.h - insets.top - insets.bottom);
+  if (result.size.w < 0 || result.size.h < 0) {
+    return GRectZero;
+  }
+  return result;
+}
+
+//
+// Colours
+//
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+  return x.argb == y.argb;
+}
+
+GColor8 gcolor_legible_over(GColor8 background_color) {
+  if (background_color.a == 0) {
+    return GColorBlack;
+  }
+  // Perceived brightness, with each channel on the 0-3 scale.
+  const int brightness = background_color.r * 299 + background_color.g * 587 + background_color.b * 114;
+  return brightness > 1500 ? GColorBlack : GColorWhite;
+}
+
+//
+// The context
+//
+
+void shim_graphics_context_init(GContext *ctx, GBitmap *dest) {
+  *ctx = (GContext) {
+    .dest = dest,
+    .offset = GPointZero,
+    .clip = dest->bounds,
+    .stroke_color = GColorBlack,
+    .fill_color = GColorBlack,
+    .text_color = GColorBlack,
+    .stroke_width = 1,
+    .compositing_mode = GCompOpAssign,
+    .antialiased = true,
+  };
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  ctx->stroke_color = color;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  ctx->fill_color = color;
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {
+  ctx->text_color = color;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {
+  ctx->compositing_mode = mode;
+}
+
+void graphics_context_set_antialiased(GContext *ctx, bool enable) {
+  ctx->antialiased = enable;
+}
+
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width) {
+  if (stroke_width > 0) {
+    ctx->stroke_width = stroke_width;
+  }
+}
+
+//
+// Primitives
+//
+
+void graphics_draw_pixel(GContext *ctx, GPoint point) {
+  ctx->draw_calls++;
+  prv_plot(ctx, ctx->offset.x + point.x, ctx->offset.y + point.y, ctx->stroke_color);
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+  ctx->draw_calls++;
+  prv_line(ctx, ctx->offset.x + p0.x, ctx->offset.y + p0.y, ctx->offset.x + p1.x, ctx->offset.y + p1.y);
+}
+
+void graphics_draw_rect(GContext *ctx, GRect rect) {
+  ctx->draw_calls++;
+  if (grect_is_empty(&rect)) {
+    return;
+  }
+  const int x0 = ctx->offset.x + rect.origin.x;
+  const int y0 = ctx->offset.y + rect.origin.y;
+  const int x1 = x0 + rect.size.w - 1;
+  const int y1 = y0 + rect.size.h - 1;
+  prv_hspan(ctx, x0, x1, y0, ctx->stroke_color);
+  prv_hspan(ctx, x0, x1, y1, ctx->stroke_color);
+  for (int y = y0 + 1; y < y1; ++y) {
+    prv_plot(ctx, x0, y, ctx->stroke_color);
+    prv_plot(ctx, x1, y, ctx->stroke_color);
+  }
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  ctx->draw_calls++;
+  if (grect_is_empty(&rect)) {
+    return;
+  }
+  const int radius = MIN(corner_radius, MIN(rect.size.w, rect.size.h) / 2);
+  const int x0 = ctx->offset.x + rect.origin.x;
+  const int y0 = ctx->offset.y + rect.origin.y;
+  for (int row = 0; row < rect.size.h; ++row) {
+    int left_inset = 0;
+    int right_inset = 0;
+    const int from_top = row;
+    const int from_bottom = rect.size.h - 1 - row;
+    if (radius > 0 && (from_top < radius || from_bottom < radius)) {
+      const int from_edge = MIN(from_top, from_bottom);
+      const double dy = radius - from_edge - 0.5;
+      const int inset = (int)(radius - sqrt((double)radius * radius - dy * dy) + 0.5);
+      const bool top = from_top < radius;
+      if (corner_mask & (top ? GCornerTopLeft : GCornerBottomLeft)) {
+        left_inset = inset;
+      }
+      if (corner_mask & (top ? GCornerTopRight : GCornerBottomRight)) {
+        right_inset = inset;
+      }
+    }
+    prv_hspan(ctx, x0 + left_inset, x0 + rect.size.w - 1 - right_inset, y0 + row, ctx->fill_color);
+  }
+}
+
+void graphics_draw_round_rect(GContext *ctx, GRect rect, uint16_t radius) {
+  // Counted as a draw call by graphics_draw_rect.
+  graphics_draw_rect(ctx, rect);
+}
+
+void shim_graphics_fill_rect_color(GContext *ctx, GRect rect, GColor color) {
+  const int x0 = ctx->offset.x + rect.origin.x;
+  const int y0 = ctx->offset.y + rect.origin.y;
+  for (int y = y0; y < y0 + rect.size.h; ++y) {
+    prv_hspan(ctx, x0, x0 + rect.size.w - 1, y, color);
+  }
+}
+
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  ctx->draw_calls++;
+  const int cx = ctx->offset.x + p.x;
+  const int cy = ctx->offset.y + p.y;
+  // A ring between these two radii, which for a one pixel stroke is just the circle itself.
+  const double outer = radius + ctx->stroke_width / 2.0;
+  const double inner = MAX(0.0, radius - ctx->stroke_width / 2.0);
+  const int extent = (int)ceil(outer);
+  for (int dy = -extent; dy <= extent; ++dy) {
+    const double outer_sq = outer * outer - dy * dy;
+    if (outer_sq < 0) {
+      continue;
+    }
+    const int outer_dx = (int)sqrt(outer_sq);
+    const double inner_sq = inner * inner - dy * dy;
+    if (inner_sq <= 0) {
+      prv_hspan(ctx, cx - outer_dx, cx + outer_dx, cy + dy, ctx->stroke_color);
+      continue;
+    }
+    const int inner_dx = (int)ceil(sqrt(inner_sq));
+    prv_hspan(ctx, cx - outer_dx, cx - inner_dx, cy + dy, ctx->stroke_color);
+    prv_hspan(ctx, cx + inner_dx, cx + outer_dx, cy + dy, ctx->stroke_color);
+  }
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  ctx->draw_calls++;
+  const int cx = ctx->offset.x + p.x;
+  const int cy = ctx->offset.y + p.y;
+  for (int dy = -radius; dy <= radius; ++dy) {
+    const int dx = (int)sqrt((double)radius * radius - dy * dy);
+    prv_hspan(ctx, cx - dx, cx + dx, cy + dy, ctx->fill_color);
+  }
+}
+
+//
+// Paths
+//
+
+static void prv_path_points(GPath *path, GPoint *out) {
+  const double angle = 2 * M_PI * path->rotation / TRIG_MAX_ANGLE;
+  const double c = cos(angle);
+  const double s = sin(angle);
+  for (uint32_t i = 0; i < path->num_points; ++i) {
+    const GPoint p = path->points[i];
+    const double x = path->rotation ? p.x * c - p.y * s : p.x;
+    const double y = path->rotation ? p.x * s + p.y * c : p.y;
+    out[i] = GPoint((int16_t)lround((x + path->offset.x) * PRECISE_ONE),
+                    (int16_t)lround((y + path->offset.y) * PRECISE_ONE));
+  }
+}
+
+void gpath_draw_filled(GContext *ctx, GPath *path) {
+  ctx->draw_calls++;
+  if (path->num_points < 3) {
+    return;
+  }
+  GPoint *points = malloc(path->num_points * sizeof(GPoint));
+  prv_path_points(path, points);
+  shim_graphics_fill_precise_polygon(ctx, points, path->num_points);
+  free(points);
+}
+
+void gpath_draw_outline(GContext *ctx, GPath *path) {
+  ctx->draw_calls++;
+  if (path->num_points < 2) {
+    return;
+  }
+  GPoint *points = malloc(path->num_points * sizeof(GPoint));
+  prv_path_points(path, points);
+  shim_graphics_draw_precise_polyline(ctx, points, path->num_points, true);
+  free(points);
+}
+
+void shim_graphics_fill_precise_polygon(GContext *ctx, const GPoint *points, size_t num_points) {
+  int min_y = INT16_MAX;
+  int max_y = INT16_MIN;
+  for (size_t i = 0; i < num_points; ++i) {
+    min_y = MIN(min_y, points[i].y);
+    max_y = MAX(max_y, points[i].y);
+  }
+  double *crossings = malloc(num_points * sizeof(double));
+  for (int y = min_y >> PRECISE_SHIFT; y <= (max_y >> PRECISE_SHIFT); ++y) {
+    // Sample each row through the middle of its pixels.
+    const double sample_y = y * PRECISE_ONE + PRECISE_ONE / 2;
+    size_t count = 0;
+    for (size_t i = 0; i < num_points; ++i) {
+      const GPoint a = points[i];
+      const GPoint b = points[(i + 1) % num_points];
+      if ((a.y <= sample_y && b.y > sample_y) || (b.y <= sample_y && a.y > sample_y)) {
+        crossings[count++] = a.x + (sample_y - a.y) * (b.x - a.x) / (double)(b.y - a.y);
+      }
+    }
+    // Insertion sort: there are only ever a handful.
+    for (size_t i = 1; i < count; ++i) {
+      const double value = crossings[i];
+      size_t j = i;
+      while (j > 0 && crossings[j - 1] > value) {
+        crossings[j] = crossings[j - 1];
+        --j;
+      }
+      crossings[j] = value;
+    }
+    for (size_t i = 0; i + 1 < count; i += 2) {
+      const int x0 = (int)ceil((crossings[i] - PRECISE_ONE / 2) / PRECISE_ONE);
+      const int x1 = (int)floor((crossings[i + 1] - PRECISE_ONE / 2) / PRECISE_ONE);
+      prv_hspan(ctx, ctx->offset.x + x0, ctx->offset.x + x1, ctx->offset.y + y, ctx->fill_color);
+    }
+  }
+  free(crossings);
+}
+
+void shim_graphics_draw_precise_polyline(GContext *ctx, const GPoint *points, size_t num_points, bool closed) {
+  const size_t segments = closed ? num_points : num_points - 1;
+  for (size_t i = 0; i < segments; ++i) {
+    const GPoint a = points[i];
+    const GPoint b = points[(i + 1) % num_points];
+    prv_line(ctx, ctx->offset.x + ((a.x + PRECISE_ONE / 2) >> PRECISE_SHIFT),
+             ctx->offset.y + ((a.y + PRECISE_ONE / 2) >> PRECISE_SHIFT),
+             ctx->offset.x + ((b.x + PRECISE_ONE / 2) >> PRECISE_SHIFT),
+             ctx->offset.y + ((b.y + PRECISE_ONE / 2) >> PRECISE_SHIFT));
+  }
+}
+
+//
+// Bitmaps
+//
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+  ctx->draw_calls++;
+  if (!bitmap || grect_is_empty(&bitmap->bounds)) {
+    return;
+  }
+  const int x0 = ctx->offset.x + rect.origin.x;
+  const int y0 = ctx->offset.y + rect.origin.y;
+  const GSize size = bitmap->bounds.size;
+  // Bitmaps smaller than the rectangle are tiled, as they are on the watch.
+  for (int y = 0; y < rect.size.h; ++y) {
+    for (int x = 0; x < rect.size.w; ++x) {
+      GColor color = prv_bitmap_pixel(bitmap, bitmap->bounds.origin.x + x % size.w,
+                                      bitmap->bounds.origin.y + y % size.h);
+      if (ctx->compositing_mode == GCompOpSet && color.a == 0) {
+        continue;
+      }
+      if (ctx->compositing_mode == GCompOpAssign) {
+        color.a = 3;
+      }
+      prv_plot(ctx, x0 + x, y0 + y, color);
+    }
+  }
+}
+
+static GColor prv_bitmap_pixel(const GBitmap *bitmap, int x, int y) {
+  const uint8_t *row = bitmap->addr + y * bitmap->row_size_bytes;
+  switch (bitmap->format) {
+    case GBitmapFormat8Bit:
+    case GBitmapFormat8BitCircular:
+      return (GColor){.argb = row[x]};
+    case GBitmapFormat1Bit:
+      return ((row[x / 8] >> (x % 8)) & 1) ? GColorWhite : GColorBlack;
+    case GBitmapFormat1BitPalette:
+      return bitmap->palette[(row[x / 8] >> (7 - x % 8)) & 0x1];
+    case GBitmapFormat2BitPalette:
+      return bitmap->palette[(row[x / 4] >> (2 * (3 - x % 4))) & 0x3];
+    case GBitmapFormat4BitPalette:
+      return bitmap->palette[(row[x / 2] >> (4 * (1 - x % 2))) & 0xf];
+  }
+  return GColorClear;
+}
+
+//
+// Pixels
+//
+
+static void prv_plot(GContext *ctx, int x, int y, GColor color) {
+  if (color.a == 0) {
+    return;
+  }
+  if (x < ctx->clip.origin.x || x >= ctx->clip.origin.x + ctx->clip.size.w ||
+      y < ctx->clip.origin.y || y >= ctx->clip.origin.y + ctx->clip.size.h) {
+    return;
+  }
+  uint8_t *pixel = ctx->dest->addr + y * ctx->dest->row_size_bytes + x;
+  if (color.a == 3) {
+    *pixel = color.argb;
+    return;
+  }
+  GColor existing = (GColor){.argb = *pixel};
+  existing.r = (color.r * color.a + existing.r * (3 - color.a)) / 3;
+  existing.g = (color.g * color.a + existing.g * (3 - color.a)) / 3;
+  existing.b = (color.b * color.a + existing.b * (3 - color.a)) / 3;
+  *pixel = existing.argb;
+}
+
+static void prv_hspan(GContext *ctx, int x0, int x1, int y, GColor color) {
+  if (color.a == 0 || y < ctx->clip.origin.y || y >= ctx->clip.origin.y + ctx->clip.size.h) {
+    return;
+  }
+  x0 = MAX(x0, ctx->clip.origin.x);
+  x1 = MIN(x1, ctx->clip.origin.x + ctx->clip.size.w - 1);
+  if (x0 > x1) {
+    return;
+  }
+  if (color.a == 3) {
+    memset(ctx->dest->addr + y * ctx->dest->row_size_bytes + x0, color.argb, x1 - x0 + 1);
+    return;
+  }
+  for (int x = x0; x <= x1; ++x) {
+    prv_plot(ctx, x, y, color);
+  }
+}
+
+static void prv_stroke_point(GContext *ctx, int x, int y) {
+  const int width = ctx->stroke_width;
+  if (width <= 1) {
+    prv_plot(ctx, x, y, ctx->stroke_color);
+    return;
+  }
+  const int start = -(width / 2);
+  for (int dy = start; dy < start + width; ++dy) {
+    prv_hspan(ctx, x + start, x + start + width - 1, y + dy, ctx->stroke_color);
+  }
+}
+
+static void prv_line(GContext *ctx, int x0, int y0, int x1, int y1) {
+  const int dx = abs(x1 - x0);
+  const int dy = -abs(y1 - y0);
+  const int step_x = x0 < x1 ? 1 : -1;
+  const int step_y = y0 < y1 ? 1 : -1;
+  int error = dx + dy;
+  while (true) {
+    prv_stroke_point(ctx, x0, y0);
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    const int e2 = 2 * error;
+    if (e2 >= dy) {
+      error += dy;
+      x0 += step_x;
+    }
+    if (e2 <= dx) {
+      error += dx;
+      y0 += step_y;
+    }
+  }
+}
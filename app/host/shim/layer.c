@@ -0,0 +1,244 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+static void prv_set_window(Layer *layer, Window *window);
+
+void layer_init(Layer *layer, GRect frame) {
+  *layer = (Layer) {
+    .frame = frame,
+    .bounds = GRect(0, 0, frame.size.w, frame.size.h),
+    .clips = true,
+  };
+}
+
+void layer_deinit(Layer *layer) {
+  layer_remove_from_parent(layer);
+  Layer *child = layer->first_child;
+  while (child) {
+    Layer *next = child->next_sibling;
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    prv_set_window(child, NULL);
+    child = next;
+  }
+  layer->first_child = NULL;
+}
+
+Layer *layer_create(GRect frame) {
+  Layer *layer = app_malloc(sizeof(Layer));
+  if (!layer) {
+    return NULL;
+  }
+  layer_init(layer, frame);
+  return layer;
+}
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+  Layer *layer = app_malloc(sizeof(Layer) + data_size);
+  if (!layer) {
+    return NULL;
+  }
+  layer_init(layer, frame);
+  layer->has_data = true;
+  memset(layer->data, 0, data_size);
+  return layer;
+}
+
+void layer_destroy(Layer *layer) {
+  if (!layer) {
+    return;
+  }
+  layer_deinit(layer);
+  app_free(layer);
+}
+
+void layer_mark_dirty(Layer *layer) {
+  // The whole screen is redrawn every frame anyway.
+  shim_request_render();
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+  shim_request_render();
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  // As in the firmware, bounds that matched the old frame follow it to the new one.
+  if (layer->bounds.origin.x == 0 && layer->bounds.origin.y == 0 &&
+      gsize_equal(&layer->bounds.size, &layer->frame.size)) {
+    layer->bounds.size = frame.size;
+  }
+  layer->frame = frame;
+  shim_request_render();
+}
+
+GRect layer_get_frame(const Layer *layer) {
+  return layer->frame;
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds) {
+  layer->bounds = bounds;
+  shim_request_render();
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return layer->bounds;
+}
+
+GPoint layer_convert_point_to_screen(const Layer *layer, GPoint point) {
+  GPoint origin = shim_layer_screen_origin(layer);
+  return GPoint(origin.x + point.x, origin.y + point.y);
+}
+
+GPoint shim_layer_screen_origin(const Layer *layer) {
+  GPoint origin = GPointZero;
+  for (const Layer *l = layer; l; l = l->parent) {
+    origin.x += l->frame.origin.x + l->bounds.origin.x;
+    origin.y += l->frame.origin.y + l->bounds.origin.y;
+  }
+  return origin;
+}
+
+Window *layer_get_window(const Layer *layer) {
+  return layer->window;
+}
+
+void layer_remove_from_parent(Layer *child) {
+  Layer *parent = child->parent;
+  if (!parent) {
+    return;
+  }
+  for (Layer **link = &parent->first_child; *link; link = &(*link)->next_sibling) {
+    if (*link == child) {
+      *link = child->next_sibling;
+      break;
+    }
+  }
+  child->parent = NULL;
+  child->next_sibling = NULL;
+  prv_set_window(child, NULL);
+  shim_request_render();
+}
+
+void layer_remove_child_layers(Layer *parent) {
+  while (parent->first_child) {
+    layer_remove_from_parent(parent->first_child);
+  }
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  layer_remove_from_parent(child);
+  Layer **link = &parent->first_child;
+  while (*link) {
+    link = &(*link)->next_sibling;
+  }
+  *link = child;
+  child->parent = parent;
+  prv_set_window(child, parent->window);
+  shim_request_render();
+}
+
+void layer_insert_below_sibling(Layer *layer_to_insert, Layer *below_sibling_layer) {
+  Layer *parent = below_sibling_layer->parent;
+  if (!parent) {
+    return;
+  }
+  layer_remove_from_parent(layer_to_insert);
+  Layer **link = &parent->first_child;
+  while (*link != below_sibling_layer) {
+    link = &(*link)->next_sibling;
+  }
+  layer_to_insert->next_sibling = below_sibling_layer;
+  *link = layer_to_insert;
+  layer_to_insert->parent = parent;
+  prv_set_window(layer_to_insert, parent->window);
+  shim_request_render();
+}
+
+void layer_insert_above_sibling(Layer *layer_to_insert, Layer *above_sibling_layer) {
+  Layer *parent = above_sibling_layer->parent;
+  if (!parent) {
+    return;
+  }
+  layer_remove_from_parent(layer_to_insert);
+  layer_to_insert->next_sibling = above_sibling_layer->next_sibling;
+  above_sibling_layer->next_sibling = layer_to_insert;
+  layer_to_insert->parent = parent;
+  prv_set_window(layer_to_insert, parent->window);
+  shim_request_render();
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+  layer->hidden = hidden;
+  shim_request_render();
+}
+
+bool layer_get_hidden(const Layer *layer) {
+  return layer->hidden;
+}
+
+void layer_set_clips(Layer *layer, bool clips) {
+  layer->clips = clips;
+}
+
+bool layer_get_clips(const Layer *layer) {
+  return layer->clips;
+}
+
+void *layer_get_data(const Layer *layer) {
+  return layer->has_data ? (void *)layer->data : NULL;
+}
+
+void shim_layer_render_tree(Layer *layer, GContext *ctx, GPoint origin, GRect clip) {
+  if (layer->hidden) {
+    return;
+  }
+  if (layer->clips) {
+    GRect frame = GRect(origin.x, origin.y, layer->frame.size.w, layer->frame.size.h);
+    grect_clip(&clip, &frame);
+  }
+  if (grect_is_empty(&clip)) {
+    return;
+  }
+  GPoint content_origin = GPoint(origin.x + layer->bounds.origin.x, origin.y + layer->bounds.origin.y);
+  if (layer->update_proc) {
+    // Like the firmware, each layer starts from the drawing state its parent started with.
+    GContext saved = *ctx;
+    ctx->offset = content_origin;
+    ctx->clip = clip;
+    layer->update_proc(layer, ctx);
+    saved.draw_calls = ctx->draw_calls;
+    *ctx = saved;
+  }
+  for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+    GPoint child_origin = GPoint(content_origin.x + child->frame.origin.x, content_origin.y + child->frame.origin.y);
+    shim_layer_render_tree(child, ctx, child_origin, clip);
+  }
+}
+
+void pebble_shim_render_layer(Layer *layer, GContext *ctx) {
+  GRect clip = ctx->dest->bounds;
+  shim_layer_render_tree(layer, ctx, GPointZero, clip);
+}
+
+static void prv_set_window(Layer *layer, Window *window) {
+  layer->window = window;
+  for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+    prv_set_window(child, window);
+  }
+}
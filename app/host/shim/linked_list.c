@@ -0,0 +1,168 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The @rebble/linked-list package, reimplemented for host builds with the same behaviour: a singly linked list
+// whose root and nodes are allocated on the app's heap.
+
+#include "shim_internal.h"
+#include <@rebble/linked-list/linked-list.h>
+
+typedef struct LinkedNode {
+  void *object;
+  struct LinkedNode *next;
+} LinkedNode;
+
+struct LinkedRoot {
+  LinkedNode *head;
+};
+
+static LinkedNode *prv_create_node(void *object);
+static LinkedNode *prv_get_node(LinkedRoot *root, uint16_t index);
+
+LinkedRoot *linked_list_create_root(void) {
+  LinkedRoot *root = app_malloc(sizeof(LinkedRoot));
+  if (root) {
+    root->head = NULL;
+  }
+  return root;
+}
+
+uint16_t linked_list_count(LinkedRoot *root) {
+  uint16_t count = 0;
+  for (LinkedNode *node = root->head; node; node = node->next) {
+    ++count;
+  }
+  return count;
+}
+
+void linked_list_append(LinkedRoot *root, void *object) {
+  LinkedNode *node = prv_create_node(object);
+  if (!node) {
+    return;
+  }
+  if (!root->head) {
+    root->head = node;
+    return;
+  }
+  LinkedNode *last = root->head;
+  while (last->next) {
+    last = last->next;
+  }
+  last->next = node;
+}
+
+void linked_list_prepend(LinkedRoot *root, void *object) {
+  LinkedNode *node = prv_create_node(object);
+  if (!node) {
+    return;
+  }
+  node->next = root->head;
+  root->head = node;
+}
+
+void linked_list_insert(LinkedRoot *root, void *object, uint16_t after) {
+  LinkedNode *previous = prv_get_node(root, after);
+  if (!previous) {
+    linked_list_append(root, object);
+    return;
+  }
+  LinkedNode *node = prv_create_node(object);
+  if (!node) {
+    return;
+  }
+  node->next = previous->next;
+  previous->next = node;
+}
+
+void *linked_list_get(LinkedRoot *root, uint16_t index) {
+  LinkedNode *node = prv_get_node(root, index);
+  return node ? node->object : NULL;
+}
+
+void linked_list_remove(LinkedRoot *root, uint16_t index) {
+  LinkedNode **link = &root->head;
+  for (uint16_t i = 0; *link && i < index; ++i) {
+    link = &(*link)->next;
+  }
+  LinkedNode *node = *link;
+  if (node) {
+    *link = node->next;
+    app_free(node);
+  }
+}
+
+void linked_list_clear(LinkedRoot *root) {
+  LinkedNode *node = root->head;
+  while (node) {
+    LinkedNode *next = node->next;
+    app_free(node);
+    node = next;
+  }
+  root->head = NULL;
+}
+
+bool linked_list_contains(LinkedRoot *root, void *object) {
+  return linked_list_find(root, object) >= 0;
+}
+
+int16_t linked_list_find(LinkedRoot *root, void *object) {
+  int16_t index = 0;
+  for (LinkedNode *node = root->head; node; node = node->next, ++index) {
+    if (node->object == object) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+int16_t linked_list_find_compare(LinkedRoot *root, void *object, LinkedListCompare compare) {
+  int16_t index = 0;
+  for (LinkedNode *node = root->head; node; node = node->next, ++index) {
+    if (compare(node->object, object)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+void linked_list_foreach(LinkedRoot *root, LinkedListForEach callback, void *context) {
+  LinkedNode *node = root->head;
+  while (node) {
+    // The callback may remove the node it's given.
+    LinkedNode *next = node->next;
+    if (!callback(node->object, context)) {
+      return;
+    }
+    node = next;
+  }
+}
+
+static LinkedNode *prv_create_node(void *object) {
+  LinkedNode *node = app_malloc(sizeof(LinkedNode));
+  if (node) {
+    node->object = object;
+    node->next = NULL;
+  }
+  return node;
+}
+
+static LinkedNode *prv_get_node(LinkedRoot *root, uint16_t index) {
+  LinkedNode *node = root->head;
+  for (uint16_t i = 0; node && i < index; ++i) {
+    node = node->next;
+  }
+  return node;
+}
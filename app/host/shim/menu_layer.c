@@ -0,0 +1,506 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// MenuLayer and SimpleMenuLayer. Rows are drawn straight from the callbacks each frame, through one cell layer that
+// is moved from row to row; the selection scrolls into view immediately.
+
+#include "shim_internal.h"
+
+#define MENU_CELL_DEFAULT_HEIGHT 44
+#define MENU_CELL_BASIC_HEADER_HEIGHT 16
+#define MENU_CELL_ICON_MARGIN 4
+
+struct MenuLayer {
+  Layer layer;
+  MenuLayerCallbacks callbacks;
+  void *context;
+  MenuIndex selected;
+  int16_t scroll_offset;
+  GColor normal_background;
+  GColor normal_foreground;
+  GColor highlight_background;
+  GColor highlight_foreground;
+};
+
+struct SimpleMenuLayer {
+  MenuLayer *menu_layer;
+  const SimpleMenuSection *sections;
+  int32_t num_sections;
+  void *context;
+};
+
+// What menu_cell_layer_is_highlighted() needs to know about the cell being drawn.
+static Layer s_cell_layer;
+static bool s_cell_highlighted;
+
+typedef bool (*RowVisitor)(MenuLayer *menu_layer, MenuIndex index, GRect cell, void *context);
+typedef bool (*HeaderVisitor)(MenuLayer *menu_layer, uint16_t section, GRect header, void *context);
+
+static uint16_t prv_num_sections(MenuLayer *menu_layer);
+static uint16_t prv_num_rows(MenuLayer *menu_layer, uint16_t section);
+static int16_t prv_row_height(MenuLayer *menu_layer, MenuIndex index);
+static int16_t prv_header_height(MenuLayer *menu_layer, uint16_t section);
+static int16_t prv_separator_height(MenuLayer *menu_layer, MenuIndex index);
+static int16_t prv_walk(MenuLayer *menu_layer, RowVisitor row_visitor, HeaderVisitor header_visitor, void *context);
+static GRect prv_row_rect(MenuLayer *menu_layer, MenuIndex index);
+static void prv_scroll_to_selection(MenuLayer *menu_layer);
+static void prv_update(Layer *layer, GContext *ctx);
+static void prv_click_config_provider(void *context);
+static void prv_up_click(ClickRecognizerRef recognizer, void *context);
+static void prv_down_click(ClickRecognizerRef recognizer, void *context);
+static void prv_select_click(ClickRecognizerRef recognizer, void *context);
+static void prv_select_long_click(ClickRecognizerRef recognizer, void *context);
+
+MenuLayer *menu_layer_create(GRect frame) {
+  MenuLayer *menu_layer = app_zalloc(sizeof(MenuLayer));
+  if (!menu_layer) {
+    return NULL;
+  }
+  layer_init(&menu_layer->layer, frame);
+  menu_layer->layer.update_proc = prv_update;
+  menu_layer->normal_background = GColorWhite;
+  menu_layer->normal_foreground = GColorBlack;
+  menu_layer->highlight_background = GColorBlack;
+  menu_layer->highlight_foreground = GColorWhite;
+  return menu_layer;
+}
+
+void menu_layer_destroy(MenuLayer *menu_layer) {
+  if (!menu_layer) {
+    return;
+  }
+  layer_deinit(&menu_layer->layer);
+  app_free(menu_layer);
+}
+
+Layer *menu_layer_get_layer(const MenuLayer *menu_layer) {
+  return (Layer *)&menu_layer->layer;
+}
+
+void menu_layer_set_callbacks(MenuLayer *menu_layer, void *callback_context, MenuLayerCallbacks callbacks) {
+  menu_layer->callbacks = callbacks;
+  menu_layer->context = callback_context;
+  menu_layer_reload_data(menu_layer);
+}
+
+void menu_layer_set_click_config_onto_window(MenuLayer *menu_layer, Window *window) {
+  window_set_click_config_provider_with_context(window, prv_click_config_provider, menu_layer);
+}
+
+void menu_layer_set_selected_next(MenuLayer *menu_layer, bool up, MenuRowAlign scroll_align, bool animated) {
+  MenuIndex index = menu_layer->selected;
+  if (up) {
+    while (index.row == 0) {
+      if (index.section == 0) {
+        return;
+      }
+      --index.section;
+      index.row = prv_num_rows(menu_layer, index.section);
+    }
+    --index.row;
+  } else {
+    ++index.row;
+    while (index.row >= prv_num_rows(menu_layer, index.section)) {
+      if (index.section + 1 >= prv_num_sections(menu_layer)) {
+        return;
+      }
+      ++index.section;
+      index.row = 0;
+    }
+  }
+  menu_layer_set_selected_index(menu_layer, index, scroll_align, animated);
+}
+
+void menu_layer_set_selected_index(MenuLayer *menu_layer, MenuIndex index, MenuRowAlign scroll_align,
+                                   bool animated) {
+  const MenuIndex old_index = menu_layer->selected;
+  if (menu_layer->callbacks.selection_will_change) {
+    menu_layer->callbacks.selection_will_change(menu_layer, &index, old_index, menu_layer->context);
+  }
+  if (index.section >= prv_num_sections(menu_layer) || index.row >= prv_num_rows(menu_layer, index.section)) {
+    return;
+  }
+  menu_layer->selected = index;
+  prv_scroll_to_selection(menu_layer);
+  layer_mark_dirty(&menu_layer->layer);
+  if (menu_layer->callbacks.selection_changed && (index.section != old_index.section || index.row != old_index.row)) {
+    menu_layer->callbacks.selection_changed(menu_layer, index, old_index, menu_layer->context);
+  }
+}
+
+MenuIndex menu_layer_get_selected_index(const MenuLayer *menu_layer) {
+  return menu_layer->selected;
+}
+
+void menu_layer_reload_data(MenuLayer *menu_layer) {
+  // Keep the selection if it still exists, otherwise move it to the last row there is.
+  const uint16_t num_sections = prv_num_sections(menu_layer);
+  MenuIndex index = menu_layer->selected;
+  if (index.section >= num_sections) {
+    index.section = num_sections > 0 ? num_sections - 1 : 0;
+    index.row = UINT16_MAX;
+  }
+  const uint16_t num_rows = num_sections > 0 ? prv_num_rows(menu_layer, index.section) : 0;
+  if (index.row >= num_rows) {
+    index.row = num_rows > 0 ? num_rows - 1 : 0;
+  }
+  menu_layer->selected = index;
+  prv_scroll_to_selection(menu_layer);
+  layer_mark_dirty(&menu_layer->layer);
+}
+
+void menu_layer_set_normal_colors(MenuLayer *menu_layer, GColor background, GColor foreground) {
+  menu_layer->normal_background = background;
+  menu_layer->normal_foreground = foreground;
+  layer_mark_dirty(&menu_layer->layer);
+}
+
+void menu_layer_set_highlight_colors(MenuLayer *menu_layer, GColor background, GColor foreground) {
+  menu_layer->highlight_background = background;
+  menu_layer->highlight_foreground = foreground;
+  layer_mark_dirty(&menu_layer->layer);
+}
+
+bool menu_cell_layer_is_highlighted(const Layer *cell_layer) {
+  return cell_layer == &s_cell_layer && s_cell_highlighted;
+}
+
+void menu_cell_basic_draw(GContext *ctx, const Layer *cell_layer, const char *title, const char *subtitle,
+                          GBitmap *icon) {
+  GRect bounds = cell_layer->bounds;
+  int16_t text_x = MENU_CELL_ICON_MARGIN;
+  if (icon) {
+    GRect icon_rect = (GRect) { .size = gbitmap_get_bounds(icon).size };
+    GRect icon_area = GRect(MENU_CELL_ICON_MARGIN, 0, icon_rect.size.w, bounds.size.h);
+    grect_align(&icon_rect, &icon_area, GAlignLeft, false);
+    graphics_context_set_compositing_mode(ctx, GCompOpSet);
+    graphics_draw_bitmap_in_rect(ctx, icon, icon_rect);
+    text_x += icon_rect.size.w + MENU_CELL_ICON_MARGIN;
+  }
+  const GFont title_font = fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD);
+  const GFont subtitle_font = fonts_get_system_font(FONT_KEY_GOTHIC_18);
+  const int16_t title_height = title_font->line_height;
+  const int16_t subtitle_height = subtitle ? subtitle_font->line_height : 0;
+  int16_t y = (bounds.size.h - title_height - subtitle_height) / 2 - 4;
+  const int16_t width = bounds.size.w - text_x - MENU_CELL_ICON_MARGIN;
+  if (title) {
+    graphics_draw_text(ctx, title, title_font, GRect(text_x, y, width, title_height), GTextOverflowModeFill,
+                       GTextAlignmentLeft, NULL);
+  }
+  y += title_height;
+  if (subtitle) {
+    graphics_draw_text(ctx, subtitle, subtitle_font, GRect(text_x, y, width, subtitle_height), GTextOverflowModeFill,
+                       GTextAlignmentLeft, NULL);
+  }
+}
+
+void menu_cell_title_draw(GContext *ctx, const Layer *cell_layer, const char *title) {
+  menu_cell_basic_draw(ctx, cell_layer, title, NULL, NULL);
+}
+
+void menu_cell_basic_header_draw(GContext *ctx, const Layer *cell_layer, const char *title) {
+  GRect bounds = cell_layer->bounds;
+  graphics_draw_text(ctx, title, fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD),
+                     GRect(MENU_CELL_ICON_MARGIN, -2, bounds.size.w - 2 * MENU_CELL_ICON_MARGIN, bounds.size.h + 2),
+                     GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+}
+
+static uint16_t prv_num_sections(MenuLayer *menu_layer) {
+  if (menu_layer->callbacks.get_num_sections) {
+    return menu_layer->callbacks.get_num_sections(menu_layer, menu_layer->context);
+  }
+  return 1;
+}
+
+static uint16_t prv_num_rows(MenuLayer *menu_layer, uint16_t section) {
+  if (menu_layer->callbacks.get_num_rows) {
+    return menu_layer->callbacks.get_num_rows(menu_layer, section, menu_layer->context);
+  }
+  return 0;
+}
+
+static int16_t prv_row_height(MenuLayer *menu_layer, MenuIndex index) {
+  if (menu_layer->callbacks.get_cell_height) {
+    return menu_layer->callbacks.get_cell_height(menu_layer, &index, menu_layer->context);
+  }
+  return MENU_CELL_DEFAULT_HEIGHT;
+}
+
+static int16_t prv_header_height(MenuLayer *menu_layer, uint16_t section) {
+  if (menu_layer->callbacks.get_header_height) {
+    return menu_layer->callbacks.get_header_height(menu_layer, section, menu_layer->context);
+  }
+  return 0;
+}
+
+static int16_t prv_separator_height(MenuLayer *menu_layer, MenuIndex index) {
+  if (menu_layer->callbacks.get_separator_height) {
+    return menu_layer->callbacks.get_separator_height(menu_layer, &index, menu_layer->context);
+  }
+  return 0;
+}
+
+// Calls the visitors for every header and row in order, with their rects in content coordinates, until one returns
+// false. Returns the height of everything visited.
+static int16_t prv_walk(MenuLayer *menu_layer, RowVisitor row_visitor, HeaderVisitor header_visitor, void *context) {
+  const int16_t width = menu_layer->layer.bounds.size.w;
+  int16_t y = 0;
+  const uint16_t num_sections = prv_num_sections(menu_layer);
+  for (uint16_t section = 0; section < num_sections; ++section) {
+    const int16_t header_height = prv_header_height(menu_layer, section);
+    if (header_height > 0) {
+      if (header_visitor && !header_visitor(menu_layer, section, GRect(0, y, width, header_height), context)) {
+        return y;
+      }
+      y += header_height;
+    }
+    const uint16_t num_rows = prv_num_rows(menu_layer, section);
+    for (uint16_t row = 0; row < num_rows; ++row) {
+      const MenuIndex index = MenuIndex(section, row);
+      const int16_t height = prv_row_height(menu_layer, index);
+      if (row_visitor && !row_visitor(menu_layer, index, GRect(0, y, width, height), context)) {
+        return y;
+      }
+      y += height + prv_separator_height(menu_layer, index);
+    }
+  }
+  return y;
+}
+
+typedef struct {
+  MenuIndex index;
+  GRect rect;
+} RowSearch;
+
+static bool prv_find_row(MenuLayer *menu_layer, MenuIndex index, GRect cell, void *context) {
+  RowSearch *search = context;
+  if (index.section == search->index.section && index.row == search->index.row) {
+    search->rect = cell;
+    return false;
+  }
+  return true;
+}
+
+static GRect prv_row_rect(MenuLayer *menu_layer, MenuIndex index) {
+  RowSearch search = { .index = index };
+  prv_walk(menu_layer, prv_find_row, NULL, &search);
+  return search.rect;
+}
+
+static void prv_scroll_to_selection(MenuLayer *menu_layer) {
+  const GRect row = prv_row_rect(menu_layer, menu_layer->selected);
+  const int16_t visible_height = menu_layer->layer.bounds.size.h;
+  if (row.origin.y < menu_layer->scroll_offset) {
+    menu_layer->scroll_offset = row.origin.y;
+  } else if (row.origin.y + row.size.h > menu_layer->scroll_offset + visible_height) {
+    menu_layer->scroll_offset = row.origin.y + row.size.h - visible_height;
+  }
+  // The first header stays in view while the first row is selected.
+  if (menu_layer->selected.section == 0 && menu_layer->selected.row == 0) {
+    menu_layer->scroll_offset = 0;
+  }
+}
+
+typedef struct {
+  GContext *ctx;
+  GPoint origin;
+  GRect clip;
+} DrawState;
+
+static bool prv_begin_cell(MenuLayer *menu_layer, GRect cell, DrawState *state, bool highlighted) {
+  cell.origin.y -= menu_layer->scroll_offset;
+  if (cell.origin.y >= menu_layer->layer.bounds.size.h) {
+    return false;
+  }
+  GContext *ctx = state->ctx;
+  GRect screen_cell = GRect(state->origin.x + cell.origin.x, state->origin.y + cell.origin.y, cell.size.w,
+                            cell.size.h);
+  grect_clip(&screen_cell, &state->clip);
+  ctx->offset = GPoint(state->origin.x + cell.origin.x, state->origin.y + cell.origin.y);
+  ctx->clip = screen_cell;
+  layer_init(&s_cell_layer, GRect(cell.origin.x, cell.origin.y, cell.size.w, cell.size.h));
+  s_cell_highlighted = highlighted;
+  const GColor background = highlighted ? menu_layer->highlight_background : menu_layer->normal_background;
+  const GColor foreground = highlighted ? menu_layer->highlight_foreground : menu_layer->normal_foreground;
+  shim_graphics_fill_rect_color(ctx, s_cell_layer.bounds, background);
+  graphics_context_set_fill_color(ctx, foreground);
+  graphics_context_set_stroke_color(ctx, foreground);
+  graphics_context_set_text_color(ctx, foreground);
+  return true;
+}
+
+static bool prv_draw_header(MenuLayer *menu_layer, uint16_t section, GRect header, void *context) {
+  DrawState *state = context;
+  if (header.origin.y + header.size.h <= menu_layer->scroll_offset) {
+    return true;
+  }
+  if (!prv_begin_cell(menu_layer, header, state, false)) {
+    return false;
+  }
+  if (menu_layer->callbacks.draw_header) {
+    menu_layer->callbacks.draw_header(state->ctx, &s_cell_layer, section, menu_layer->context);
+  }
+  return true;
+}
+
+static bool prv_draw_row(MenuLayer *menu_layer, MenuIndex index, GRect cell, void *context) {
+  DrawState *state = context;
+  if (cell.origin.y + cell.size.h <= menu_layer->scroll_offset) {
+    return true;
+  }
+  const bool highlighted = index.section == menu_layer->selected.section && index.row == menu_layer->selected.row;
+  if (!prv_begin_cell(menu_layer, cell, state, highlighted)) {
+    return false;
+  }
+  if (menu_layer->callbacks.draw_row) {
+    menu_layer->callbacks.draw_row(state->ctx, &s_cell_layer, &index, menu_layer->context);
+  }
+  return true;
+}
+
+static void prv_update(Layer *layer, GContext *ctx) {
+  MenuLayer *menu_layer = (MenuLayer *)layer;
+  shim_graphics_fill_rect_color(ctx, layer->bounds, menu_layer->normal_background);
+  GContext saved = *ctx;
+  DrawState state = {
+    .ctx = ctx,
+    .origin = ctx->offset,
+    .clip = ctx->clip,
+  };
+  prv_walk(menu_layer, prv_draw_row, prv_draw_header, &state);
+  saved.draw_calls = ctx->draw_calls;
+  *ctx = saved;
+  s_cell_highlighted = false;
+}
+
+static void prv_click_config_provider(void *context) {
+  window_single_repeating_click_subscribe(BUTTON_ID_UP, 100, prv_up_click);
+  window_single_repeating_click_subscribe(BUTTON_ID_DOWN, 100, prv_down_click);
+  window_single_click_subscribe(BUTTON_ID_SELECT, prv_select_click);
+  window_long_click_subscribe(BUTTON_ID_SELECT, 0, prv_select_long_click, NULL);
+}
+
+static void prv_up_click(ClickRecognizerRef recognizer, void *context) {
+  menu_layer_set_selected_next(context, true, MenuRowAlignCenter, true);
+}
+
+static void prv_down_click(ClickRecognizerRef recognizer, void *context) {
+  menu_layer_set_selected_next(context, false, MenuRowAlignCenter, true);
+}
+
+static void prv_select_click(ClickRecognizerRef recognizer, void *context) {
+  MenuLayer *menu_layer = context;
+  if (menu_layer->callbacks.select_click) {
+    menu_layer->callbacks.select_click(menu_layer, &menu_layer->selected, menu_layer->context);
+  }
+}
+
+static void prv_select_long_click(ClickRecognizerRef recognizer, void *context) {
+  MenuLayer *menu_layer = context;
+  if (menu_layer->callbacks.select_long_click) {
+    menu_layer->callbacks.select_long_click(menu_layer, &menu_layer->selected, menu_layer->context);
+  } else {
+    prv_select_click(recognizer, context);
+  }
+}
+
+//
+// SimpleMenuLayer
+//
+
+static uint16_t prv_simple_num_sections(MenuLayer *menu_layer, void *context) {
+  SimpleMenuLayer *simple_menu = context;
+  return simple_menu->num_sections;
+}
+
+static uint16_t prv_simple_num_rows(MenuLayer *menu_layer, uint16_t section, void *context) {
+  SimpleMenuLayer *simple_menu = context;
+  return simple_menu->sections[section].num_items;
+}
+
+static int16_t prv_simple_header_height(MenuLayer *menu_layer, uint16_t section, void *context) {
+  SimpleMenuLayer *simple_menu = context;
+  return simple_menu->sections[section].title ? MENU_CELL_BASIC_HEADER_HEIGHT : 0;
+}
+
+static void prv_simple_draw_header(GContext *ctx, const Layer *cell_layer, uint16_t section, void *context) {
+  SimpleMenuLayer *simple_menu = context;
+  menu_cell_basic_header_draw(ctx, cell_layer, simple_menu->sections[section].title);
+}
+
+static void prv_simple_draw_row(GContext *ctx, const Layer *cell_layer, MenuIndex *index, void *context) {
+  SimpleMenuLayer *simple_menu = context;
+  const SimpleMenuItem *item = &simple_menu->sections[index->section].items[index->row];
+  menu_cell_basic_draw(ctx, cell_layer, item->title, item->subtitle, item->icon);
+}
+
+static void prv_simple_select(MenuLayer *menu_layer, MenuIndex *index, void *context) {
+  SimpleMenuLayer *simple_menu = context;
+  const SimpleMenuItem *item = &simple_menu->sections[index->section].items[index->row];
+  if (item->callback) {
+    item->callback(index->row, simple_menu->context);
+  }
+}
+
+SimpleMenuLayer *simple_menu_layer_create(GRect frame, Window *window, const SimpleMenuSection *sections,
+                                          int32_t num_sections, void *callback_context) {
+  SimpleMenuLayer *simple_menu = app_zalloc(sizeof(SimpleMenuLayer));
+  if (!simple_menu) {
+    return NULL;
+  }
+  simple_menu->menu_layer = menu_layer_create(frame);
+  if (!simple_menu->menu_layer) {
+    app_free(simple_menu);
+    return NULL;
+  }
+  simple_menu->sections = sections;
+  simple_menu->num_sections = num_sections;
+  simple_menu->context = callback_context;
+  menu_layer_set_callbacks(simple_menu->menu_layer, simple_menu, (MenuLayerCallbacks) {
+    .get_num_sections = prv_simple_num_sections,
+    .get_num_rows = prv_simple_num_rows,
+    .get_header_height = prv_simple_header_height,
+    .draw_header = prv_simple_draw_header,
+    .draw_row = prv_simple_draw_row,
+    .select_click = prv_simple_select,
+  });
+  menu_layer_set_click_config_onto_window(simple_menu->menu_layer, window);
+  return simple_menu;
+}
+
+void simple_menu_layer_destroy(SimpleMenuLayer *simple_menu) {
+  if (!simple_menu) {
+    return;
+  }
+  menu_layer_destroy(simple_menu->menu_layer);
+  app_free(simple_menu);
+}
+
+Layer *simple_menu_layer_get_layer(const SimpleMenuLayer *simple_menu) {
+  return menu_layer_get_layer(simple_menu->menu_layer);
+}
+
+int simple_menu_layer_get_selected_index(const SimpleMenuLayer *simple_menu) {
+  return menu_layer_get_selected_index(simple_menu->menu_layer).row;
+}
+
+void simple_menu_layer_set_selected_index(SimpleMenuLayer *simple_menu, int32_t index, bool animated) {
+  menu_layer_set_selected_index(simple_menu->menu_layer, MenuIndex(0, index), MenuRowAlignCenter, animated);
+}
+
+MenuLayer *simple_menu_layer_get_menu_layer(SimpleMenuLayer *simple_menu) {
+  return simple_menu->menu_layer;
+}
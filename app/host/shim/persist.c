@@ -0,0 +1,133 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Persistent storage that lasts as long as the process does.
+
+#include "shim_internal.h"
+
+#define MAX_PERSIST_KEYS 256
+
+typedef struct {
+  bool used;
+  uint32_t key;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+static PersistEntry s_entries[MAX_PERSIST_KEYS];
+
+static PersistEntry *prv_find(uint32_t key);
+static int prv_write(uint32_t key, const void *data, size_t size);
+
+void shim_persist_reset(void) {
+  memset(s_entries, 0, sizeof(s_entries));
+}
+
+bool persist_exists(const uint32_t key) {
+  return prv_find(key) != NULL;
+}
+
+int persist_get_size(const uint32_t key) {
+  PersistEntry *entry = prv_find(key);
+  return entry ? entry->size : E_DOES_NOT_EXIST;
+}
+
+bool persist_read_bool(const uint32_t key) {
+  bool value = false;
+  persist_read_data(key, &value, sizeof(value));
+  return value;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+  int32_t value = 0;
+  persist_read_data(key, &value, sizeof(value));
+  return value;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+  PersistEntry *entry = prv_find(key);
+  if (!entry) {
+    return E_DOES_NOT_EXIST;
+  }
+  const size_t size = MIN(buffer_size, entry->size);
+  memcpy(buffer, entry->data, size);
+  return size;
+}
+
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size) {
+  if (buffer_size == 0) {
+    return E_INVALID_ARGUMENT;
+  }
+  const int read = persist_read_data(key, buffer, buffer_size);
+  if (read < 0) {
+    return read;
+  }
+  buffer[MIN((size_t)read, buffer_size - 1)] = '\0';
+  return read;
+}
+
+status_t persist_write_bool(const uint32_t key, const bool value) {
+  return prv_write(key, &value, sizeof(value));
+}
+
+status_t persist_write_int(const uint32_t key, const int32_t value) {
+  return prv_write(key, &value, sizeof(value));
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+  return prv_write(key, data, size);
+}
+
+int persist_write_string(const uint32_t key, const char *cstring) {
+  return prv_write(key, cstring, strlen(cstring) + 1);
+}
+
+status_t persist_delete(const uint32_t key) {
+  PersistEntry *entry = prv_find(key);
+  if (!entry) {
+    return E_DOES_NOT_EXIST;
+  }
+  entry->used = false;
+  return S_SUCCESS;
+}
+
+static PersistEntry *prv_find(uint32_t key) {
+  for (int i = 0; i < MAX_PERSIST_KEYS; ++i) {
+    if (s_entries[i].used && s_entries[i].key == key) {
+      return &s_entries[i];
+    }
+  }
+  return NULL;
+}
+
+static int prv_write(uint32_t key, const void *data, size_t size) {
+  // Like the firmware, anything past the maximum is silently dropped.
+  size = MIN(size, PERSIST_DATA_MAX_LENGTH);
+  PersistEntry *entry = prv_find(key);
+  for (int i = 0; !entry && i < MAX_PERSIST_KEYS; ++i) {
+    if (!s_entries[i].used) {
+      entry = &s_entries[i];
+    }
+  }
+  if (!entry) {
+    return E_OUT_OF_STORAGE;
+  }
+  entry->used = true;
+  entry->key = key;
+  entry->size = size;
+  memcpy(entry->data, data, size);
+  return size;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Resources come straight from app/resources. On a watch they're in flash, not on the heap, so the shim keeps them
+// in host memory and only what the app loads from them counts against its heap.
+
+#include "shim_internal.h"
+
+struct ResourceEntry {
+  uint32_t id;
+  bool loaded;
+  uint8_t *data;
+  size_t size;
+};
+
+static struct ResourceEntry *s_entries;
+
+static struct ResourceEntry *prv_get_entry(uint32_t resource_id);
+
+void shim_resources_init(void) {
+  if (!s_entries) {
+    s_entries = calloc(g_shim_resource_count, sizeof(struct ResourceEntry));
+    for (uint32_t i = 0; i < g_shim_resource_count; ++i) {
+      s_entries[i].id = i;
+    }
+  }
+}
+
+void shim_resources_deinit(void) {
+  if (!s_entries) {
+    return;
+  }
+  for (uint32_t i = 0; i < g_shim_resource_count; ++i) {
+    free(s_entries[i].data);
+  }
+  free(s_entries);
+  s_entries = NULL;
+}
+
+const uint8_t *shim_resource_data(uint32_t resource_id, size_t *size) {
+  struct ResourceEntry *entry = prv_get_entry(resource_id);
+  if (!entry) {
+    return NULL;
+  }
+  *size = entry->size;
+  return entry->data;
+}
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+  return prv_get_entry(resource_id);
+}
+
+size_t resource_size(ResHandle h) {
+  return h ? h->size : 0;
+}
+
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length) {
+  return resource_load_byte_range(h, 0, buffer, max_length);
+}
+
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes) {
+  if (!h || start_offset >= h->size) {
+    return 0;
+  }
+  const size_t length = MIN(num_bytes, h->size - start_offset);
+  memcpy(buffer, h->data + start_offset, length);
+  return length;
+}
+
+static struct ResourceEntry *prv_get_entry(uint32_t resource_id) {
+  if (!s_entries || resource_id == 0 || resource_id >= g_shim_resource_count) {
+    return NULL;
+  }
+  struct ResourceEntry *entry = &s_entries[resource_id];
+  if (!entry->loaded) {
+    entry->loaded = true;
+    FILE *file = fopen(g_shim_resource_files[resource_id], "rb");
+    if (!file) {
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Can't open resource %u: %s", resource_id, g_shim_resource_files[resource_id]);
+      return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    entry->size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    entry->data = malloc(entry->size);
+    if (fread(entry->data, 1, entry->size, file) != entry->size) {
+      entry->size = 0;
+    }
+    fclose(file);
+  }
+  return entry->data ? entry : NULL;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+static GBitmap *s_framebuffer;
+static GContext s_screen_context;
+static int s_render_count;
+static PebbleShimRenderHandler s_render_handler;
+static void *s_render_handler_context;
+
+void shim_screen_init(void) {
+  if (!s_framebuffer) {
+    s_framebuffer = shim_gbitmap_create(GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT), GBitmapFormat8Bit, false);
+  }
+  memset(s_framebuffer->addr, GColorBlackARGB8, s_framebuffer->row_size_bytes * PBL_DISPLAY_HEIGHT);
+  shim_graphics_context_init(&s_screen_context, s_framebuffer);
+  s_render_count = 0;
+  s_render_handler = NULL;
+  s_render_handler_context = NULL;
+}
+
+void shim_screen_deinit(void) {
+  if (s_framebuffer) {
+    free(s_framebuffer->owned_data);
+    free(s_framebuffer);
+    s_framebuffer = NULL;
+  }
+}
+
+GBitmap *pebble_shim_framebuffer(void) {
+  return s_framebuffer;
+}
+
+void pebble_shim_render(void) {
+  Window *window = window_stack_get_top_window();
+  if (!window) {
+    return;
+  }
+  shim_graphics_context_init(&s_screen_context, s_framebuffer);
+  shim_graphics_fill_rect_color(&s_screen_context, s_framebuffer->bounds, window->background_color);
+  shim_layer_render_tree(&window->root_layer, &s_screen_context, GPointZero, s_framebuffer->bounds);
+  ++s_render_count;
+  if (s_render_handler) {
+    s_render_handler(s_render_handler_context);
+  }
+}
+
+int pebble_shim_render_count(void) {
+  return s_render_count;
+}
+
+void pebble_shim_set_render_handler(PebbleShimRenderHandler handler, void *context) {
+  s_render_handler = handler;
+  s_render_handler_context = context;
+}
+
+bool pebble_shim_write_ppm(const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+  const GRect bounds = s_framebuffer->bounds;
+  fprintf(file, "P6\n%d %d\n255\n", bounds.size.w, bounds.size.h);
+  for (int y = 0; y < bounds.size.h; ++y) {
+    const uint8_t *row = s_framebuffer->addr + y * s_framebuffer->row_size_bytes;
+    for (int x = 0; x < bounds.size.w; ++x) {
+      GColor color = (GColor){.argb = row[x]};
+      // Each two-bit channel spreads evenly over 0-255.
+      uint8_t rgb[3] = { color.r * 85, color.g * 85, color.b * 85 };
+      fwrite(rgb, 1, sizeof(rgb), file);
+    }
+  }
+  return fclose(file) == 0;
+}
+
+GContext *pebble_shim_graphics_context_create(GBitmap *bitmap) {
+  GContext *ctx = malloc(sizeof(GContext));
+  shim_graphics_context_init(ctx, bitmap);
+  return ctx;
+}
+
+void pebble_shim_graphics_context_destroy(GContext *ctx) {
+  free(ctx);
+}
+
+uint32_t pebble_shim_graphics_context_draw_calls(const GContext *ctx) {
+  return ctx->draw_calls;
+}
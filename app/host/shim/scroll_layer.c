@@ -0,0 +1,273 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// ScrollLayer and the ContentIndicator that comes with it. Scrolling is immediate; there's no animation and no
+// shadow.
+
+#include "shim_internal.h"
+
+// How far one press of up or down moves the content.
+#define SCROLL_STEP 40
+#define CONTENT_INDICATOR_ARROW_HEIGHT 6
+
+typedef struct {
+  bool configured;
+  bool available;
+  ContentIndicatorConfig config;
+  // The indicator takes over its layer's drawing while there's content that way, and gives it back after.
+  LayerUpdateProc original_update_proc;
+} ContentIndicatorDirectionState;
+
+struct ContentIndicator {
+  ContentIndicatorDirectionState directions[NumContentIndicatorDirections];
+};
+
+struct ScrollLayer {
+  Layer layer;
+  Layer content_layer;
+  ScrollLayerCallbacks callbacks;
+  void *context;
+  bool shadow_hidden;
+  ContentIndicator content_indicator;
+};
+
+static void prv_click_config_provider(void *context);
+static void prv_update_content_indicator(ScrollLayer *scroll_layer);
+static void prv_draw_arrow(Layer *layer, GContext *ctx, ContentIndicatorDirection direction);
+static void prv_draw_up_arrow(Layer *layer, GContext *ctx);
+static void prv_draw_down_arrow(Layer *layer, GContext *ctx);
+
+// Indicators that have taken over a layer, so the arrow drawing can find its colours from the layer alone.
+static ContentIndicator *s_drawing_indicators[16];
+
+ScrollLayer *scroll_layer_create(GRect frame) {
+  ScrollLayer *scroll_layer = app_zalloc(sizeof(ScrollLayer));
+  if (!scroll_layer) {
+    return NULL;
+  }
+  layer_init(&scroll_layer->layer, frame);
+  layer_init(&scroll_layer->content_layer, GRect(0, 0, frame.size.w, frame.size.h));
+  layer_add_child(&scroll_layer->layer, &scroll_layer->content_layer);
+  scroll_layer->context = scroll_layer;
+  return scroll_layer;
+}
+
+void scroll_layer_destroy(ScrollLayer *scroll_layer) {
+  if (!scroll_layer) {
+    return;
+  }
+  for (int i = 0; i < NumContentIndicatorDirections; ++i) {
+    content_indicator_set_content_available(&scroll_layer->content_indicator, i, false);
+  }
+  layer_deinit(&scroll_layer->content_layer);
+  layer_deinit(&scroll_layer->layer);
+  app_free(scroll_layer);
+}
+
+Layer *scroll_layer_get_layer(const ScrollLayer *scroll_layer) {
+  return (Layer *)&scroll_layer->layer;
+}
+
+void scroll_layer_add_child(ScrollLayer *scroll_layer, Layer *child) {
+  layer_add_child(&scroll_layer->content_layer, child);
+}
+
+void scroll_layer_set_click_config_onto_window(ScrollLayer *scroll_layer, Window *window) {
+  window_set_click_config_provider_with_context(window, prv_click_config_provider, scroll_layer);
+}
+
+void scroll_layer_set_callbacks(ScrollLayer *scroll_layer, ScrollLayerCallbacks callbacks) {
+  scroll_layer->callbacks = callbacks;
+}
+
+void scroll_layer_set_context(ScrollLayer *scroll_layer, void *context) {
+  scroll_layer->context = context;
+}
+
+void scroll_layer_set_content_offset(ScrollLayer *scroll_layer, GPoint offset, bool animated) {
+  const GSize content_size = scroll_layer->content_layer.frame.size;
+  const GSize frame_size = scroll_layer->layer.frame.size;
+  offset.y = MAX(offset.y, MIN(0, frame_size.h - content_size.h));
+  offset.y = MIN(offset.y, 0);
+  offset.x = MAX(offset.x, MIN(0, frame_size.w - content_size.w));
+  offset.x = MIN(offset.x, 0);
+  if (gpoint_equal(&offset, &scroll_layer->content_layer.frame.origin)) {
+    return;
+  }
+  scroll_layer->content_layer.frame.origin = offset;
+  prv_update_content_indicator(scroll_layer);
+  layer_mark_dirty(&scroll_layer->layer);
+  if (scroll_layer->callbacks.content_offset_changed_handler) {
+    scroll_layer->callbacks.content_offset_changed_handler(scroll_layer, scroll_layer->context);
+  }
+}
+
+GPoint scroll_layer_get_content_offset(ScrollLayer *scroll_layer) {
+  return scroll_layer->content_layer.frame.origin;
+}
+
+void scroll_layer_set_content_size(ScrollLayer *scroll_layer, GSize size) {
+  GRect frame = scroll_layer->content_layer.frame;
+  frame.size = size;
+  layer_set_frame(&scroll_layer->content_layer, frame);
+  // Shrinking the content can leave the offset past its end.
+  scroll_layer_set_content_offset(scroll_layer, frame.origin, false);
+  prv_update_content_indicator(scroll_layer);
+}
+
+GSize scroll_layer_get_content_size(const ScrollLayer *scroll_layer) {
+  return scroll_layer->content_layer.frame.size;
+}
+
+void scroll_layer_scroll_up_click_handler(ClickRecognizerRef recognizer, void *context) {
+  ScrollLayer *scroll_layer = context;
+  GPoint offset = scroll_layer_get_content_offset(scroll_layer);
+  offset.y += SCROLL_STEP;
+  scroll_layer_set_content_offset(scroll_layer, offset, true);
+}
+
+void scroll_layer_scroll_down_click_handler(ClickRecognizerRef recognizer, void *context) {
+  ScrollLayer *scroll_layer = context;
+  GPoint offset = scroll_layer_get_content_offset(scroll_layer);
+  offset.y -= SCROLL_STEP;
+  scroll_layer_set_content_offset(scroll_layer, offset, true);
+}
+
+void scroll_layer_set_shadow_hidden(ScrollLayer *scroll_layer, bool hidden) {
+  scroll_layer->shadow_hidden = hidden;
+}
+
+bool scroll_layer_get_shadow_hidden(const ScrollLayer *scroll_layer) {
+  return scroll_layer->shadow_hidden;
+}
+
+ContentIndicator *scroll_layer_get_content_indicator(ScrollLayer *scroll_layer) {
+  return &scroll_layer->content_indicator;
+}
+
+bool content_indicator_configure_direction(ContentIndicator *content_indicator, ContentIndicatorDirection direction,
+                                           const ContentIndicatorConfig *config) {
+  if (direction >= NumContentIndicatorDirections) {
+    return false;
+  }
+  content_indicator_set_content_available(content_indicator, direction, false);
+  ContentIndicatorDirectionState *state = &content_indicator->directions[direction];
+  state->configured = config != NULL;
+  if (config) {
+    state->config = *config;
+  }
+  return true;
+}
+
+bool content_indicator_get_content_available(ContentIndicator *content_indicator,
+                                             ContentIndicatorDirection direction) {
+  return direction < NumContentIndicatorDirections && content_indicator->directions[direction].available;
+}
+
+void content_indicator_set_content_available(ContentIndicator *content_indicator,
+                                             ContentIndicatorDirection direction, bool available) {
+  if (direction >= NumContentIndicatorDirections) {
+    return;
+  }
+  ContentIndicatorDirectionState *state = &content_indicator->directions[direction];
+  if (state->available == available) {
+    return;
+  }
+  state->available = available;
+  if (!state->configured || !state->config.layer) {
+    return;
+  }
+  Layer *layer = state->config.layer;
+  if (available) {
+    state->original_update_proc = layer->update_proc;
+    layer->update_proc = direction == ContentIndicatorDirectionUp ? prv_draw_up_arrow : prv_draw_down_arrow;
+    for (size_t i = 0; i < sizeof(s_drawing_indicators) / sizeof(s_drawing_indicators[0]); ++i) {
+      if (!s_drawing_indicators[i]) {
+        s_drawing_indicators[i] = content_indicator;
+        break;
+      }
+    }
+  } else {
+    layer->update_proc = state->original_update_proc;
+    bool still_drawing = false;
+    for (int i = 0; i < NumContentIndicatorDirections; ++i) {
+      still_drawing |= content_indicator->directions[i].available;
+    }
+    for (size_t i = 0; !still_drawing && i < sizeof(s_drawing_indicators) / sizeof(s_drawing_indicators[0]); ++i) {
+      if (s_drawing_indicators[i] == content_indicator) {
+        s_drawing_indicators[i] = NULL;
+      }
+    }
+  }
+  layer_mark_dirty(layer);
+}
+
+static void prv_click_config_provider(void *context) {
+  ScrollLayer *scroll_layer = context;
+  window_single_repeating_click_subscribe(BUTTON_ID_UP, 100, scroll_layer_scroll_up_click_handler);
+  window_single_repeating_click_subscribe(BUTTON_ID_DOWN, 100, scroll_layer_scroll_down_click_handler);
+  if (scroll_layer->callbacks.click_config_provider) {
+    // The app's own subscriptions get the scroll layer's context, and the up/down handlers keep the scroll layer.
+    shim_window_set_click_context(scroll_layer->context);
+    scroll_layer->callbacks.click_config_provider(scroll_layer->context);
+    shim_window_set_click_context(scroll_layer);
+  }
+}
+
+static void prv_update_content_indicator(ScrollLayer *scroll_layer) {
+  const GRect content = scroll_layer->content_layer.frame;
+  content_indicator_set_content_available(&scroll_layer->content_indicator, ContentIndicatorDirectionUp,
+                                          content.origin.y < 0);
+  content_indicator_set_content_available(&scroll_layer->content_indicator, ContentIndicatorDirectionDown,
+                                          content.origin.y + content.size.h > scroll_layer->layer.frame.size.h);
+}
+
+static void prv_draw_arrow(Layer *layer, GContext *ctx, ContentIndicatorDirection direction) {
+  ContentIndicatorDirectionState *state = NULL;
+  for (size_t i = 0; !state && i < sizeof(s_drawing_indicators) / sizeof(s_drawing_indicators[0]); ++i) {
+    ContentIndicator *indicator = s_drawing_indicators[i];
+    if (indicator && indicator->directions[direction].available &&
+        indicator->directions[direction].config.layer == layer) {
+      state = &indicator->directions[direction];
+    }
+  }
+  if (!state) {
+    return;
+  }
+  const GRect bounds = layer->bounds;
+  shim_graphics_fill_rect_color(ctx, bounds, state->config.colors.background);
+  GRect arrow = GRect(0, 0, CONTENT_INDICATOR_ARROW_HEIGHT * 2, CONTENT_INDICATOR_ARROW_HEIGHT);
+  grect_align(&arrow, &bounds, state->config.alignment, true);
+  const int16_t tip_y = direction == ContentIndicatorDirectionUp ? arrow.origin.y : arrow.origin.y + arrow.size.h;
+  const int16_t base_y = direction == ContentIndicatorDirectionUp ? arrow.origin.y + arrow.size.h : arrow.origin.y;
+  const GPoint points[] = {
+    GPoint(arrow.origin.x * 8, base_y * 8),
+    GPoint(arrow.origin.x + arrow.size.w * 8, base_y * 8),
+    GPoint((arrow.origin.x + arrow.size.w / 2) * 8, tip_y * 8),
+  };
+  GColor fill_color = ctx->fill_color;
+  graphics_context_set_fill_color(ctx, state->config.colors.foreground);
+  shim_graphics_fill_precise_polygon(ctx, points, 3);
+  graphics_context_set_fill_color(ctx, fill_color);
+}
+
+static void prv_draw_up_arrow(Layer *layer, GContext *ctx) {
+  prv_draw_arrow(layer, ctx, ContentIndicatorDirectionUp);
+}
+
+static void prv_draw_down_arrow(Layer *layer, GContext *ctx) {
+  prv_draw_arrow(layer, ctx, ContentIndicatorDirectionDown);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Shared between the shim's own files. App code never sees this.
+
+#pragma once
+
+#include <pebble.h>
+#include <pebble_shim.h>
+
+// Objects the firmware puts on the app's heap (layers, windows, bitmaps, AppMessage buffers...) go through
+// app_malloc, so they count against the app just as they would on a watch. The shim's own bookkeeping uses the
+// host's allocator.
+#undef malloc
+#undef free
+#define app_malloc(size) sim_heap_malloc(size)
+#define app_free(ptr) sim_heap_free(ptr)
+void *app_zalloc(size_t size);
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+//
+// Layers and windows
+//
+
+struct Layer {
+  GRect frame;
+  GRect bounds;
+  Layer *parent;
+  Layer *first_child;
+  Layer *next_sibling;
+  Window *window;
+  LayerUpdateProc update_proc;
+  bool hidden;
+  bool clips;
+  bool has_data;
+  // layer_create_with_data() puts the caller's data here.
+  uint8_t data[] __attribute__((aligned(8)));
+};
+
+// For layers that live inside another struct (TextLayer and friends).
+void layer_init(Layer *layer, GRect frame);
+// Detaches the layer from its parent and its children from it, without freeing anything.
+void layer_deinit(Layer *layer);
+// Draws the layer and everything under it, with the layer's frame origin at `origin` (screen coordinates).
+void shim_layer_render_tree(Layer *layer, GContext *ctx, GPoint origin, GRect clip);
+// Where the layer's bounds origin is on screen, if it is attached to a window.
+GPoint shim_layer_screen_origin(const Layer *layer);
+
+typedef struct {
+  ClickHandler single;
+  ClickHandler long_down;
+  ClickHandler long_up;
+  void *context;
+} ClickConfig;
+
+struct ClickRecognizer {
+  ButtonId button;
+  bool is_long;
+};
+
+struct Window {
+  Layer root_layer;
+  GColor background_color;
+  WindowHandlers handlers;
+  ClickConfigProvider click_config_provider;
+  void *click_config_context;
+  ClickConfig clicks[NUM_BUTTONS];
+  void *user_data;
+  bool loaded;
+  bool on_screen;
+};
+
+// The window whose click config provider is running, so window_*_click_subscribe() know where to put things.
+Window *shim_window_configuring(void);
+void shim_window_set_click_context(void *context);
+void shim_window_stack_reset(void);
+bool shim_window_stack_is_empty(void);
+
+//
+// Graphics
+//
+
+struct GBitmap {
+  uint8_t *addr;
+  uint16_t row_size_bytes;
+  GBitmapFormat format;
+  GRect bounds;
+  GColor *palette;
+  // Set when the pixels (and palette) came from the same allocation as the bitmap, or from one of their own that
+  // the bitmap owns.
+  void *owned_data;
+};
+
+struct GContext {
+  GBitmap *dest;
+  // Where the current layer's origin is, and what it may draw on, in screen coordinates.
+  GPoint offset;
+  GRect clip;
+  GColor stroke_color;
+  GColor fill_color;
+  GColor text_color;
+  uint8_t stroke_width;
+  GCompOp compositing_mode;
+  bool antialiased;
+  // Calls to the SDK's drawing functions made with this context. A vector image counts once, however many
+  // commands it has, and saving and restoring the drawing state around a layer or a menu row keeps the count.
+  uint32_t draw_calls;
+};
+
+void shim_graphics_context_init(GContext *ctx, GBitmap *dest);
+// Fills a rectangle in the context's coordinates with a colour, ignoring the context's own colours.
+void shim_graphics_fill_rect_color(GContext *ctx, GRect rect, GColor color);
+// Draws a polygon from points already in the context's coordinates, scaled up by 8 (the PDC "precise" format).
+void shim_graphics_fill_precise_polygon(GContext *ctx, const GPoint *points, size_t num_points);
+void shim_graphics_draw_precise_polyline(GContext *ctx, const GPoint *points, size_t num_points, bool closed);
+
+GBitmap *shim_gbitmap_create(GSize size, GBitmapFormat format, bool app_heap);
+void shim_screen_init(void);
+void shim_screen_deinit(void);
+
+//
+// Dictionaries
+//
+
+// Points iter at a serialised dictionary without reading any of it, so handing a message to the app doesn't count as
+// the app having read a tuple.
+void shim_dict_read_begin(DictionaryIterator *iter, const uint8_t *buffer, uint16_t size);
+
+//
+// Text
+//
+
+struct FontInfo {
+  int16_t line_height;
+  // Average advance of a letter; narrow and wide letters are scaled from this.
+  int16_t advance;
+  bool custom;
+};
+
+//
+// Time and events
+//
+
+void shim_events_reset(void);
+void shim_request_render(void);
+void shim_app_message_reset(void);
+void shim_dict_reset(void);
+void shim_text_reset(void);
+void shim_pebble_events_reset(void);
+void shim_persist_reset(void);
+void shim_wakeup_reset(void);
+void shim_resources_init(void);
+void shim_resources_deinit(void);
+void shim_dictation_reset(void);
+void shim_system_reset(void);
+
+// Generated from package.json: the file behind each resource ID, indexed by ID.
+extern const char *const g_shim_resource_files[];
+extern const uint32_t g_shim_resource_count;
+// Generated from package.json's messageKeys, in the same order.
+extern const char *const g_shim_message_key_names[];
+extern const uint32_t *const g_shim_message_key_values[];
+extern const uint32_t g_shim_message_key_count;
+
+// A resource's bytes, loaded from disk the first time it's asked for. NULL if there is no such resource.
+const uint8_t *shim_resource_data(uint32_t resource_id, size_t *size);
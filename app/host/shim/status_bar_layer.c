@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The status bar shows the time as of whenever the screen was last drawn. Unlike the firmware's, it doesn't redraw
+// itself each minute: that would need a tick subscription of its own, and the app owns the only one.
+
+#include "shim_internal.h"
+
+#define STATUS_BAR_DOT_SPACING 3
+
+struct StatusBarLayer {
+  Layer layer;
+  GColor background;
+  GColor foreground;
+  StatusBarLayerSeparatorMode separator_mode;
+};
+
+static void prv_update(Layer *layer, GContext *ctx);
+
+StatusBarLayer *status_bar_layer_create(void) {
+  StatusBarLayer *status_bar = app_zalloc(sizeof(StatusBarLayer));
+  if (!status_bar) {
+    return NULL;
+  }
+  layer_init(&status_bar->layer, GRect(0, 0, PBL_DISPLAY_WIDTH, STATUS_BAR_LAYER_HEIGHT));
+  status_bar->layer.update_proc = prv_update;
+  status_bar->background = GColorBlack;
+  status_bar->foreground = GColorWhite;
+  return status_bar;
+}
+
+void status_bar_layer_destroy(StatusBarLayer *status_bar_layer) {
+  if (!status_bar_layer) {
+    return;
+  }
+  layer_deinit(&status_bar_layer->layer);
+  app_free(status_bar_layer);
+}
+
+Layer *status_bar_layer_get_layer(StatusBarLayer *status_bar_layer) {
+  return &status_bar_layer->layer;
+}
+
+GColor status_bar_layer_get_background_color(const StatusBarLayer *status_bar_layer) {
+  return status_bar_layer->background;
+}
+
+GColor status_bar_layer_get_foreground_color(const StatusBarLayer *status_bar_layer) {
+  return status_bar_layer->foreground;
+}
+
+void status_bar_layer_set_colors(StatusBarLayer *status_bar_layer, GColor background, GColor foreground) {
+  status_bar_layer->background = background;
+  status_bar_layer->foreground = foreground;
+  layer_mark_dirty(&status_bar_layer->layer);
+}
+
+void status_bar_layer_set_separator_mode(StatusBarLayer *status_bar_layer, StatusBarLayerSeparatorMode mode) {
+  status_bar_layer->separator_mode = mode;
+  layer_mark_dirty(&status_bar_layer->layer);
+}
+
+static void prv_update(Layer *layer, GContext *ctx) {
+  StatusBarLayer *status_bar = (StatusBarLayer *)layer;
+  const GRect bounds = layer->bounds;
+  shim_graphics_fill_rect_color(ctx, bounds, status_bar->background);
+  char time_text[8];
+  const time_t now = time(NULL);
+  strftime(time_text, sizeof(time_text), clock_is_24h_style() ? "%H:%M" : "%I:%M", localtime(&now));
+  const char *text = (!clock_is_24h_style() && time_text[0] == '0') ? time_text + 1 : time_text;
+  graphics_context_set_text_color(ctx, status_bar->foreground);
+  graphics_draw_text(ctx, text, fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD), GRect(0, -2, bounds.size.w, 14),
+                     GTextOverflowModeFill, GTextAlignmentCenter, NULL);
+  if (status_bar->separator_mode == StatusBarLayerSeparatorModeDotted) {
+    const int16_t y = bounds.size.h - 1;
+    for (int16_t x = 0; x < bounds.size.w; x += STATUS_BAR_DOT_SPACING) {
+      shim_graphics_fill_rect_color(ctx, GRect(x, y, 1, 1), status_bar->foreground);
+    }
+  }
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Odds and ends of the firmware that don't need a file each, and the shim's setup.
+
+#include "shim_internal.h"
+
+#include <stdarg.h>
+
+static AppLaunchReason s_launch_reason;
+static int s_vibe_count;
+
+void *app_zalloc(size_t size) {
+  void *ptr = app_malloc(size);
+  if (ptr) {
+    memset(ptr, 0, size);
+  }
+  return ptr;
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  // BOBBY_HOST_LOG_LEVEL filters the app's logging: 50 keeps warnings and errors, 0 silences it.
+  static int s_max_level = -1;
+  if (s_max_level < 0) {
+    const char *env = getenv("BOBBY_HOST_LOG_LEVEL");
+    s_max_level = env ? atoi(env) : APP_LOG_LEVEL_DEBUG_VERBOSE;
+  }
+  if (log_level > s_max_level) {
+    return;
+  }
+  const char *slash = strrchr(src_filename, '/');
+  fprintf(stderr, "[%06lld] %s:%d> ", (long long)(pebble_shim_now_ms() % 1000000), slash ? slash + 1 : src_filename,
+          src_line_number);
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+bool clock_is_24h_style(void) {
+  return false;
+}
+
+void vibes_cancel(void) {
+}
+
+void vibes_short_pulse(void) {
+  ++s_vibe_count;
+}
+
+void vibes_long_pulse(void) {
+  ++s_vibe_count;
+}
+
+void vibes_double_pulse(void) {
+  ++s_vibe_count;
+}
+
+void vibes_enqueue_custom_pattern(VibePattern pattern) {
+  ++s_vibe_count;
+}
+
+int pebble_shim_vibe_count(void) {
+  return s_vibe_count;
+}
+
+void light_enable_interaction(void) {
+}
+
+void light_enable(bool enable) {
+}
+
+AppLaunchReason launch_reason(void) {
+  return s_launch_reason;
+}
+
+uint32_t launch_get_args(void) {
+  return 0;
+}
+
+void pebble_shim_set_launch_reason(AppLaunchReason reason) {
+  s_launch_reason = reason;
+}
+
+PreferredContentSize preferred_content_size(void) {
+  return PreferredContentSizeMedium;
+}
+
+void shim_system_reset(void) {
+  s_launch_reason = APP_LAUNCH_USER;
+  s_vibe_count = 0;
+}
+
+void pebble_shim_init(void) {
+  // Local time is UTC, so runs don't depend on where they happen.
+  setenv("TZ", "UTC", 1);
+  tzset();
+  shim_system_reset();
+  shim_events_reset();
+  shim_window_stack_reset();
+  shim_app_message_reset();
+  shim_dict_reset();
+  shim_text_reset();
+  shim_pebble_events_reset();
+  shim_persist_reset();
+  shim_wakeup_reset();
+  shim_dictation_reset();
+  shim_resources_init();
+  shim_screen_init();
+}
+
+void pebble_shim_deinit(void) {
+  shim_events_reset();
+  shim_window_stack_reset();
+  shim_screen_deinit();
+  shim_resources_deinit();
+}
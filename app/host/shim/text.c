@@ -0,0 +1,314 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Text without fonts. Every font is a line height and an average advance taken from its name (or, for custom fonts,
+// its header), and glyphs are drawn as solid blocks. Wrapping follows the firmware's rules closely enough that
+// layout code, scroll extents and everything measured from them behave the same way they do on a watch.
+
+#include "shim_internal.h"
+#include "util/perimeter.h"
+
+#define MAX_SYSTEM_FONTS 24
+#define ELLIPSIS "\xe2\x80\xa6"
+
+typedef struct {
+  const char *key;
+  struct FontInfo info;
+} SystemFont;
+
+typedef struct {
+  const char *start;
+  const char *end;
+  int16_t width;
+} Line;
+
+typedef void (*LineCallback)(const Line *line, int16_t y, GRangeHorizontal range, bool last, void *context);
+
+typedef struct {
+  GContext *ctx;
+  GFont font;
+  GTextAlignment alignment;
+  GTextOverflowMode overflow_mode;
+} DrawContext;
+
+static SystemFont s_system_fonts[MAX_SYSTEM_FONTS];
+static int s_system_font_count;
+// Calls to graphics_text_layout_get_content_size*, for pebble_shim_text_layout_calls().
+static uint32_t s_layout_calls;
+
+static struct FontInfo prv_font_from_key(const char *font_key);
+static int16_t prv_advance(GFont font, const char *c, int *bytes);
+static int16_t prv_width(GFont font, const char *start, const char *end);
+static GSize prv_layout(const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode,
+                        GTextAttributes *attributes, GPoint screen_origin, LineCallback callback, void *context);
+static void prv_draw_line(const Line *line, int16_t y, GRangeHorizontal range, bool last, void *context);
+
+GFont fonts_get_system_font(const char *font_key) {
+  for (int i = 0; i < s_system_font_count; ++i) {
+    if (strcmp(s_system_fonts[i].key, font_key) == 0) {
+      return &s_system_fonts[i].info;
+    }
+  }
+  if (s_system_font_count == MAX_SYSTEM_FONTS) {
+    return &s_system_fonts[0].info;
+  }
+  SystemFont *font = &s_system_fonts[s_system_font_count++];
+  font->key = font_key;
+  font->info = prv_font_from_key(font_key);
+  return &font->info;
+}
+
+GFont fonts_load_custom_font(ResHandle handle) {
+  if (!handle) {
+    return NULL;
+  }
+  // A .pbf starts with a version byte, then the font's line height.
+  uint8_t header[2];
+  if (resource_load_byte_range(handle, 0, header, sizeof(header)) != sizeof(header)) {
+    return NULL;
+  }
+  GFont font = app_malloc(sizeof(struct FontInfo));
+  if (!font) {
+    return NULL;
+  }
+  *font = (struct FontInfo) {
+    .line_height = header[1],
+    .advance = header[1] * 2 / 5,
+    .custom = true,
+  };
+  return font;
+}
+
+void fonts_unload_custom_font(GFont font) {
+  if (font && font->custom) {
+    app_free(font);
+  }
+}
+
+void shim_text_reset(void) {
+  s_layout_calls = 0;
+}
+
+uint32_t pebble_shim_text_layout_calls(void) {
+  return s_layout_calls;
+}
+
+GTextAttributes *graphics_text_attributes_create(void) {
+  GTextAttributes *attributes = app_zalloc(sizeof(GTextAttributes));
+  return attributes;
+}
+
+void graphics_text_attributes_destroy(GTextAttributes *text_attributes) {
+  app_free(text_attributes);
+}
+
+GSize graphics_text_layout_get_content_size(const char *text, GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment) {
+  s_layout_calls++;
+  return prv_layout(text, font, box, overflow_mode, NULL, GPointZero, NULL, NULL);
+}
+
+GSize graphics_text_layout_get_content_size_with_attributes(const char *text, GFont font, const GRect box,
+                                                            const GTextOverflowMode overflow_mode,
+                                                            const GTextAlignment alignment,
+                                                            GTextAttributes *text_attributes) {
+  s_layout_calls++;
+  GPoint origin = text_attributes ? text_attributes->flow_data.paging.origin_on_screen : GPointZero;
+  return prv_layout(text, font, box, overflow_mode, text_attributes, origin, NULL, NULL);
+}
+
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes *text_attributes) {
+  ctx->draw_calls++;
+  DrawContext draw = {
+    .ctx = ctx,
+    .font = font,
+    .alignment = alignment,
+    .overflow_mode = overflow_mode,
+  };
+  prv_layout(text, font, box, overflow_mode, text_attributes, ctx->offset, prv_draw_line, &draw);
+}
+
+static struct FontInfo prv_font_from_key(const char *font_key) {
+  // Keys look like RESOURCE_ID_GOTHIC_24_BOLD; the first number is the line height.
+  const char *digits = font_key;
+  while (*digits && (*digits < '0' || *digits > '9')) {
+    ++digits;
+  }
+  int16_t height = *digits ? atoi(digits) : 14;
+  // LECO is a wide display face; Gothic is narrow.
+  const bool wide = strstr(font_key, "LECO") != NULL;
+  const bool bold = strstr(font_key, "BOLD") != NULL;
+  return (struct FontInfo) {
+    .line_height = height,
+    .advance = height * (wide ? 3 : 2) / 5 + (bold ? 1 : 0),
+  };
+}
+
+// Letters keep roughly the proportions they have in Gothic, so narrow ones are narrow.
+static int16_t prv_advance(GFont font, const char *c, int *bytes) {
+  const unsigned char lead = *c;
+  *bytes = lead < 0x80 ? 1 : lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : 4;
+  const int16_t advance = font->advance;
+  switch (lead) {
+    case ' ': return advance / 2;
+    case 'i': case 'l': case 'j': case 'I': case '.': case ',': case '\'': case '!': case ':': case ';': case '|':
+      return MAX(2, advance / 3);
+    case 'm': case 'w': case 'M': case 'W': case '@':
+      return advance * 3 / 2;
+    default:
+      return advance;
+  }
+}
+
+static int16_t prv_width(GFont font, const char *start, const char *end) {
+  int16_t width = 0;
+  for (const char *c = start; c < end;) {
+    int bytes;
+    width += prv_advance(font, c, &bytes);
+    c += bytes;
+  }
+  return width;
+}
+
+static GSize prv_layout(const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode,
+                        GTextAttributes *attributes, GPoint screen_origin, LineCallback callback, void *context) {
+  if (!text || !font || box.size.w <= 0) {
+    return GSizeZero;
+  }
+  const GPerimeter *perimeter = attributes ? attributes->flow_data.perimeter.impl : NULL;
+  const int16_t line_height = font->line_height;
+  const int max_lines = MAX(1, box.size.h / line_height);
+  int16_t max_width = 0;
+  int lines = 0;
+  const char *c = text;
+  while (*c && lines < max_lines) {
+    const int16_t y = box.origin.y + lines * line_height;
+    GRangeHorizontal range = { .origin_x = box.origin.x, .size_w = box.size.w };
+    if (perimeter && perimeter->callback) {
+      // The perimeter works in screen coordinates.
+      const GSize screen = GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+      const GRangeVertical vertical = { .origin_y = screen_origin.y + y, .size_h = line_height };
+      GRangeHorizontal allowed = perimeter->callback(perimeter, &screen, vertical,
+                                                     attributes->flow_data.perimeter.inset);
+      const int16_t left = MAX(range.origin_x, allowed.origin_x - screen_origin.x);
+      const int16_t right = MIN(range.origin_x + range.size_w, allowed.origin_x + allowed.size_w - screen_origin.x);
+      range = (GRangeHorizontal){ .origin_x = left, .size_w = MAX(0, right - left) };
+    }
+    // Take words until the next one doesn't fit. A word wider than the whole line is broken wherever it overflows.
+    Line line = { .start = c, .end = c, .width = 0 };
+    const char *cursor = c;
+    while (*cursor && *cursor != '\n') {
+      const char *word_end = cursor;
+      while (*word_end == ' ') {
+        ++word_end;
+      }
+      while (*word_end && *word_end != ' ' && *word_end != '\n') {
+        ++word_end;
+      }
+      const int16_t width = prv_width(font, line.start, word_end);
+      if (width > range.size_w && line.end != line.start) {
+        break;
+      }
+      if (width > range.size_w) {
+        // Break inside the word.
+        const char *fit = cursor;
+        int16_t fit_width = prv_width(font, line.start, cursor);
+        while (fit < word_end) {
+          int bytes;
+          const int16_t advance = prv_advance(font, fit, &bytes);
+          if (fit_width + advance > range.size_w && fit != line.start) {
+            break;
+          }
+          fit_width += advance;
+          fit += bytes;
+        }
+        line.end = fit;
+        break;
+      }
+      line.end = word_end;
+      cursor = word_end;
+    }
+    // Trailing spaces don't count towards a line's width.
+    const char *visible_end = line.end;
+    while (visible_end > line.start && visible_end[-1] == ' ') {
+      --visible_end;
+    }
+    line.width = prv_width(font, line.start, visible_end);
+    c = line.end;
+    while (*c == ' ') {
+      ++c;
+    }
+    if (*c == '\n') {
+      ++c;
+    }
+    ++lines;
+    max_width = MAX(max_width, line.width);
+    if (callback) {
+      const bool last = lines == max_lines && *c;
+      line.end = visible_end;
+      callback(&line, y, range, last && overflow_mode == GTextOverflowModeTrailingEllipsis, context);
+    }
+  }
+  return GSize(MIN(max_width, box.size.w), lines * line_height);
+}
+
+static void prv_draw_line(const Line *line, int16_t y, GRangeHorizontal range, bool ellipsis, void *context) {
+  DrawContext *draw = context;
+  GFont font = draw->font;
+  int16_t width = line->width;
+  const char *end = line->end;
+  int ellipsis_bytes;
+  const int16_t ellipsis_width = ellipsis ? prv_advance(font, ELLIPSIS, &ellipsis_bytes) : 0;
+  if (ellipsis) {
+    while (end > line->start && width + ellipsis_width > range.size_w) {
+      int bytes;
+      --end;
+      while (end > line->start && ((unsigned char)*end & 0xc0) == 0x80) {
+        --end;
+      }
+      width -= prv_advance(font, end, &bytes);
+    }
+    width += ellipsis_width;
+  }
+  int16_t x = range.origin_x;
+  if (draw->alignment == GTextAlignmentCenter) {
+    x += (range.size_w - width) / 2;
+  } else if (draw->alignment == GTextAlignmentRight) {
+    x += range.size_w - width;
+  }
+  // Each glyph is a block from roughly the x-height down to the baseline.
+  const int16_t top = y + font->line_height * 2 / 5;
+  const int16_t height = MAX(1, font->line_height * 2 / 5);
+  for (const char *c = line->start; c < end || ellipsis;) {
+    int bytes;
+    int16_t advance;
+    if (c < end) {
+      advance = prv_advance(font, c, &bytes);
+      if (*c != ' ') {
+        shim_graphics_fill_rect_color(draw->ctx, GRect(x, top, MAX(1, advance - 1), height), draw->ctx->text_color);
+      }
+      c += bytes;
+    } else {
+      advance = ellipsis_width;
+      shim_graphics_fill_rect_color(draw->ctx, GRect(x, top + height - 2, MAX(1, advance - 1), 2),
+                                    draw->ctx->text_color);
+      ellipsis = false;
+    }
+    x += advance;
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+struct TextLayer {
+  Layer layer;
+  const char *text;
+  GFont font;
+  GColor text_color;
+  GColor background_color;
+  GTextOverflowMode overflow_mode;
+  GTextAlignment alignment;
+};
+
+static void prv_update(Layer *layer, GContext *ctx);
+
+TextLayer *text_layer_create(GRect frame) {
+  TextLayer *text_layer = app_zalloc(sizeof(TextLayer));
+  if (!text_layer) {
+    return NULL;
+  }
+  layer_init(&text_layer->layer, frame);
+  text_layer->layer.update_proc = prv_update;
+  text_layer->font = fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD);
+  text_layer->text_color = GColorBlack;
+  text_layer->background_color = GColorWhite;
+  text_layer->overflow_mode = GTextOverflowModeWordWrap;
+  text_layer->alignment = GTextAlignmentLeft;
+  return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+  if (!text_layer) {
+    return;
+  }
+  layer_deinit(&text_layer->layer);
+  app_free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+  return &text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+  text_layer->text = text;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+const char *text_layer_get_text(TextLayer *text_layer) {
+  return text_layer->text;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+  text_layer->background_color = color;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+  text_layer->text_color = color;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode) {
+  text_layer->overflow_mode = line_mode;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+  text_layer->font = font;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+  text_layer->alignment = text_alignment;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+GSize text_layer_get_content_size(TextLayer *text_layer) {
+  if (!text_layer->text) {
+    return GSizeZero;
+  }
+  return graphics_text_layout_get_content_size(text_layer->text, text_layer->font, text_layer->layer.bounds,
+                                               text_layer->overflow_mode, text_layer->alignment);
+}
+
+void text_layer_set_size(TextLayer *text_layer, const GSize max_size) {
+  GRect frame = text_layer->layer.frame;
+  frame.size = max_size;
+  layer_set_frame(&text_layer->layer, frame);
+}
+
+static void prv_update(Layer *layer, GContext *ctx) {
+  TextLayer *text_layer = (TextLayer *)layer;
+  if (text_layer->background_color.a) {
+    shim_graphics_fill_rect_color(ctx, layer->bounds, text_layer->background_color);
+  }
+  if (text_layer->text) {
+    graphics_context_set_text_color(ctx, text_layer->text_color);
+    graphics_draw_text(ctx, text_layer->text, text_layer->font, layer->bounds, text_layer->overflow_mode,
+                       text_layer->alignment, NULL);
+  }
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Wakeups, with the firmware's rules: a handful per app, none in the past, and none within a minute of another.
+// While the app is running they arrive through the wakeup handler, as they would on a watch.
+
+#include "shim_internal.h"
+
+#define MAX_WAKEUPS 8
+#define WAKEUP_SPACING_SECONDS 60
+
+typedef struct {
+  WakeupId id;
+  time_t timestamp;
+  int32_t cookie;
+  AppTimer *timer;
+} Wakeup;
+
+static Wakeup s_wakeups[MAX_WAKEUPS];
+static WakeupId s_next_id;
+static WakeupHandler s_handler;
+static bool s_launched_by_wakeup;
+static WakeupId s_launch_id;
+static int32_t s_launch_cookie;
+
+static Wakeup *prv_find(WakeupId id);
+static void prv_fire(void *data);
+
+void shim_wakeup_reset(void) {
+  memset(s_wakeups, 0, sizeof(s_wakeups));
+  s_next_id = 1;
+  s_handler = NULL;
+  s_launched_by_wakeup = false;
+}
+
+void pebble_shim_set_wakeup_launch(WakeupId id, int32_t cookie) {
+  s_launched_by_wakeup = true;
+  s_launch_id = id;
+  s_launch_cookie = cookie;
+  pebble_shim_set_launch_reason(APP_LAUNCH_WAKEUP);
+}
+
+void wakeup_service_subscribe(WakeupHandler handler) {
+  s_handler = handler;
+}
+
+WakeupId wakeup_schedule(time_t timestamp, int32_t cookie, bool notify_if_missed) {
+  const time_t now = time(NULL);
+  if (timestamp < now) {
+    return E_INVALID_ARGUMENT;
+  }
+  Wakeup *free_slot = NULL;
+  for (int i = 0; i < MAX_WAKEUPS; ++i) {
+    Wakeup *wakeup = &s_wakeups[i];
+    if (!wakeup->id) {
+      free_slot = free_slot ? free_slot : wakeup;
+    } else if (llabs((long long)(wakeup->timestamp - timestamp)) < WAKEUP_SPACING_SECONDS) {
+      return E_RANGE;
+    }
+  }
+  if (!free_slot) {
+    return E_OUT_OF_RESOURCES;
+  }
+  *free_slot = (Wakeup) {
+    .id = s_next_id++,
+    .timestamp = timestamp,
+    .cookie = cookie,
+  };
+  const int64_t delay_ms = (int64_t)timestamp * 1000 - pebble_shim_now_ms();
+  free_slot->timer = app_timer_register(MAX(delay_ms, 0), prv_fire, (void *)(intptr_t)free_slot->id);
+  return free_slot->id;
+}
+
+void wakeup_cancel(WakeupId wakeup_id) {
+  Wakeup *wakeup = prv_find(wakeup_id);
+  if (wakeup) {
+    app_timer_cancel(wakeup->timer);
+    wakeup->id = 0;
+  }
+}
+
+void wakeup_cancel_all(void) {
+  for (int i = 0; i < MAX_WAKEUPS; ++i) {
+    if (s_wakeups[i].id) {
+      wakeup_cancel(s_wakeups[i].id);
+    }
+  }
+}
+
+bool wakeup_get_launch_event(WakeupId *wakeup_id, int32_t *cookie) {
+  if (!s_launched_by_wakeup) {
+    return false;
+  }
+  *wakeup_id = s_launch_id;
+  *cookie = s_launch_cookie;
+  return true;
+}
+
+bool wakeup_query(WakeupId wakeup_id, time_t *timestamp) {
+  Wakeup *wakeup = prv_find(wakeup_id);
+  if (!wakeup) {
+    return false;
+  }
+  if (timestamp) {
+    *timestamp = wakeup->timestamp;
+  }
+  return true;
+}
+
+static Wakeup *prv_find(WakeupId id) {
+  if (id <= 0) {
+    return NULL;
+  }
+  for (int i = 0; i < MAX_WAKEUPS; ++i) {
+    if (s_wakeups[i].id == id) {
+      return &s_wakeups[i];
+    }
+  }
+  return NULL;
+}
+
+static void prv_fire(void *data) {
+  Wakeup *wakeup = prv_find((WakeupId)(intptr_t)data);
+  if (!wakeup) {
+    return;
+  }
+  const int32_t cookie = wakeup->cookie;
+  wakeup->id = 0;
+  if (s_handler) {
+    s_handler((WakeupId)(intptr_t)data, cookie);
+  }
+}
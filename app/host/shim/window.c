@@ -0,0 +1,294 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shim_internal.h"
+
+#define MAX_WINDOWS 16
+
+static Window *s_stack[MAX_WINDOWS];
+static int s_stack_size;
+static Window *s_configuring;
+static void *s_configuring_context;
+
+static void prv_show(Window *window);
+static void prv_hide(Window *window);
+static void prv_configure_clicks(Window *window);
+static void prv_remove_at(int index);
+
+Window *window_create(void) {
+  Window *window = app_zalloc(sizeof(Window));
+  if (!window) {
+    return NULL;
+  }
+  layer_init(&window->root_layer, GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  window->root_layer.window = window;
+  window->background_color = GColorWhite;
+  return window;
+}
+
+void window_destroy(Window *window) {
+  if (!window) {
+    return;
+  }
+  window_stack_remove(window, false);
+  layer_deinit(&window->root_layer);
+  app_free(window);
+}
+
+void window_set_click_config_provider(Window *window, ClickConfigProvider click_config_provider) {
+  window_set_click_config_provider_with_context(window, click_config_provider, window);
+}
+
+void window_set_click_config_provider_with_context(Window *window, ClickConfigProvider click_config_provider,
+                                                   void *context) {
+  window->click_config_provider = click_config_provider;
+  window->click_config_context = context;
+  if (window->on_screen) {
+    prv_configure_clicks(window);
+  }
+}
+
+ClickConfigProvider window_get_click_config_provider(const Window *window) {
+  return window->click_config_provider;
+}
+
+void *window_get_click_config_context(Window *window) {
+  return window->click_config_context;
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+Layer *window_get_root_layer(const Window *window) {
+  return (Layer *)&window->root_layer;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+  window->background_color = background_color;
+  shim_request_render();
+}
+
+bool window_is_loaded(Window *window) {
+  return window->loaded;
+}
+
+void window_set_user_data(Window *window, void *data) {
+  window->user_data = data;
+}
+
+void *window_get_user_data(const Window *window) {
+  return window->user_data;
+}
+
+Window *shim_window_configuring(void) {
+  return s_configuring;
+}
+
+void shim_window_set_click_context(void *context) {
+  s_configuring_context = context;
+}
+
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler) {
+  if (!s_configuring) {
+    return;
+  }
+  s_configuring->clicks[button_id].single = handler;
+  s_configuring->clicks[button_id].context = s_configuring_context;
+}
+
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler) {
+  window_single_click_subscribe(button_id, handler);
+}
+
+void window_multi_click_subscribe(ButtonId button_id, uint8_t min_clicks, uint8_t max_clicks, uint16_t timeout,
+                                  bool last_click_only, ClickHandler handler) {
+  if (min_clicks <= 1) {
+    window_single_click_subscribe(button_id, handler);
+  }
+}
+
+void window_long_click_subscribe(ButtonId button_id, uint16_t delay_ms, ClickHandler down_handler,
+                                 ClickHandler up_handler) {
+  if (!s_configuring) {
+    return;
+  }
+  s_configuring->clicks[button_id].long_down = down_handler;
+  s_configuring->clicks[button_id].long_up = up_handler;
+  s_configuring->clicks[button_id].context = s_configuring_context;
+}
+
+void window_set_click_context(ButtonId button_id, void *context) {
+  if (!s_configuring) {
+    return;
+  }
+  s_configuring->clicks[button_id].context = context;
+}
+
+void window_stack_push(Window *window, bool animated) {
+  if (s_stack_size == MAX_WINDOWS) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Window stack is full");
+    return;
+  }
+  window_stack_remove(window, false);
+  if (s_stack_size > 0) {
+    prv_hide(s_stack[s_stack_size - 1]);
+  }
+  s_stack[s_stack_size++] = window;
+  if (!window->loaded) {
+    window->loaded = true;
+    if (window->handlers.load) {
+      window->handlers.load(window);
+    }
+  }
+  // The load handler may already have pushed something on top.
+  if (window_stack_get_top_window() == window) {
+    prv_show(window);
+  }
+}
+
+Window *window_stack_pop(bool animated) {
+  if (s_stack_size == 0) {
+    return NULL;
+  }
+  Window *window = s_stack[s_stack_size - 1];
+  prv_remove_at(s_stack_size - 1);
+  return window;
+}
+
+void window_stack_pop_all(const bool animated) {
+  while (s_stack_size > 0) {
+    window_stack_pop(animated);
+  }
+}
+
+bool window_stack_remove(Window *window, bool animated) {
+  for (int i = s_stack_size - 1; i >= 0; --i) {
+    if (s_stack[i] == window) {
+      prv_remove_at(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+Window *window_stack_get_top_window(void) {
+  return s_stack_size > 0 ? s_stack[s_stack_size - 1] : NULL;
+}
+
+bool window_stack_contains_window(Window *window) {
+  for (int i = 0; i < s_stack_size; ++i) {
+    if (s_stack[i] == window) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool shim_window_stack_is_empty(void) {
+  return s_stack_size == 0;
+}
+
+void shim_window_stack_reset(void) {
+  s_stack_size = 0;
+  s_configuring = NULL;
+}
+
+void pebble_shim_click(ButtonId button) {
+  Window *window = window_stack_get_top_window();
+  if (!window) {
+    return;
+  }
+  ClickConfig *config = &window->clicks[button];
+  struct ClickRecognizer recognizer = { .button = button };
+  if (config->single) {
+    config->single(&recognizer, config->context);
+  } else if (button == BUTTON_ID_BACK) {
+    window_stack_pop(true);
+  }
+}
+
+void pebble_shim_long_click(ButtonId button) {
+  Window *window = window_stack_get_top_window();
+  if (!window) {
+    return;
+  }
+  ClickConfig *config = &window->clicks[button];
+  struct ClickRecognizer recognizer = { .button = button, .is_long = true };
+  if (config->long_down) {
+    config->long_down(&recognizer, config->context);
+    if (config->long_up) {
+      config->long_up(&recognizer, config->context);
+    }
+  } else {
+    pebble_shim_click(button);
+  }
+}
+
+static void prv_remove_at(int index) {
+  Window *window = s_stack[index];
+  bool was_top = index == s_stack_size - 1;
+  memmove(&s_stack[index], &s_stack[index + 1], (s_stack_size - index - 1) * sizeof(Window *));
+  --s_stack_size;
+  if (was_top) {
+    prv_hide(window);
+  }
+  if (window->loaded) {
+    window->loaded = false;
+    // Apps often destroy the window from here, so it can't be touched afterwards.
+    if (window->handlers.unload) {
+      window->handlers.unload(window);
+    }
+  }
+  Window *top = window_stack_get_top_window();
+  if (was_top && top && !top->on_screen) {
+    prv_show(top);
+  }
+  shim_request_render();
+}
+
+static void prv_show(Window *window) {
+  window->on_screen = true;
+  prv_configure_clicks(window);
+  if (window->handlers.appear) {
+    window->handlers.appear(window);
+  }
+  shim_request_render();
+}
+
+static void prv_hide(Window *window) {
+  if (!window->on_screen) {
+    return;
+  }
+  window->on_screen = false;
+  if (window->handlers.disappear) {
+    window->handlers.disappear(window);
+  }
+}
+
+static void prv_configure_clicks(Window *window) {
+  memset(window->clicks, 0, sizeof(window->clicks));
+  if (!window->click_config_provider) {
+    return;
+  }
+  Window *previous = s_configuring;
+  void *previous_context = s_configuring_context;
+  s_configuring = window;
+  s_configuring_context = window->click_config_context;
+  window->click_config_provider(window->click_config_context);
+  s_configuring = previous;
+  s_configuring_context = previous_context;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sim_heap.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Blocks are rounded up to this, and each is preceded by a header of the same size.
+#define BLOCK_ALIGNMENT 8
+
+typedef struct {
+  uint32_t size;
+  uint32_t allocated;
+} BlockHeader;
+
+_Static_assert(sizeof(BlockHeader) == BLOCK_ALIGNMENT, "Block headers must keep blocks aligned.");
+
+static uint8_t *s_heap;
+static size_t s_heap_size;
+static SimHeapStats s_stats;
+static size_t s_allocation_limit;
+
+static BlockHeader *prv_next_block(BlockHeader *block);
+static void prv_merge_free_blocks(void);
+
+void sim_heap_init(size_t size) {
+  size = size / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+  s_heap = aligned_alloc(BLOCK_ALIGNMENT, size);
+  s_heap_size = size;
+  s_allocation_limit = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
+  BlockHeader *first = (BlockHeader *)s_heap;
+  first->size = size - sizeof(BlockHeader);
+  first->allocated = 0;
+  s_stats.size = first->size;
+}
+
+void sim_heap_deinit(void) {
+  free(s_heap);
+  s_heap = NULL;
+}
+
+void *sim_heap_malloc(size_t size) {
+  if (size == 0) {
+    size = 1;
+  }
+  size = (size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+  if (s_allocation_limit && size > s_allocation_limit) {
+    s_stats.failures++;
+    return NULL;
+  }
+  for (BlockHeader *block = (BlockHeader *)s_heap; block; block = prv_next_block(block)) {
+    if (block->allocated || block->size < size) {
+      continue;
+    }
+    // Split off whatever's left over, if it's big enough to be a block of its own.
+    if (block->size >= size + sizeof(BlockHeader) + BLOCK_ALIGNMENT) {
+      BlockHeader *rest = (BlockHeader *)((uint8_t *)(block + 1) + size);
+      rest->size = block->size - size - sizeof(BlockHeader);
+      rest->allocated = 0;
+      block->size = size;
+    }
+    block->allocated = 1;
+    s_stats.allocations++;
+    s_stats.used += block->size + sizeof(BlockHeader);
+    if (s_stats.used > s_stats.peak_used) {
+      s_stats.peak_used = s_stats.used;
+    }
+    return block + 1;
+  }
+  s_stats.failures++;
+  if ((size_t)heap_bytes_free() >= size) {
+    s_stats.fragmented_failures++;
+  }
+  return NULL;
+}
+
+void sim_heap_free(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  if (!block->allocated) {
+    abort();
+  }
+  block->allocated = 0;
+  s_stats.used -= block->size + sizeof(BlockHeader);
+  prv_merge_free_blocks();
+}
+
+int heap_bytes_free(void) {
+  size_t free_bytes = 0;
+  for (BlockHeader *block = (BlockHeader *)s_heap; block; block = prv_next_block(block)) {
+    if (!block->allocated) {
+      free_bytes += block->size;
+    }
+  }
+  return free_bytes;
+}
+
+void sim_heap_set_allocation_limit(size_t size) {
+  s_allocation_limit = size;
+}
+
+SimHeapStats sim_heap_get_stats(void) {
+  s_stats.largest_free_block = 0;
+  s_stats.free_blocks = 0;
+  for (BlockHeader *block = (BlockHeader *)s_heap; block; block = prv_next_block(block)) {
+    if (block->allocated) {
+      continue;
+    }
+    s_stats.free_blocks++;
+    if (block->size > s_stats.largest_free_block) {
+      s_stats.largest_free_block = block->size;
+    }
+  }
+  return s_stats;
+}
+
+static BlockHeader *prv_next_block(BlockHeader *block) {
+  uint8_t *next = (uint8_t *)(block + 1) + block->size;
+  if (next >= s_heap + s_heap_size) {
+    return NULL;
+  }
+  return (BlockHeader *)next;
+}
+
+static void prv_merge_free_blocks(void) {
+  BlockHeader *block = (BlockHeader *)s_heap;
+  while (block) {
+    BlockHeader *next = prv_next_block(block);
+    if (next && !block->allocated && !next->allocated) {
+      block->size += next->size + sizeof(BlockHeader);
+      continue;
+    }
+    block = next;
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A stand-in for the watch firmware's heap: a fixed amount of memory, handed out first-fit, with a header on every
+// block. Freed blocks merge with free neighbours, but nothing ever moves, so it fragments much like the real one.
+
+typedef struct {
+  // Usable bytes, after the first block's header.
+  size_t size;
+  // Bytes taken by allocated blocks, headers included.
+  size_t used;
+  size_t peak_used;
+  size_t largest_free_block;
+  int free_blocks;
+  int allocations;
+  // Allocations that returned NULL, and how many of those would have fit if the free space had been in one piece.
+  int failures;
+  int fragmented_failures;
+} SimHeapStats;
+
+void sim_heap_init(size_t size);
+// pebble.h points malloc, free and heap_bytes_free at these.
+void *sim_heap_malloc(size_t size);
+void sim_heap_free(void *ptr);
+int heap_bytes_free(void);
+void sim_heap_deinit(void);
+SimHeapStats sim_heap_get_stats(void);
+// Makes every allocation bigger than this fail, as if no free block were large enough, until it's set back to zero.
+// For tests that need one particular allocation to fail.
+void sim_heap_set_allocation_limit(size_t size);
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Times what the legal, feedback and report windows do to their text when they open, both ways FormattedTextLayer
+// can get it: parsed on the watch from the .txt source, as the windows used to, and loaded from the fragment table
+// formatted_text.py built from it.
+//
+//   bobby_text_bench [--repeat N] TEXT_DIR
+//
+// TEXT_DIR is app/resources/text, where the .txt sources live. Times are the host's, so only good for comparing one
+// way with the other; layouts and heap are what the watch would see. Exits non-zero if the two ways lay a text out to
+// different heights.
+
+#include "sim_heap.h"
+
+#include <pebble.h>
+#include <pebble_shim.h>
+
+#include "util/fonts.h"
+#include "util/formatted_text_layer.h"
+#include "util/memory/malloc.h"
+#include "util/memory/pressure.h"
+
+// The sources are read into host memory, not the app's heap.
+#undef malloc
+#undef free
+
+#define DEFAULT_HEAP_SIZE (24 * 1024)
+#define DEFAULT_REPEAT 200
+#define MAX_PATH 512
+
+typedef struct {
+  const char *name;
+  const char *source;
+  uint32_t resource_id;
+  // The layer's frame, as the window creates it.
+  int16_t height;
+} BenchText;
+
+typedef struct {
+  int64_t median_ns;
+  uint32_t layout_calls;
+  size_t heap_bytes;
+  int16_t content_height;
+} BenchOpen;
+
+static const BenchText s_texts[] = {
+  { "legal", "legal.txt", RESOURCE_ID_LEGAL_TEXT, 10000 },
+  { "feedback blurb", "feedback_blurb.txt", RESOURCE_ID_FEEDBACK_BLURB, 2000 },
+  { "report blurb", "report_blurb.txt", RESOURCE_ID_REPORT_BLURB, 2000 },
+};
+#define TEXT_COUNT ((int)(sizeof(s_texts) / sizeof(s_texts[0])))
+
+static char *prv_read_file(const char *directory, const char *name, size_t *size);
+static BenchOpen prv_time_opens(const BenchText *text, const char *source, size_t source_size, int repeat);
+static int prv_compare_int64(const void *a, const void *b);
+static int64_t prv_host_ns(void);
+static void prv_usage(void);
+
+int main(int argc, char **argv) {
+  int repeat = DEFAULT_REPEAT;
+  const char *directory = NULL;
+  for (int arg = 1; arg < argc; ++arg) {
+    if (strcmp(argv[arg], "--repeat") == 0 && arg + 1 < argc) {
+      repeat = atoi(argv[++arg]);
+    } else if (argv[arg][0] != '-' && !directory) {
+      directory = argv[arg];
+    } else {
+      prv_usage();
+      return 2;
+    }
+  }
+  if (!directory || repeat < 1) {
+    prv_usage();
+    return 2;
+  }
+
+  sim_heap_init(DEFAULT_HEAP_SIZE);
+  pebble_shim_init();
+  memory_pressure_init();
+  bmalloc_init();
+  fonts_load();
+
+  printf("Opening each text, median of %d:\n", repeat);
+  printf("  %-16s %10s %10s %15s %15s %12s %12s\n", "", "us parsed", "us loaded", "layouts parsed", "layouts loaded",
+         "heap parsed", "heap loaded");
+  bool ok = true;
+  for (int i = 0; i < TEXT_COUNT; ++i) {
+    size_t source_size;
+    char *source = prv_read_file(directory, s_texts[i].source, &source_size);
+    if (!source) {
+      ok = false;
+      continue;
+    }
+    const BenchOpen parsed = prv_time_opens(&s_texts[i], source, source_size, repeat);
+    const BenchOpen loaded = prv_time_opens(&s_texts[i], NULL, 0, repeat);
+    printf("  %-16s %10.1f %10.1f %15u %15u %12zu %12zu\n", s_texts[i].name, parsed.median_ns / 1000.0,
+           loaded.median_ns / 1000.0, (unsigned)parsed.layout_calls, (unsigned)loaded.layout_calls, parsed.heap_bytes,
+           loaded.heap_bytes);
+    if (parsed.content_height != loaded.content_height) {
+      printf("  Parsed, %s is %d high; loaded, it's %d.\n", s_texts[i].name, parsed.content_height,
+             loaded.content_height);
+      ok = false;
+    }
+    free(source);
+  }
+  printf("  (heap is what the layer holds once it's open, in bytes)\n");
+
+  fonts_unload();
+  pebble_shim_deinit();
+  sim_heap_deinit();
+  return ok ? 0 : 1;
+}
+
+static char *prv_read_file(const char *directory, const char *name, size_t *size) {
+  char path[MAX_PATH];
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "Couldn't open %s\n", path);
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  *size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *data = malloc(*size + 1);
+  *size = fread(data, 1, *size, file);
+  data[*size] = '\0';
+  fclose(file);
+  return data;
+}
+
+// Opens the text repeat times, as the window does. With a source it's copied onto the heap first, standing in for the
+// resource_load the window used to do, and parsed; without one it's loaded from the precompiled resource.
+static BenchOpen prv_time_opens(const BenchText *text, const char *source, size_t source_size, int repeat) {
+  BenchOpen result = {0};
+  int64_t *times = malloc(sizeof(int64_t) * repeat);
+  for (int i = 0; i < repeat; ++i) {
+    const size_t used_before = sim_heap_get_stats().used;
+    const uint32_t layouts_before = pebble_shim_text_layout_calls();
+    const int64_t start = prv_host_ns();
+    FormattedTextLayer *layer = formatted_text_layer_create(GRect(5, 0, PBL_DISPLAY_WIDTH - 10, text->height));
+    char *copy = NULL;
+    if (source) {
+      copy = bmalloc(source_size + 1);
+      memcpy(copy, source, source_size + 1);
+      formatted_text_layer_set_text(layer, copy);
+    } else {
+      formatted_text_layer_set_precompiled_text(layer, text->resource_id);
+    }
+    result.content_height = formatted_text_layer_get_content_size(layer).h;
+    times[i] = prv_host_ns() - start;
+    result.layout_calls = pebble_shim_text_layout_calls() - layouts_before;
+    result.heap_bytes = sim_heap_get_stats().used - used_before;
+    formatted_text_layer_destroy(layer);
+    bfree(copy);
+  }
+  qsort(times, repeat, sizeof(int64_t), prv_compare_int64);
+  result.median_ns = times[repeat / 2];
+  free(times);
+  return result;
+}
+
+static int prv_compare_int64(const void *a, const void *b) {
+  const int64_t x = *(const int64_t *)a;
+  const int64_t y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int64_t prv_host_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void prv_usage(void) {
+  fprintf(stderr, "usage: bobby_text_bench [--repeat N] TEXT_DIR\n");
+}
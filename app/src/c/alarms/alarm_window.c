@@ -146,10 +146,10 @@ static void prv_window_unload(Window *window) {
   vector_sequence_layer_destroy(data->animation_layer);
   events_tick_timer_service_unsubscribe(data->tick_handle);
   if (data->name) {
-    free(data->name);
+    bfree(data->name);
   }
   sad_vibe_score_destroy(data->vibes);
-  free(data);
+  bfree(data);
   window_destroy(window);
 }
 
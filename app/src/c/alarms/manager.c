@@ -19,10 +19,10 @@
 #include "../util/persist_keys.h"
 #include "../util/memory/malloc.h"
 #include "../util/logging.h"
+#include "../util/app_message_router.h"
 
 #include "alarm_window.h"
 
-#include <pebble-events/pebble-events.h>
 #include <pebble.h>
 
 struct Alarm {
@@ -35,7 +35,7 @@ struct Alarm {
 struct AlarmManager {
   Alarm *pending_alarms;
   uint8_t pending_alarm_count;
-  EventHandle app_message_handle;
+  AppMessageRoute *app_message_route;
 };
 
 AlarmManager s_manager;
@@ -54,7 +54,8 @@ void alarm_manager_init() {
   wakeup_service_subscribe(prv_wakeup_handler);
   s_manager.pending_alarms = NULL;
   s_manager.pending_alarm_count = 0;
-  s_manager.app_message_handle = events_app_message_register_inbox_received(prv_handle_app_message_inbox_received, NULL);
+  const uint32_t keys[] = { MESSAGE_KEY_SET_ALARM_TIME, MESSAGE_KEY_GET_ALARM_OR_TIMER, MESSAGE_KEY_CANCEL_ALARM_TIME };
+  s_manager.app_message_route = app_message_router_subscribe(keys, sizeof(keys) / sizeof(keys[0]), prv_handle_app_message_inbox_received, NULL);
   prv_load_alarms();
 }
 
@@ -105,13 +106,10 @@ int alarm_manager_add_alarm(time_t when, bool is_timer, char* name, bool convers
         .widget = {
           .timer = {
             .target_time = alarm->scheduled_time,
+            .name = alarm->name,
           }
         }
       };
-      if (alarm->name) {
-        widget.widget.timer.name = bmalloc(name_len + 1);
-        strncpy(widget.widget.timer.name, alarm->name, name_len + 1);
-      }
       conversation_manager_add_widget(conversation_manager, &widget);
     } else {
       ConversationAction action = {
@@ -121,14 +119,10 @@ int alarm_manager_add_alarm(time_t when, bool is_timer, char* name, bool convers
             .time = alarm->scheduled_time,
             .is_timer = alarm->is_timer,
             .deleted = false,
-            .name = NULL,
+            .name = alarm->name,
           }
         }
       };
-      if (name) {
-        action.action.set_alarm.name = bmalloc(name_len + 1);
-        strncpy(action.action.set_alarm.name, name, name_len + 1);
-      }
       conversation_manager_add_action(conversation_manager, &action);
     }
   }
@@ -154,9 +148,9 @@ int alarm_manager_add_alarm(time_t when, bool is_timer, char* name, bool convers
     if (i == s_manager.pending_alarm_count - 1) {
       new_alarms[i] = *alarm;
     }
-    free(s_manager.pending_alarms);
+    bfree(s_manager.pending_alarms);
     s_manager.pending_alarms = new_alarms;
-    free(alarm);
+    bfree(alarm);
   }
   prv_save_alarms();
   return 0;
@@ -295,24 +289,19 @@ static void prv_remove_alarm(int to_remove) {
           .time = alarm->scheduled_time,
           .is_timer = alarm->is_timer,
           .deleted = true,
-          .name = NULL,
+          .name = alarm->name,
         }
       }
     };
-    if (alarm->name) {
-      size_t name_len = strlen(alarm->name);
-      action.action.set_alarm.name = bmalloc(name_len + 1);
-      strncpy(action.action.set_alarm.name, alarm->name, name_len + 1);
-    }
     conversation_manager_add_action(conversation_manager, &action);
   }
 
   if (alarm->name) {
-    free(alarm->name);
+    bfree(alarm->name);
   }
 
   if (s_manager.pending_alarm_count == 1) {
-    free(s_manager.pending_alarms);
+    bfree(s_manager.pending_alarms);
     s_manager.pending_alarms = NULL;
     s_manager.pending_alarm_count = 0;
     return;
@@ -326,7 +315,7 @@ static void prv_remove_alarm(int to_remove) {
     ++j;
   }
   s_manager.pending_alarm_count--;
-  free(s_manager.pending_alarms);
+  bfree(s_manager.pending_alarms);
   s_manager.pending_alarms = new_alarms;
 }
 
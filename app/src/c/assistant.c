@@ -28,7 +28,10 @@
 #include <pebble-events/pebble-events.h>
 
 #include "util/fonts.h"
+#include "util/app_message_router.h"
 #include "util/logging.h"
+#include "util/memory/heap_report.h"
+#include "util/memory/malloc.h"
 #include "util/memory/pressure.h"
 
 
@@ -38,6 +41,9 @@ static RootWindow* s_root_window = NULL;
 
 static void prv_init(void) {
   memory_pressure_init();
+  bmalloc_init();
+  app_message_router_init();
+  heap_report_init();
   version_init();
   consent_migrate();
   settings_init();
@@ -21,11 +21,11 @@
 #include "../util/logging.h"
 #include "../util/memory/malloc.h"
 #include "../util/memory/sdk.h"
+#include "../util/app_message_router.h"
 #include "../version/version.h"
 #include "../root_window.h"
 
 #include <pebble.h>
-#include <pebble-events/pebble-events.h>
 
 
 #define STAGE_LLM_WARNING 0
@@ -44,7 +44,7 @@ typedef struct {
   ActionMenu* action_menu;
   int stage;
   int expected_app_response;
-  EventHandle app_message_handle;
+  AppMessageRoute *app_message_route;
 } ConsentWindowData;
 
 static void prv_set_stage(Window* window, int stage);
@@ -134,7 +134,8 @@ static void prv_window_load(Window *window) {
     .click_config_provider = prv_click_config_provider,
   });
   scroll_layer_set_context(data->scroll_layer, window);
-  data->app_message_handle = events_app_message_register_inbox_received(prv_app_message_handler, window);
+  const uint32_t keys[] = { MESSAGE_KEY_LOCATION_ENABLED };
+  data->app_message_route = app_message_router_subscribe(keys, 1, prv_app_message_handler, window);
 }
 
 static void prv_click_config_provider(void *context) {
@@ -154,13 +155,13 @@ static void prv_window_unload(Window *window) {
   gbitmap_destroy(data->select_indicator_bitmap);
   bitmap_layer_destroy(data->select_indicator_layer);
   layer_destroy(data->content_indicator_layer);
-  free(data);
+  bfree(data);
 }
 
 static void prv_set_stage(Window* window, int stage) {
   ConsentWindowData *data = window_get_user_data(window);
   if (data->current_text) {
-    free(data->current_text);
+    bfree(data->current_text);
     data->current_text = NULL;
   }
   ResHandle res_handle = NULL;
@@ -252,7 +253,7 @@ static void prv_consent_menu_select_callback(ActionMenu *action_menu, const Acti
   Window *window = context;
   ConsentWindowData *data = window_get_user_data(window);
   data->expected_app_response = STAGE_LOCATION_CONSENT;
-  bool choice = (int)action_menu_item_get_action_data(action);
+  bool choice = (int)(intptr_t)action_menu_item_get_action_data(action);
   action_menu_freeze(action_menu);
   // We need to inform the phone of the user's choice.
   DictionaryIterator *iter;
@@ -274,7 +275,8 @@ static void prv_app_message_handler(DictionaryIterator *iter, void *context) {
   }
   data->expected_app_response = 0;
   BOBBY_LOG(APP_LOG_LEVEL_INFO, "Got location enabled reply, dismissing dialog.");
-  events_app_message_unsubscribe(data->app_message_handle);
+  app_message_router_unsubscribe(data->app_message_route);
+  data->app_message_route = NULL;
   bool location_enabled = tuple->value->int16;
   persist_write_bool(PERSIST_KEY_LOCATION_ENABLED, location_enabled);
   prv_mark_consents_complete();
@@ -16,6 +16,7 @@
 
 #include "conversation.h"
 #include "../image_manager/image_manager.h"
+#include "../util/memory/arena.h"
 #include "../util/memory/malloc.h"
 #include "../util/logging.h"
 #include "../features.h"
@@ -32,293 +33,639 @@ struct ConversationEntry {
   } content;
 };
 
+// Entries live in fixed-size chunks that are chained together, oldest first. New entries are appended
+// to the tail chunk, and evicting the oldest entry just advances the head. Entries never move once
+// created, so pointers handed out to SegmentLayers etc. stay valid until the entry is deleted.
+#define ENTRY_CHUNK_SIZE 8
+
+// Streamed response text is stored in chunks holding at least this many bytes.
+#define RESPONSE_CHUNK_SIZE 128
+
+struct ConversationResponseChunk {
+  ConversationResponseChunk *next;
+  uint16_t len;
+  uint16_t capacity;
+  char text[];
+};
+
+// Entry payloads and their strings are packed together into a single allocation from the conversation's
+// arena, which is carved out of blocks of this size.
+#define ARENA_CHUNK_SIZE 256
+
+// Number of EntryType values, including EntryTypeDeleted.
+#define ENTRY_TYPE_COUNT (EntryTypeError + 1)
+
+typedef struct EntryChunk {
+  struct EntryChunk *prev;
+  struct EntryChunk *next;
+  ConversationEntry entries[ENTRY_CHUNK_SIZE];
+} EntryChunk;
+
 struct Conversation {
-  ConversationEntry* entries;
-  int deleted_entries;
-  int nulled_entries;
+  EntryChunk* head_chunk;
+  EntryChunk* tail_chunk;
+  // Index of the oldest held entry in head_chunk.
+  int head;
+  // Index one past the newest entry in tail_chunk.
+  int tail;
+  // Number of slots between head and tail, including thoughts that were deleted in place.
+  int slot_count;
+  // Number of entries that haven't been deleted.
   int entry_count;
-  int entry_allocated;
+  // The response currently receiving fragments, if any.
+  ConversationResponse* open_response;
+  // The newest entry of each type. A type whose bit is set in stale_types has lost its newest entry
+  // and is found again by scanning the next time somebody asks for it.
+  ConversationEntry* last_of_type[ENTRY_TYPE_COUNT];
+  uint8_t stale_types;
+  Arena* arena;
   char thread_id[37];
 };
 
-static ConversationEntry* prv_create_entry(Conversation* conversation);
-void prv_destroy_entry(ConversationEntry *entry);
+static ConversationEntry* prv_create_entry(Conversation* conversation, EntryType type);
+static ConversationEntry* prv_last_slot(Conversation* conversation);
+static bool prv_step_back(Conversation* conversation, EntryChunk** chunk, int* index);
+static void prv_advance_head(Conversation* conversation);
+static void prv_destroy_entry(Conversation* conversation, ConversationEntry *entry);
+static bool prv_no_room_for(EntryType type);
+static void prv_append_to_response(ConversationResponse *response, const char* fragment);
+static void prv_free_response_text(ConversationResponse *response);
 const char* prv_type_to_string(EntryType type);
 
 Conversation* conversation_create() {
   Conversation *conversation = bmalloc(sizeof(Conversation));
-  conversation->deleted_entries = 0;
-  conversation->nulled_entries = 0;
+  // Chunks are allocated on demand when the first entry arrives.
+  conversation->head_chunk = NULL;
+  conversation->tail_chunk = NULL;
+  conversation->head = 0;
+  conversation->tail = 0;
+  conversation->slot_count = 0;
   conversation->entry_count = 0;
-  conversation->entry_allocated = 30;
-  conversation->entries = bmalloc(sizeof(ConversationEntry) * conversation->entry_allocated);
+  conversation->open_response = NULL;
+  memset(conversation->last_of_type, 0, sizeof(conversation->last_of_type));
+  conversation->stale_types = 0;
+  conversation->arena = arena_create(ARENA_CHUNK_SIZE);
   conversation->thread_id[0] = 0;
   return conversation;
 }
 
 void conversation_destroy(Conversation* conversation) {
-  for (int i = conversation->deleted_entries; i < conversation->entry_count; ++i) {
-    prv_destroy_entry(&conversation->entries[i]);
+  EntryChunk* chunk = conversation->head_chunk;
+  int start = conversation->head;
+  while (chunk) {
+    int end = chunk == conversation->tail_chunk ? conversation->tail : ENTRY_CHUNK_SIZE;
+    for (int i = start; i < end; ++i) {
+      prv_destroy_entry(conversation, &chunk->entries[i]);
+    }
+    EntryChunk* next = chunk->next;
+    bfree(chunk);
+    chunk = next;
+    start = 0;
   }
-  free(conversation->entries);
-  free(conversation);
+  arena_destroy(conversation->arena);
+  bfree(conversation);
 }
 
-void prv_destroy_entry(ConversationEntry *entry) {
+static void prv_destroy_entry(Conversation* conversation, ConversationEntry *entry) {
+  if (entry->type != EntryTypeDeleted && conversation->last_of_type[entry->type] == entry) {
+    conversation->last_of_type[entry->type] = NULL;
+    conversation->stale_types |= 1 << entry->type;
+  }
+  if (entry->type == EntryTypeResponse && entry->content.response == conversation->open_response) {
+    conversation->open_response = NULL;
+  }
+  // Strings belonging to each payload were packed into the same arena allocation, so there's only one
+  // thing to free for most entries.
   switch (entry->type) {
     case EntryTypeDeleted:
       // Nothing to do here.
-      break;
+      return;
     case EntryTypePrompt:
-      free(entry->content.prompt->prompt);
-      free(entry->content.prompt);
+      arena_free(conversation->arena, entry->content.prompt);
       break;
     case EntryTypeResponse:
-      free(entry->content.response->response);
-      free(entry->content.response);
+      prv_free_response_text(entry->content.response);
+      arena_free(conversation->arena, entry->content.response);
       break;
     case EntryTypeThought:
-      free(entry->content.thought->thought);
-      free(entry->content.thought);
+      arena_free(conversation->arena, entry->content.thought);
       break;
     case EntryTypeError:
-      free(entry->content.error->message);
-      free(entry->content.error);
+      arena_free(conversation->arena, entry->content.error);
       break;
     case EntryTypeAction:
-      // Only alarms and generic sentence actions need further cleanup.
-      switch (entry->content.action->type) {
-        case ConversationActionTypeSetAlarm:
-          if (entry->content.action->action.set_alarm.name) {
-            free(entry->content.action->action.set_alarm.name);
-          }
-          break;
-        case ConversationActionTypeGenericSentence:
-          free(entry->content.action->action.generic_sentence.sentence);
-          break;
-        case ConversationActionTypeSetReminder:
-        case ConversationActionTypeDeleteReminder:
-        case ConversationActionTypeSendFeedback:
-        case ConversationActionTypeUpdateChecklist:
-          // These have nothing to clean up.
-          break;
-      }
-      free(entry->content.action);
+      arena_free(conversation->arena, entry->content.action);
       break;
     case EntryTypeWidget:
-      switch (entry->content.widget->type) {
-        case ConversationWidgetTypeWeatherSingleDay:
-          free(entry->content.widget->widget.weather_single_day.location);
-          free(entry->content.widget->widget.weather_single_day.summary);
-          free(entry->content.widget->widget.weather_single_day.temp_unit);
-          free(entry->content.widget->widget.weather_single_day.day);
-          break;
-        case ConversationWidgetTypeWeatherCurrent:
-          free(entry->content.widget->widget.weather_current.location);
-          free(entry->content.widget->widget.weather_current.summary);
-          free(entry->content.widget->widget.weather_current.wind_speed_unit);
-          break;
-        case ConversationWidgetTypeWeatherMultiDay:
-          free(entry->content.widget->widget.weather_multi_day.location);
-          break;
-        case ConversationWidgetTypeTimer:
-          if (entry->content.widget->widget.timer.name) {
-            free(entry->content.widget->widget.timer.name);
-          }
-          break;
-        case ConversationWidgetTypeNumber:
-          free(entry->content.widget->widget.number.number);
-          if (entry->content.widget->widget.number.unit) {
-            free(entry->content.widget->widget.number.unit);
-          }
-          break;
 #if ENABLE_FEATURE_MAPS
-        case ConversationWidgetTypeMap:
-          image_manager_destroy_image(entry->content.widget->widget.map.image_id);
-          break;
-#endif
+      if (entry->content.widget->type == ConversationWidgetTypeMap) {
+        image_manager_destroy_image(entry->content.widget->widget.map.image_id);
       }
-      free(entry->content.widget);
+#endif
+      arena_free(conversation->arena, entry->content.widget);
       break;
   }
   entry->type = EntryTypeDeleted;
 }
 
-static ConversationEntry* prv_create_entry(Conversation* conversation) {
-  if (conversation->entry_count >= conversation->entry_allocated) {
-    ConversationEntry *new_entries = bmalloc(sizeof(ConversationEntry) * (conversation->entry_allocated + 1));
-    memcpy(new_entries, conversation->entries, sizeof(ConversationEntry) * conversation->entry_allocated);
-    ++conversation->entry_allocated;
-    conversation->entries = new_entries;
+static size_t prv_string_size(const char* str) {
+  return str ? strlen(str) + 1 : 0;
+}
+
+// Copies str to *cursor and advances the cursor past it.
+static char* prv_pack_string(char** cursor, const char* str) {
+  if (!str) {
+    return NULL;
+  }
+  size_t size = strlen(str) + 1;
+  char* packed = *cursor;
+  memcpy(packed, str, size);
+  *cursor += size;
+  return packed;
+}
+
+// Gathers the addresses of every string a widget owns. Returns how many there are.
+static int prv_widget_string_fields(ConversationWidget* widget, char** fields[4]) {
+  switch (widget->type) {
+    case ConversationWidgetTypeWeatherSingleDay:
+      fields[0] = &widget->widget.weather_single_day.location;
+      fields[1] = &widget->widget.weather_single_day.summary;
+      fields[2] = &widget->widget.weather_single_day.temp_unit;
+      fields[3] = &widget->widget.weather_single_day.day;
+      return 4;
+    case ConversationWidgetTypeWeatherCurrent:
+      fields[0] = &widget->widget.weather_current.location;
+      fields[1] = &widget->widget.weather_current.summary;
+      fields[2] = &widget->widget.weather_current.wind_speed_unit;
+      return 3;
+    case ConversationWidgetTypeWeatherMultiDay:
+      fields[0] = &widget->widget.weather_multi_day.location;
+      return 1;
+    case ConversationWidgetTypeTimer:
+      fields[0] = &widget->widget.timer.name;
+      return 1;
+    case ConversationWidgetTypeNumber:
+      fields[0] = &widget->widget.number.number;
+      fields[1] = &widget->widget.number.unit;
+      return 2;
+#if ENABLE_FEATURE_MAPS
+    case ConversationWidgetTypeMap:
+      return 0;
+#endif
+  }
+  return 0;
+}
+
+// Returns the address of the string an action owns, if any.
+static char** prv_action_string_field(ConversationAction* action) {
+  switch (action->type) {
+    case ConversationActionTypeSetAlarm:
+      return &action->action.set_alarm.name;
+    case ConversationActionTypeGenericSentence:
+      return &action->action.generic_sentence.sentence;
+    case ConversationActionTypeSetReminder:
+    case ConversationActionTypeDeleteReminder:
+    case ConversationActionTypeSendFeedback:
+    case ConversationActionTypeUpdateChecklist:
+      break;
+  }
+  return NULL;
+}
+
+static ConversationEntry* prv_create_entry(Conversation* conversation, EntryType type) {
+  if (conversation->tail_chunk == NULL || conversation->tail == ENTRY_CHUNK_SIZE) {
+    EntryChunk *chunk = bmalloc(sizeof(EntryChunk));
+    if (chunk == NULL) {
+      return NULL;
+    }
+    chunk->prev = conversation->tail_chunk;
+    chunk->next = NULL;
+    if (conversation->tail_chunk) {
+      conversation->tail_chunk->next = chunk;
+    } else {
+      conversation->head_chunk = chunk;
+      conversation->head = 0;
+    }
+    conversation->tail_chunk = chunk;
+    conversation->tail = 0;
+  }
+  ConversationEntry *entry = &conversation->tail_chunk->entries[conversation->tail++];
+  memset(entry, 0, sizeof(ConversationEntry));
+  entry->type = type;
+  conversation->slot_count++;
+  conversation->entry_count++;
+  conversation->last_of_type[type] = entry;
+  conversation->stale_types &= ~(1 << type);
+  return entry;
+}
+
+static ConversationEntry* prv_last_slot(Conversation* conversation) {
+  if (conversation->slot_count == 0) {
+    return NULL;
   }
-  memset(&conversation->entries[conversation->entry_count], 0, sizeof(ConversationEntry));
-  return &conversation->entries[conversation->entry_count++];
+  return &conversation->tail_chunk->entries[conversation->tail - 1];
 }
 
-void conversation_add_prompt(Conversation* conversation, const char* prompt_text) {
-  ConversationEntry *entry = prv_create_entry(conversation);
-  entry->type = EntryTypePrompt;
-  ConversationPrompt *prompt = bmalloc(sizeof(ConversationPrompt));
-  prompt->prompt = bmalloc(strlen(prompt_text) + 1);
-  strcpy(prompt->prompt, prompt_text);
+// Moves (chunk, index) back by one slot. Returns false if that would walk past the oldest held entry.
+// Start from (tail_chunk, tail) to visit the newest entry first.
+static bool prv_step_back(Conversation* conversation, EntryChunk** chunk, int* index) {
+  if (*chunk == NULL) {
+    return false;
+  }
+  if (*chunk == conversation->head_chunk) {
+    if (*index <= conversation->head) {
+      return false;
+    }
+    --*index;
+    return true;
+  }
+  if (*index > 0) {
+    --*index;
+    return true;
+  }
+  *chunk = (*chunk)->prev;
+  *index = ENTRY_CHUNK_SIZE - 1;
+  return true;
+}
+
+// Drops the oldest slot, which must already have been destroyed.
+static void prv_advance_head(Conversation* conversation) {
+  conversation->head++;
+  conversation->slot_count--;
+  if (conversation->head < ENTRY_CHUNK_SIZE) {
+    return;
+  }
+  EntryChunk *chunk = conversation->head_chunk;
+  if (chunk == conversation->tail_chunk) {
+    // Everything has been consumed; start over at the beginning of the same chunk.
+    conversation->head = 0;
+    conversation->tail = 0;
+    return;
+  }
+  conversation->head_chunk = chunk->next;
+  conversation->head_chunk->prev = NULL;
+  conversation->head = 0;
+  bfree(chunk);
+}
+
+// Logs that an entry couldn't be added for lack of memory; returns false, for the caller to pass on.
+static bool prv_no_room_for(EntryType type) {
+  BOBBY_LOG(APP_LOG_LEVEL_ERROR, "No room for a new %s; dropping it.", prv_type_to_string(type));
+  return false;
+}
+
+bool conversation_add_prompt(Conversation* conversation, const char* prompt_text) {
+  ConversationPrompt *prompt = arena_alloc(conversation->arena, sizeof(ConversationPrompt) + prv_string_size(prompt_text));
+  if (prompt == NULL) {
+    return prv_no_room_for(EntryTypePrompt);
+  }
+  char *cursor = (char *)(prompt + 1);
+  prompt->prompt = prv_pack_string(&cursor, prompt_text);
+  ConversationEntry *entry = prv_create_entry(conversation, EntryTypePrompt);
+  if (entry == NULL) {
+    arena_free(conversation->arena, prompt);
+    return prv_no_room_for(EntryTypePrompt);
+  }
   entry->content.prompt = prompt;
+  return true;
 }
 
-void conversation_add_response(Conversation* conversation, const char* response_text) {
-  ConversationEntry *entry = prv_create_entry(conversation);
-  entry->type = EntryTypeResponse;
-  ConversationResponse *response = bmalloc(sizeof(ConversationResponse));
+bool conversation_add_response(Conversation* conversation, const char* response_text) {
+  ConversationResponse *response = arena_alloc(conversation->arena, sizeof(ConversationResponse));
+  if (response == NULL) {
+    return prv_no_room_for(EntryTypeResponse);
+  }
+  response->first = NULL;
+  response->last = NULL;
+  response->len = 0;
+  prv_append_to_response(response, response_text);
   response->complete = true;
-  response->len = strlen(response_text);
-  response->allocated = response->len + 1;
-  response->response = bmalloc(response->allocated);
-  strcpy(response->response, response_text);
+  ConversationEntry *entry = prv_create_entry(conversation, EntryTypeResponse);
+  if (entry == NULL) {
+    prv_free_response_text(response);
+    arena_free(conversation->arena, response);
+    return prv_no_room_for(EntryTypeResponse);
+  }
   entry->content.response = response;
+  return true;
 }
 
-void conversation_start_response(Conversation *conversation) {
-  ConversationEntry *entry = prv_create_entry(conversation);
-  entry->type = EntryTypeResponse;
-  ConversationResponse *response = bmalloc(sizeof(ConversationResponse));
-  response->complete = false;
+bool conversation_start_response(Conversation *conversation) {
+  ConversationResponse *response = arena_alloc(conversation->arena, sizeof(ConversationResponse));
+  if (response == NULL) {
+    return prv_no_room_for(EntryTypeResponse);
+  }
+  response->first = NULL;
+  response->last = NULL;
   response->len = 0;
-  response->allocated = 8;
-  response->response = bmalloc(response->allocated);
-  response->response[0] = 0;
+  response->complete = false;
+  ConversationEntry *entry = prv_create_entry(conversation, EntryTypeResponse);
+  if (entry == NULL) {
+    arena_free(conversation->arena, response);
+    return prv_no_room_for(EntryTypeResponse);
+  }
   entry->content.response = response;
+  conversation->open_response = response;
+  return true;
 }
 
 static void prv_append_to_response(ConversationResponse *response, const char* fragment) {
   size_t len = strlen(fragment);
-  while (response->len + len >= response->allocated) {
-    response->allocated *= 2;
-    char* new_resp = bmalloc(response->allocated);
-    BOBBY_LOG(APP_LOG_LEVEL_INFO, "Expanding buffer to %d bytes. New buffer: %p. Old buffer: %p.", response->allocated, new_resp, response->response);
-    strcpy(new_resp, response->response);
-    BOBBY_LOG(APP_LOG_LEVEL_INFO, "Copied %d bytes.", strlen(response->response) + 1);
-    free(response->response);
-    response->response = new_resp;
-  }
-  response->len += len;
-  strcat(response->response, fragment);
-}
-
-static ConversationResponse* prv_find_last_open_response(Conversation* conversation) {
-  for (int i = conversation->entry_count - 1; i >= conversation->deleted_entries; --i) {
-    ConversationEntry* entry = &conversation->entries[i];
-    if (entry->type != EntryTypeResponse) {
-      continue;
+  while (len > 0) {
+    ConversationResponseChunk *chunk = response->last;
+    if (chunk == NULL || chunk->len == chunk->capacity) {
+      // Whatever doesn't fit goes in a fresh chunk; the text already stored never moves.
+      size_t capacity = len > RESPONSE_CHUNK_SIZE ? len : RESPONSE_CHUNK_SIZE;
+      chunk = bmalloc(sizeof(ConversationResponseChunk) + capacity);
+      if (chunk == NULL) {
+        BOBBY_LOG(APP_LOG_LEVEL_ERROR, "No room for the rest of the response; dropping %d bytes.", len);
+        return;
+      }
+      BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "New %d byte response chunk: %p.", capacity, chunk);
+      chunk->next = NULL;
+      chunk->len = 0;
+      chunk->capacity = capacity;
+      if (response->last) {
+        response->last->next = chunk;
+      } else {
+        response->first = chunk;
+      }
+      response->last = chunk;
     }
-    if (!entry->content.response->complete) {
-      return entry->content.response;
+    size_t to_copy = chunk->capacity - chunk->len;
+    if (to_copy > len) {
+      to_copy = len;
     }
+    memcpy(chunk->text + chunk->len, fragment, to_copy);
+    chunk->len += to_copy;
+    response->len += to_copy;
+    fragment += to_copy;
+    len -= to_copy;
   }
-  return NULL;
+}
+
+static void prv_free_response_text(ConversationResponse *response) {
+  ConversationResponseChunk *chunk = response->first;
+  while (chunk) {
+    ConversationResponseChunk *next = chunk->next;
+    bfree(chunk);
+    chunk = next;
+  }
+  response->first = NULL;
+  response->last = NULL;
+  response->len = 0;
+}
+
+void conversation_response_cursor_init(ConversationResponse* response, ConversationResponseCursor* cursor, size_t offset) {
+  const ConversationResponseChunk *chunk = response->first;
+  while (chunk && offset >= chunk->len) {
+    offset -= chunk->len;
+    chunk = chunk->next;
+  }
+  cursor->chunk = chunk;
+  cursor->offset = chunk ? offset : 0;
+}
+
+const char* conversation_response_cursor_next(ConversationResponseCursor* cursor, size_t* length) {
+  const ConversationResponseChunk *chunk = cursor->chunk;
+  if (chunk == NULL) {
+    *length = 0;
+    return NULL;
+  }
+  const char *run = chunk->text + cursor->offset;
+  *length = chunk->len - cursor->offset;
+  cursor->chunk = chunk->next;
+  cursor->offset = 0;
+  return run;
+}
+
+size_t conversation_response_copy(ConversationResponse* response, size_t offset, char* buffer, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  ConversationResponseCursor cursor;
+  conversation_response_cursor_init(response, &cursor, offset);
+  size_t copied = 0;
+  size_t run_length;
+  const char *run;
+  while (copied < size - 1 && (run = conversation_response_cursor_next(&cursor, &run_length))) {
+    if (run_length > size - 1 - copied) {
+      run_length = size - 1 - copied;
+    }
+    memcpy(buffer + copied, run, run_length);
+    copied += run_length;
+  }
+  buffer[copied] = '\0';
+  return copied;
 }
 
 bool conversation_add_response_fragment(Conversation* conversation, const char* fragment) {
-  ConversationResponse* response = prv_find_last_open_response(conversation);
+  ConversationResponse* response = conversation->open_response;
   bool added_entry = false;
   if (response == NULL) {
+    if (!conversation_start_response(conversation)) {
+      return false;
+    }
     added_entry = true;
-    conversation_start_response(conversation);
-    response = prv_find_last_open_response(conversation);
+    response = conversation->open_response;
   }
   prv_append_to_response(response, fragment);
   return added_entry;
 }
 
 void conversation_complete_response(Conversation *conversation) {
-  ConversationResponse* response = prv_find_last_open_response(conversation);
+  ConversationResponse* response = conversation->open_response;
   if (response == NULL) {
     BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Trying to complete a response, but couldn't find any.");
     return;
   }
   response->complete = true;
+  conversation->open_response = NULL;
 }
 
-void conversation_add_thought(Conversation* conversation, char* thought_text) {
-  ConversationEntry* entry = prv_create_entry(conversation);
-  ConversationThought* thought = bmalloc(sizeof(ConversationThought));
-  thought->thought = bmalloc(strlen(thought_text) + 1);
-  strcpy(thought->thought, thought_text);
-  entry->type = EntryTypeThought;
+bool conversation_add_thought(Conversation* conversation, char* thought_text) {
+  ConversationThought* thought = arena_alloc(conversation->arena, sizeof(ConversationThought) + prv_string_size(thought_text));
+  if (thought == NULL) {
+    return prv_no_room_for(EntryTypeThought);
+  }
+  char* cursor = (char*)(thought + 1);
+  thought->thought = prv_pack_string(&cursor, thought_text);
+  ConversationEntry* entry = prv_create_entry(conversation, EntryTypeThought);
+  if (entry == NULL) {
+    arena_free(conversation->arena, thought);
+    return prv_no_room_for(EntryTypeThought);
+  }
   entry->content.thought = thought;
+  return true;
 }
 
-void conversation_add_action(Conversation* conversation, ConversationAction* action) {
-  ConversationAction* new_action = bmalloc(sizeof(ConversationAction));
+bool conversation_add_action(Conversation* conversation, ConversationAction* action) {
+  char** source_field = prv_action_string_field(action);
+  const char* text = source_field ? *source_field : NULL;
+  ConversationAction* new_action = arena_alloc(conversation->arena, sizeof(ConversationAction) + prv_string_size(text));
+  if (new_action == NULL) {
+    return prv_no_room_for(EntryTypeAction);
+  }
   memcpy(new_action, action, sizeof(ConversationAction));
-  ConversationEntry* entry = prv_create_entry(conversation);
-  entry->type = EntryTypeAction;
+  if (source_field) {
+    char* cursor = (char*)(new_action + 1);
+    *prv_action_string_field(new_action) = prv_pack_string(&cursor, text);
+  }
+  ConversationEntry* entry = prv_create_entry(conversation, EntryTypeAction);
+  if (entry == NULL) {
+    arena_free(conversation->arena, new_action);
+    return prv_no_room_for(EntryTypeAction);
+  }
   entry->content.action = new_action;
+  return true;
 }
 
-void conversation_add_error(Conversation* conversation, const char* error_text) {
-  ConversationEntry* entry = prv_create_entry(conversation);
-  ConversationError* error = bmalloc(sizeof(ConversationError));
-  error->message = bmalloc(strlen(error_text) + 1);
-  strcpy(error->message, error_text);
-  entry->type = EntryTypeError;
+bool conversation_add_error(Conversation* conversation, const char* error_text) {
+  ConversationError* error = arena_alloc(conversation->arena, sizeof(ConversationError) + prv_string_size(error_text));
+  if (error == NULL) {
+    return prv_no_room_for(EntryTypeError);
+  }
+  char* cursor = (char*)(error + 1);
+  error->message = prv_pack_string(&cursor, error_text);
+  ConversationEntry* entry = prv_create_entry(conversation, EntryTypeError);
+  if (entry == NULL) {
+    arena_free(conversation->arena, error);
+    return prv_no_room_for(EntryTypeError);
+  }
   entry->content.error = error;
+  return true;
 }
 
-void conversation_add_widget(Conversation* conversation, ConversationWidget* widget) {
-  ConversationWidget* new_widget = bmalloc(sizeof(ConversationWidget));
+bool conversation_add_widget(Conversation* conversation, ConversationWidget* widget) {
+  char** fields[4];
+  int field_count = prv_widget_string_fields(widget, fields);
+  size_t size = sizeof(ConversationWidget);
+  for (int i = 0; i < field_count; ++i) {
+    size += prv_string_size(*fields[i]);
+  }
+  ConversationWidget* new_widget = arena_alloc(conversation->arena, size);
+  if (new_widget == NULL) {
+    return prv_no_room_for(EntryTypeWidget);
+  }
   memcpy(new_widget, widget, sizeof(ConversationWidget));
-  ConversationEntry* entry = prv_create_entry(conversation);
-  entry->type = EntryTypeWidget;
+  // The new widget's string fields still point at the caller's strings; pack copies in behind the struct.
+  char* cursor = (char*)(new_widget + 1);
+  prv_widget_string_fields(new_widget, fields);
+  for (int i = 0; i < field_count; ++i) {
+    *fields[i] = prv_pack_string(&cursor, *fields[i]);
+  }
+  ConversationEntry* entry = prv_create_entry(conversation, EntryTypeWidget);
+  if (entry == NULL) {
+    arena_free(conversation->arena, new_widget);
+    return prv_no_room_for(EntryTypeWidget);
+  }
   entry->content.widget = new_widget;
+  return true;
 }
 
 void conversation_delete_first_entry(Conversation* conversation) {
-  ConversationEntry* entry = &conversation->entries[conversation->deleted_entries];
-  while (entry->type == EntryTypeDeleted && conversation->deleted_entries < conversation->entry_count) {
-    conversation->deleted_entries++;
-    conversation->nulled_entries--;
-    entry = &conversation->entries[conversation->deleted_entries];
+  // Thoughts deleted in place leave a hole; skip over those to find the oldest real entry.
+  while (conversation->slot_count > 0) {
+    ConversationEntry* entry = &conversation->head_chunk->entries[conversation->head];
+    bool was_deleted = entry->type == EntryTypeDeleted;
+    prv_destroy_entry(conversation, entry);
+    prv_advance_head(conversation);
+    if (!was_deleted) {
+      conversation->entry_count--;
+      return;
+    }
   }
-  prv_destroy_entry(entry);
-  conversation->deleted_entries++;
 }
 
 
 void conversation_delete_last_thought(Conversation* conversation) {
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Deleting last thought");
-  for (int i = conversation->entry_count - 2; i >= conversation->deleted_entries; --i) {
-    ConversationEntry* entry = &conversation->entries[i];
+  ConversationEntry* newest = prv_last_slot(conversation);
+  ConversationEntry* thought = conversation_get_last_of_type(conversation, EntryTypeThought);
+  if (thought == NULL) {
+    return;
+  }
+  // The newest entry is what replaced the thought, so the thought we're after is older than it. That's
+  // almost always the latest thought; only a thought replacing a thought needs to look further back.
+  if (thought != newest) {
+    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Deleting thought %p", thought);
+    prv_destroy_entry(conversation, thought);
+    conversation->entry_count--;
+    return;
+  }
+  EntryChunk* chunk = conversation->tail_chunk;
+  int i = conversation->tail - 1;
+  while (prv_step_back(conversation, &chunk, &i)) {
+    ConversationEntry* entry = &chunk->entries[i];
     if (entry->type == EntryTypeThought) {
-      BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Deleting thought %d", i);
-      prv_destroy_entry(entry);
+      BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Deleting thought %p", entry);
+      prv_destroy_entry(conversation, entry);
+      conversation->entry_count--;
       return;
     }
   }
 }
 
 ConversationEntry* conversation_entry_at_index(Conversation* conversation, int index) {
-  if (index >= conversation->entry_count) {
-    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Caller asked for entry %d, but only %d exist.", index, conversation->entry_count);
+  if (index < 0 || index >= conversation->slot_count) {
+    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Caller asked for entry %d, but only %d exist.", index, conversation->slot_count);
     return NULL;
   }
-  return &conversation->entries[index];
+  index += conversation->head;
+  EntryChunk* chunk = conversation->head_chunk;
+  while (index >= ENTRY_CHUNK_SIZE) {
+    chunk = chunk->next;
+    index -= ENTRY_CHUNK_SIZE;
+  }
+  return &chunk->entries[index];
+}
+
+// The oldest entry that hasn't been deleted, which is the one conversation_delete_first_entry would delete next.
+ConversationEntry* conversation_first_entry(Conversation* conversation) {
+  EntryChunk* chunk = conversation->head_chunk;
+  int index = conversation->head;
+  for (int i = 0; i < conversation->slot_count; ++i) {
+    if (index == ENTRY_CHUNK_SIZE) {
+      chunk = chunk->next;
+      index = 0;
+    }
+    ConversationEntry* entry = &chunk->entries[index++];
+    if (entry->type != EntryTypeDeleted) {
+      return entry;
+    }
+  }
+  return NULL;
 }
 
 ConversationEntry* conversation_peek(Conversation* conversation) {
-  if (conversation->entry_count == conversation->deleted_entries) {
+  ConversationEntry* entry = prv_last_slot(conversation);
+  if (entry == NULL) {
     BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Tried to peek at conversation, but no entries yet.");
-    return NULL;
   }
-  return &conversation->entries[conversation->entry_count-1];
+  return entry;
 }
 
 ConversationEntry* conversation_get_last_of_type(Conversation* conversation, EntryType type) {
-  for (int i = conversation->entry_count - 1; i >= conversation->deleted_entries; --i) {
-    ConversationEntry* entry = &conversation->entries[i];
+  if (type == EntryTypeDeleted) {
+    return NULL;
+  }
+  if (!(conversation->stale_types & (1 << type))) {
+    return conversation->last_of_type[type];
+  }
+  // The newest entry of this type was deleted, so find whichever one is now newest.
+  EntryChunk* chunk = conversation->tail_chunk;
+  int i = conversation->tail;
+  ConversationEntry* found = NULL;
+  while (prv_step_back(conversation, &chunk, &i)) {
+    ConversationEntry* entry = &chunk->entries[i];
     if (entry->type == type) {
-      return entry;
+      found = entry;
+      break;
     }
   }
-  return NULL;
+  conversation->last_of_type[type] = found;
+  conversation->stale_types &= ~(1 << type);
+  return found;
 }
 
 const char* prv_type_to_string(EntryType type) {
@@ -403,7 +750,7 @@ const char* conversation_get_thread_id(Conversation* conversation) {
 }
 
 int conversation_length(Conversation* conversation) {
-  return conversation->entry_count - conversation->deleted_entries - conversation->nulled_entries;
+  return conversation->entry_count;
 }
 
 bool conversation_is_idle(Conversation* conversation) {
@@ -447,9 +794,10 @@ bool conversation_assistant_just_started(Conversation* conversation) {
   if (!prv_entry_type_is_assistant(entry)) {
     return false;
   }
-  if (conversation->entry_count == 1) {
+  EntryChunk* chunk = conversation->tail_chunk;
+  int i = conversation->tail - 1;
+  if (!prv_step_back(conversation, &chunk, &i)) {
     return true;
   }
-  ConversationEntry *previous = &conversation->entries[conversation->entry_count - 2];
-  return !prv_entry_type_is_assistant(previous);
+  return !prv_entry_type_is_assistant(&chunk->entries[i]);
 }
@@ -78,13 +78,22 @@ typedef struct {
   char *prompt;
 } ConversationPrompt;
 
+typedef struct ConversationResponseChunk ConversationResponseChunk;
+
+// Response text is kept as a list of chunks, so that streaming in a long answer never needs to copy it or
+// find one large contiguous block for it. Use a ConversationResponseCursor to read it back.
 typedef struct {
-  char *response;
+  ConversationResponseChunk *first;
+  ConversationResponseChunk *last;
   size_t len;
-  size_t allocated;
   bool complete;
 } ConversationResponse;
 
+typedef struct {
+  const ConversationResponseChunk *chunk;
+  size_t offset;
+} ConversationResponseCursor;
+
 typedef struct {
   char *thought;
 } ConversationThought;
@@ -165,27 +174,38 @@ typedef enum {
 
 Conversation* conversation_create();
 void conversation_destroy(Conversation* conversation);
-void conversation_add_prompt(Conversation* conversation, const char* prompt);
-void conversation_add_response(Conversation* conversation, const char* response);
-void conversation_start_response(Conversation *conversation);
+// The add and start functions return false, and add nothing, if there's no memory for the new entry.
+bool conversation_add_prompt(Conversation* conversation, const char* prompt);
+bool conversation_add_response(Conversation* conversation, const char* response);
+bool conversation_start_response(Conversation *conversation);
 bool conversation_add_response_fragment(Conversation *conversation, const char* fragment);
 void conversation_complete_response(Conversation *conversation);
-void conversation_add_thought(Conversation* conversation, char* thought);
-void conversation_add_action(Conversation* conversation, ConversationAction* action);
-void conversation_add_widget(Conversation* conversation, ConversationWidget* widget);
-void conversation_add_error(Conversation* conversation, const char* error_text);
+bool conversation_add_thought(Conversation* conversation, char* thought);
+// Strings referenced by the action or widget are copied into the conversation; the caller keeps ownership.
+bool conversation_add_action(Conversation* conversation, ConversationAction* action);
+bool conversation_add_widget(Conversation* conversation, ConversationWidget* widget);
+bool conversation_add_error(Conversation* conversation, const char* error_text);
 void conversation_set_thread_id(Conversation* conversation, const char* thread_id);
 const char* conversation_get_thread_id(Conversation* conversation);
 int conversation_length(Conversation* conversation);
 bool conversation_is_idle(Conversation* conversation);
 bool conversation_assistant_just_started(Conversation* conversation);
 ConversationEntry* conversation_entry_at_index(Conversation* conversation, int index);
+ConversationEntry* conversation_first_entry(Conversation* conversation);
 ConversationEntry* conversation_peek(Conversation* conversation);
 ConversationEntry* conversation_get_last_of_type(Conversation* conversation, EntryType type);
 EntryType conversation_entry_get_type(ConversationEntry* entry);
 void conversation_delete_first_entry(Conversation* conversation);
 void conversation_delete_last_thought(Conversation* conversation);
 
+// Positions the cursor at the given byte offset into the response text.
+void conversation_response_cursor_init(ConversationResponse* response, ConversationResponseCursor* cursor, size_t offset);
+// Returns the next contiguous run of text and advances past it, or NULL once the end is reached.
+// The run is not NUL-terminated; its length is written to *length.
+const char* conversation_response_cursor_next(ConversationResponseCursor* cursor, size_t* length);
+// Copies up to size - 1 bytes starting at offset into buffer, and NUL-terminates it. Returns the number of bytes copied.
+size_t conversation_response_copy(ConversationResponse* response, size_t offset, char* buffer, size_t size);
+
 ConversationPrompt* conversation_entry_get_prompt(ConversationEntry* entry);
 ConversationResponse* conversation_entry_get_response(ConversationEntry* response);
 ConversationThought* conversation_entry_get_thought(ConversationEntry* thought);
@@ -19,6 +19,7 @@
 #include "conversation.h"
 #include "../util/memory/malloc.h"
 #include "../util/memory/pressure.h"
+#include "../util/app_message_router.h"
 #include "../util/logging.h"
 #include "../util/strings.h"
 
@@ -26,57 +27,79 @@
 #include <pebble.h>
 
 
+// Updates to an existing entry (mostly streamed response text) are passed on at most once per this many
+// milliseconds. Around 30 Hz is as fast as the display can usefully change.
+#define DEFAULT_UPDATE_INTERVAL_MS 33
+
 struct ConversationManager {
   Conversation* conversation;
   EventHandle app_message_handle;
+  AppMessageRoute* app_message_route;
+  MemoryPressureCallback* memory_pressure_callback;
+  // Memory pressure deletes entries up to this one, but not this one.
+  ConversationEntry* pinned_entry;
   void* context;
   ConversationManagerUpdateHandler handler;
   ConversationManagerEntryDeletedHandler deletion_handler;
+  AppTimer* update_timer;
+  uint32_t update_interval_ms;
+  bool update_pending;
+  // Updates that were folded into an already pending one rather than being passed on separately.
+  uint32_t coalesced_updates;
 };
 
 static void prv_conversation_updated(ConversationManager* manager, bool new_entry);
+static void prv_flush_pending_update(ConversationManager* manager);
+static void prv_update_timer_fired(void* context);
 static void prv_handle_app_message_outbox_sent(DictionaryIterator *iterator, void *context);
 static void prv_handle_app_message_outbox_failed(DictionaryIterator *iterator, AppMessageResult reason, void *context);
 static void prv_handle_app_message_inbox_received(DictionaryIterator *iterator, void *context);
 static void prv_handle_app_message_inbox_dropped(AppMessageResult result, void *context);
-static void prv_process_weather_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager);
-static void prv_process_timer_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager);
-static void prv_process_highlight_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager);
-#if ENABLE_FEATURE_MAPS
-static void prv_process_map_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager);
-#endif
-static bool prv_handle_memory_pressure(void *context);
+static void prv_build_inbox_index();
+static AppMessageRoute* prv_route_inbox(ConversationManager *manager);
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context);
 
 static ConversationManager* s_conversation_manager;
 
 void conversation_manager_init() {
   events_app_message_request_outbox_size(1024);
   events_app_message_request_inbox_size(1024);
+  prv_build_inbox_index();
 }
 
 ConversationManager* conversation_manager_create() {
   ConversationManager* manager = bmalloc(sizeof(ConversationManager));
   manager->conversation = conversation_create();
   manager->handler = NULL;
+  manager->update_timer = NULL;
+  manager->update_interval_ms = DEFAULT_UPDATE_INTERVAL_MS;
+  manager->update_pending = false;
+  manager->coalesced_updates = 0;
+  manager->pinned_entry = NULL;
   manager->app_message_handle = events_app_message_subscribe_handlers((EventAppMessageHandlers){
       .sent = prv_handle_app_message_outbox_sent,
       .failed = prv_handle_app_message_outbox_failed,
-      .received = prv_handle_app_message_inbox_received,
       // We don't handle this elegantly enough for it to make sense here.
       // .dropped = prv_handle_app_message_inbox_dropped,
   }, manager);
+  manager->app_message_route = prv_route_inbox(manager);
   s_conversation_manager = manager;
-  memory_pressure_register_callback(prv_handle_memory_pressure, 1, manager);
+  manager->memory_pressure_callback = memory_pressure_register_callback(prv_handle_memory_pressure, 1, manager);
   return manager;
 }
 
 void conversation_manager_destroy(ConversationManager* manager) {
+  if (manager->update_timer) {
+    app_timer_cancel(manager->update_timer);
+  }
   conversation_destroy(manager->conversation);
   events_app_message_unsubscribe(manager->app_message_handle);
+  app_message_router_unsubscribe(manager->app_message_route);
+  memory_pressure_unregister_callback(manager->memory_pressure_callback);
   if (s_conversation_manager == manager) {
     s_conversation_manager = NULL;
   }
-  free(manager);
+  bfree(manager);
 }
 
 ConversationManager* conversation_manager_get_current() {
@@ -92,6 +115,21 @@ void conversation_manager_set_handler(ConversationManager* manager, Conversation
   manager->context = context;
 }
 
+void conversation_manager_set_update_interval(ConversationManager* manager, uint32_t interval_ms) {
+  manager->update_interval_ms = interval_ms;
+  if (interval_ms == 0) {
+    prv_flush_pending_update(manager);
+  }
+}
+
+uint32_t conversation_manager_get_coalesced_update_count(ConversationManager* manager) {
+  return manager->coalesced_updates;
+}
+
+void conversation_manager_pin_entry(ConversationManager* manager, ConversationEntry* entry) {
+  manager->pinned_entry = entry;
+}
+
 void conversation_manager_set_deletion_handler(ConversationManager* manager, ConversationManagerEntryDeletedHandler handler) {
   manager->deletion_handler = handler;
 }
@@ -99,12 +137,14 @@ void conversation_manager_set_deletion_handler(ConversationManager* manager, Con
 void conversation_manager_add_input(ConversationManager* manager, const char* input) {
   DictionaryIterator *iter;
   AppMessageResult result = app_message_outbox_begin(&iter);
-  conversation_add_prompt(manager->conversation, input);
-  prv_conversation_updated(manager, true);
+  if (conversation_add_prompt(manager->conversation, input)) {
+    prv_conversation_updated(manager, true);
+  }
   if (result != APP_MSG_OK) {
     BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Preparing outbox failed: %d.", result);
-    conversation_add_error(manager->conversation, "Sending to service failed.");
-    prv_conversation_updated(manager, true);
+    if (conversation_add_error(manager->conversation, "Sending to service failed.")) {
+      prv_conversation_updated(manager, true);
+    }
     return;
   }
 
@@ -114,7 +154,7 @@ void conversation_manager_add_input(ConversationManager* manager, const char* in
   strcpy(bridge_bodge, input);
   strings_fix_android_bridge_bodge(bridge_bodge);
   dict_write_cstring(iter, MESSAGE_KEY_PROMPT, bridge_bodge);
-  free(bridge_bodge);
+  bfree(bridge_bodge);
 
   const char* thread_id = conversation_get_thread_id(manager->conversation);
   if (thread_id[0] != 0) {
@@ -124,22 +164,32 @@ void conversation_manager_add_input(ConversationManager* manager, const char* in
   result = app_message_outbox_send();
   if (result != APP_MSG_OK) {
     BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Sending message failed: %d.", result);
-    conversation_add_error(manager->conversation, "Sending to service failed.");
-    prv_conversation_updated(manager, true);
+    if (conversation_add_error(manager->conversation, "Sending to service failed.")) {
+      prv_conversation_updated(manager, true);
+    }
     return;
   }
 }
 
 void conversation_manager_add_action(ConversationManager* manager, ConversationAction* action) {
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Adding action to conversation.");
-  conversation_add_action(manager->conversation, action);
-  prv_conversation_updated(manager, true);
+  if (conversation_add_action(manager->conversation, action)) {
+    prv_conversation_updated(manager, true);
+  }
 }
 
 void conversation_manager_add_widget(ConversationManager* manager, ConversationWidget* widget) {
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Adding widget to conversation.");
-  conversation_add_widget(manager->conversation, widget);
-  prv_conversation_updated(manager, true);
+  if (conversation_add_widget(manager->conversation, widget)) {
+    prv_conversation_updated(manager, true);
+  }
+}
+
+void conversation_manager_add_error(ConversationManager* manager, const char* error_text) {
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Adding error to conversation.");
+  if (conversation_add_error(manager->conversation, error_text)) {
+    prv_conversation_updated(manager, true);
+  }
 }
 
 static void prv_handle_app_message_outbox_sent(DictionaryIterator *iterator, void *context) {
@@ -149,254 +199,444 @@ static void prv_handle_app_message_outbox_sent(DictionaryIterator *iterator, voi
 static void prv_handle_app_message_outbox_failed(DictionaryIterator *iterator, AppMessageResult reason, void *context) {
   BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Sending message failed: %d", reason);
   ConversationManager* manager = context;
-  conversation_add_error(manager->conversation, "Sending to service failed.");
-  prv_conversation_updated(manager, true);
+  if (conversation_add_error(manager->conversation, "Sending to service failed.")) {
+    prv_conversation_updated(manager, true);
+  }
+}
+
+// Fields that widget messages carry alongside the key identifying the widget. Array keys take one slot per
+// element.
+typedef enum {
+  InboxFieldWeatherDayHigh,
+  InboxFieldWeatherDayLow,
+  InboxFieldWeatherDayIcon,
+  InboxFieldWeatherDaySummary,
+  InboxFieldWeatherLocation,
+  InboxFieldWeatherTempUnit,
+  InboxFieldWeatherDayOfWeek,
+  InboxFieldWeatherCurrentTemp,
+  InboxFieldWeatherFeelsLike,
+  InboxFieldWeatherWindSpeed,
+  InboxFieldWeatherWindSpeedUnit,
+  InboxFieldWeatherMultiDay,
+  InboxFieldWeatherMultiIcon = InboxFieldWeatherMultiDay + 3,
+  InboxFieldWeatherMultiHigh = InboxFieldWeatherMultiIcon + 3,
+  InboxFieldWeatherMultiLow = InboxFieldWeatherMultiHigh + 3,
+  InboxFieldTimerTargetTime = InboxFieldWeatherMultiLow + 3,
+  InboxFieldTimerName,
+  InboxFieldHighlightPrimary,
+  InboxFieldHighlightSecondary,
+  InboxFieldMapImageId,
+  InboxFieldMapUserLocation,
+  InboxFieldCount,
+} InboxField;
+
+// Everything we care about in one inbound message, gathered in a single pass over the dictionary.
+typedef struct {
+  Tuple *fields[InboxFieldCount];
+  int tuples_visited;
+} InboxMessage;
+
+typedef void (*InboxKeyHandler)(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+
+static void prv_handle_chat(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_function(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_chat_done(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_thread_id(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_close_was_clean(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_close_reason(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_reminder_was_set(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_reminder_deleted(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_feedback_sent(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_settings_updated(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_warning(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_handle_widget(ConversationManager *manager, Tuple *tuple, InboxMessage *message);
+static void prv_process_weather_widget(int widget_type, InboxMessage *message, ConversationManager *manager);
+static void prv_process_timer_widget(int widget_type, InboxMessage *message, ConversationManager *manager);
+static void prv_process_highlight_widget(int widget_type, InboxMessage *message, ConversationManager *manager);
+#if ENABLE_FEATURE_MAPS
+static void prv_process_map_widget(int widget_type, InboxMessage *message, ConversationManager *manager);
+#endif
+
+// Message keys are assigned by the build, so they aren't compile-time constants; the tables below refer to
+// them by address and conversation_manager_init turns them into a lookup indexed by key.
+static const struct {
+  const uint32_t *key;
+  InboxKeyHandler handler;
+} s_inbox_handlers[] = {
+  { &MESSAGE_KEY_CHAT, prv_handle_chat },
+  { &MESSAGE_KEY_FUNCTION, prv_handle_function },
+  { &MESSAGE_KEY_CHAT_DONE, prv_handle_chat_done },
+  { &MESSAGE_KEY_THREAD_ID, prv_handle_thread_id },
+  { &MESSAGE_KEY_CLOSE_WAS_CLEAN, prv_handle_close_was_clean },
+  { &MESSAGE_KEY_CLOSE_REASON, prv_handle_close_reason },
+  { &MESSAGE_KEY_ACTION_REMINDER_WAS_SET, prv_handle_reminder_was_set },
+  { &MESSAGE_KEY_ACTION_REMINDER_DELETED, prv_handle_reminder_deleted },
+  { &MESSAGE_KEY_ACTION_FEEDBACK_SENT, prv_handle_feedback_sent },
+  { &MESSAGE_KEY_ACTION_SETTINGS_UPDATED, prv_handle_settings_updated },
+  { &MESSAGE_KEY_WARNING, prv_handle_warning },
+  { &MESSAGE_KEY_WEATHER_WIDGET, prv_handle_widget },
+  { &MESSAGE_KEY_TIMER_WIDGET, prv_handle_widget },
+  { &MESSAGE_KEY_HIGHLIGHT_WIDGET, prv_handle_widget },
+#if ENABLE_FEATURE_MAPS
+  { &MESSAGE_KEY_MAP_WIDGET, prv_handle_widget },
+#endif
+};
+#define INBOX_HANDLER_COUNT ((int)(sizeof(s_inbox_handlers) / sizeof(s_inbox_handlers[0])))
+
+static const struct {
+  const uint32_t *key;
+  InboxField field;
+  uint8_t count;
+} s_inbox_fields[] = {
+  { &MESSAGE_KEY_WEATHER_WIDGET_DAY_HIGH, InboxFieldWeatherDayHigh, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_DAY_LOW, InboxFieldWeatherDayLow, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON, InboxFieldWeatherDayIcon, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY, InboxFieldWeatherDaySummary, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_LOCATION, InboxFieldWeatherLocation, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_TEMP_UNIT, InboxFieldWeatherTempUnit, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_DAY_OF_WEEK, InboxFieldWeatherDayOfWeek, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_CURRENT_TEMP, InboxFieldWeatherCurrentTemp, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_FEELS_LIKE, InboxFieldWeatherFeelsLike, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED, InboxFieldWeatherWindSpeed, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED_UNIT, InboxFieldWeatherWindSpeedUnit, 1 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_DAY, InboxFieldWeatherMultiDay, 3 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_ICON, InboxFieldWeatherMultiIcon, 3 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_HIGH, InboxFieldWeatherMultiHigh, 3 },
+  { &MESSAGE_KEY_WEATHER_WIDGET_MULTI_LOW, InboxFieldWeatherMultiLow, 3 },
+  { &MESSAGE_KEY_TIMER_WIDGET_TARGET_TIME, InboxFieldTimerTargetTime, 1 },
+  { &MESSAGE_KEY_TIMER_WIDGET_NAME, InboxFieldTimerName, 1 },
+  { &MESSAGE_KEY_HIGHLIGHT_WIDGET_PRIMARY, InboxFieldHighlightPrimary, 1 },
+  { &MESSAGE_KEY_HIGHLIGHT_WIDGET_SECONDARY, InboxFieldHighlightSecondary, 1 },
+  { &MESSAGE_KEY_MAP_WIDGET_IMAGE_ID, InboxFieldMapImageId, 1 },
+  { &MESSAGE_KEY_MAP_WIDGET_USER_LOCATION, InboxFieldMapUserLocation, 1 },
+};
+#define INBOX_FIELD_KEY_COUNT ((int)(sizeof(s_inbox_fields) / sizeof(s_inbox_fields[0])))
+
+// Maps (key - s_inbox_first_key) to what to do with a tuple: 0 means ignore it, 1 to INBOX_HANDLER_COUNT
+// picks a handler, and anything above that is a field slot.
+static uint8_t *s_inbox_key_slots;
+static uint32_t s_inbox_first_key;
+static uint32_t s_inbox_key_span;
+
+static void prv_inbox_index_key(uint32_t key, int slot) {
+  s_inbox_key_slots[key - s_inbox_first_key] = slot;
+}
+
+static void prv_build_inbox_index() {
+  uint32_t first = UINT32_MAX;
+  uint32_t last = 0;
+  for (int i = 0; i < INBOX_HANDLER_COUNT; ++i) {
+    uint32_t key = *s_inbox_handlers[i].key;
+    if (key < first) {
+      first = key;
+    }
+    if (key > last) {
+      last = key;
+    }
+  }
+  for (int i = 0; i < INBOX_FIELD_KEY_COUNT; ++i) {
+    uint32_t key = *s_inbox_fields[i].key;
+    if (key < first) {
+      first = key;
+    }
+    if (key + s_inbox_fields[i].count - 1 > last) {
+      last = key + s_inbox_fields[i].count - 1;
+    }
+  }
+  s_inbox_first_key = first;
+  s_inbox_key_span = last - first + 1;
+  s_inbox_key_slots = bmalloc(s_inbox_key_span);
+  memset(s_inbox_key_slots, 0, s_inbox_key_span);
+  for (int i = 0; i < INBOX_HANDLER_COUNT; ++i) {
+    prv_inbox_index_key(*s_inbox_handlers[i].key, 1 + i);
+  }
+  for (int i = 0; i < INBOX_FIELD_KEY_COUNT; ++i) {
+    for (int j = 0; j < s_inbox_fields[i].count; ++j) {
+      prv_inbox_index_key(*s_inbox_fields[i].key + j, 1 + INBOX_HANDLER_COUNT + s_inbox_fields[i].field + j);
+    }
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Inbox index covers %d keys.", (int)s_inbox_key_span);
+}
+
+// Asks the router for every message containing a key we have a handler for. Widget fields only ever arrive
+// alongside their widget's key, so they don't need routes of their own.
+static AppMessageRoute* prv_route_inbox(ConversationManager *manager) {
+  uint32_t keys[INBOX_HANDLER_COUNT];
+  for (int i = 0; i < INBOX_HANDLER_COUNT; ++i) {
+    keys[i] = *s_inbox_handlers[i].key;
+  }
+  return app_message_router_subscribe(keys, INBOX_HANDLER_COUNT, prv_handle_app_message_inbox_received, manager);
+}
+
+static int prv_inbox_slot_for_key(uint32_t key) {
+  if (key < s_inbox_first_key || key - s_inbox_first_key >= s_inbox_key_span) {
+    return 0;
+  }
+  return s_inbox_key_slots[key - s_inbox_first_key];
 }
 
 static void prv_handle_app_message_inbox_received(DictionaryIterator *iter, void *context) {
   ConversationManager* manager = context;
+  InboxMessage message;
+  memset(&message, 0, sizeof(message));
+  // Each tuple is looked at exactly once. Fields are stashed for whichever handler wants them, and tuples
+  // that have handlers are queued so they still run in the order the phone sent them.
+  Tuple *queued[INBOX_HANDLER_COUNT];
+  uint8_t queued_handlers[INBOX_HANDLER_COUNT];
+  int queued_count = 0;
   for (Tuple *tuple = dict_read_first(iter); tuple; tuple = dict_read_next(iter)) {
-    if (tuple->key == MESSAGE_KEY_CHAT) {
-      bool added_entry = conversation_add_response_fragment(manager->conversation, tuple->value->cstring);
-      prv_conversation_updated(manager, added_entry);
-    } else if (tuple->key == MESSAGE_KEY_FUNCTION) {
-      BOBBY_LOG(APP_LOG_LEVEL_INFO, "Received function: \"%s\".", tuple->value->cstring);
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-      conversation_add_thought(manager->conversation, tuple->value->cstring);
+    message.tuples_visited++;
+    int slot = prv_inbox_slot_for_key(tuple->key);
+    if (slot == 0) {
+      continue;
+    }
+    if (slot > INBOX_HANDLER_COUNT) {
+      message.fields[slot - INBOX_HANDLER_COUNT - 1] = tuple;
+    } else if (queued_count < INBOX_HANDLER_COUNT) {
+      queued[queued_count] = tuple;
+      queued_handlers[queued_count] = slot - 1;
+      queued_count++;
+    }
+  }
+  for (int i = 0; i < queued_count; ++i) {
+    s_inbox_handlers[queued_handlers[i]].handler(manager, queued[i], &message);
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Inbox message: %d tuples visited, %d dispatched.", message.tuples_visited, queued_count);
+}
+
+static void prv_handle_chat(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  bool added_entry = conversation_add_response_fragment(manager->conversation, tuple->value->cstring);
+  prv_conversation_updated(manager, added_entry);
+}
+
+static void prv_handle_function(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  BOBBY_LOG(APP_LOG_LEVEL_INFO, "Received function: \"%s\".", tuple->value->cstring);
+  conversation_complete_response(manager->conversation);
+  prv_conversation_updated(manager, false);
+  if (conversation_add_thought(manager->conversation, tuple->value->cstring)) {
+    prv_conversation_updated(manager, true);
+  }
+}
+
+static void prv_handle_chat_done(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  conversation_complete_response(manager->conversation);
+  prv_conversation_updated(manager, false);
+}
+
+static void prv_handle_thread_id(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  conversation_set_thread_id(manager->conversation, tuple->value->cstring);
+}
+
+static void prv_handle_close_was_clean(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  if (!tuple->value->int16) {
+    conversation_complete_response(manager->conversation);
+    if (conversation_add_error(manager->conversation, "Lost connection to server.")) {
       prv_conversation_updated(manager, true);
-    } else if (tuple->key == MESSAGE_KEY_CHAT_DONE) {
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-    } else if (tuple->key == MESSAGE_KEY_THREAD_ID) {
-      conversation_set_thread_id(manager->conversation, tuple->value->cstring);
-    } else if (tuple->key == MESSAGE_KEY_CLOSE_WAS_CLEAN) {
-      if (!tuple->value->int16) {
-        conversation_complete_response(manager->conversation);
-        conversation_add_error(manager->conversation, "Lost connection to server.");
-        prv_conversation_updated(manager, true);
-      }
-    } else if (tuple->key == MESSAGE_KEY_CLOSE_REASON) {
-      if (tuple->value->cstring[0] != 0) {
-        conversation_complete_response(manager->conversation);
-        conversation_add_error(manager->conversation, tuple->value->cstring);
-        prv_conversation_updated(manager, true);
-      }
-    } else if (tuple->key == MESSAGE_KEY_ACTION_REMINDER_WAS_SET) {
-      // Setting reminders is handled by the phone, so we don't have any logic here for it.
-      // We pick this up here so we can add a note about it to the session view.
-      ConversationAction action = {
-        .type = ConversationActionTypeSetReminder,
-        .action = {
-          .set_reminder = {
-            .time = tuple->value->int32,
-          },
-        },
-      };
-      conversation_manager_add_action(manager, &action);
-    } else if (tuple->key == MESSAGE_KEY_ACTION_REMINDER_DELETED) {
-      ConversationAction action = {
-        .type = ConversationActionTypeDeleteReminder,
-        .action = {},
-      };
-      conversation_manager_add_action(manager, &action);
-    } else if (tuple->key == MESSAGE_KEY_ACTION_FEEDBACK_SENT) {
-      ConversationAction action = {
-        .type = ConversationActionTypeSendFeedback,
-        .action = {}
-      };
-      conversation_manager_add_action(manager, &action);
-    } else if (tuple->key == MESSAGE_KEY_ACTION_SETTINGS_UPDATED) {
-      char *sentence = bmalloc(strlen(tuple->value->cstring) + 1);
-      strcpy(sentence, tuple->value->cstring);
-      ConversationAction action = {
-        .type = ConversationActionTypeGenericSentence,
-        .action = {
-          .generic_sentence = {
-            .sentence = sentence,
-          }
-        },
-      };
-      conversation_manager_add_action(manager, &action);
-    } else if (tuple->key == MESSAGE_KEY_WARNING) {
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-      conversation_add_error(manager->conversation, tuple->value->cstring);
+    }
+  }
+}
+
+static void prv_handle_close_reason(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  if (tuple->value->cstring[0] != 0) {
+    conversation_complete_response(manager->conversation);
+    if (conversation_add_error(manager->conversation, tuple->value->cstring)) {
       prv_conversation_updated(manager, true);
-    } else if (tuple->key == MESSAGE_KEY_WEATHER_WIDGET) {
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-      prv_process_weather_widget(tuple->value->int32, iter, manager);
-    } else if (tuple->key == MESSAGE_KEY_TIMER_WIDGET) {
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-      prv_process_timer_widget(tuple->value->int32, iter, manager);
-    } else if (tuple->key == MESSAGE_KEY_HIGHLIGHT_WIDGET) {
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-      prv_process_highlight_widget(tuple->value->int32, iter, manager);
+    }
+  }
+}
+
+static void prv_handle_reminder_was_set(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  // Setting reminders is handled by the phone, so we don't have any logic here for it.
+  // We pick this up here so we can add a note about it to the session view.
+  ConversationAction action = {
+    .type = ConversationActionTypeSetReminder,
+    .action = {
+      .set_reminder = {
+        .time = tuple->value->int32,
+      },
+    },
+  };
+  conversation_manager_add_action(manager, &action);
+}
+
+static void prv_handle_reminder_deleted(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  ConversationAction action = {
+    .type = ConversationActionTypeDeleteReminder,
+    .action = {},
+  };
+  conversation_manager_add_action(manager, &action);
+}
+
+static void prv_handle_feedback_sent(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  ConversationAction action = {
+    .type = ConversationActionTypeSendFeedback,
+    .action = {}
+  };
+  conversation_manager_add_action(manager, &action);
+}
+
+static void prv_handle_settings_updated(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  ConversationAction action = {
+    .type = ConversationActionTypeGenericSentence,
+    .action = {
+      .generic_sentence = {
+        .sentence = tuple->value->cstring,
+      }
+    },
+  };
+  conversation_manager_add_action(manager, &action);
+}
+
+static void prv_handle_warning(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  conversation_complete_response(manager->conversation);
+  prv_conversation_updated(manager, false);
+  if (conversation_add_error(manager->conversation, tuple->value->cstring)) {
+    prv_conversation_updated(manager, true);
+  }
+}
+
+static void prv_handle_widget(ConversationManager *manager, Tuple *tuple, InboxMessage *message) {
+  conversation_complete_response(manager->conversation);
+  prv_conversation_updated(manager, false);
+  if (tuple->key == MESSAGE_KEY_WEATHER_WIDGET) {
+    prv_process_weather_widget(tuple->value->int32, message, manager);
+  } else if (tuple->key == MESSAGE_KEY_TIMER_WIDGET) {
+    prv_process_timer_widget(tuple->value->int32, message, manager);
+  } else if (tuple->key == MESSAGE_KEY_HIGHLIGHT_WIDGET) {
+    prv_process_highlight_widget(tuple->value->int32, message, manager);
 #if ENABLE_FEATURE_MAPS
-    } else if (tuple->key == MESSAGE_KEY_MAP_WIDGET) {
-      conversation_complete_response(manager->conversation);
-      prv_conversation_updated(manager, false);
-      prv_process_map_widget(tuple->value->int32, iter, manager);
+  } else if (tuple->key == MESSAGE_KEY_MAP_WIDGET) {
+    prv_process_map_widget(tuple->value->int32, message, manager);
 #endif
-    }
   }
 }
 
-static void prv_process_weather_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager) {
+static int32_t prv_widget_field_int(InboxMessage *message, InboxField field) {
+  Tuple *tuple = message->fields[field];
+  if (tuple == NULL || tuple->type == TUPLE_CSTRING) {
+    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Widget is missing integer field %d.", field);
+    return 0;
+  }
+  return tuple->value->int32;
+}
+
+// Returns the field's string, or fallback if the phone didn't send one.
+static char* prv_widget_field_string(InboxMessage *message, InboxField field, char *fallback) {
+  Tuple *tuple = message->fields[field];
+  if (tuple == NULL || tuple->type != TUPLE_CSTRING) {
+    return fallback;
+  }
+  return tuple->value->cstring;
+}
+
+static void prv_process_weather_widget(int widget_type, InboxMessage *message, ConversationManager *manager) {
   switch (widget_type) {
     case 1: {
-      int high = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_HIGH)->value->int32;
-      int low = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_LOW)->value->int32;
-      int icon = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON)->value->int32;
-      const char* summary = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY)->value->cstring;
-      const char* location = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_LOCATION)->value->cstring;
-      const char* temp_unit = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_TEMP_UNIT)->value->cstring;
-      const char* day = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_OF_WEEK)->value->cstring;
-      char* summary_stored = bmalloc(strlen(summary) + 1);
-      strcpy(summary_stored, summary);
-      char* location_stored = bmalloc(strlen(location) + 1);
-      strcpy(location_stored, location);
-      char* temp_unit_stored = bmalloc(strlen(temp_unit) + 1);
-      strcpy(temp_unit_stored, temp_unit);
-      char* day_stored = bmalloc(strlen(day) + 1);
-      strcpy(day_stored, day);
       ConversationWidget widget = {
         .type = ConversationWidgetTypeWeatherSingleDay,
         .widget = {
           .weather_single_day = {
-            .high = high,
-            .low = low,
-            .condition = icon,
-            .location = location_stored,
-            .summary = summary_stored,
-            .temp_unit = temp_unit_stored,
-            .day = day_stored,
+            .high = prv_widget_field_int(message, InboxFieldWeatherDayHigh),
+            .low = prv_widget_field_int(message, InboxFieldWeatherDayLow),
+            .condition = prv_widget_field_int(message, InboxFieldWeatherDayIcon),
+            .location = prv_widget_field_string(message, InboxFieldWeatherLocation, ""),
+            .summary = prv_widget_field_string(message, InboxFieldWeatherDaySummary, ""),
+            .temp_unit = prv_widget_field_string(message, InboxFieldWeatherTempUnit, ""),
+            .day = prv_widget_field_string(message, InboxFieldWeatherDayOfWeek, ""),
           }
         }
       };
-      conversation_add_widget(manager->conversation, &widget);
-      prv_conversation_updated(manager, true);
+      if (conversation_add_widget(manager->conversation, &widget)) {
+        prv_conversation_updated(manager, true);
+      }
       break;
     }
     case 2: {
-      int temp = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_CURRENT_TEMP)->value->int32;
-      int feels_like = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_FEELS_LIKE)->value->int32;
-      int icon = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_ICON)->value->int32;
-      int wind_speed = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED)->value->int32;
-      const char* location = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_LOCATION)->value->cstring;
-      const char* summary = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_DAY_SUMMARY)->value->cstring;
-      const char* wind_speed_unit = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_WIND_SPEED_UNIT)->value->cstring;
-      char* location_stored = bmalloc(strlen(location) + 1);
-      strcpy(location_stored, location);
-      char* summary_stored = bmalloc(strlen(summary) + 1);
-      strcpy(summary_stored, summary);
-      char* wind_speed_unit_stored = bmalloc(strlen(wind_speed_unit) + 1);
-      strcpy(wind_speed_unit_stored, wind_speed_unit);
       ConversationWidget widget = {
         .type = ConversationWidgetTypeWeatherCurrent,
         .widget = {
           .weather_current = {
-            .temperature = temp,
-            .feels_like = feels_like,
-            .condition = icon,
-            .wind_speed = wind_speed,
-            .location = location_stored,
-            .summary = summary_stored,
-            .wind_speed_unit = wind_speed_unit_stored,
+            .temperature = prv_widget_field_int(message, InboxFieldWeatherCurrentTemp),
+            .feels_like = prv_widget_field_int(message, InboxFieldWeatherFeelsLike),
+            .condition = prv_widget_field_int(message, InboxFieldWeatherDayIcon),
+            .wind_speed = prv_widget_field_int(message, InboxFieldWeatherWindSpeed),
+            .location = prv_widget_field_string(message, InboxFieldWeatherLocation, ""),
+            .summary = prv_widget_field_string(message, InboxFieldWeatherDaySummary, ""),
+            .wind_speed_unit = prv_widget_field_string(message, InboxFieldWeatherWindSpeedUnit, ""),
           }
         }
       };
-      conversation_add_widget(manager->conversation, &widget);
-      prv_conversation_updated(manager, true);
+      if (conversation_add_widget(manager->conversation, &widget)) {
+        prv_conversation_updated(manager, true);
+      }
       break;
     }
     case 3: {
-      const char* location = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_LOCATION)->value->cstring;
-      char *location_stored = bmalloc(strlen(location) + 1);
-      strcpy(location_stored, location);
       ConversationWidget widget = {
         .type = ConversationWidgetTypeWeatherMultiDay,
         .widget = {
           .weather_multi_day = {
-            .location = location_stored,
+            .location = prv_widget_field_string(message, InboxFieldWeatherLocation, ""),
           }
         }
       };
       for (int i = 0; i < 3; ++i) {
         ConversationWidgetWeatherMultiDaySegment *s = &widget.widget.weather_multi_day.days[i];
-        s->high = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_MULTI_HIGH + i)->value->int32;
-        s->low = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_MULTI_LOW + i)->value->int32;
-        s->condition = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_MULTI_ICON + i)->value->int32;
-        const char* day = dict_find(iter, MESSAGE_KEY_WEATHER_WIDGET_MULTI_DAY + i)->value->cstring;
-        strncpy(s->day, day, sizeof(s->day));
+        s->high = prv_widget_field_int(message, InboxFieldWeatherMultiHigh + i);
+        s->low = prv_widget_field_int(message, InboxFieldWeatherMultiLow + i);
+        s->condition = prv_widget_field_int(message, InboxFieldWeatherMultiIcon + i);
+        strncpy(s->day, prv_widget_field_string(message, InboxFieldWeatherMultiDay + i, ""), sizeof(s->day));
         s->day[sizeof(s->day) - 1] = '\0';
       }
-      conversation_add_widget(manager->conversation, &widget);
-      prv_conversation_updated(manager, true);
+      if (conversation_add_widget(manager->conversation, &widget)) {
+        prv_conversation_updated(manager, true);
+      }
       break;
     }
   }
 }
 
-static void prv_process_timer_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager) {
-  time_t target_time = dict_find(iter, MESSAGE_KEY_TIMER_WIDGET_TARGET_TIME)->value->int32;
-  char *name_stored = NULL;
-  Tuple *tuple = dict_find(iter, MESSAGE_KEY_TIMER_WIDGET_NAME);
-  if (tuple) {
-    const char *name = tuple->value->cstring;
-    name_stored = bmalloc(strlen(name) + 1);
-    strcpy(name_stored, name);
-  }
+static void prv_process_timer_widget(int widget_type, InboxMessage *message, ConversationManager *manager) {
   ConversationWidget widget = {
     .type = ConversationWidgetTypeTimer,
     .widget = {
       .timer = {
-        .target_time = target_time,
-        .name = name_stored,
+        .target_time = prv_widget_field_int(message, InboxFieldTimerTargetTime),
+        .name = prv_widget_field_string(message, InboxFieldTimerName, NULL),
       }
     }
   };
-  conversation_add_widget(manager->conversation, &widget);
-  prv_conversation_updated(manager, true);
+  if (conversation_add_widget(manager->conversation, &widget)) {
+    prv_conversation_updated(manager, true);
+  }
 }
 
-static void prv_process_highlight_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager) {
+static void prv_process_highlight_widget(int widget_type, InboxMessage *message, ConversationManager *manager) {
   if (widget_type != 1) {
     return;
   }
-  char *number = dict_find(iter, MESSAGE_KEY_HIGHLIGHT_WIDGET_PRIMARY)->value->cstring;
-  char *number_stored = bmalloc(strlen(number) + 1);
-  strcpy(number_stored, number);
-  char *units_stored = NULL;
-  Tuple *tuple = dict_find(iter, MESSAGE_KEY_HIGHLIGHT_WIDGET_SECONDARY);
-  if (tuple) {
-    const char *units = tuple->value->cstring;
-    units_stored = bmalloc(strlen(units) + 1);
-    strcpy(units_stored, units);
-  }
   ConversationWidget widget = {
     .type = ConversationWidgetTypeNumber,
     .widget = {
       .number = {
-        .number = number_stored,
-        .unit = units_stored,
+        .number = prv_widget_field_string(message, InboxFieldHighlightPrimary, ""),
+        .unit = prv_widget_field_string(message, InboxFieldHighlightSecondary, NULL),
       }
     }
   };
-  conversation_add_widget(manager->conversation, &widget);
-  prv_conversation_updated(manager, true);
+  if (conversation_add_widget(manager->conversation, &widget)) {
+    prv_conversation_updated(manager, true);
+  }
 }
 
 #if ENABLE_FEATURE_MAPS
-static void prv_process_map_widget(int widget_type, DictionaryIterator *iter, ConversationManager *manager) {
+static void prv_process_map_widget(int widget_type, InboxMessage *message, ConversationManager *manager) {
   if (widget_type != 1) {
     return;
   }
-  int image_id = dict_find(iter, MESSAGE_KEY_MAP_WIDGET_IMAGE_ID)->value->int32;
-  int user_location = dict_find(iter, MESSAGE_KEY_MAP_WIDGET_USER_LOCATION)->value->int32;
+  int image_id = prv_widget_field_int(message, InboxFieldMapImageId);
+  int user_location = prv_widget_field_int(message, InboxFieldMapUserLocation);
   ConversationWidget widget = {
     .type = ConversationWidgetTypeMap,
     .widget = {
@@ -406,37 +646,90 @@ static void prv_process_map_widget(int widget_type, DictionaryIterator *iter, Co
       }
     }
   };
-  conversation_add_widget(manager->conversation, &widget);
-  prv_conversation_updated(manager, true);
+  if (conversation_add_widget(manager->conversation, &widget)) {
+    prv_conversation_updated(manager, true);
+  }
 }
 #endif
 
 static void prv_handle_app_message_inbox_dropped(AppMessageResult reason, void *context) {
   BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Received message dropped: %d", reason);
   ConversationManager* manager = context;
-  conversation_add_error(manager->conversation, "Response from service lost.");
-  prv_conversation_updated(manager, true);
+  if (conversation_add_error(manager->conversation, "Response from service lost.")) {
+    prv_conversation_updated(manager, true);
+  }
 }
 
 static void prv_conversation_updated(ConversationManager* manager, bool new_entry) {
+  if (new_entry) {
+    // Whoever is listening needs to have seen the final state of the previous entry before a new one turns up.
+    prv_flush_pending_update(manager);
+    if (manager->handler) {
+      manager->handler(true, manager->context);
+    }
+    return;
+  }
+  if (manager->update_interval_ms == 0) {
+    if (manager->handler) {
+      manager->handler(false, manager->context);
+    }
+    return;
+  }
+  if (manager->update_pending) {
+    manager->coalesced_updates++;
+    return;
+  }
+  manager->update_pending = true;
+  manager->update_timer = app_timer_register(manager->update_interval_ms, prv_update_timer_fired, manager);
+}
+
+static void prv_flush_pending_update(ConversationManager* manager) {
+  if (!manager->update_pending) {
+    return;
+  }
+  if (manager->update_timer) {
+    app_timer_cancel(manager->update_timer);
+    manager->update_timer = NULL;
+  }
+  manager->update_pending = false;
   if (manager->handler) {
-    manager->handler(new_entry, manager->context);
+    manager->handler(false, manager->context);
   }
 }
 
-static bool prv_handle_memory_pressure(void *context) {
+static void prv_update_timer_fired(void* context) {
+  ConversationManager* manager = context;
+  manager->update_timer = NULL;
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Flushing coalesced update; %d updates coalesced so far.", (int)manager->coalesced_updates);
+  prv_flush_pending_update(manager);
+}
+
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context) {
   BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Memory pressure detected.");
   ConversationManager* manager = context;
   if (!manager->conversation) {
-    return false;
+    return 0;
   }
   if (conversation_length(manager->conversation) <= 2) {
-    return false;
+    return 0;
+  }
+  // Entries can only go from the front, so there's no choosing which to evict by size, as the image manager does.
+  const int free_before = bmalloc_bytes_free();
+  int deleted = 0;
+  while (conversation_length(manager->conversation) > 2 && bmalloc_bytes_free() - free_before < (int)bytes_needed) {
+    // Slot 0 can be a deleted thought, and deleting the first entry skips over those, so check what it would delete.
+    if (manager->pinned_entry && conversation_first_entry(manager->conversation) == manager->pinned_entry) {
+      break;
+    }
+    if (manager->deletion_handler) {
+      manager->deletion_handler(0, manager->context);
+    }
+    conversation_delete_first_entry(manager->conversation);
+    deleted++;
   }
-  BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Deleting oldest entry from conversation.");
-  if (manager->deletion_handler) {
-    manager->deletion_handler(0, manager->context);
+  if (deleted == 0) {
+    return 0;
   }
-  conversation_delete_first_entry(manager->conversation);
-  return true;
+  BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Deleted the oldest %d entries from the conversation.", deleted);
+  return memory_pressure_bytes_freed_since(free_before);
 }
\ No newline at end of file
@@ -30,9 +30,18 @@ ConversationManager* conversation_manager_get_current();
 void conversation_manager_destroy(ConversationManager* manager);
 void conversation_manager_set_handler(ConversationManager* manager, ConversationManagerUpdateHandler handler, void* context);
 void conversation_manager_set_deletion_handler(ConversationManager* manager, ConversationManagerEntryDeletedHandler handler);
+// Updates to existing entries are batched up and delivered at most once per interval; 0 delivers each one
+// immediately. New entries are always delivered immediately.
+void conversation_manager_set_update_interval(ConversationManager* manager, uint32_t interval_ms);
+// How many updates have been folded into another rather than delivered on their own.
+uint32_t conversation_manager_get_coalesced_update_count(ConversationManager* manager);
 void conversation_manager_add_input(ConversationManager* manager, const char* input);
 void conversation_manager_add_action(ConversationManager* manager, ConversationAction* action);
 void conversation_manager_add_widget(ConversationManager* manager, ConversationWidget* widget);
+void conversation_manager_add_error(ConversationManager* manager, const char* error_text);
 Conversation* conversation_manager_get_conversation(ConversationManager* manager);
+// Stops memory pressure from deleting the entry, and so anything after it, until another is pinned or NULL is passed.
+// For while something is being built from the entry that might allocate.
+void conversation_manager_pin_entry(ConversationManager* manager, ConversationEntry* entry);
 
 #endif
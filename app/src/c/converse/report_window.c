@@ -24,8 +24,8 @@
 #include "../version/version.h"
 #include "../util/memory/malloc.h"
 #include "../util/memory/sdk.h"
+#include "../util/app_message_router.h"
 #include <pebble.h>
-#include <pebble-events/pebble-events.h>
 
 typedef struct {
   ScrollLayer *scroll_layer;
@@ -33,8 +33,7 @@ typedef struct {
   GBitmap *select_indicator;
   BitmapLayer *select_indicator_layer;
   char thread_uuid[37];
-  char *blurb;
-  EventHandle event_handle;
+  AppMessageRoute *app_message_route;
   GDrawCommandSequence *loading_sequence;
   VectorSequenceLayer *loading_layer;
   Layer *scroll_indicator_down;
@@ -101,14 +100,8 @@ static void prv_window_load(Window *window) {
   };
   content_indicator_configure_direction(indicator, ContentIndicatorDirectionDown, &down_config);
 
-  ResHandle blurb_handle = resource_get_handle(RESOURCE_ID_REPORT_BLURB);
-  size_t blurb_length = resource_size(blurb_handle);
-  data->blurb = bmalloc(blurb_length + 1);
-  resource_load(blurb_handle, (uint8_t *)data->blurb, blurb_length);
-  data->blurb[blurb_length] = '\0';
-
   data->text_layer = formatted_text_layer_create(GRect(5, 5, bounds.size.w - 10, 2000));
-  formatted_text_layer_set_text(data->text_layer, data->blurb);
+  formatted_text_layer_set_precompiled_text(data->text_layer, RESOURCE_ID_REPORT_BLURB);
   GSize text_size = formatted_text_layer_get_content_size(data->text_layer);
   layer_set_frame(formatted_text_layer_get_layer(data->text_layer), GRect(5, 5, bounds.size.w - 10, text_size.h));
   scroll_layer_add_child(data->scroll_layer, formatted_text_layer_get_layer(data->text_layer));
@@ -127,7 +120,8 @@ static void prv_window_load(Window *window) {
   data->loading_layer = vector_sequence_layer_create(GRect(bounds.size.w / 2 - pony_size.w / 2, bounds.size.h / 2 - pony_size.h / 2, pony_size.w, pony_size.h));
   vector_sequence_layer_set_sequence(data->loading_layer, data->loading_sequence);
 
-  data->event_handle = events_app_message_register_inbox_received(prv_app_message_received, window);
+  const uint32_t keys[] = { MESSAGE_KEY_REPORT_SEND_RESULT };
+  data->app_message_route = app_message_router_subscribe(keys, 1, prv_app_message_received, window);
 
   data->busy = false;
 }
@@ -142,9 +136,8 @@ static void prv_window_unload(Window *window) {
   vector_sequence_layer_destroy(data->loading_layer);
   layer_destroy(data->scroll_indicator_down);
   status_bar_layer_destroy(data->status_bar_layer);
-  events_app_message_unsubscribe(data->event_handle);
-  free(data->blurb);
-  free(data);
+  app_message_router_unsubscribe(data->app_message_route);
+  bfree(data);
   window_destroy(window);
 }
 
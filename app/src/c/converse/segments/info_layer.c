@@ -66,7 +66,7 @@ void info_layer_destroy(InfoLayer* layer) {
   InfoLayerData* data = layer_get_data(layer);
   text_layer_destroy(data->content_layer);
   if (data->content_text) {
-    free(data->content_text);
+    bfree(data->content_text);
   }
   if (data->icon) {
     gdraw_command_image_destroy(data->icon);
@@ -210,7 +210,7 @@ static char* prv_generate_action_text(ConversationAction* action) {
       strncpy(buffer, "Checklist updated.", 50);
       break;
     case ConversationActionTypeGenericSentence:
-      free(buffer);
+      bfree(buffer);
       buffer = bmalloc(strlen(action->action.generic_sentence.sentence) + 1);
       strcpy(buffer, action->action.generic_sentence.sentence);
       break;
@@ -16,44 +16,70 @@
 
 #include "message_layer.h"
 #include "../../util/fonts.h"
+#include "../../util/glyph_cache.h"
+#include "../../util/memory/malloc.h"
 #include "../../util/memory/sdk.h"
 #include "../../util/logging.h"
 
 #include <pebble.h>
 
+// No line on a watch screen comes anywhere near this long; text is copied out a line at a time into buffers
+// of this size for measuring and drawing.
+#define MAX_LINE_BYTES 128
+
+// We do our own word wrapping, and keep track of where every line starts. Text is only ever appended, so
+// every line but the last is final once laid out, and updates only need to re-wrap the last one.
+typedef struct {
+  uint16_t offset;
+  // Bytes to draw; any whitespace or newline ending the line isn't included.
+  uint16_t length;
+} MessageLine;
 
 typedef struct {
   ConversationEntry* entry;
   TextLayer* speaker_layer;
-  TextLayer* content_layer;
+  int16_t content_origin_y;
   uint16_t content_height;
-  size_t last_newline_offset;
+  // Distance between the tops of consecutive lines, and the height of a single line on its own.
+  int16_t line_pitch;
+  int16_t line_height;
+  MessageLine* lines;
+  uint16_t line_count;
+  uint16_t line_space;
+  // Firmware text layouts spent wrapping this message so far.
+  uint16_t layout_calls;
 } MessageLayerData;
 
-static char *prv_get_content_text(MessageLayer *layer);
-static int prv_get_content_height(MessageLayer* layer);
+static size_t prv_get_text_length(MessageLayer *layer);
+static size_t prv_copy_text(MessageLayer *layer, size_t offset, char *buffer, size_t size);
+static MessageLine* prv_add_line(MessageLayer *layer);
+static size_t prv_fit_line(GFont font, int16_t width, char *text, size_t length, size_t *consumed);
+static size_t prv_trim_to_break(const char *text, size_t length);
+static void prv_layout(MessageLayer* layer);
+static void prv_layer_update(Layer* layer, GContext* ctx);
 
 MessageLayer* message_layer_create(GRect rect, ConversationEntry* entry) {
     Layer* layer = blayer_create_with_data(rect, sizeof(MessageLayerData));
     MessageLayerData* data = layer_get_data(layer);
     const FontsConfig *fonts = fonts_get_config();
+    memset(data, 0, sizeof(MessageLayerData));
     data->entry = entry;
     data->speaker_layer = btext_layer_create(GRect(5, 0, rect.size.w, fonts->small_font_cap * 1.75));
-    size_t content_origin_y = -5;
+    data->content_origin_y = -5;
     EntryType type = conversation_entry_get_type(entry);
     if (type == EntryTypePrompt) {
       text_layer_set_text(data->speaker_layer, "You");
-      content_origin_y = fonts->small_font_cap * 1.75;
+      data->content_origin_y = fonts->small_font_cap * 1.75;
     }
     text_layer_set_font(data->speaker_layer, fonts->small_font);
     layer_add_child(layer, (Layer *)data->speaker_layer);
-    data->last_newline_offset = 0;
-    data->content_height = prv_get_content_height(layer);
-    data->content_layer = btext_layer_create(GRect(5, content_origin_y, rect.size.w - 10, data->content_height));
-    text_layer_set_text(data->content_layer, prv_get_content_text(layer));
-    text_layer_set_font(data->content_layer, fonts->text_font);
-    data->content_height = text_layer_get_content_size(data->content_layer).h;
-    layer_add_child(layer, (Layer *)data->content_layer);
+    const GRect measure_rect = GRect(0, 0, rect.size.w, 1000);
+    data->line_height = graphics_text_layout_get_content_size("Xg", fonts->text_font, measure_rect, GTextOverflowModeWordWrap, GTextAlignmentLeft).h;
+    data->line_pitch = graphics_text_layout_get_content_size("Xg\nXg", fonts->text_font, measure_rect, GTextOverflowModeWordWrap, GTextAlignmentLeft).h - data->line_height;
+    if (data->line_pitch <= 0) {
+      data->line_pitch = data->line_height;
+    }
+    layer_set_update_proc(layer, prv_layer_update);
     message_layer_update(layer);
     return layer;
 }
@@ -63,87 +89,262 @@ void message_layer_destroy(MessageLayer* layer) {
   if (data->speaker_layer) {
     text_layer_destroy(data->speaker_layer);
   }
-  text_layer_destroy(data->content_layer);
+  bfree(data->lines);
   layer_destroy(layer);
 }
 
 void message_layer_update(MessageLayer* layer) {
   MessageLayerData* data = layer_get_data(layer);
   const FontsConfig *fonts = fonts_get_config();
-  // The text pointer can change out underneath us.
-  text_layer_set_text(data->content_layer, prv_get_content_text(layer));
-  data->content_height = prv_get_content_height(layer);
-  int width = layer_get_bounds(layer).size.w;
+  uint32_t layout_calls = glyph_cache_get_stats()->layout_calls;
+  prv_layout(layer);
+  data->layout_calls += glyph_cache_get_stats()->layout_calls - layout_calls;
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Message is %d lines; %d firmware layouts so far.", data->line_count, data->layout_calls);
   GRect frame = layer_get_frame(layer);
   frame.size.h = data->content_height + 5;
   if (conversation_entry_get_type(data->entry) == EntryTypePrompt) {
     frame.size.h += fonts->small_font_cap * 1.75;
   }
-  text_layer_set_size(data->content_layer, GSize(width - 10, data->content_height + 5));
   layer_set_frame(layer, frame);
+  layer_mark_dirty(layer);
 }
 
-static char *prv_get_content_text(MessageLayer *layer) {
+static size_t prv_get_text_length(MessageLayer *layer) {
   MessageLayerData* data = layer_get_data(layer);
-  ConversationEntry* entry = data->entry;
-  switch(conversation_entry_get_type(entry)) {
+  switch (conversation_entry_get_type(data->entry)) {
     case EntryTypePrompt:
-      return conversation_entry_get_prompt(entry)->prompt;
+      return strlen(conversation_entry_get_prompt(data->entry)->prompt);
     case EntryTypeResponse:
-      return conversation_entry_get_response(entry)->response;
+      return conversation_entry_get_response(data->entry)->len;
     default:
-      return "(Bobby bug)";
+      return 0;
   }
 }
 
-static int prv_get_content_height(MessageLayer* layer) {
+static size_t prv_copy_text(MessageLayer *layer, size_t offset, char *buffer, size_t size) {
   MessageLayerData* data = layer_get_data(layer);
-  const FontsConfig *fonts = fonts_get_config();
-  // Measuring the whole field every time we add text is way too expensive.
-  // Instead, just try to figure out where we are line breaking. We don't get enough information
-  // from the text layout engine to do this in any particularly clever way, so instead we try
-  // to figure out what's on the current line, and when that spills over to the next line.
-  // Then we figure out (guess) exactly what spilled over and repeat from there.
-  size_t offset = data->last_newline_offset;
-  char* text = prv_get_content_text(layer);
-  const GFont font = fonts->text_font;
-  const GRect rect = GRect(0, 0, layer_get_frame(layer).size.w - 10, 10000);
-  // This algorithm is somewhat buggy (it can't cope with words getting broken; it assumes only one break per
-  // fragment), so for content where speed is less important just actually measure the thing.
-  GTextAlignment alignment = GTextAlignmentLeft;
-  if (conversation_entry_get_type(data->entry) != EntryTypeResponse || conversation_entry_get_response(data->entry)->complete) {
-    return graphics_text_layout_get_content_size(text, font, rect, GTextOverflowModeTrailingEllipsis, alignment).h;
+  switch (conversation_entry_get_type(data->entry)) {
+    case EntryTypePrompt: {
+      const char *prompt = conversation_entry_get_prompt(data->entry)->prompt + offset;
+      strncpy(buffer, prompt, size - 1);
+      buffer[size - 1] = '\0';
+      return strlen(buffer);
+    }
+    case EntryTypeResponse:
+      return conversation_response_copy(conversation_entry_get_response(data->entry), offset, buffer, size);
+    default:
+      strncpy(buffer, "(Bobby bug)", size - 1);
+      buffer[size - 1] = '\0';
+      return strlen(buffer);
   }
-  int height = graphics_text_layout_get_content_size(text + offset, font, rect, GTextOverflowModeTrailingEllipsis, alignment).h;
-  int content_height = data->content_height;
-
-  if (height > fonts->text_font_cap * 2) {
-    int h2 = 0;
-    // we broke to a new line. see if we can figure out where.
-    size_t len = strlen(text + offset);
-    for (int i = len; i > 0; --i) {
-      // TODO: maybe we should just copy it? This could cause us trouble with literals...
-      char c = (text+offset)[i];
-      (text+offset)[i] = 0;
-      h2 = graphics_text_layout_get_content_size(text + offset, font, rect, GTextOverflowModeTrailingEllipsis, alignment).h;
-      (text+offset)[i] = c;
-      if (h2 < height) {
-        // now try to backtrack to where in the text we caused this.
-        // I can't think of any way to infer this from the sizing, so just go back to a word break.
-        for (int j = i - 1; j >= 0; --j) {
-          if ((text+offset)[j] == ' ' || (text+offset)[j] == '-' || (text+offset)[j] == '\n') {
-            i = j+1;
-//            BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "New line starts \"%s\".", text+offset+i);
-            break;
-          }
-        }
-        offset += i;
+}
+
+static MessageLine* prv_add_line(MessageLayer *layer) {
+  MessageLayerData* data = layer_get_data(layer);
+  if (data->line_count == data->line_space) {
+    uint16_t new_space = data->line_space ? data->line_space * 2 : 8;
+    MessageLine *new_lines = bmalloc(sizeof(MessageLine) * new_space);
+    if (data->lines) {
+      memcpy(new_lines, data->lines, sizeof(MessageLine) * data->line_count);
+      bfree(data->lines);
+    }
+    data->lines = new_lines;
+    data->line_space = new_space;
+  }
+  return &data->lines[data->line_count++];
+}
+
+// Measures prefixes of one line's worth of text. While every character seen so far is in the glyph cache
+// the width is predicted without asking the firmware, and kept running so each word only adds its own
+// characters. Past that, the firmware measures everything.
+typedef struct {
+  GFont font;
+  char *text;
+  size_t measured;
+  int16_t width;
+  bool use_firmware;
+} LineMeasure;
+
+// text must be a scratch copy: the firmware path briefly overwrites the byte after length.
+static int16_t prv_text_width(LineMeasure *measure, size_t length) {
+  if (!measure->use_firmware) {
+    if (length < measure->measured) {
+      measure->measured = 0;
+      measure->width = 0;
+    }
+    while (measure->measured < length) {
+      int16_t advance = glyph_cache_get_advance(measure->font, measure->text[measure->measured]);
+      if (advance < 0) {
+        measure->use_firmware = true;
         break;
       }
+      measure->width += advance;
+      measure->measured++;
+    }
+    if (!measure->use_firmware) {
+      return measure->width;
     }
-    data->last_newline_offset = offset;
-    content_height += height - h2;
   }
+  return glyph_cache_layout_width(measure->font, measure->text, length);
+}
+
+// Steps back from offset to the start of the UTF-8 character containing it.
+static size_t prv_char_start(const char *text, size_t offset) {
+  while (offset > 0 && (text[offset] & 0xC0) == 0x80) {
+    --offset;
+  }
+  return offset;
+}
 
-  return content_height;
+// Works out how much of text (which starts a line) fits on that line, breaking between words where
+// possible and within a word only if it doesn't fit on a line by itself. Returns the number of bytes to
+// draw; *consumed is set to where the next line starts, past any spaces or newline ending this one.
+static size_t prv_fit_line_with(LineMeasure *measure, int16_t width, size_t length, size_t *consumed) {
+  char *text = measure->text;
+  size_t fitted = 0;
+  size_t next_start = 0;
+  size_t word_start = 0;
+  while (true) {
+    size_t word_end = word_start;
+    while (word_end < length && text[word_end] != ' ' && text[word_end] != '\n') {
+      ++word_end;
+    }
+    if (prv_text_width(measure, word_end) > width) {
+      if (fitted > 0) {
+        *consumed = next_start;
+        return fitted;
+      }
+      // The first word is too long for a line, so split it at the last character that fits (but always
+      // take at least one, or we'd never get anywhere).
+      size_t low = 1;
+      while (low < word_end && (text[low] & 0xC0) == 0x80) {
+        ++low;
+      }
+      size_t high = word_end;
+      while (high - low > 1) {
+        size_t mid = prv_char_start(text, (low + high) / 2);
+        if (mid <= low) {
+          break;
+        }
+        if (prv_text_width(measure, mid) <= width) {
+          low = mid;
+        } else {
+          high = mid;
+        }
+      }
+      *consumed = low;
+      return low;
+    }
+    fitted = word_end;
+    if (word_end >= length) {
+      *consumed = length;
+      return fitted;
+    }
+    if (text[word_end] == '\n') {
+      *consumed = word_end + 1;
+      return fitted;
+    }
+    next_start = word_end;
+    while (next_start < length && text[next_start] == ' ') {
+      ++next_start;
+    }
+    if (next_start >= length) {
+      *consumed = length;
+      return fitted;
+    }
+    word_start = next_start;
+  }
+}
+
+static size_t prv_fit_line(GFont font, int16_t width, char *text, size_t length, size_t *consumed) {
+  LineMeasure measure = { .font = font, .text = text };
+  size_t fitted = prv_fit_line_with(&measure, width, length, consumed);
+  // A line fitted entirely from predictions is checked once with the firmware, which has the last word.
+  if (!measure.use_firmware && fitted > 0 && glyph_cache_layout_width(font, text, fitted) > width) {
+    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Glyph cache mispredicted a line of %d bytes; measuring it properly.", fitted);
+    measure = (LineMeasure) { .font = font, .text = text, .use_firmware = true };
+    fitted = prv_fit_line_with(&measure, width, length, consumed);
+  }
+  return fitted;
+}
+
+// Returns how much of a buffer cut off at length to keep: up to the last space or newline after the first character if
+// there is one, or else up to the end of the last whole UTF-8 character.
+static size_t prv_trim_to_break(const char *text, size_t length) {
+  for (size_t i = length; i > 1; --i) {
+    if (text[i - 1] == ' ' || text[i - 1] == '\n') {
+      return i;
+    }
+  }
+  size_t last = prv_char_start(text, length - 1);
+  uint8_t lead = text[last];
+  size_t char_length = lead < 0x80 ? 1 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+  // Keep something, even if the text isn't valid UTF-8, or we'd never get past it.
+  if (last + char_length > length && last > 0) {
+    return last;
+  }
+  return length;
+}
+
+static void prv_layout(MessageLayer* layer) {
+  MessageLayerData* data = layer_get_data(layer);
+  const GFont font = fonts_get_config()->text_font;
+  const int16_t width = layer_get_frame(layer).size.w - 10;
+  size_t text_length = prv_get_text_length(layer);
+  char buffer[MAX_LINE_BYTES + 1];
+  size_t offset = 0;
+  // Everything before the last line is settled, so pick up from there.
+  if (data->line_count > 0) {
+    offset = data->lines[--data->line_count].offset;
+  }
+  while (true) {
+    MessageLine *line = prv_add_line(layer);
+    line->offset = offset;
+    line->length = 0;
+    if (offset >= text_length) {
+      break;
+    }
+    size_t available = prv_copy_text(layer, offset, buffer, sizeof(buffer));
+    // If there's more text than fits in the buffer, the copy may have stopped part way through a word or even a
+    // character, and the line fitting would take that for the end of the text.
+    if (offset + available < text_length) {
+      available = prv_trim_to_break(buffer, available);
+      buffer[available] = '\0';
+    }
+    size_t consumed;
+    line->length = prv_fit_line(font, width, buffer, available, &consumed);
+    offset += consumed;
+    // A trailing newline still leaves an empty line after it.
+    if (offset >= text_length && buffer[consumed - 1] != '\n') {
+      break;
+    }
+  }
+  data->content_height = (data->line_count - 1) * data->line_pitch + data->line_height;
+}
+
+static void prv_layer_update(Layer* layer, GContext* ctx) {
+  MessageLayerData* data = layer_get_data(layer);
+  const FontsConfig *fonts = fonts_get_config();
+  GRect bounds = layer_get_bounds(layer);
+  graphics_context_set_text_color(ctx, GColorBlack);
+  char buffer[MAX_LINE_BYTES + 1];
+  // Only draw lines that are actually on screen.
+  int16_t screen_origin = layer_convert_point_to_screen(layer, GPoint(0, data->content_origin_y)).y;
+  int first = screen_origin < 0 ? (-screen_origin - data->line_height) / data->line_pitch : 0;
+  if (first < 0) {
+    first = 0;
+  }
+  for (int i = first; i < data->line_count; ++i) {
+    MessageLine *line = &data->lines[i];
+    int16_t top = data->content_origin_y + i * data->line_pitch;
+    if (screen_origin + i * data->line_pitch > PBL_DISPLAY_HEIGHT) {
+      break;
+    }
+    if (line->length == 0) {
+      continue;
+    }
+    prv_copy_text(layer, line->offset, buffer, line->length + 1);
+    GRect frame = GRect(5, top, bounds.size.w - 10, data->line_height + 5);
+    graphics_draw_text(ctx, buffer, fonts->text_font, frame, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+  }
 }
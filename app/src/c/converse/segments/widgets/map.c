@@ -42,10 +42,18 @@ MapWidget* map_widget_create(GRect rect, ConversationEntry* entry) {
   MapWidgetData* data = layer_get_data(layer);
   data->entry = entry;
   data->bitmap = NULL;
+  data->skull_image = NULL;
   data->loading_layer = thinking_layer_create(GRect(rect.size.w / 2 - THINKING_LAYER_WIDTH / 2, image_size.h / 2 - THINKING_LAYER_HEIGHT / 2, THINKING_LAYER_WIDTH, THINKING_LAYER_HEIGHT));
   layer_add_child(layer, data->loading_layer);
   image_manager_register_callback(image_id, prv_image_updated, layer);
   layer_set_update_proc(layer, prv_layer_update);
+  // The session window recreates widgets that were scrolled out of view, by which point the image may already have
+  // arrived, or been thrown away.
+  if (image_manager_get_image(image_id)) {
+    prv_image_updated(image_id, ImageStatusCompleted, layer);
+  } else if (image_size.h == 0) {
+    prv_image_updated(image_id, ImageStatusDestroyed, layer);
+  }
   return layer;
 }
 
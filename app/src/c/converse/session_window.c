@@ -25,6 +25,7 @@
 #include "../util/action_menu_crimes.h"
 #include "../util/logging.h"
 #include "../util/memory/malloc.h"
+#include "../util/memory/pressure.h"
 #include "../util/memory/sdk.h"
 #include "../vibes/haptic_feedback.h"
 #include "../features.h"
@@ -34,6 +35,27 @@
 #include "report_window.h"
 
 #define PADDING 5
+// Segments this far beyond the top or bottom of the screen keep their layers, so scrolling back and forth
+// a little doesn't keep destroying and recreating them.
+#define SEGMENT_MARGIN 60
+// Segment positions keep growing as old segments are deleted off the top, so every so often we move them all back
+// up before they get anywhere near the limits of an int16_t.
+#define SEGMENT_REBASE_THRESHOLD 8192
+// The contiguous heap the firmware needs to open an action menu, and to run dictation, which needs a ridiculous amount
+// of memory to behave properly. Both are estimates of everything the call allocates, not derived from the firmware.
+// If we can't free that much up we show an error rather than make the call.
+#define ACTION_MENU_HEAP_SIZE 750
+#define DICTATION_HEAP_SIZE 2048
+
+// Everything we need to put a segment back on screen after its layer has been thrown away. Only segments near
+// the viewport (and the newest one, which is still being updated) actually have layers.
+typedef struct {
+  ConversationEntry* entry;
+  SegmentLayer* layer;
+  int16_t top;
+  int16_t height;
+  bool assistant_label;
+} SessionSegment;
 
 struct SessionWindow {
   Window* window;
@@ -42,13 +64,19 @@ struct SessionWindow {
   ScrollLayer* scroll_layer;
   StatusBarLayer* status_layer;
   Layer* scroll_indicator_down;
-  SegmentLayer** segment_layers;
+  SessionSegment* segments;
+  // Holds every segment and the thinking layer. Deleting the top segment moves this up instead of moving everything
+  // in it; content_height, last_prompt_end_offset and segment positions are all relative to it.
+  Layer* segment_container;
+  int16_t container_offset;
+  uint32_t rebases;
   ThinkingLayer* thinking_layer;
   GBitmap* button_bitmap;
   BitmapLayer* button_layer;
   int segment_space;
   int segment_count;
   int segments_deleted;
+  bool updating_segments;
   bool dictation_pending;
   int content_height;
   int last_prompt_end_offset;
@@ -57,6 +85,7 @@ struct SessionWindow {
   int timeout;
   char* starting_prompt;
   char* last_prompt_label;
+  MemoryPressureCallback* memory_pressure_callback;
 };
 
 static void prv_window_load(Window *window);
@@ -73,6 +102,14 @@ static void prv_select_long_pressed(ClickRecognizerRef recognizer, void *context
 static void prv_update_thinking_layer(SessionWindow* sw);
 static int16_t prv_content_height(const SessionWindow* sw);
 static void prv_scrolled_handler(ScrollLayer* scroll_layer, void* context);
+static void prv_update_live_segments(SessionWindow* sw);
+static void prv_create_segment_layer(SessionWindow* sw, int index);
+static void prv_destroy_segment_layer(SessionWindow* sw, int index);
+static void prv_set_segment_height(SessionWindow* sw, int index, int16_t height);
+static bool prv_segment_in_view(SessionWindow* sw, int index, int16_t margin);
+static void prv_rebase_segments(SessionWindow* sw);
+static bool prv_make_room_for_segment(SessionWindow* sw);
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context);
 static void prv_refresh_timeout(SessionWindow* sw);
 static void prv_timed_out(void *ctx);
 static void prv_cancel_timeout(SessionWindow* sw);
@@ -101,12 +138,34 @@ void session_window_push(int timeout, char *starting_prompt) {
   window_stack_push(window, true);
 }
 
+SessionWindowStats session_window_get_stats(SessionWindow *sw) {
+  SessionWindowStats stats = {
+    .segments = sw->segment_count - sw->segments_deleted,
+    .segment_space = sw->segment_space,
+    .container_offset = sw->container_offset,
+    .rebases = sw->rebases,
+  };
+  for (int i = sw->segments_deleted; i < sw->segment_count; ++i) {
+    if (!sw->segments[i].layer) {
+      continue;
+    }
+    stats.layers++;
+    if (i < sw->segment_count - 1 && !prv_segment_in_view(sw, i, SEGMENT_MARGIN)) {
+      stats.layers_out_of_view++;
+    }
+  }
+  return stats;
+}
+
 static void prv_destroy(SessionWindow *sw) {
   BOBBY_LOG(APP_LOG_LEVEL_INFO, "destroying SessionWindow %p.", sw);
   prv_cancel_timeout(sw);
+  memory_pressure_unregister_callback(sw->memory_pressure_callback);
   dictation_session_destroy(sw->dictation);
   for (int i = sw->segments_deleted; i < sw->segment_count; ++i) {
-    segment_layer_destroy(sw->segment_layers[i]);
+    if (sw->segments[i].layer) {
+      segment_layer_destroy(sw->segments[i].layer);
+    }
   }
   conversation_manager_destroy(sw->manager);
   status_bar_layer_destroy(sw->status_layer);
@@ -118,12 +177,13 @@ static void prv_destroy(SessionWindow *sw) {
     thinking_layer_destroy(sw->thinking_layer);
     sw->thinking_layer = NULL;
   }
-  free(sw->segment_layers);
+  layer_destroy(sw->segment_container);
+  bfree(sw->segments);
   window_destroy(sw->window);
   if (sw->starting_prompt) {
-    free(sw->starting_prompt);
+    bfree(sw->starting_prompt);
   }
-  free(sw);
+  bfree(sw);
 }
 
 static void prv_window_load(Window *window) {
@@ -139,10 +199,10 @@ static void prv_window_load(Window *window) {
   sw->dictation = dictation_session_create(0, prv_dictation_status_callback, sw);
   dictation_session_enable_confirmation(sw->dictation, settings_get_should_confirm_transcripts());
 
-  sw->segment_space = 3;
+  sw->segment_space = 4;
   sw->segment_count = 0;
   sw->segments_deleted = 0;
-  sw->segment_layers = bmalloc(sizeof(SegmentLayer*) * sw->segment_space);
+  sw->segments = bmalloc(sizeof(SessionSegment) * sw->segment_space);
 
   sw->status_layer = bstatus_bar_layer_create();
   bobby_status_bar_config(sw->status_layer);
@@ -175,6 +235,9 @@ static void prv_window_load(Window *window) {
   };
   content_indicator_configure_direction(indicator, ContentIndicatorDirectionDown, &down_config);
   layer_add_child(root_layer, (Layer *)sw->scroll_layer);
+  sw->segment_container = blayer_create(GRect(0, 0, window_size.w, 0));
+  sw->container_offset = 0;
+  scroll_layer_add_child(sw->scroll_layer, sw->segment_container);
   scroll_layer_set_context(sw->scroll_layer, sw);
   scroll_layer_set_callbacks(sw->scroll_layer, (ScrollLayerCallbacks) {
     .click_config_provider = prv_click_config_provider,
@@ -194,6 +257,7 @@ static void prv_window_load(Window *window) {
   // This must be added last.
   layer_add_child(root_layer, sw->scroll_indicator_down);
   window_set_user_data(sw->window, sw);
+  sw->memory_pressure_callback = memory_pressure_register_callback(prv_handle_memory_pressure, 0, sw);
 }
 
 static void prv_window_appear(Window *window) {
@@ -201,7 +265,7 @@ static void prv_window_appear(Window *window) {
   if (sw->starting_prompt) {
     conversation_manager_add_input(sw->manager, sw->starting_prompt);
     sw->query_time = time(NULL);
-    free(sw->starting_prompt);
+    bfree(sw->starting_prompt);
     sw->starting_prompt = NULL;
     sw->dictation_pending = false;
   }
@@ -238,15 +302,18 @@ static void prv_dictation_status_callback(DictationSession *session, DictationSe
 }
 
 static void prv_set_scroll_height(SessionWindow* sw) {
+  GRect container_frame = layer_get_frame(sw->segment_container);
+  container_frame.size.h = sw->content_height;
+  layer_set_frame(sw->segment_container, container_frame);
   GSize old_size = scroll_layer_get_content_size(sw->scroll_layer);
-  GSize new_size = GSize(old_size.w, sw->content_height + PADDING);
+  GSize new_size = GSize(old_size.w, sw->content_height - sw->container_offset + PADDING);
   if (old_size.h >= new_size.h) {
     return;
   }
   scroll_layer_set_content_size(sw->scroll_layer, new_size);
   GPoint offset = scroll_layer_get_content_offset(sw->scroll_layer);
-  if (offset.y > -sw->last_prompt_end_offset) {
-    int scroll_target = -sw->last_prompt_end_offset;
+  int scroll_target = -(sw->last_prompt_end_offset - sw->container_offset);
+  if (offset.y > scroll_target) {
     scroll_layer_set_content_offset(sw->scroll_layer, GPoint(0, scroll_target), false);
   }
 }
@@ -279,7 +346,7 @@ static void prv_update_thinking_layer(SessionWindow* sw) {
   GSize holder_size = scroll_layer_get_content_size(sw->scroll_layer);
   if (!sw->thinking_layer) {
     sw->thinking_layer = thinking_layer_create(GRect((holder_size.w - THINKING_LAYER_WIDTH) / 2, sw->content_height + 5, THINKING_LAYER_WIDTH, THINKING_LAYER_HEIGHT));
-    scroll_layer_add_child(sw->scroll_layer, sw->thinking_layer);
+    layer_add_child(sw->segment_container, sw->thinking_layer);
     sw->content_height += THINKING_LAYER_HEIGHT + 5;
     return;
   }
@@ -300,12 +367,15 @@ static void prv_conversation_manager_handler(bool entry_added, void* context) {
   SessionWindow* sw = context;
   GSize holder_size = scroll_layer_get_content_size(sw->scroll_layer);
   if (!entry_added) {
-    if (sw->segment_count > sw->segments_deleted) {
-      SegmentLayer *layer = sw->segment_layers[sw->segment_count-1];
-      int old_height = layer_get_frame(layer).size.h;
+    // The newest entry might not have a segment, if there was no room for one; then there's nothing to update.
+    Conversation *conversation = conversation_manager_get_conversation(sw->manager);
+    if (sw->segment_count > sw->segments_deleted &&
+        sw->segments[sw->segment_count-1].entry == conversation_peek(conversation)) {
+      // The newest segment should always have a layer, but it's cheap to make sure.
+      prv_create_segment_layer(sw, sw->segment_count-1);
+      SegmentLayer *layer = sw->segments[sw->segment_count-1].layer;
       segment_layer_update(layer);
-      int new_height = layer_get_frame(layer).size.h;
-      sw->content_height = sw->content_height - old_height + new_height;
+      prv_set_segment_height(sw, sw->segment_count-1, layer_get_frame(layer).size.h);
       prv_update_thinking_layer(sw);
       prv_set_scroll_height(sw);
       light_enable_interaction();
@@ -316,16 +386,15 @@ static void prv_conversation_manager_handler(bool entry_added, void* context) {
   // If we have a new entry, we might just want to replace the old segment layer - we don't
   // keep old Thought segments around.
   if (sw->segment_count > sw->segments_deleted) {
-    SegmentLayer* last_layer = sw->segment_layers[sw->segment_count-1];
-    EntryType type = conversation_entry_get_type(segment_layer_get_entry(last_layer));
+    SessionSegment* last_segment = &sw->segments[sw->segment_count-1];
+    EntryType type = conversation_entry_get_type(last_segment->entry);
     if (type == EntryTypeThought) {
       // clean it up
-      sw->content_height -= layer_get_frame(last_layer).size.h;
+      sw->content_height -= last_segment->height;
       prv_update_thinking_layer(sw);
       prv_set_scroll_height(sw);
-      layer_remove_from_parent(last_layer);
-      segment_layer_destroy(last_layer);
-      sw->segment_layers[--sw->segment_count] = NULL;
+      prv_destroy_segment_layer(sw, sw->segment_count-1);
+      --sw->segment_count;
       conversation_delete_last_thought(conversation);
     }
   }
@@ -335,30 +404,34 @@ static void prv_conversation_manager_handler(bool entry_added, void* context) {
     BOBBY_LOG(APP_LOG_LEVEL_ERROR, "We were told a new entry was added, but no entries actually exist????");
     return;
   }
-  if (sw->segment_count == sw->segment_space) {
-    // make room for a new segment
-    SegmentLayer** new_block = bmalloc(sizeof(SegmentLayer*) * ++sw->segment_space);
-    memcpy(new_block, sw->segment_layers, sizeof(SegmentLayer*) * sw->segment_count);
-    free(sw->segment_layers);
-    sw->segment_layers = new_block;
+  if (!prv_make_room_for_segment(sw)) {
+    // The entry stays in the conversation without a segment. The deletion handler knows to expect that.
+    return;
   }
-  SegmentLayer* layer = segment_layer_create(GRect(0, prv_content_height(sw), holder_size.w, 10), entry, conversation_assistant_just_started(conversation));
-  sw->segment_layers[sw->segment_count++] = layer;
+  bool assistant_label = conversation_assistant_just_started(conversation);
+  SegmentLayer* layer = segment_layer_create(GRect(0, prv_content_height(sw), holder_size.w, 10), entry, assistant_label);
   // It's possible that the content height changed *while the layer was being created*. In case this happened, move the
   // layer back to where it should be. Because segment layers are expected to adjust their own frame during
   // construction, we must read its size back first.
   GRect frame = layer_get_frame(layer);
   frame.origin.y = prv_content_height(sw);
   layer_set_frame(layer, frame);
-  scroll_layer_add_child(sw->scroll_layer, layer);
-  int layer_height = layer_get_frame(layer).size.h;
-  sw->content_height += layer_height;
+  layer_add_child(sw->segment_container, layer);
+  sw->segments[sw->segment_count++] = (SessionSegment) {
+    .entry = entry,
+    .layer = layer,
+    .top = frame.origin.y,
+    .height = frame.size.h,
+    .assistant_label = assistant_label,
+  };
+  sw->content_height += frame.size.h;
   EntryType entry_type = conversation_entry_get_type(entry);
   if (entry_type == EntryTypePrompt) {
     sw->last_prompt_end_offset = prv_content_height(sw);
   }
   prv_update_thinking_layer(sw);
   prv_set_scroll_height(sw);
+  prv_update_live_segments(sw);
   light_enable_interaction();
   prv_refresh_timeout(sw);
   // For responses that took longer than five seconds, pulse the vibe when we get useful data.
@@ -393,32 +466,33 @@ static void prv_conversation_entry_deleted_handler(int index, void* context) {
     return;
   }
   SessionWindow* sw = context;
-  // We need to go through every segment that's left and shift it up by the height of the deleted segment
-  SegmentLayer *to_delete = sw->segment_layers[sw->segments_deleted];
-  int16_t removed_height = layer_get_frame(to_delete).size.h;
-  for (int i = sw->segments_deleted + 1; i < sw->segment_count; ++i) {
-    if (sw->segment_layers[i] == NULL) {
-      BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Segment layer %d is NULL (not possible!?)", i);
-      continue;
-    }
-    SegmentLayer *layer = sw->segment_layers[i];
-    GRect frame = layer_get_frame(layer);
-    frame.origin.y -= removed_height;
-    layer_set_frame(layer, frame);
+  // An entry that never got a segment, because there was no room for one, has nothing to remove.
+  ConversationEntry *deleted_entry = conversation_first_entry(conversation_manager_get_conversation(sw->manager));
+  if (sw->segments_deleted >= sw->segment_count || sw->segments[sw->segments_deleted].entry != deleted_entry) {
+    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Deleted entry had no segment.");
+    return;
   }
-  // We need to adjust the height of everything to compensate for the missing segment.
-  sw->content_height -= removed_height;
+  // We need to remove our first segment. Do it before anything else, so nothing tries to give it a layer again while
+  // we scroll.
+  int16_t removed_height = sw->segments[sw->segments_deleted].height;
+  prv_destroy_segment_layer(sw, sw->segments_deleted);
+  sw->segments[sw->segments_deleted].entry = NULL;
+  sw->segments_deleted++;
+  // Everything is in one container, so moving that up is enough to close the gap. We're probably being called from
+  // inside an allocation, so the scroll this causes mustn't create any layers.
+  sw->container_offset += removed_height;
+  GRect container_frame = layer_get_frame(sw->segment_container);
+  container_frame.origin.y = -sw->container_offset;
+  layer_set_frame(sw->segment_container, container_frame);
+  bool updating_segments = sw->updating_segments;
+  sw->updating_segments = true;
   GPoint current_offset = scroll_layer_get_content_offset(sw->scroll_layer);
   GPoint new_offset = GPoint(current_offset.x, current_offset.y - removed_height);
   scroll_layer_set_content_offset(sw->scroll_layer, new_offset, false);
   GSize current_size = scroll_layer_get_content_size(sw->scroll_layer);
   GSize new_size = GSize(current_size.w, current_size.h - removed_height);
   scroll_layer_set_content_size(sw->scroll_layer, new_size);
-  // We need to remove our first segment.
-  layer_remove_from_parent(to_delete);
-  segment_layer_destroy(sw->segment_layers[sw->segments_deleted]);
-  sw->segment_layers[sw->segments_deleted] = NULL;
-  sw->segments_deleted++;
+  sw->updating_segments = updating_segments;
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Removed top segment; adjusted upward by %d pixels.", removed_height);
 }
 
@@ -438,7 +512,7 @@ static void prv_destroy_action_menu(ActionMenu *action_menu, const ActionMenuIte
   SessionWindow *sw = context;
   action_menu_hierarchy_destroy(action_menu_get_root_level(action_menu), NULL, NULL);
   if (sw->last_prompt_label) {
-    free(sw->last_prompt_label);
+    bfree(sw->last_prompt_label);
     sw->last_prompt_label = NULL;
   }
 }
@@ -478,9 +552,15 @@ static void prv_select_long_pressed(ClickRecognizerRef recognizer, void *context
     .context = sw,
     .did_close = prv_destroy_action_menu,
   };
+  if (!bmalloc_reserve(ACTION_MENU_HEAP_SIZE)) {
+    action_menu_hierarchy_destroy(action_menu, NULL, NULL);
+    bfree(sw->last_prompt_label);
+    sw->last_prompt_label = NULL;
+    conversation_manager_add_error(sw->manager, "Not enough memory to open the menu.");
+    return;
+  }
   vibe_haptic_feedback();
   sw->query_time = time(NULL);
-  free(bmalloc(750));
   action_menu_open(&config);
 }
 
@@ -504,9 +584,194 @@ static void prv_action_menu_report_thread(ActionMenu *action_menu, const ActionM
 
 static void prv_scrolled_handler(ScrollLayer* scroll_layer, void* context) {
   SessionWindow* sw = context;
+  prv_update_live_segments(sw);
   prv_refresh_timeout(sw);
 }
 
+// Gives layers to the segments near the viewport, and takes them away from everything else. The newest
+// segment always keeps its layer, because it's the one being updated.
+static void prv_update_live_segments(SessionWindow* sw) {
+  // Creating layers can set off memory pressure, which can scroll us and call back in here.
+  if (sw->updating_segments) {
+    return;
+  }
+  sw->updating_segments = true;
+  if (sw->container_offset > SEGMENT_REBASE_THRESHOLD) {
+    prv_rebase_segments(sw);
+  }
+  int deleted;
+  do {
+    deleted = sw->segments_deleted;
+    // Throw away layers first, so there's as much memory as possible for the new ones.
+    for (int i = sw->segments_deleted; i < sw->segment_count - 1; ++i) {
+      if (sw->segments[i].layer && !prv_segment_in_view(sw, i, SEGMENT_MARGIN)) {
+        prv_destroy_segment_layer(sw, i);
+      }
+    }
+    for (int i = sw->segments_deleted; i < sw->segment_count; ++i) {
+      if (!sw->segments[i].layer && prv_segment_in_view(sw, i, SEGMENT_MARGIN)) {
+        prv_create_segment_layer(sw, i);
+      }
+    }
+    // Deleting segments to make room for those layers scrolls us, which can leave others we made off screen.
+  } while (sw->segments_deleted != deleted);
+  sw->updating_segments = false;
+}
+
+static bool prv_segment_in_view(SessionWindow* sw, int index, int16_t margin) {
+  SessionSegment *segment = &sw->segments[index];
+  int16_t view_top = sw->container_offset - scroll_layer_get_content_offset(sw->scroll_layer).y;
+  int16_t view_bottom = view_top + layer_get_frame((Layer *)sw->scroll_layer).size.h;
+  return segment->top < view_bottom + margin && segment->top + segment->height > view_top - margin;
+}
+
+// Makes sure there's space at the end of segments for one more, returning false if there isn't. Segments deleted off the
+// top are dropped at the same time, so the array only ever needs to be a couple of times the size of what's actually
+// alive. Dropping them is preferred to growing even when only a quarter are deleted: a conversation that has started
+// losing entries is short of memory, and a bigger array would only take more of it away.
+static bool prv_make_room_for_segment(SessionWindow* sw) {
+  if (sw->segment_count < sw->segment_space) {
+    return true;
+  }
+  if (sw->segments_deleted >= sw->segment_space / 4) {
+    int live = sw->segment_count - sw->segments_deleted;
+    memmove(sw->segments, &sw->segments[sw->segments_deleted], sizeof(SessionSegment) * live);
+    sw->segment_count = live;
+    sw->segments_deleted = 0;
+    return true;
+  }
+  int new_space = sw->segment_space * 2;
+  SessionSegment* new_block = bmalloc(sizeof(SessionSegment) * new_space);
+  // Memory pressure during that allocation might have deleted more segments, so only look now.
+  int live = sw->segment_count - sw->segments_deleted;
+  if (new_block == NULL) {
+    // Memory pressure will have deleted everything it could off the top, which is room enough unless the conversation
+    // is down to its last couple of entries.
+    if (sw->segments_deleted == 0) {
+      BOBBY_LOG(APP_LOG_LEVEL_ERROR, "No room for another segment (%d live).", live);
+      return false;
+    }
+    memmove(sw->segments, &sw->segments[sw->segments_deleted], sizeof(SessionSegment) * live);
+    sw->segment_count = live;
+    sw->segments_deleted = 0;
+    return true;
+  }
+  memcpy(new_block, &sw->segments[sw->segments_deleted], sizeof(SessionSegment) * live);
+  bfree(sw->segments);
+  sw->segments = new_block;
+  sw->segment_space = new_space;
+  sw->segment_count = live;
+  sw->segments_deleted = 0;
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Grew segments to %d (%d live).", new_space, live);
+  return true;
+}
+
+// Moves everything in the container back up to the top, so it's at the origin again. This touches every segment, so
+// it only happens once in a long while, and never from memory pressure.
+static void prv_rebase_segments(SessionWindow* sw) {
+  int16_t shift = sw->container_offset;
+  for (int i = sw->segments_deleted; i < sw->segment_count; ++i) {
+    SessionSegment *segment = &sw->segments[i];
+    segment->top -= shift;
+    if (segment->layer) {
+      GRect frame = layer_get_frame(segment->layer);
+      frame.origin.y -= shift;
+      layer_set_frame(segment->layer, frame);
+    }
+  }
+  if (sw->thinking_layer) {
+    GRect frame = layer_get_frame(sw->thinking_layer);
+    frame.origin.y -= shift;
+    layer_set_frame(sw->thinking_layer, frame);
+  }
+  sw->content_height -= shift;
+  sw->last_prompt_end_offset -= shift;
+  sw->container_offset = 0;
+  sw->rebases++;
+  layer_set_frame(sw->segment_container, GRect(0, 0, layer_get_frame(sw->segment_container).size.w, sw->content_height));
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Rebased segments by %d pixels.", shift);
+}
+
+static void prv_create_segment_layer(SessionWindow* sw, int index) {
+  SessionSegment *segment = &sw->segments[index];
+  if (segment->layer) {
+    return;
+  }
+  GSize holder_size = scroll_layer_get_content_size(sw->scroll_layer);
+  // Creating the layer allocates, and memory pressure then deletes the oldest entries, which could be this one while
+  // the layer is still reading it. Pinning it means only the entries before it can go.
+  conversation_manager_pin_entry(sw->manager, segment->entry);
+  SegmentLayer *layer = segment_layer_create(GRect(0, segment->top, holder_size.w, 10), segment->entry, segment->assistant_label);
+  conversation_manager_pin_entry(sw->manager, NULL);
+  // The segment itself is still there, but check anyway: its layer is no use if it's been deleted since.
+  if (index < sw->segments_deleted) {
+    segment_layer_destroy(layer);
+    return;
+  }
+  GRect frame = layer_get_frame(layer);
+  frame.origin.y = segment->top;
+  layer_set_frame(layer, frame);
+  layer_add_child(sw->segment_container, layer);
+  segment->layer = layer;
+  // The entry hasn't changed since we last saw it, but a widget can still come back a different size (e.g. if its
+  // image has since been thrown away).
+  if (frame.size.h != segment->height) {
+    prv_set_segment_height(sw, index, frame.size.h);
+    prv_update_thinking_layer(sw);
+    prv_set_scroll_height(sw);
+  }
+}
+
+static void prv_destroy_segment_layer(SessionWindow* sw, int index) {
+  SessionSegment *segment = &sw->segments[index];
+  if (segment->layer == NULL) {
+    return;
+  }
+  layer_remove_from_parent(segment->layer);
+  segment_layer_destroy(segment->layer);
+  segment->layer = NULL;
+}
+
+// Records a segment's new height, and moves everything after it to match.
+static void prv_set_segment_height(SessionWindow* sw, int index, int16_t height) {
+  int16_t delta = height - sw->segments[index].height;
+  if (delta == 0) {
+    return;
+  }
+  sw->segments[index].height = height;
+  for (int i = index + 1; i < sw->segment_count; ++i) {
+    SessionSegment *segment = &sw->segments[i];
+    segment->top += delta;
+    if (segment->layer) {
+      GRect frame = layer_get_frame(segment->layer);
+      frame.origin.y += delta;
+      layer_set_frame(segment->layer, frame);
+    }
+  }
+  sw->content_height += delta;
+}
+
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context) {
+  SessionWindow *sw = context;
+  // Segments that aren't on screen can be recreated whenever they're scrolled back to, so they're cheap to give up.
+  const int free_before = bmalloc_bytes_free();
+  int destroyed = 0;
+  for (int i = sw->segments_deleted; i < sw->segment_count - 1; ++i) {
+    if (bmalloc_bytes_free() - free_before >= (int)bytes_needed) {
+      break;
+    }
+    if (sw->segments[i].layer && !prv_segment_in_view(sw, i, 0)) {
+      prv_destroy_segment_layer(sw, i);
+      destroyed++;
+    }
+  }
+  if (destroyed == 0) {
+    return 0;
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Freed %d off-screen segment layers.", destroyed);
+  return memory_pressure_bytes_freed_since(free_before);
+}
+
 static void prv_refresh_timeout(SessionWindow* sw) {
   if (sw->timeout == 0) {
     return;
@@ -532,8 +797,10 @@ static void prv_timed_out(void *ctx) {
 }
 
 static void prv_start_dictation(SessionWindow *sw) {
-  // Dictation needs a ridiculous amount of memory to behave properly.
-  free(bmalloc(2048));
+  if (!bmalloc_reserve(DICTATION_HEAP_SIZE)) {
+    conversation_manager_add_error(sw->manager, "Not enough memory to listen.");
+    return;
+  }
 #if !ENABLE_FEATURE_FIXED_PROMPT
   dictation_session_start(sw->dictation);
 #else
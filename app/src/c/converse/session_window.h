@@ -21,7 +21,21 @@
 
 typedef struct SessionWindow SessionWindow;
 
+typedef struct {
+  // Segments not yet deleted, and how many the array has room for.
+  int segments;
+  int segment_space;
+  // Segments that have a layer, and how many of those are neither near the screen nor the newest one.
+  int layers;
+  int layers_out_of_view;
+  int16_t container_offset;
+  // How many times the container has been moved back to the origin.
+  uint32_t rebases;
+} SessionWindowStats;
+
 void session_window_push(int timeout, char *starting_prompt);
 void session_window_destroy(SessionWindow* window);
+// For benchmarks and tests. The SessionWindow is the user data of its window.
+SessionWindowStats session_window_get_stats(SessionWindow* sw);
 
 #endif
@@ -26,6 +26,10 @@
 // If true, the image manager will be available (required for maps to function)
 #define ENABLE_FEATURE_IMAGE_MANAGER 1
 
+// If true, bmalloc tracks how much memory each of its callers holds, and reports it to the phone when asked. This costs
+// eight bytes per allocation from the system heap, one per pool slot, and about a kilobyte for the table itself.
+#define ENABLE_FEATURE_HEAP_ACCOUNTING 0
+
 #if ENABLE_FEATURE_MAPS && !ENABLE_FEATURE_IMAGE_MANAGER
 #error "ENABLE_FEATURE_MAPS requires ENABLE_FEATURE_IMAGE_MANAGER to be enabled."
 #endif
@@ -21,6 +21,7 @@
 #include "../util/memory/malloc.h"
 #include "../util/memory/pressure.h"
 #include "../util/logging.h"
+#include "../util/app_message_router.h"
 #include "image_manager.h"
 
 typedef struct {
@@ -43,21 +44,26 @@ static bool prv_foreach_destroy(void *object, void *context);
 static void prv_handle_new_image(int image_id, size_t size, DictionaryIterator *iterator);
 static void prv_handle_image_chunk(int image_id, size_t offset, DictionaryIterator *iterator);
 static void prv_handle_image_complete(int image_id);
-static bool prv_handle_memory_pressure(void *context);
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context);
 
-static EventHandle *s_appmessage_handle;
+static AppMessageRoute *s_app_message_route;
+static MemoryPressureCallback *s_memory_pressure_callback;
 static LinkedRoot *s_image_list;
 static ManagedImage *s_cached_image_ref = NULL;
 
 void image_manager_init() {
   s_image_list = linked_list_create_root();
   events_app_message_request_inbox_size(1024);
-  s_appmessage_handle = events_app_message_register_inbox_received(prv_inbox_received, NULL);
-  memory_pressure_register_callback(prv_handle_memory_pressure, 0, NULL);
+  // Every image message carries the image ID; everything else we need is found from there.
+  const uint32_t keys[] = { MESSAGE_KEY_IMAGE_ID };
+  s_app_message_route = app_message_router_subscribe(keys, 1, prv_inbox_received, NULL);
+  s_memory_pressure_callback = memory_pressure_register_callback(prv_handle_memory_pressure, 0, NULL);
 }
 
 void image_manager_deinit() {
-  events_app_message_unsubscribe(s_appmessage_handle);
+  app_message_router_unsubscribe(s_app_message_route);
+  memory_pressure_unregister_callback(s_memory_pressure_callback);
+  s_memory_pressure_callback = NULL;
 }
 
 void image_manager_register_callback(int image_id, ImageManagerCallback callback, void *context) {
@@ -138,13 +144,13 @@ static void prv_destroy_image(ManagedImage *image) {
     image->bitmap = NULL;
   }
   if (image->data) {
-    free(image->data);
+    bfree(image->data);
     image->data = NULL;
   }
   if (s_cached_image_ref == image) {
     s_cached_image_ref = NULL;
   }
-  free(image);
+  bfree(image);
 }
 
 static bool prv_foreach_destroy(void *object, void *context) {
@@ -260,13 +266,36 @@ static void prv_handle_image_complete(int image_id) {
 }
 
 
-static bool prv_handle_memory_pressure(void *context) {
-  if (linked_list_count(s_image_list) == 0) {
-    return false;
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context) {
+  int count = linked_list_count(s_image_list);
+  if (count == 0) {
+    return 0;
   }
-  BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Memory pressure! Destroying the oldest image.");
-  ManagedImage *image = linked_list_get(s_image_list, 0);
-  prv_destroy_image(image);
-  linked_list_remove(s_image_list, 0);
-  return true;
+  // If there are ever more images than this, the oldest ones are the ones we consider.
+  if (count > MEMORY_PRESSURE_MAX_CANDIDATES) {
+    count = MEMORY_PRESSURE_MAX_CANDIDATES;
+  }
+  // Each image's data is a single block, so picking by size lets us free one that leaves a big enough gap, rather
+  // than however many of the oldest it takes.
+  size_t sizes[MEMORY_PRESSURE_MAX_CANDIDATES];
+  bool evict[MEMORY_PRESSURE_MAX_CANDIDATES];
+  for (int i = 0; i < count; ++i) {
+    ManagedImage *image = linked_list_get(s_image_list, i);
+    sizes[i] = image->data ? image->size : 0;
+  }
+  if (memory_pressure_plan_eviction(sizes, count, bytes_needed, evict) == 0) {
+    return 0;
+  }
+  const int free_before = bmalloc_bytes_free();
+  // Backwards, so removing an image doesn't move the ones still to go.
+  for (int i = count - 1; i >= 0; --i) {
+    if (!evict[i]) {
+      continue;
+    }
+    ManagedImage *image = linked_list_get(s_image_list, i);
+    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Memory pressure! Destroying image %d (%d bytes).", image->image_id, image->size);
+    prv_destroy_image(image);
+    linked_list_remove(s_image_list, i);
+  }
+  return memory_pressure_bytes_freed_since(free_before);
 }
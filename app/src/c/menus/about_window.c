@@ -97,12 +97,12 @@ static void prv_window_load(Window* window) {
 
 static void prv_window_unload(Window* window) {
   AboutWindowData *data = window_get_user_data(window);
-  free(data->about_text);
+  bfree(data->about_text);
   formatted_text_layer_destroy(data->text_layer);
   scroll_layer_destroy(data->scroll_layer);
   status_bar_layer_destroy(data->status_bar);
   bitmap_layer_destroy(data->bitmap_layer);
   gbitmap_destroy(data->bobby_image);
-  free(data);
+  bfree(data);
   window_destroy(window);
 }
@@ -127,7 +127,7 @@ static void prv_window_unload(Window* window) {
     gdraw_command_image_destroy(data->sleeping_horse_image);
   }
   window_destroy(window);
-  free(data);
+  bfree(data);
 }
 
 static void prv_window_appear(Window* window) {
@@ -22,10 +22,10 @@
 #include "../util/style.h"
 #include "../util/memory/malloc.h"
 #include "../util/memory/sdk.h"
+#include "../util/app_message_router.h"
 #include "../alarms/manager.h"
 #include "../version/version.h"
 #include <pebble.h>
-#include <pebble-events/pebble-events.h>
 
 typedef struct {
   DictationSession *dict_session;
@@ -33,8 +33,7 @@ typedef struct {
   FormattedTextLayer *text_layer;
   GBitmap *select_indicator;
   BitmapLayer *select_indicator_layer;
-  char *blurb;
-  EventHandle event_handle;
+  AppMessageRoute *app_message_route;
   GDrawCommandSequence *loading_sequence;
   VectorSequenceLayer *loading_layer;
   Layer *scroll_indicator_down;
@@ -101,14 +100,8 @@ static void prv_window_load(Window *window) {
   };
   content_indicator_configure_direction(indicator, ContentIndicatorDirectionDown, &down_config);
 
-  ResHandle blurb_handle = resource_get_handle(RESOURCE_ID_FEEDBACK_BLURB);
-  size_t blurb_length = resource_size(blurb_handle);
-  data->blurb = bmalloc(blurb_length + 1);
-  resource_load(blurb_handle, (uint8_t *)data->blurb, blurb_length);
-  data->blurb[blurb_length] = '\0';
-
   data->text_layer = formatted_text_layer_create(GRect(5, 5, bounds.size.w - 10, 2000));
-  formatted_text_layer_set_text(data->text_layer, data->blurb);
+  formatted_text_layer_set_precompiled_text(data->text_layer, RESOURCE_ID_FEEDBACK_BLURB);
   GSize text_size = formatted_text_layer_get_content_size(data->text_layer);
   layer_set_frame(formatted_text_layer_get_layer(data->text_layer), GRect(5, 5, bounds.size.w - 10, text_size.h));
   scroll_layer_add_child(data->scroll_layer, formatted_text_layer_get_layer(data->text_layer));
@@ -131,7 +124,8 @@ static void prv_window_load(Window *window) {
   dictation_session_enable_error_dialogs(data->dict_session, true);
   dictation_session_enable_confirmation(data->dict_session, true);
 
-  data->event_handle = events_app_message_register_inbox_received(prv_app_message_received, window);
+  const uint32_t keys[] = { MESSAGE_KEY_FEEDBACK_SEND_RESULT };
+  data->app_message_route = app_message_router_subscribe(keys, 1, prv_app_message_received, window);
 
   data->busy = false;
 }
@@ -147,9 +141,8 @@ static void prv_window_unload(Window *window) {
   vector_sequence_layer_destroy(data->loading_layer);
   layer_destroy(data->scroll_indicator_down);
   status_bar_layer_destroy(data->status_bar_layer);
-  events_app_message_unsubscribe(data->event_handle);
-  free(data->blurb);
-  free(data);
+  app_message_router_unsubscribe(data->app_message_route);
+  bfree(data);
   window_destroy(window);
 }
 
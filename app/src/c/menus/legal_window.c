@@ -22,7 +22,6 @@
 #include "../util/memory/sdk.h"
 
 typedef struct {
- char *legal_text;
  FormattedTextLayer *text_layer;
  ScrollLayer *scroll_layer;
  StatusBarLayer *status_bar;
@@ -45,11 +44,6 @@ void legal_window_push() {
 
 static void prv_window_load(Window* window) {
  CreditsWindowData *data = window_get_user_data(window);
- ResHandle res_handle = resource_get_handle(RESOURCE_ID_LEGAL_TEXT);
- size_t res_size = resource_size(res_handle);
- data->legal_text = bmalloc(res_size + 1);
- resource_load(res_handle, (uint8_t*)data->legal_text, res_size);
- data->legal_text[res_size] = '\0';
  Layer *root_layer = window_get_root_layer(window);
  GRect window_bounds = layer_get_bounds(root_layer);
  data->status_bar = bstatus_bar_layer_create();
@@ -60,7 +54,7 @@ static void prv_window_load(Window* window) {
  scroll_layer_set_click_config_onto_window(data->scroll_layer, window);
  layer_add_child(root_layer, scroll_layer_get_layer(data->scroll_layer));
  data->text_layer = formatted_text_layer_create(GRect(5, 0, window_bounds.size.w - 10, 10000));
- formatted_text_layer_set_text(data->text_layer, data->legal_text);
+ formatted_text_layer_set_precompiled_text(data->text_layer, RESOURCE_ID_LEGAL_TEXT);
  GSize text_size = formatted_text_layer_get_content_size(data->text_layer);
  scroll_layer_set_content_size(data->scroll_layer, GSize(window_bounds.size.w, text_size.h + 10));
  scroll_layer_add_child(data->scroll_layer, formatted_text_layer_get_layer(data->text_layer));
@@ -68,10 +62,9 @@ static void prv_window_load(Window* window) {
 
 static void prv_window_unload(Window* window) {
  CreditsWindowData *data = window_get_user_data(window);
- free(data->legal_text);
  formatted_text_layer_destroy(data->text_layer);
  scroll_layer_destroy(data->scroll_layer);
  status_bar_layer_destroy(data->status_bar);
- free(data);
+ bfree(data);
  window_destroy(window);
 }
@@ -22,16 +22,16 @@
 #include "../util/memory/malloc.h"
 #include "../util/memory/sdk.h"
 #include "../util/logging.h"
+#include "../util/app_message_router.h"
 
 #include <pebble.h>
-#include <pebble-events/pebble-events.h>
 
 typedef struct {
   UsageLayer* usage_layer;
   TextLayer* explanation_layer;
   GDrawCommandSequence *loading_sequence;
   VectorSequenceLayer* loading_layer;
-  EventHandle app_message_handle;
+  AppMessageRoute *app_message_route;
   ScrollLayer* scroll_layer;
   StatusBarLayer* status_bar;
   char explanation[164];
@@ -77,7 +77,8 @@ static void prv_window_load(Window* window) {
   layer_add_child(root_layer, data->loading_layer);
   layer_add_child(root_layer, (Layer *)data->status_bar);
   vector_sequence_layer_play(data->loading_layer);
-  data->app_message_handle = events_app_message_register_inbox_received(prv_app_message_received, window);
+  const uint32_t keys[] = { MESSAGE_KEY_QUOTA_RESPONSE_USED };
+  data->app_message_route = app_message_router_subscribe(keys, 1, prv_app_message_received, window);
   prv_fetch_quota(window);
 }
 
@@ -87,10 +88,10 @@ static void prv_window_unload(Window* window) {
   text_layer_destroy(data->explanation_layer);
   vector_sequence_layer_destroy(data->loading_layer);
   gdraw_command_sequence_destroy(data->loading_sequence);
-  events_app_message_unsubscribe(data->app_message_handle);
+  app_message_router_unsubscribe(data->app_message_route);
   scroll_layer_destroy(data->scroll_layer);
   status_bar_layer_destroy(data->status_bar);
-  free(data);
+  bfree(data);
   window_destroy(window);
 }
 
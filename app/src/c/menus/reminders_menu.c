@@ -22,8 +22,8 @@
 #include "../util/time.h"
 #include "../util/memory/malloc.h"
 #include "../util/memory/sdk.h"
+#include "../util/app_message_router.h"
 #include <pebble.h>
-#include <pebble-events/pebble-events.h>
 
 typedef struct {
   char *text;
@@ -40,7 +40,7 @@ typedef struct {
   TextLayer *empty_text_layer;
   GDrawCommandImage *sleeping_horse_image;
   VectorLayer *sleeping_horse_layer;
-  EventHandle app_message_handle;
+  AppMessageRoute *app_message_route;
   Reminder *reminders;
   uint16_t num_reminders;
   uint16_t reminders_capacity;
@@ -142,7 +142,8 @@ static void prv_window_load(Window *window) {
   vector_sequence_layer_play(data->loading_layer);
 
   data->loading = true;
-  data->app_message_handle = events_app_message_register_inbox_received(prv_app_message_received, window);
+  const uint32_t keys[] = { MESSAGE_KEY_REMINDER_COUNT, MESSAGE_KEY_REMINDER_TEXT };
+  data->app_message_route = app_message_router_subscribe(keys, sizeof(keys) / sizeof(keys[0]), prv_app_message_received, window);
   prv_fetch_reminders(window);
 }
 
@@ -161,16 +162,16 @@ static void prv_window_unload(Window *window) {
     vector_layer_destroy(data->sleeping_horse_layer);
     gdraw_command_image_destroy(data->sleeping_horse_image);
   }
-  events_app_message_unsubscribe(data->app_message_handle);
+  app_message_router_unsubscribe(data->app_message_route);
   
   // Free all reminder texts and the reminders array
   for (uint16_t i = 0; i < data->num_reminders; i++) {
-    free(data->reminders[i].text);
-    free(data->reminders[i].id);
+    bfree(data->reminders[i].text);
+    bfree(data->reminders[i].id);
   }
-  free(data->reminders);
+  bfree(data->reminders);
   
-  free(data);
+  bfree(data);
   window_destroy(window);
 }
 
@@ -300,8 +301,8 @@ static void prv_delete_reminder_callback(ActionMenu *action_menu, const ActionMe
   for (uint16_t i = 0; i < data->num_reminders; i++) {
     if (strcmp(data->reminders[i].id, reminder->id) == 0) {
       // Free the text of the deleted reminder
-      free(data->reminders[i].text);
-      free(data->reminders[i].id);
+      bfree(data->reminders[i].text);
+      bfree(data->reminders[i].id);
       // Move remaining reminders up
       memmove(&data->reminders[i], &data->reminders[i + 1], 
               (data->num_reminders - i - 1) * sizeof(Reminder));
@@ -126,7 +126,7 @@ static void prv_window_unload(Window* window) {
     }
   }
   s_menu_section.num_items = 0;
-  free(data);
+  bfree(data);
   window_destroy(window);
 }
 
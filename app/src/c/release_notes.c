@@ -84,9 +84,9 @@ static void prv_load(Window *window) {
 
 static void prv_unload(Window *window) {
   ReleaseNotesWindowData *data = window_get_user_data(window);
-  free(data->text);
+  bfree(data->text);
   formatted_text_layer_destroy(data->text_layer);
   scroll_layer_destroy(data->scroll_layer);
-  free(data);
+  bfree(data);
   window_destroy(window);
 }
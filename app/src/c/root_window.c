@@ -21,6 +21,7 @@
 #include "talking_horse_layer.h"
 #include "converse/session_window.h"
 #include "menus/root_menu.h"
+#include "util/app_message_router.h"
 #include "util/logging.h"
 #include "util/style.h"
 #include "util/time.h"
@@ -40,7 +41,7 @@ struct RootWindow {
   TextLayer* version_layer;
   TalkingHorseLayer* talking_horse_layer;
   EventHandle event_handle;
-  EventHandle app_message_handle;
+  AppMessageRoute *app_message_route;
   char time_string[6];
   char version_string[9];
   char** sample_prompts;
@@ -79,7 +80,7 @@ void root_window_push(RootWindow* window) {
 
 void root_window_destroy(RootWindow* window) {
   window_destroy(window->window);
-  free(window);
+  bfree(window);
 }
 
 Window* root_window_get_window(RootWindow* window) {
@@ -144,8 +145,9 @@ static void prv_window_appear(Window* window) {
     time_t now = time(NULL);
     prv_time_changed(localtime(&now), MINUTE_UNIT, rw);
   }
-  if (!rw->app_message_handle) {
-    rw->app_message_handle = events_app_message_register_inbox_received(prv_app_message_handler, rw);
+  if (!rw->app_message_route) {
+    const uint32_t keys[] = { MESSAGE_KEY_COBBLE_WARNING };
+    rw->app_message_route = app_message_router_subscribe(keys, 1, prv_app_message_handler, rw);
   }
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Window appeared. Heap usage increased %d bytes", heap_size - heap_bytes_free());
 }
@@ -157,8 +159,9 @@ static void prv_window_disappear(Window* window) {
     events_tick_timer_service_unsubscribe(rw->event_handle);
     rw->event_handle = NULL;
   }
-  if (rw->app_message_handle) {
-    events_app_message_unsubscribe(rw->app_message_handle);
+  if (rw->app_message_route) {
+    app_message_router_unsubscribe(rw->app_message_route);
+    rw->app_message_route = NULL;
   }
   action_bar_layer_destroy(rw->action_bar);
   gbitmap_destroy(rw->question_icon);
@@ -235,8 +238,8 @@ static void prv_action_menu_closed(ActionMenu *action_menu, const ActionMenuItem
   RootWindow* rw = context;
   action_menu_hierarchy_destroy(action_menu_get_root_level(action_menu), NULL, NULL);
   // memory is allocated for sample_prompts[0], but not the rest of the entries - so just free the first one.
-  free(rw->sample_prompts[0]);
-  free(rw->sample_prompts);
+  bfree(rw->sample_prompts[0]);
+  bfree(rw->sample_prompts);
 }
 
 static void prv_suggestion_clicked(ActionMenu *action_menu, const ActionMenuItem *action, void *context) {
@@ -16,20 +16,26 @@
 
 #include "settings.h"
 #include <pebble.h>
-#include <pebble-events/pebble-events.h>
 
+#include "../util/app_message_router.h"
 #include "../util/persist_keys.h"
 
-static EventHandle s_event_handle;
+static AppMessageRoute *s_app_message_route;
 
 static void prv_app_message_handler(DictionaryIterator *iter, void *context);
 
 void settings_init() {
-  s_event_handle = events_app_message_register_inbox_received(prv_app_message_handler, NULL);
+  const uint32_t keys[] = {
+    MESSAGE_KEY_QUICK_LAUNCH_BEHAVIOUR,
+    MESSAGE_KEY_ALARM_VIBE_PATTERN,
+    MESSAGE_KEY_TIMER_VIBE_PATTERN,
+    MESSAGE_KEY_CONFIRM_TRANSCRIPTS,
+  };
+  s_app_message_route = app_message_router_subscribe(keys, sizeof(keys) / sizeof(keys[0]), prv_app_message_handler, NULL);
 }
 
 void settings_deinit() {
-  events_app_message_unsubscribe(s_event_handle);
+  app_message_router_unsubscribe(s_app_message_route);
 }
 
 QuickLaunchBehaviour settings_get_quick_launch_behaviour() {
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app_message_router.h"
+#include "logging.h"
+#include "memory/malloc.h"
+
+#include <pebble-events/pebble-events.h>
+#include <pebble.h>
+
+// There are rarely more than half a dozen modules listening at once.
+#define MAX_ROUTES 16
+
+struct AppMessageRoute {
+  AppMessageRouteHandler handler;
+  void *context;
+  // The range spanned by keys, so most tuples can be rejected without looking at the list.
+  uint32_t first_key;
+  uint32_t last_key;
+  int key_count;
+  uint32_t keys[];
+};
+
+static AppMessageRoute *s_routes[MAX_ROUTES];
+// The range spanned by every route's keys, for rejecting tuples nobody wants.
+static uint32_t s_first_key;
+static uint32_t s_last_key;
+static AppMessageRouterStats s_stats;
+
+static void prv_inbox_received(DictionaryIterator *iter, void *context);
+static void prv_update_key_range();
+
+void app_message_router_init() {
+  memset(s_routes, 0, sizeof(s_routes));
+  memset(&s_stats, 0, sizeof(s_stats));
+  prv_update_key_range();
+  events_app_message_register_inbox_received(prv_inbox_received, NULL);
+}
+
+AppMessageRoute* app_message_router_subscribe(const uint32_t *keys, int key_count, AppMessageRouteHandler handler, void *context) {
+  int slot = -1;
+  for (int i = 0; i < MAX_ROUTES; ++i) {
+    if (s_routes[i] == NULL) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot == -1) {
+    BOBBY_LOG(APP_LOG_LEVEL_ERROR, "No room for another AppMessage route (handler %p).", handler);
+    return NULL;
+  }
+  AppMessageRoute *route = bmalloc(sizeof(AppMessageRoute) + sizeof(uint32_t) * key_count);
+  route->handler = handler;
+  route->context = context;
+  route->key_count = key_count;
+  route->first_key = UINT32_MAX;
+  route->last_key = 0;
+  for (int i = 0; i < key_count; ++i) {
+    route->keys[i] = keys[i];
+    if (keys[i] < route->first_key) {
+      route->first_key = keys[i];
+    }
+    if (keys[i] > route->last_key) {
+      route->last_key = keys[i];
+    }
+  }
+  s_routes[slot] = route;
+  prv_update_key_range();
+  return route;
+}
+
+void app_message_router_unsubscribe(AppMessageRoute *route) {
+  if (route == NULL) {
+    return;
+  }
+  for (int i = 0; i < MAX_ROUTES; ++i) {
+    if (s_routes[i] == route) {
+      s_routes[i] = NULL;
+      bfree(route);
+      prv_update_key_range();
+      return;
+    }
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Tried to unsubscribe unknown AppMessage route %p.", route);
+}
+
+const AppMessageRouterStats* app_message_router_get_stats() {
+  return &s_stats;
+}
+
+static void prv_update_key_range() {
+  s_first_key = UINT32_MAX;
+  s_last_key = 0;
+  for (int i = 0; i < MAX_ROUTES; ++i) {
+    AppMessageRoute *route = s_routes[i];
+    if (route == NULL || route->key_count == 0) {
+      continue;
+    }
+    if (route->first_key < s_first_key) {
+      s_first_key = route->first_key;
+    }
+    if (route->last_key > s_last_key) {
+      s_last_key = route->last_key;
+    }
+  }
+}
+
+static void prv_inbox_received(DictionaryIterator *iter, void *context) {
+  AppMessageRoute *wanted[MAX_ROUTES] = {NULL};
+  uint16_t tuples_visited = 0;
+  uint16_t key_checks = 0;
+  for (Tuple *tuple = dict_read_first(iter); tuple; tuple = dict_read_next(iter)) {
+    tuples_visited++;
+    if (tuple->key < s_first_key || tuple->key > s_last_key) {
+      continue;
+    }
+    for (int i = 0; i < MAX_ROUTES; ++i) {
+      AppMessageRoute *route = s_routes[i];
+      if (route == NULL || wanted[i] == route || tuple->key < route->first_key || tuple->key > route->last_key) {
+        continue;
+      }
+      for (int k = 0; k < route->key_count; ++k) {
+        key_checks++;
+        if (route->keys[k] == tuple->key) {
+          wanted[i] = route;
+          break;
+        }
+      }
+    }
+  }
+  uint8_t handlers_called = 0;
+  for (int i = 0; i < MAX_ROUTES; ++i) {
+    // Handlers can unsubscribe themselves or others, so check the route is still there.
+    AppMessageRoute *route = s_routes[i];
+    if (route == NULL || route != wanted[i]) {
+      continue;
+    }
+    handlers_called++;
+    route->handler(iter, route->context);
+  }
+  s_stats.messages++;
+  s_stats.tuples_visited += tuples_visited;
+  s_stats.key_checks += key_checks;
+  s_stats.handlers_called += handlers_called;
+  s_stats.last_tuples_visited = tuples_visited;
+  s_stats.last_key_checks = key_checks;
+  s_stats.last_handlers_called = handlers_called;
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Routed AppMessage: %d tuples, %d key checks, %d handlers.", tuples_visited, key_checks, handlers_called);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <pebble.h>
+
+// Routes inbound AppMessages to whichever modules asked for one of the keys they contain. Each message is
+// read once, here, and a handler is only called if its message actually concerns it.
+
+typedef struct AppMessageRoute AppMessageRoute;
+typedef void (*AppMessageRouteHandler)(DictionaryIterator *iter, void *context);
+
+typedef struct {
+  // Totals since the router started.
+  uint32_t messages;
+  uint32_t tuples_visited;
+  uint32_t key_checks;
+  uint32_t handlers_called;
+  // The same figures for the most recent message.
+  uint16_t last_tuples_visited;
+  uint16_t last_key_checks;
+  uint8_t last_handlers_called;
+} AppMessageRouterStats;
+
+void app_message_router_init();
+// Calls handler for every inbound message containing at least one of the given keys. The keys are copied.
+// Returns NULL if there's no room for another route.
+AppMessageRoute* app_message_router_subscribe(const uint32_t *keys, int key_count, AppMessageRouteHandler handler, void *context);
+// Safe to call from inside a route handler, including the route's own.
+void app_message_router_unsubscribe(AppMessageRoute *route);
+const AppMessageRouterStats* app_message_router_get_stats();
@@ -1,5 +1,6 @@
 #include <pebble.h>
 #include "fonts.h"
+#include "glyph_cache.h"
 
 typedef struct {
   const char *title_font;
@@ -103,6 +104,7 @@ void fonts_load(void) {
 }
 
 void fonts_unload(void) {
+  glyph_cache_clear();
   const FontsSpec *spec = &s_specs[preferred_content_size()];
   prv_unload_font(spec->title_font, s_config.title_font);
   prv_unload_font(spec->text_font, s_config.text_font);
@@ -17,6 +17,7 @@
 
 #include "formatted_text_layer.h"
 #include "fonts.h"
+#include "logging.h"
 #include "memory/malloc.h"
 
 #include <pebble.h>
@@ -29,30 +30,49 @@ typedef enum {
   FragmentTypeBody,
 } FragmentType;
 
+// This is also the format of the fragment table in precompiled text resources (see formatted_text.py), so it can be
+// loaded straight in.
 typedef struct {
-  FragmentType type;
-  const char *text;
-  size_t text_length;
+  uint16_t text_offset;
+  uint16_t text_length;
   int16_t vertical_offset;
+  uint8_t type;
+  uint8_t reserved;
 } TextFragment;
 
+// Precompiled text resources start with this, followed by the fragment table and then the text.
+typedef struct {
+  uint16_t fragment_count;
+  uint16_t reserved;
+} PrecompiledTextHeader;
+
 typedef struct {
   const char* text;
+  // The loaded resource, when the text came from one. fragments and text both point into it, and the fragments are
+  // NUL-terminated.
+  uint8_t* resource;
   GFont title_font;
   GFont subtitle_font;
   GFont body_font;
   TextFragment* fragments;
   size_t fragment_count;
   size_t largest_fragment_length;
+  // Somewhere to copy a fragment to when we need it NUL-terminated; big enough for the largest one.
+  char* buffer;
   GTextAlignment alignment;
   int16_t total_height;
 } FormattedTextLayerData;
 
 static void prv_layer_update(Layer *layer, GContext *ctx);
 static int prv_segment_upper_bound(const char* text);
-static void prv_recalculate(FormattedTextLayer* layer);
+static void prv_relayout(FormattedTextLayer* layer);
+static void prv_free_text(FormattedTextLayerData* data);
+static int64_t prv_time_ms();
 static void prv_fragment(FormattedTextLayerData* data);
 static void prv_layout(FormattedTextLayer* layer);
+static size_t prv_find_first_visible_fragment(FormattedTextLayerData* data, int16_t top);
+static const char* prv_fragment_text(FormattedTextLayerData* data, TextFragment* fragment);
+static bool prv_fragments_are_valid(const TextFragment* fragments, size_t count, const uint8_t* text, size_t text_size);
 
 FormattedTextLayer* formatted_text_layer_create(GRect frame) {
   Layer *layer = blayer_create_with_data(frame, sizeof(FormattedTextLayerData));
@@ -73,38 +93,70 @@ Layer* formatted_text_layer_get_layer(FormattedTextLayer* layer) {
 
 void formatted_text_layer_destroy(FormattedTextLayer* layer) {
   FormattedTextLayerData *data = layer_get_data(layer);
-  free(data->fragments);
+  prv_free_text(data);
   layer_destroy(layer);
 }
 
 void formatted_text_layer_set_text(FormattedTextLayer* layer, const char* text) {
   FormattedTextLayerData *data = layer_get_data(layer);
+  int64_t start = prv_time_ms();
+  prv_free_text(data);
   data->text = text;
-  prv_recalculate(layer);
+  prv_fragment(data);
+  prv_relayout(layer);
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Parsed and laid out %d fragments in %d ms.", data->fragment_count, (int)(prv_time_ms() - start));
+}
+
+void formatted_text_layer_set_precompiled_text(FormattedTextLayer* layer, uint32_t resource_id) {
+  FormattedTextLayerData *data = layer_get_data(layer);
+  int64_t start = prv_time_ms();
+  prv_free_text(data);
+  ResHandle handle = resource_get_handle(resource_id);
+  size_t size = resource_size(handle);
+  if (size < sizeof(PrecompiledTextHeader)) {
+    BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Precompiled text resource %d is too short for a header.", (int)resource_id);
+    return;
+  }
+  data->resource = bmalloc(size);
+  resource_load(handle, data->resource, size);
+  PrecompiledTextHeader *header = (PrecompiledTextHeader *)data->resource;
+  size_t text_start = sizeof(PrecompiledTextHeader) + header->fragment_count * sizeof(TextFragment);
+  if (text_start > size || !prv_fragments_are_valid((TextFragment *)(data->resource + sizeof(PrecompiledTextHeader)),
+                                                    header->fragment_count, data->resource + text_start,
+                                                    size - text_start)) {
+    BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Precompiled text resource %d is corrupt.", (int)resource_id);
+    prv_free_text(data);
+    return;
+  }
+  data->fragments = (TextFragment *)(data->resource + sizeof(PrecompiledTextHeader));
+  data->fragment_count = header->fragment_count;
+  data->text = (const char *)(data->resource + text_start);
+  prv_relayout(layer);
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Loaded and laid out %d precompiled fragments in %d ms.", data->fragment_count, (int)(prv_time_ms() - start));
 }
 
 void formatted_text_layer_set_title_font(FormattedTextLayer* layer, GFont font) {
   FormattedTextLayerData *data = layer_get_data(layer);
   data->title_font = font;
-  prv_recalculate(layer);
+  prv_relayout(layer);
 }
 
 void formatted_text_layer_set_subtitle_font(FormattedTextLayer* layer, GFont font) {
   FormattedTextLayerData *data = layer_get_data(layer);
   data->subtitle_font = font;
-  prv_recalculate(layer);
+  prv_relayout(layer);
 }
 
 void formatted_text_layer_set_body_font(FormattedTextLayer* layer, GFont font) {
   FormattedTextLayerData *data = layer_get_data(layer);
   data->body_font = font;
-  prv_recalculate(layer);
+  prv_relayout(layer);
 }
 
 void formatted_text_layer_set_text_alignment(FormattedTextLayer* layer, GTextAlignment alignment) {
   FormattedTextLayerData *data = layer_get_data(layer);
   data->alignment = alignment;
-  prv_recalculate(layer);
+  prv_relayout(layer);
 }
 
 static void prv_layer_update(Layer *layer, GContext *ctx) {
@@ -116,66 +168,117 @@ static void prv_layer_update(Layer *layer, GContext *ctx) {
     data->body_font,
   };
   graphics_context_set_text_color(ctx, GColorBlack);
-  char *buffer = bmalloc(data->largest_fragment_length + 1);
-  for (size_t i = 0; i < data->fragment_count; ++i) {
+  // This gets called on every frame while scrolling, so it mustn't do anything expensive: find where the screen starts,
+  // and copy out only what's actually on it.
+  int16_t screen_origin = layer_convert_point_to_screen(layer, GPointZero).y;
+  for (size_t i = prv_find_first_visible_fragment(data, -screen_origin - 10); i < data->fragment_count; ++i) {
     TextFragment *fragment = &data->fragments[i];
-    if (fragment->text_length == 0) {
-      continue;
-    }
     // If we're off the bottom of the screen, stop - there's no more work to do.
-    if (layer_convert_point_to_screen(layer, GPoint(0, fragment->vertical_offset)).y > PBL_DISPLAY_HEIGHT) {
+    if (screen_origin + fragment->vertical_offset > PBL_DISPLAY_HEIGHT) {
       break;
     }
-    // If the next fragment starts before the beginning of the screen, skip ahead.
-    if (i < data->fragment_count - 1) {
-      TextFragment *next_fragment = &data->fragments[i+1];
-      if (layer_convert_point_to_screen(layer, GPoint(0, next_fragment->vertical_offset)).y < -10) {
-        continue;
-      }
+    if (fragment->text_length == 0) {
+      continue;
     }
-    // We're at least partially on screen, get to it
     GRect frame = GRect(0, fragment->vertical_offset, bounds.size.w, 10000);
-    strncpy(buffer, fragment->text, fragment->text_length);
-    buffer[fragment->text_length] = '\0';
-    graphics_draw_text(ctx, buffer, font_lookup[fragment->type], frame, GTextOverflowModeWordWrap, data->alignment, NULL);
+    graphics_draw_text(ctx, prv_fragment_text(data, fragment), font_lookup[fragment->type], frame, GTextOverflowModeWordWrap, data->alignment, NULL);
   }
-  free(buffer);
 }
 
-static void prv_fragment(FormattedTextLayerData *data) {
-  if (data->fragments) {
-    free(data->fragments);
+// Returns the last fragment starting above top, which is the first one that can reach below it. Fragments are
+// laid out in order, so their offsets are sorted.
+static size_t prv_find_first_visible_fragment(FormattedTextLayerData* data, int16_t top) {
+  size_t low = 0;
+  size_t high = data->fragment_count;
+  while (high - low > 1) {
+    size_t mid = (low + high) / 2;
+    if (data->fragments[mid].vertical_offset < top) {
+      low = mid;
+    } else {
+      high = mid;
+    }
   }
+  return low;
+}
+
+// Fragments of plain text aren't NUL-terminated, and Pebble doesn't take lengths, so we copy them out first. The result
+// is only good until the next call.
+static const char* prv_fragment_text(FormattedTextLayerData* data, TextFragment* fragment) {
+  if (data->resource) {
+    return data->text + fragment->text_offset;
+  }
+  memcpy(data->buffer, data->text + fragment->text_offset, fragment->text_length);
+  data->buffer[fragment->text_length] = '\0';
+  return data->buffer;
+}
+
+// Precompiled fragments are drawn straight out of the resource, so each one has to lie inside the text that follows
+// the table and end in a NUL, and its type has to pick one of our fonts.
+static bool prv_fragments_are_valid(const TextFragment* fragments, size_t count, const uint8_t* text, size_t text_size) {
+  for (size_t i = 0; i < count; ++i) {
+    const TextFragment *fragment = &fragments[i];
+    size_t end = (size_t)fragment->text_offset + fragment->text_length;
+    if (end >= text_size || text[end] != '\0' || fragment->type > FragmentTypeBody) {
+      BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Precompiled fragment %d runs off the end of the text or has a bad type.", (int)i);
+      return false;
+    }
+  }
+  return true;
+}
+
+static int64_t prv_time_ms() {
+  time_t seconds;
+  uint16_t milliseconds = time_ms(&seconds, NULL);
+  return (int64_t)seconds * 1000 + milliseconds;
+}
+
+static void prv_free_text(FormattedTextLayerData* data) {
+  if (data->resource) {
+    bfree(data->resource);
+  } else {
+    bfree(data->fragments);
+  }
+  bfree(data->buffer);
+  data->resource = NULL;
+  data->fragments = NULL;
+  data->fragment_count = 0;
+  data->buffer = NULL;
+  data->text = NULL;
+  data->total_height = 0;
+}
+
+static void prv_fragment(FormattedTextLayerData *data) {
   int max_fragment_count = prv_segment_upper_bound(data->text);
   data->largest_fragment_length = 0;
+  data->fragment_count = 0;
   data->fragments = bmalloc(max_fragment_count * sizeof(TextFragment));
   size_t text_length = strlen(data->text);
   const char* ptr = data->text;
   TextFragment* last_fragment = &data->fragments[data->fragment_count++];
-  last_fragment->text = ptr;
+  last_fragment->text_offset = 0;
   last_fragment->type = FragmentTypeBody;
   while ((ptr = strchr(ptr, '#')) != NULL) {
-    last_fragment->text_length = ptr - last_fragment->text;
+    last_fragment->text_length = (ptr - data->text) - last_fragment->text_offset;
     if (last_fragment->text_length > data->largest_fragment_length) {
       data->largest_fragment_length = last_fragment->text_length;
     }
 
     TextFragment *fragment = &data->fragments[data->fragment_count++];
-    fragment->text = ptr;
     fragment->text_length = 0;
     int hash_count = 0;
     bool hashing = true;
-    while (fragment->text[fragment->text_length] != '\n') {
-      if (hashing && fragment->text[fragment->text_length] == '#') {
+    while (ptr[fragment->text_length] != '\n' && ptr[fragment->text_length] != '\0') {
+      if (hashing && ptr[fragment->text_length] == '#') {
         ++hash_count;
-        ++fragment->text;
-      } else if (hashing && fragment->text[fragment->text_length] == ' ') {
-        ++fragment->text;
+        ++ptr;
+      } else if (hashing && ptr[fragment->text_length] == ' ') {
+        ++ptr;
       } else {
         hashing = false;
         ++fragment->text_length;
       }
     }
+    fragment->text_offset = ptr - data->text;
     switch (hash_count) {
       case 1:
         fragment->type = FragmentTypeTitle;
@@ -185,20 +288,21 @@ static void prv_fragment(FormattedTextLayerData *data) {
         fragment->type = FragmentTypeSubtitle;
         break;
     }
-    ptr = fragment->text + fragment->text_length;
+    ptr += fragment->text_length;
     if (*ptr == '\n') {
       ++ptr;
     }
     last_fragment = &data->fragments[data->fragment_count++];
-    last_fragment->text = ptr;
+    last_fragment->text_offset = ptr - data->text;
     last_fragment->type = FragmentTypeBody;
   }
   if (last_fragment) {
-    last_fragment->text_length = text_length - (last_fragment->text - data->text);
+    last_fragment->text_length = text_length - last_fragment->text_offset;
     if (last_fragment->text_length > data->largest_fragment_length) {
       data->largest_fragment_length = last_fragment->text_length;
     }
   }
+  data->buffer = bmalloc(data->largest_fragment_length + 1);
 }
 
 static void prv_layout(FormattedTextLayer* layer) {
@@ -206,8 +310,6 @@ static void prv_layout(FormattedTextLayer* layer) {
   GRect bounds = layer_get_bounds(layer);
   GRect sizing_frame = GRect(0, 0, bounds.size.w, 10000);
 
-  char *buffer = bmalloc(data->largest_fragment_length + 1);
-
   GFont font_lookup[3] = {
     data->title_font,
     data->subtitle_font,
@@ -217,27 +319,23 @@ static void prv_layout(FormattedTextLayer* layer) {
   int16_t y = 0;
 
   for (size_t i = 0; i < data->fragment_count; ++i) {
-    // We need to copy the text out of the fragment, because it's not null-terminated, and Pebble doesn't take lengths.
     TextFragment *fragment = &data->fragments[i];
+    // Empty fragments still get an offset, so the offsets stay sorted for prv_find_first_visible_fragment.
+    fragment->vertical_offset = y;
     if (fragment->text_length == 0) {
       continue;
     }
-    strncpy(buffer, fragment->text, fragment->text_length);
-    buffer[fragment->text_length] = '\0';
-    GSize size = graphics_text_layout_get_content_size(buffer, font_lookup[fragment->type], sizing_frame, GTextOverflowModeWordWrap, data->alignment);
-    fragment->vertical_offset = y;
+    GSize size = graphics_text_layout_get_content_size(prv_fragment_text(data, fragment), font_lookup[fragment->type], sizing_frame, GTextOverflowModeWordWrap, data->alignment);
     y += size.h;
   }
   data->total_height = y;
-  free(buffer);
 }
 
-static void prv_recalculate(FormattedTextLayer* layer) {
+static void prv_relayout(FormattedTextLayer* layer) {
   FormattedTextLayerData *data = layer_get_data(layer);
   if (!data->text) {
     return;
   }
-  prv_fragment(data);
   prv_layout(layer);
   layer_mark_dirty(layer);
 }
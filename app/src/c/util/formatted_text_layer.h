@@ -24,6 +24,8 @@ FormattedTextLayer* formatted_text_layer_create(GRect frame);
 Layer* formatted_text_layer_get_layer(FormattedTextLayer* layer);
 void formatted_text_layer_destroy(FormattedTextLayer* layer);
 void formatted_text_layer_set_text(FormattedTextLayer* layer, const char* text);
+// Shows a text resource that was split into fragments at build time by formatted_text.py. The layer loads and owns it.
+void formatted_text_layer_set_precompiled_text(FormattedTextLayer* layer, uint32_t resource_id);
 void formatted_text_layer_set_title_font(FormattedTextLayer* layer, GFont font);
 void formatted_text_layer_set_subtitle_font(FormattedTextLayer* layer, GFont font);
 void formatted_text_layer_set_body_font(FormattedTextLayer* layer, GFont font);
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glyph_cache.h"
+#include "memory/malloc.h"
+
+#include <pebble.h>
+
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH '~'
+#define GLYPH_COUNT (LAST_GLYPH - FIRST_GLYPH + 1)
+#define UNKNOWN_ADVANCE 0xFF
+// One for each font in FontsConfig, though in practice only the text font gets measured.
+#define MAX_FONTS 5
+
+typedef struct {
+  GFont font;
+  // The width of "XX", which is subtracted from "X?X" to find the advance of ?. Measuring characters on their
+  // own wouldn't work for spaces, which the firmware doesn't count at the end of a line.
+  int16_t pair_width;
+  uint8_t advances[GLYPH_COUNT];
+} FontAdvances;
+
+static FontAdvances *s_fonts[MAX_FONTS];
+static GlyphCacheStats s_stats;
+static bool s_disabled;
+
+static FontAdvances* prv_get_font(GFont font);
+static int16_t prv_layout_width(GFont font, const char *text);
+
+int16_t glyph_cache_get_advance(GFont font, char c) {
+  if (s_disabled || c < FIRST_GLYPH || c > LAST_GLYPH) {
+    return -1;
+  }
+  FontAdvances *advances = prv_get_font(font);
+  if (advances == NULL) {
+    return -1;
+  }
+  uint8_t *advance = &advances->advances[c - FIRST_GLYPH];
+  if (*advance == UNKNOWN_ADVANCE) {
+    char text[] = {'X', c, 'X', '\0'};
+    int16_t width = prv_layout_width(font, text) - advances->pair_width;
+    if (width < 0 || width >= UNKNOWN_ADVANCE) {
+      return -1;
+    }
+    *advance = width;
+  }
+  s_stats.predicted_glyphs++;
+  return *advance;
+}
+
+int16_t glyph_cache_layout_width(GFont font, char *text, size_t length) {
+  char saved = text[length];
+  text[length] = '\0';
+  int16_t width = prv_layout_width(font, text);
+  text[length] = saved;
+  return width;
+}
+
+void glyph_cache_clear(void) {
+  for (int i = 0; i < MAX_FONTS; ++i) {
+    bfree(s_fonts[i]);
+    s_fonts[i] = NULL;
+  }
+}
+
+void glyph_cache_set_enabled(bool enabled) {
+  s_disabled = !enabled;
+}
+
+const GlyphCacheStats* glyph_cache_get_stats(void) {
+  return &s_stats;
+}
+
+static FontAdvances* prv_get_font(GFont font) {
+  for (int i = 0; i < MAX_FONTS; ++i) {
+    if (s_fonts[i] == NULL) {
+      FontAdvances *advances = bmalloc(sizeof(FontAdvances));
+      advances->font = font;
+      advances->pair_width = prv_layout_width(font, "XX");
+      memset(advances->advances, UNKNOWN_ADVANCE, sizeof(advances->advances));
+      s_fonts[i] = advances;
+      return advances;
+    }
+    if (s_fonts[i]->font == font) {
+      return s_fonts[i];
+    }
+  }
+  return NULL;
+}
+
+static int16_t prv_layout_width(GFont font, const char *text) {
+  s_stats.layout_calls++;
+  return graphics_text_layout_get_content_size(text, font, GRect(0, 0, 1000, 1000), GTextOverflowModeWordWrap, GTextAlignmentLeft).w;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <pebble.h>
+
+// Remembers how far each printable ASCII character advances the pen in each font, so the width of a run of
+// text can be predicted by adding them up instead of asking the firmware to lay the whole run out again.
+// Pebble fonts have no kerning, so the prediction is exact for the characters we know about. Anything else
+// has to be measured by the firmware.
+
+typedef struct {
+  // Calls into the firmware's text layout engine, including those made to fill the cache.
+  uint32_t layout_calls;
+  // Characters whose advance came from the cache.
+  uint32_t predicted_glyphs;
+} GlyphCacheStats;
+
+// Returns the advance of c in font, or -1 if the cache can't predict it.
+int16_t glyph_cache_get_advance(GFont font, char c);
+// Measures the first length bytes of text with the firmware. text must be a scratch copy: the byte after
+// them is briefly overwritten.
+int16_t glyph_cache_layout_width(GFont font, char *text, size_t length);
+// Forgets every font. Must be called before any font the cache has seen is unloaded.
+void glyph_cache_clear(void);
+// For benchmarks. While disabled the cache predicts nothing, so every width is measured by the firmware, as it was
+// before there was a cache.
+void glyph_cache_set_enabled(bool enabled);
+const GlyphCacheStats* glyph_cache_get_stats(void);
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "arena.h"
+#include "malloc.h"
+#include "../logging.h"
+
+#include <pebble.h>
+
+// Everything we store is made of ints and pointers, so pointer alignment is enough.
+#define ARENA_ALIGNMENT sizeof(void *)
+
+typedef struct ArenaChunk {
+  struct ArenaChunk *prev;
+  struct ArenaChunk *next;
+  uint16_t size;
+  uint16_t used;
+  // Number of allocations from this chunk that haven't been freed yet.
+  uint16_t live;
+  uint8_t data[] __attribute__((aligned(sizeof(void *))));
+} ArenaChunk;
+
+// Every allocation is preceded by a pointer to the chunk it came from, so arena_free can find it.
+typedef struct {
+  ArenaChunk *chunk;
+} ArenaHeader;
+
+struct Arena {
+  ArenaChunk *first;
+  // The chunk we're currently bumping into; always the last one in the list.
+  ArenaChunk *current;
+  size_t chunk_size;
+};
+
+static ArenaChunk *prv_add_chunk(Arena *arena, size_t min_size);
+static void prv_release_chunk(Arena *arena, ArenaChunk *chunk);
+
+Arena *arena_create(size_t chunk_size) {
+  Arena *arena = bmalloc(sizeof(Arena));
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->chunk_size = chunk_size;
+  return arena;
+}
+
+void arena_destroy(Arena *arena) {
+  ArenaChunk *chunk = arena->first;
+  while (chunk) {
+    ArenaChunk *next = chunk->next;
+    bfree(chunk);
+    chunk = next;
+  }
+  bfree(arena);
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+  size_t needed = (sizeof(ArenaHeader) + size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+  ArenaChunk *chunk = arena->current;
+  if (chunk == NULL || chunk->size - chunk->used < needed) {
+    ArenaChunk *old = chunk;
+    chunk = prv_add_chunk(arena, needed);
+    if (!chunk) {
+      return NULL;
+    }
+    // The previous chunk may have been emptied while it was still current; it can go now.
+    if (old && old->live == 0) {
+      prv_release_chunk(arena, old);
+    }
+  }
+  ArenaHeader *header = (ArenaHeader *)(chunk->data + chunk->used);
+  header->chunk = chunk;
+  chunk->used += needed;
+  chunk->live++;
+  return header + 1;
+}
+
+void arena_free(Arena *arena, void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  ArenaChunk *chunk = ((ArenaHeader *)ptr - 1)->chunk;
+  if (--chunk->live > 0) {
+    return;
+  }
+  if (chunk == arena->current) {
+    // Keep the chunk we're allocating from, but start it over.
+    chunk->used = 0;
+    return;
+  }
+  prv_release_chunk(arena, chunk);
+}
+
+static ArenaChunk *prv_add_chunk(Arena *arena, size_t min_size) {
+  size_t size = min_size > arena->chunk_size ? min_size : arena->chunk_size;
+  ArenaChunk *chunk = bmalloc(sizeof(ArenaChunk) + size);
+  if (!chunk) {
+    BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Couldn't allocate %d byte arena chunk.", size);
+    return NULL;
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "New arena chunk %p (%d bytes).", chunk, size);
+  chunk->size = size;
+  chunk->used = 0;
+  chunk->live = 0;
+  chunk->next = NULL;
+  chunk->prev = arena->current;
+  if (arena->current) {
+    arena->current->next = chunk;
+  } else {
+    arena->first = chunk;
+  }
+  arena->current = chunk;
+  return chunk;
+}
+
+static void prv_release_chunk(Arena *arena, ArenaChunk *chunk) {
+  if (chunk->prev) {
+    chunk->prev->next = chunk->next;
+  } else {
+    arena->first = chunk->next;
+  }
+  if (chunk->next) {
+    chunk->next->prev = chunk->prev;
+  } else {
+    arena->current = chunk->prev;
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Released arena chunk %p.", chunk);
+  bfree(chunk);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <pebble.h>
+
+// A chunked bump allocator for groups of small objects that tend to be freed in roughly the order they
+// were allocated. Each allocation costs a four byte back-pointer instead of a full heap block header, and
+// a chunk is returned to the heap once everything allocated from it has been freed.
+typedef struct Arena Arena;
+
+Arena *arena_create(size_t chunk_size);
+void arena_destroy(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+void arena_free(Arena *arena, void *ptr);
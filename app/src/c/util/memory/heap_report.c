@@ -0,0 +1,68 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "heap_report.h"
+#include "malloc.h"
+#include "../app_message_router.h"
+#include "../logging.h"
+
+#include <pebble.h>
+
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+// The layout of each callsite in HEAP_REPORT. The phone decodes this, so keep it in sync with src/pkjs/heap_report.js.
+typedef struct __attribute__((__packed__)) {
+  uint32_t site;
+  uint32_t allocations;
+  uint32_t live_bytes;
+  uint32_t peak_bytes;
+  uint16_t live_count;
+} HeapReportEntry;
+
+static void prv_app_message_received(DictionaryIterator *iter, void *context);
+
+void heap_report_init() {
+  const uint32_t keys[] = { MESSAGE_KEY_HEAP_REPORT_REQUEST };
+  app_message_router_subscribe(keys, 1, prv_app_message_received, NULL);
+}
+
+static void prv_app_message_received(DictionaryIterator *iter, void *context) {
+  const int count = bmalloc_callsite_count();
+  const size_t size = sizeof(HeapReportEntry) * count;
+  HeapReportEntry *entries = bmalloc(size);
+  for (int i = 0; i < count; ++i) {
+    const BmallocCallsiteStats *stats = bmalloc_get_callsite_stats(i);
+    entries[i] = (HeapReportEntry) {
+      .site = stats->site,
+      .allocations = stats->allocations,
+      .live_bytes = stats->live_bytes,
+      .peak_bytes = stats->peak_bytes,
+      .live_count = stats->live_count,
+    };
+  }
+  DictionaryIterator *out;
+  AppMessageResult result = app_message_outbox_begin(&out);
+  if (result == APP_MSG_OK) {
+    dict_write_data(out, MESSAGE_KEY_HEAP_REPORT, (uint8_t *)entries, size);
+    dict_write_int32(out, MESSAGE_KEY_HEAP_REPORT_FREE, heap_bytes_free());
+    app_message_outbox_send();
+  } else {
+    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Couldn't send heap report: %d", result);
+  }
+  bfree(entries);
+}
+#else
+void heap_report_init() {}
+#endif
@@ -20,15 +20,120 @@
 
 #include <pebble.h>
 
+// The address we'll return to, for logging and accounting. Only on the watch is it somewhere we can just read it.
+#ifdef __arm__
+#define CAPTURE_CALLER(name) register uintptr_t lr __asm("lr"); const uintptr_t name = lr
+#else
+#define CAPTURE_CALLER(name) const uintptr_t name = (uintptr_t)__builtin_return_address(0)
+#endif
+
+// Small allocations are served from slabs: blocks from the system heap, carved into equal slots of a few sizes. They
+// make up most of our allocations, and pooling them saves the firmware's per-allocation overhead, keeps them from
+// fragmenting the heap, and is a lot faster.
+#define POOL_COUNT 5
+static const uint16_t s_pool_sizes[POOL_COUNT] = {8, 16, 24, 32, 48};
+// Each slab has room for this much, however it's divided up.
+#define SLAB_PAYLOAD_BYTES 192
+// bmalloc won't go to the system heap with less than this free; slabs don't get to eat into it either.
+#define HEAP_RESERVE 750
+
+typedef struct PoolSlab {
+  struct PoolSlab *next;
+  // Free slots are chained through their first word.
+  void *free_list;
+  uint8_t pool;
+  uint8_t used;
+  uint8_t capacity;
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+  // The callsite index for each slot, stored after the slots themselves.
+  uint8_t *sites;
+#endif
+  uint8_t data[] __attribute__((aligned(8)));
+} PoolSlab;
+
+typedef struct {
+  PoolSlab *slabs;
+  BmallocPoolStats stats;
+} Pool;
+
+static Pool s_pools[POOL_COUNT];
+
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+// Allocations from the system heap are preceded by one of these. It's eight bytes to keep the allocation aligned.
+typedef struct {
+  uint32_t size;
+  uint8_t site;
+  uint8_t reserved[3];
+} AllocationHeader;
+
+// There are around seventy calls to bmalloc, and only some are reachable in any one run. Once the table is full, new
+// callers are all lumped into the first entry.
+#define MAX_CALLSITES 48
+static BmallocCallsiteStats s_callsites[MAX_CALLSITES];
+static int s_callsite_count;
+
+static uint8_t prv_callsite_index(uintptr_t site);
+static void prv_account_alloc(uint8_t site, size_t size);
+static void prv_account_free(uint8_t site, size_t size);
+#endif
+// Every slab from every pool, in address order, so bfree can find the one a pointer is in with a binary search. Once
+// it's full, small allocations go to the heap like everything else; it takes far more of them than fit to get there.
+#define MAX_SLABS 64
+static PoolSlab *s_slabs[MAX_SLABS];
+static int s_slab_count = 0;
+// Bytes in unused slots across all the pools.
+static size_t s_pool_free_bytes = 0;
+
+static void *prv_bmalloc(size_t size, uintptr_t saved_lr);
+static int prv_pool_for_size(size_t size);
+static void *prv_pool_alloc(int pool_index, uintptr_t site);
+static void *prv_heap_alloc(size_t size, uintptr_t site);
+static PoolSlab *prv_find_slab(void *ptr);
+static int prv_slabs_at_or_below(uintptr_t address);
+static void prv_add_slab(PoolSlab *slab);
+static void prv_release_slab(PoolSlab *slab);
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context);
+
+void bmalloc_init() {
+  for (int i = 0; i < POOL_COUNT; ++i) {
+    s_pools[i].slabs = NULL;
+    memset(&s_pools[i].stats, 0, sizeof(BmallocPoolStats));
+    s_pools[i].stats.size = s_pool_sizes[i];
+  }
+  s_pool_free_bytes = 0;
+  s_slab_count = 0;
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+  memset(s_callsites, 0, sizeof(s_callsites));
+  // Entry zero is where callers go once the table is full.
+  s_callsite_count = 1;
+#endif
+  memory_pressure_register_callback(prv_handle_memory_pressure, 0, NULL);
+}
+
 void *bmalloc(size_t size) {
-  register uintptr_t lr __asm("lr");
-  const uintptr_t saved_lr = lr;
+  CAPTURE_CALLER(saved_lr);
+  void *ptr = prv_bmalloc(size, saved_lr);
+  // The trace lines are what the host heap simulator replays; see app/host/heap_sim.c.
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG_VERBOSE, "trace: alloc %d %p %p", size, ptr, saved_lr);
+  return ptr;
+}
+
+static void *prv_bmalloc(size_t size, uintptr_t saved_lr) {
+  int pool_index = prv_pool_for_size(size);
+  if (pool_index >= 0) {
+    void *ptr = prv_pool_alloc(pool_index, saved_lr);
+    if (ptr) {
+      return ptr;
+    }
+    // Couldn't get a new slab, so this one comes from the heap like everything else.
+    s_pools[pool_index].stats.fallbacks++;
+  }
   int heap_size = heap_bytes_free();
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "malloc request: %d; free: %d", size, heap_size);
   while (true) {
     heap_size = heap_bytes_free();
-    if (heap_bytes_free() > 750) {
-      void *ptr = malloc(size);
+    if (heap_bytes_free() > HEAP_RESERVE) {
+      void *ptr = prv_heap_alloc(size, saved_lr);
       if (ptr) {
         BOBBY_LOG(APP_LOG_LEVEL_DEBUG_VERBOSE, "malloc returned %p for caller %p", ptr, saved_lr);
         return ptr;
@@ -37,9 +142,12 @@ void *bmalloc(size_t size) {
     } else {
       BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Low memory (%d byte free); trying to free some before allocating %d bytes.", heap_size, size);
     }
-    if (!memory_pressure_try_free()) {
+    // If there's less than the reserve free we need to get back over it, but if there's enough and we still couldn't
+    // allocate, it's too fragmented, and we need at least a block this size to come free.
+    size_t bytes_needed = heap_size > HEAP_RESERVE ? size : size + HEAP_RESERVE - heap_size;
+    if (memory_pressure_try_free(bytes_needed) == 0) {
       BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Failed to allocate memory: couldn't free enough heap.");
-      void *tried = malloc(size);
+      void *tried = prv_heap_alloc(size, saved_lr);
       if (tried) {
         BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "malloc returned %p for caller %p", tried, saved_lr);
       }
@@ -50,3 +158,258 @@ void *bmalloc(size_t size) {
   }
   return NULL;
 }
+
+bool bmalloc_reserve(size_t size) {
+  CAPTURE_CALLER(saved_lr);
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG_VERBOSE, "trace: reserve %d", size);
+  while (true) {
+    // Only the firmware's own allocator can tell us whether there's a large enough block: heap_bytes_free() counts
+    // every gap, however small. The block goes straight back, into the same gap the firmware will find.
+    void *block = malloc(size);
+    if (block) {
+      free(block);
+      return true;
+    }
+    BOBBY_LOG(APP_LOG_LEVEL_WARNING, "No %d byte block for caller %p (%d bytes free); trying to free some.", size, saved_lr, heap_bytes_free());
+    if (memory_pressure_try_free(size) == 0) {
+      BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Couldn't reserve %d bytes for caller %p.", size, saved_lr);
+      return false;
+    }
+  }
+}
+
+void bfree(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  BOBBY_LOG(APP_LOG_LEVEL_DEBUG_VERBOSE, "trace: free %p", ptr);
+  PoolSlab *slab = prv_find_slab(ptr);
+  if (slab == NULL) {
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+    AllocationHeader *header = (AllocationHeader *)ptr - 1;
+    prv_account_free(header->site, header->size);
+    free(header);
+#else
+    free(ptr);
+#endif
+    return;
+  }
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+  const uint16_t size = s_pool_sizes[slab->pool];
+  prv_account_free(slab->sites[((uint8_t *)ptr - slab->data) / size], size);
+#endif
+  *(void **)ptr = slab->free_list;
+  slab->free_list = ptr;
+  slab->used--;
+  Pool *pool = &s_pools[slab->pool];
+  pool->stats.in_use--;
+  s_pool_free_bytes += s_pool_sizes[slab->pool];
+  if (slab->used > 0) {
+    return;
+  }
+  // Keep one empty slab around so a pool that's hovering around a slab boundary doesn't keep going back to the heap.
+  // Any more than that can go straight away; the last one goes if we're short on memory.
+  for (PoolSlab *other = pool->slabs; other; other = other->next) {
+    if (other != slab && other->used == 0) {
+      prv_release_slab(slab);
+      return;
+    }
+  }
+}
+
+int bmalloc_bytes_free() {
+  return heap_bytes_free() + s_pool_free_bytes;
+}
+
+int bmalloc_pool_count() {
+  return POOL_COUNT;
+}
+
+const BmallocPoolStats *bmalloc_get_pool_stats(int pool_index) {
+  return &s_pools[pool_index].stats;
+}
+
+static int prv_pool_for_size(size_t size) {
+  for (int i = 0; i < POOL_COUNT; ++i) {
+    if (size <= s_pool_sizes[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void *prv_pool_alloc(int pool_index, uintptr_t site) {
+  Pool *pool = &s_pools[pool_index];
+  PoolSlab *slab = pool->slabs;
+  while (slab && slab->free_list == NULL) {
+    slab = slab->next;
+  }
+  if (slab == NULL) {
+    const uint16_t size = s_pool_sizes[pool_index];
+    const uint8_t capacity = SLAB_PAYLOAD_BYTES / size;
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+    const size_t slab_size = sizeof(PoolSlab) + capacity * (size + 1);
+#else
+    const size_t slab_size = sizeof(PoolSlab) + capacity * size;
+#endif
+    if (s_slab_count == MAX_SLABS || heap_bytes_free() < HEAP_RESERVE + (int)slab_size) {
+      return NULL;
+    }
+    slab = malloc(slab_size);
+    if (slab == NULL) {
+      return NULL;
+    }
+    slab->pool = pool_index;
+    slab->used = 0;
+    slab->capacity = capacity;
+    slab->free_list = NULL;
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+    slab->sites = &slab->data[capacity * size];
+#endif
+    for (int i = capacity - 1; i >= 0; --i) {
+      void *slot = &slab->data[i * size];
+      *(void **)slot = slab->free_list;
+      slab->free_list = slot;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->stats.slabs++;
+    s_pool_free_bytes += capacity * size;
+    prv_add_slab(slab);
+  }
+  void *ptr = slab->free_list;
+  slab->free_list = *(void **)ptr;
+  slab->used++;
+  pool->stats.allocations++;
+  pool->stats.in_use++;
+  s_pool_free_bytes -= s_pool_sizes[pool_index];
+  if (pool->stats.in_use > pool->stats.peak_in_use) {
+    pool->stats.peak_in_use = pool->stats.in_use;
+  }
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+  const uint8_t site_index = prv_callsite_index(site);
+  slab->sites[((uint8_t *)ptr - slab->data) / s_pool_sizes[pool_index]] = site_index;
+  prv_account_alloc(site_index, s_pool_sizes[pool_index]);
+#endif
+  return ptr;
+}
+
+static void *prv_heap_alloc(size_t size, uintptr_t site) {
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+  AllocationHeader *header = malloc(sizeof(AllocationHeader) + size);
+  if (header == NULL) {
+    return NULL;
+  }
+  header->size = size;
+  header->site = prv_callsite_index(site);
+  prv_account_alloc(header->site, size);
+  return header + 1;
+#else
+  return malloc(size);
+#endif
+}
+
+// The only slab a pointer can be in is the last one starting at or below it; it's from the heap if it isn't.
+static PoolSlab *prv_find_slab(void *ptr) {
+  const uintptr_t address = (uintptr_t)ptr;
+  const int index = prv_slabs_at_or_below(address) - 1;
+  if (index < 0) {
+    return NULL;
+  }
+  PoolSlab *slab = s_slabs[index];
+  if (address >= (uintptr_t)slab->data + slab->capacity * s_pool_sizes[slab->pool]) {
+    return NULL;
+  }
+  return slab;
+}
+
+static int prv_slabs_at_or_below(uintptr_t address) {
+  int low = 0;
+  int high = s_slab_count;
+  while (low < high) {
+    const int middle = (low + high) / 2;
+    if ((uintptr_t)s_slabs[middle] <= address) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+static void prv_add_slab(PoolSlab *slab) {
+  const int index = prv_slabs_at_or_below((uintptr_t)slab);
+  memmove(&s_slabs[index + 1], &s_slabs[index], (s_slab_count - index) * sizeof(PoolSlab *));
+  s_slabs[index] = slab;
+  s_slab_count++;
+}
+
+static void prv_release_slab(PoolSlab *slab) {
+  Pool *pool = &s_pools[slab->pool];
+  PoolSlab **link = &pool->slabs;
+  while (*link != slab) {
+    link = &(*link)->next;
+  }
+  *link = slab->next;
+  const int index = prv_slabs_at_or_below((uintptr_t)slab) - 1;
+  memmove(&s_slabs[index], &s_slabs[index + 1], (s_slab_count - index - 1) * sizeof(PoolSlab *));
+  s_slab_count--;
+  pool->stats.slabs--;
+  s_pool_free_bytes -= slab->capacity * s_pool_sizes[slab->pool];
+  free(slab);
+}
+
+static size_t prv_handle_memory_pressure(size_t bytes_needed, void *context) {
+  size_t freed = 0;
+  for (int i = 0; i < POOL_COUNT && freed < bytes_needed; ++i) {
+    PoolSlab *slab = s_pools[i].slabs;
+    while (slab && freed < bytes_needed) {
+      PoolSlab *next = slab->next;
+      if (slab->used == 0) {
+        freed += sizeof(PoolSlab) + slab->capacity * s_pool_sizes[i];
+        prv_release_slab(slab);
+      }
+      slab = next;
+    }
+  }
+  return freed;
+}
+
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+int bmalloc_callsite_count() {
+  return s_callsite_count;
+}
+
+const BmallocCallsiteStats *bmalloc_get_callsite_stats(int index) {
+  return &s_callsites[index];
+}
+
+static uint8_t prv_callsite_index(uintptr_t site) {
+  for (int i = 1; i < s_callsite_count; ++i) {
+    if (s_callsites[i].site == site) {
+      return i;
+    }
+  }
+  if (s_callsite_count == MAX_CALLSITES) {
+    return 0;
+  }
+  s_callsites[s_callsite_count].site = site;
+  return s_callsite_count++;
+}
+
+static void prv_account_alloc(uint8_t site, size_t size) {
+  BmallocCallsiteStats *stats = &s_callsites[site];
+  stats->allocations++;
+  stats->live_count++;
+  stats->live_bytes += size;
+  if (stats->live_bytes > stats->peak_bytes) {
+    stats->peak_bytes = stats->live_bytes;
+  }
+}
+
+static void prv_account_free(uint8_t site, size_t size) {
+  BmallocCallsiteStats *stats = &s_callsites[site];
+  stats->live_count--;
+  stats->live_bytes -= size;
+}
+#endif
@@ -4,6 +4,48 @@
 
 #pragma once
 
+#include "../../features.h"
+
 #include <pebble.h>
 
+typedef struct {
+  // The largest allocation this pool serves.
+  uint16_t size;
+  uint16_t slabs;
+  uint16_t in_use;
+  uint16_t peak_in_use;
+  uint32_t allocations;
+  // Allocations of this size that went to the system heap because we couldn't get another slab.
+  uint32_t fallbacks;
+} BmallocPoolStats;
+
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+// Allocations made from one place in the code. Pool allocations count the whole slot they occupy; heap allocations
+// count the bytes asked for.
+typedef struct {
+  // The address bmalloc returns to, or zero for the entry that collects callers once the table is full.
+  uintptr_t site;
+  uint32_t allocations;
+  uint32_t live_bytes;
+  uint32_t peak_bytes;
+  uint16_t live_count;
+} BmallocCallsiteStats;
+#endif
+
+// Must be called after memory_pressure_init.
+void bmalloc_init();
 void *bmalloc(size_t size);
+// Frees memory from bmalloc, and nothing else.
+void bfree(void *ptr);
+// Makes sure the system heap has a contiguous block of at least size bytes for a firmware call that's about to need
+// it, evicting no more than it takes through the memory pressure callbacks. Returns false if it couldn't free enough;
+// the caller can still try, but the firmware will probably fail.
+bool bmalloc_reserve(size_t size);
+// heap_bytes_free(), plus whatever is sitting unused in the pools.
+int bmalloc_bytes_free();
+int bmalloc_pool_count();
+const BmallocPoolStats *bmalloc_get_pool_stats(int pool_index);
+#if ENABLE_FEATURE_HEAP_ACCOUNTING
+int bmalloc_callsite_count();
+const BmallocCallsiteStats *bmalloc_get_callsite_stats(int index);
+#endif
@@ -15,96 +15,147 @@
  */
 
 #include "pressure.h"
+#include "malloc.h"
 #include "../logging.h"
 #include <pebble.h>
 
-#include <@rebble/linked-list/linked-list.h>
+// There are usually only a handful of these: the pools, the image manager, and a conversation manager and session
+// window for each session on the stack. A few stacked sessions can use them all up.
+#define MAX_CALLBACKS 8
 
-static LinkedRoot *s_callback_list = NULL;
-int s_max_priority = 0;
-
-typedef struct {
+struct MemoryPressureCallback {
+  // NULL if this slot is free.
   MemoryPressureHandler handler;
   int priority;
   void *context;
-} MemoryPressureCallbackEntry;
+};
 
-static bool prv_entry_compare(void *object1, void *object2);
-static void prv_update_max_priority();
-static bool prv_max_priority_callback(void *object, void *context);
+static MemoryPressureCallback s_callbacks[MAX_CALLBACKS];
+// Indices into s_callbacks, ordered by priority and then registration order, so a sweep is a single pass. Unregistered
+// callbacks are left in place and skipped until the next registration tidies them up.
+static uint8_t s_order[MAX_CALLBACKS];
+static int s_order_count;
+static MemoryPressureStats s_stats;
 
 void memory_pressure_init() {
-  s_callback_list = linked_list_create_root();
+  memset(s_callbacks, 0, sizeof(s_callbacks));
+  s_order_count = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
 }
 
 void memory_pressure_deinit() {
-  linked_list_clear(s_callback_list);
+  memory_pressure_init();
 }
 
-void memory_pressure_register_callback(MemoryPressureHandler handler, int priority, void *context) {
-  MemoryPressureCallbackEntry *entry = malloc(sizeof(MemoryPressureCallbackEntry));
-  entry->handler = handler;
-  entry->priority = priority;
-  entry->context = context;
-  linked_list_append(s_callback_list, entry);
-  if (entry->priority > s_max_priority) {
-    s_max_priority = entry->priority;
+MemoryPressureCallback *memory_pressure_register_callback(MemoryPressureHandler handler, int priority, void *context) {
+  // Drop anything that's been unregistered since last time.
+  int kept = 0;
+  for (int i = 0; i < s_order_count; ++i) {
+    if (s_callbacks[s_order[i]].handler) {
+      s_order[kept++] = s_order[i];
+    }
+  }
+  s_order_count = kept;
+  int slot = -1;
+  for (int i = 0; i < MAX_CALLBACKS; ++i) {
+    if (s_callbacks[i].handler == NULL) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot == -1) {
+    // Whoever asked just won't be asked to give anything up. That's better than stopping the app.
+    BOBBY_LOG(APP_LOG_LEVEL_ERROR, "No room for memory pressure callback %p!", handler);
+    return NULL;
+  }
+  s_callbacks[slot] = (MemoryPressureCallback) {
+    .handler = handler,
+    .priority = priority,
+    .context = context,
+  };
+  int position = s_order_count;
+  while (position > 0 && s_callbacks[s_order[position - 1]].priority > priority) {
+    s_order[position] = s_order[position - 1];
+    --position;
   }
+  s_order[position] = slot;
+  s_order_count++;
   BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "memory_pressure_register_callback: %p, priority %d", handler, priority);
+  return &s_callbacks[slot];
 }
 
-void memory_pressure_unregister_callback(MemoryPressureHandler handler) {
-  int idx = linked_list_find_compare(s_callback_list, handler, prv_entry_compare);
-  if (idx == -1) {
+void memory_pressure_unregister_callback(MemoryPressureCallback *callback) {
+  if (callback == NULL) {
     return;
   }
-  MemoryPressureCallbackEntry *entry = linked_list_get(s_callback_list, idx);
-  linked_list_remove(s_callback_list, idx);
-  if (entry->priority == s_max_priority) {
-    prv_update_max_priority();
-  }
-  free(entry);
+  callback->handler = NULL;
 }
 
-bool memory_pressure_try_free() {
-  BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Memory emergency! Trying to free memory.");
-  int count = linked_list_count(s_callback_list);
-  if (count == 0) {
-    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "No memory freeing callbacks registered");
-    return false;
-  }
-  for (int p = 0; p <= s_max_priority; ++p) {
-    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Trying priority level %d", p);
-    for (int i = 0; i < count; ++i) {
-      MemoryPressureCallbackEntry *entry = linked_list_get(s_callback_list, i);
-      if (entry->priority != p) {
-        continue;
-      }
-      BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Calling memory pressure callback %p with priority %d", entry->handler, entry->priority);
-      if (entry->handler(entry->context)) {
-        BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Freed some memory!");
-        return true;
-      }
+size_t memory_pressure_try_free(size_t bytes_needed) {
+  BOBBY_LOG(APP_LOG_LEVEL_WARNING, "Memory emergency! Trying to free %d bytes.", bytes_needed);
+  size_t freed = 0;
+  s_stats.sweeps++;
+  // A handler might unregister callbacks as it goes, but nothing registers one while we're out of memory, so the order
+  // stays put.
+  for (int i = 0; i < s_order_count; ++i) {
+    MemoryPressureCallback *callback = &s_callbacks[s_order[i]];
+    if (callback->handler == NULL) {
+      continue;
+    }
+    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Calling memory pressure callback %p with priority %d", callback->handler, callback->priority);
+    size_t handler_freed = callback->handler(bytes_needed - freed, callback->context);
+    if (handler_freed == 0) {
       BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "No joy.");
+      continue;
+    }
+    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Freed %d bytes!", handler_freed);
+    s_stats.evictions++;
+    s_stats.bytes_freed += handler_freed;
+    freed += handler_freed;
+    if (freed >= bytes_needed) {
+      return freed;
     }
   }
-  return false;
+  if (freed == 0) {
+    BOBBY_LOG(APP_LOG_LEVEL_DEBUG, "Nothing more to free.");
+  }
+  return freed;
 }
 
-static bool prv_entry_compare(void *object1, void *object2) {
-  MemoryPressureCallbackEntry *entry = object1;
-  return entry->handler == object2;
+size_t memory_pressure_bytes_freed_since(int free_before) {
+  int freed = bmalloc_bytes_free() - free_before;
+  return freed > 0 ? freed : 1;
 }
 
-static void prv_update_max_priority() {
-  s_max_priority = 0;
-  linked_list_foreach(s_callback_list, prv_max_priority_callback, NULL);
+MemoryPressureStats memory_pressure_get_stats() {
+  return s_stats;
 }
 
-static bool prv_max_priority_callback(void *object, void *context) {
-  MemoryPressureCallbackEntry *entry = object;
-  if (entry->priority > s_max_priority) {
-    s_max_priority = entry->priority;
+size_t memory_pressure_plan_eviction(const size_t *sizes, int count, size_t bytes_needed, bool *evict) {
+  int best_fit = -1;
+  for (int i = 0; i < count; ++i) {
+    evict[i] = false;
+    if (sizes[i] >= bytes_needed && (best_fit == -1 || sizes[i] < sizes[best_fit])) {
+      best_fit = i;
+    }
+  }
+  if (best_fit != -1) {
+    evict[best_fit] = true;
+    return sizes[best_fit];
+  }
+  size_t planned = 0;
+  while (planned < bytes_needed) {
+    int largest = -1;
+    for (int i = 0; i < count; ++i) {
+      if (!evict[i] && sizes[i] > 0 && (largest == -1 || sizes[i] > sizes[largest])) {
+        largest = i;
+      }
+    }
+    if (largest == -1) {
+      break;
+    }
+    evict[largest] = true;
+    planned += sizes[largest];
   }
-  return true;
+  return planned;
 }
@@ -18,10 +18,40 @@
 
 #include <pebble.h>
 
-typedef bool (*MemoryPressureHandler)(void *context);
+// Asked to give up at least bytes_needed bytes of heap if it can. Returns how much it freed, which needn't be exact;
+// zero means it had nothing left to give up, and anything else means it may be worth asking again.
+typedef size_t (*MemoryPressureHandler)(size_t bytes_needed, void *context);
+typedef struct MemoryPressureCallback MemoryPressureCallback;
 
 void memory_pressure_init();
 void memory_pressure_deinit();
-void memory_pressure_register_callback(MemoryPressureHandler handler, int priority, void *context);
-void memory_pressure_unregister_callback(MemoryPressureHandler handler);
-bool memory_pressure_try_free();
+// Handlers are called in order of priority, lowest first, and those with the same priority in the order they were
+// registered. There's room for a fixed handful; once they're all taken this logs an error and returns NULL, and the
+// handler is never called. NULL can still be passed to memory_pressure_unregister_callback.
+MemoryPressureCallback *memory_pressure_register_callback(MemoryPressureHandler handler, int priority, void *context);
+// Safe to call from inside a handler.
+void memory_pressure_unregister_callback(MemoryPressureCallback *callback);
+// Calls the handlers in priority order until bytes_needed have been freed or they run out of things to free.
+// Returns how much was freed; zero means there's nothing more to be had.
+size_t memory_pressure_try_free(size_t bytes_needed);
+// For handlers that can't easily count what they freed: how much more memory there is than when bmalloc_bytes_free()
+// returned free_before. It's never less than one, so a handler that gave something up will be asked again.
+size_t memory_pressure_bytes_freed_since(int free_before);
+
+typedef struct {
+  // How often memory_pressure_try_free was called, how many handler calls gave something up, and how much they gave.
+  uint32_t sweeps;
+  uint32_t evictions;
+  uint32_t bytes_freed;
+} MemoryPressureStats;
+
+// Counted since memory_pressure_init.
+MemoryPressureStats memory_pressure_get_stats();
+
+// The most blocks a handler should offer memory_pressure_plan_eviction at once.
+#define MEMORY_PRESSURE_MAX_CANDIDATES 16
+// For handlers that can free any of several blocks: picks which of the count blocks, sized as given, to free to make
+// room for bytes_needed, and sets evict accordingly. If any block is big enough on its own, that's the smallest one
+// that is, because freeing it leaves a gap the allocation is sure to fit in. Otherwise the largest go first, so as few
+// as possible are freed. Returns the total size of the blocks picked.
+size_t memory_pressure_plan_eviction(const size_t *sizes, int count, size_t bytes_needed, bool *evict);
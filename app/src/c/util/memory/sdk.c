@@ -22,69 +22,64 @@
 
 #include "pressure.h"
 
+static size_t prv_resource_heap_size(uint32_t resource_id);
+
+// The sizes reserved here are estimates of everything each call allocates, headers included; they aren't derived from
+// the firmware. The firmware allocates first fit, so one free block that big has room for however the call splits it
+// up. If there isn't one, the call is made anyway, as it always was.
+
 Layer *blayer_create(GRect frame) {
-  void *space = bmalloc(64);
-  free(space);
+  bmalloc_reserve(64);
   return layer_create(frame);
 }
 
 Layer *blayer_create_with_data(GRect frame, size_t data_size) {
-  void *space = bmalloc(data_size + 64 + 8);
-  free(space);
+  bmalloc_reserve(data_size + 64 + 8);
   return layer_create_with_data(frame, data_size);
 }
 
 Window *bwindow_create() {
-  void *space = bmalloc(144);
-  free(space);
+  bmalloc_reserve(144);
   return window_create();
 }
 
 ActionBarLayer *baction_bar_layer_create() {
-  void *space = bmalloc(176);
-  free(space);
+  bmalloc_reserve(176);
   return action_bar_layer_create();
 }
 
 TextLayer *btext_layer_create(GRect frame) {
-  void *space = bmalloc(96);
-  free(space);
+  bmalloc_reserve(96);
   return text_layer_create(frame);
 }
 
 MenuLayer *bmenu_layer_create(GRect frame) {
-  void *space = bmalloc(456);
-  free(space);
+  bmalloc_reserve(456);
   return menu_layer_create(frame);
 }
 
 SimpleMenuLayer *bsimple_menu_layer_create(GRect frame, Window *window, SimpleMenuSection *sections, int32_t num_sections, void *context) {
-  void *space = bmalloc(500);
-  free(space);
+  bmalloc_reserve(500);
   return simple_menu_layer_create(frame, window, sections, num_sections, context);
 }
 
 BitmapLayer *bbitmap_layer_create(GRect frame) {
-  void *space = bmalloc(80);
-  free(space);
+  bmalloc_reserve(80);
   return bitmap_layer_create(frame);
 }
 
 ActionMenuLevel *baction_menu_level_create(int max_items) {
-  void *space = bmalloc(36 + 20 * max_items);
-  free(space);
+  bmalloc_reserve(36 + 20 * max_items);
   return action_menu_level_create(max_items);
 }
 
 ScrollLayer *bscroll_layer_create(GRect frame) {
-  void *space = bmalloc(216);
-  free(space);
+  bmalloc_reserve(216);
   return scroll_layer_create(frame);
 }
 
 StatusBarLayer *bstatus_bar_layer_create() {
-  void *space = bmalloc(204);
-  free(space);
+  bmalloc_reserve(204);
   return status_bar_layer_create();
 }
 
@@ -99,7 +94,7 @@ GBitmap *bgbitmap_create_with_resource(uint32_t resource_id) {
     if (ptr) {
       return ptr;
     }
-    if (!memory_pressure_try_free()) {
+    if (memory_pressure_try_free(prv_resource_heap_size(resource_id)) == 0) {
       BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Failed to allocate memory: couldn't free enough heap.");
       return NULL;
     }
@@ -120,7 +115,7 @@ GDrawCommandImage *bgdraw_command_image_create_with_resource(uint32_t resource_i
     if (ptr) {
       return ptr;
     }
-    if (!memory_pressure_try_free()) {
+    if (memory_pressure_try_free(prv_resource_heap_size(resource_id)) == 0) {
       BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Failed to allocate memory: couldn't free enough heap.");
       return NULL;
     }
@@ -141,7 +136,7 @@ GDrawCommandSequence *bgdraw_command_sequence_create_with_resource(uint32_t reso
     if (ptr) {
       return ptr;
     }
-    if (!memory_pressure_try_free()) {
+    if (memory_pressure_try_free(prv_resource_heap_size(resource_id)) == 0) {
       BOBBY_LOG(APP_LOG_LEVEL_ERROR, "Failed to allocate memory: couldn't free enough heap.");
       return NULL;
     }
@@ -150,3 +145,8 @@ GDrawCommandSequence *bgdraw_command_sequence_create_with_resource(uint32_t reso
   }
   return NULL;
 }
+
+// The firmware loads these resources whole, so their size is a good guess at how much heap they'll need.
+static size_t prv_resource_heap_size(uint32_t resource_id) {
+  return resource_size(resource_get_handle(resource_id));
+}
@@ -106,9 +106,9 @@ static void prv_window_unload(Window* window) {
   status_bar_layer_destroy(data->status_bar);
   app_timer_cancel(data->timer);
   gdraw_command_image_destroy(data->image);
-  free(data->title_text);
-  free(data->text_text);
-  free(data);
+  bfree(data->title_text);
+  bfree(data->text_text);
+  bfree(data);
   window_destroy(window);
 }
 
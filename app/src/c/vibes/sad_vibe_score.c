@@ -45,8 +45,8 @@ void sad_vibe_score_destroy(SadVibeScore* score) {
   if (s_active_vibe_score == score) {
     sad_vibe_score_stop();
   }
-  free(score->notes);
-  free(score);
+  bfree(score->notes);
+  bfree(score);
 }
 
 void sad_vibe_score_play(SadVibeScore* score) {
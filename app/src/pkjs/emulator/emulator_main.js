@@ -1,5 +1,6 @@
 var location = require("../location");
 var reminders = require("../reminders");
+var heapReport = require("../heap_report");
 var emulatorSession = require("./emulator_session");
 var quota = require("../quota");
 var config = require("../config");
@@ -26,6 +27,10 @@ function handleAppMessage(e) {
         return;
     }
 
+    if (heapReport.handleHeapReportMessage(data)) {
+        return;
+    }
+
     if (data.QUOTA_REQUEST) {
         console.log("Requesting quota...");
         quota.handleQuotaRequest();
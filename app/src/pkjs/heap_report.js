@@ -0,0 +1,61 @@
+/**
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Asks the watch how much memory each caller of bmalloc is holding. The watch only answers if it was built with
+// ENABLE_FEATURE_HEAP_ACCOUNTING; from the developer console, run requestHeapReport().
+
+// Matches HeapReportEntry in src/c/util/memory/heap_report.c.
+var ENTRY_SIZE = 18;
+
+function readUint(bytes, offset, length) {
+    var value = 0;
+    for (var i = length - 1; i >= 0; --i) {
+        value = value * 256 + bytes[offset + i];
+    }
+    return value;
+}
+
+exports.request = function() {
+    Pebble.sendAppMessage({HEAP_REPORT_REQUEST: 1});
+};
+
+exports.handleHeapReportMessage = function(data) {
+    if (!('HEAP_REPORT' in data)) {
+        return false;
+    }
+    var bytes = data.HEAP_REPORT;
+    var entries = [];
+    for (var offset = 0; offset + ENTRY_SIZE <= bytes.length; offset += ENTRY_SIZE) {
+        entries.push({
+            site: readUint(bytes, offset, 4),
+            allocations: readUint(bytes, offset + 4, 4),
+            liveBytes: readUint(bytes, offset + 8, 4),
+            peakBytes: readUint(bytes, offset + 12, 4),
+            liveCount: readUint(bytes, offset + 16, 2)
+        });
+    }
+    entries.sort(function(a, b) {
+        return b.liveBytes - a.liveBytes;
+    });
+    console.log("Heap report: " + data.HEAP_REPORT_FREE + " bytes free.");
+    console.log("caller      live bytes (count)  peak bytes  allocations");
+    entries.forEach(function(entry) {
+        // Site zero collects every caller that didn't fit in the watch's table.
+        var site = entry.site === 0 ? "(others)  " : "0x" + ("00000000" + entry.site.toString(16)).slice(-8);
+        console.log(site + "  " + entry.liveBytes + " (" + entry.liveCount + ")  " + entry.peakBytes + "  " + entry.allocations);
+    });
+    return true;
+};
@@ -22,6 +22,7 @@ var clayConfig = require('./config.json');
 var customConfigFunction = require('./custom_config');
 var config = require('./config');
 var reminders = require('./reminders');
+var heapReport = require('./heap_report');
 var feedback = require('./lib/feedback');
 var package_json = require('package.json');
 
@@ -60,6 +61,10 @@ function handleAppMessage(e) {
         return;
     }
 
+    if (heapReport.handleHeapReportMessage(data)) {
+        return;
+    }
+
     if (data.QUOTA_REQUEST) {
         console.log("Requesting quota...");
         quota.handleQuotaRequest();
@@ -95,6 +100,7 @@ Pebble.addEventListener("ready",
         // given how many things bizarrely don't work.
         doCobbleWarning();
         console.log("Bobby " + package_json['version']);
+        window.requestHeapReport = heapReport.request;
         if (Pebble.platform === 'pypkjs') {
             console.log("Entering emulator mode.");
             var emulator_main = require('./emulator/emulator_main');
@@ -19,6 +19,7 @@ var MAX_BYTES_IN_FLIGHT = 400;
 function MessageQueue() {
     this.queue = [];
     this.log = null;
+    this.logStart = 0;
     this.messagesInFlight = 0;
     this.bytesInFlight = 0;
 }
@@ -45,8 +46,11 @@ function countBytes(message) {
     return bytes;
 }
 
+// Each logged entry is {at: <ms after startLogging when the message went to the watch>, message: <the message>}, which
+// is what app/host/replay.c plays back.
 MessageQueue.prototype.startLogging = function() {
     this.log = [];
+    this.logStart = Date.now();
 };
 
 MessageQueue.prototype.stopLogging = function() {
@@ -59,7 +63,7 @@ MessageQueue.prototype.getLog = function() {
 
 MessageQueue.prototype.enqueue = function(message) {
     if (this.log) {
-        this.log.push(message);
+        this.log.push({at: null, message: message});
     }
     this.queue.push(message);
     if (this.messagesInFlight < 6 && this.bytesInFlight < MAX_BYTES_IN_FLIGHT) {
@@ -73,6 +77,14 @@ MessageQueue.prototype.enqueue = function(message) {
 MessageQueue.prototype.dequeue = function() {
     var m = this.queue.shift();
     var mSize = countBytes(m);
+    if (this.log) {
+        for (var i = 0; i < this.log.length; i++) {
+            if (this.log[i].message === m && this.log[i].at === null) {
+                this.log[i].at = Date.now() - this.logStart;
+                break;
+            }
+        }
+    }
     console.log('sending message, remaining: ' + this.queue.length + ', bytes in flight: ' + this.bytesInFlight);
     this.messagesInFlight++;
     this.bytesInFlight += mSize;